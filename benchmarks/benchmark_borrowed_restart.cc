@@ -0,0 +1,131 @@
+/*
+//@HEADER
+// *****************************************************************************
+//
+//                        benchmark_borrowed_restart.cc
+//                 DARMA/magistrate => Serialization Library
+//
+// Copyright 2019 National Technology & Engineering Solutions of Sandia, LLC
+// (NTESS). Under the terms of Contract DE-NA0003525 with NTESS, the U.S.
+// Government retains certain rights in this software.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+//
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// * Neither the name of the copyright holder nor the names of its
+//   contributors may be used to endorse or promote products derived from this
+//   software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// Questions? Contact darma@sandia.gov
+//
+// *****************************************************************************
+//@HEADER
+*/
+
+#include "benchmark_common.h"
+
+#include <checkpoint/checkpoint.h>
+
+#include <cstdio>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace checkpoint { namespace benchmarks {
+
+struct OwnedRestart {
+  template <typename SerializerT>
+  void serialize(SerializerT& s) {
+    s | field | labels;
+  }
+
+  std::vector<double> field;
+  std::vector<std::string> labels;
+};
+
+struct BorrowedRestart {
+  template <typename SerializerT>
+  void serialize(SerializerT& s) {
+    s | field | labels;
+  }
+
+  checkpoint::span<double const> field;
+  std::vector<std::string_view> labels;
+};
+
+}} /* end namespace checkpoint::benchmarks */
+
+int main(int argc, char** argv) {
+  using namespace checkpoint::benchmarks;
+
+  int const reps = getRepetitions(argc, argv, 5);
+  std::size_t const mib = argc > 2 ? std::atoi(argv[2]) : 256;
+  std::string const dir = argc > 3 ? argv[3] : ".";
+
+  OwnedRestart owned;
+  owned.field.assign((mib << 20) / sizeof(double), 1.0);
+  for (int i = 0; i < (1 << 16); i++) {
+    owned.labels.push_back("label-" + std::to_string(i) + std::string(48, 'x'));
+  }
+
+  BorrowedRestart borrowed;
+  borrowed.field = checkpoint::span<double const>(owned.field);
+  for (auto const& l : owned.labels) {
+    borrowed.labels.emplace_back(l);
+  }
+
+  auto const owned_file = dir + "/benchmark_restart_owned.bin";
+  auto const borrowed_file = dir + "/benchmark_restart_borrowed.bin";
+  checkpoint::serializeToFile(owned, owned_file);
+  checkpoint::serializeToFile(borrowed, borrowed_file);
+
+  auto const bytes = checkpoint::getSize(owned);
+
+  printHeader("restart from file: copying vs borrowing deserialization");
+
+  auto const copy = timeMedian(reps, [&]{
+    auto out = checkpoint::deserializeFromFile<OwnedRestart>(owned_file);
+    doNotOptimize(out->field.data());
+  });
+  auto const borrow = timeMedian(reps, [&]{
+    auto out =
+      checkpoint::deserializeBorrowedFromFile<BorrowedRestart>(borrowed_file);
+    doNotOptimize(out->field.data());
+  });
+  auto const borrow_touch = timeMedian(reps, [&]{
+    auto out =
+      checkpoint::deserializeBorrowedFromFile<BorrowedRestart>(borrowed_file);
+    double sum = 0;
+    for (auto x : out->field) {
+      sum += x;
+    }
+    doNotOptimize(sum);
+  });
+
+  printResult("deserializeFromFile (copy)", bytes, copy);
+  printResult("deserializeBorrowedFromFile", bytes, borrow);
+  printResult("deserializeBorrowedFromFile + read", bytes, borrow_touch);
+
+  std::remove(owned_file.c_str());
+  std::remove(borrowed_file.c_str());
+  return 0;
+}
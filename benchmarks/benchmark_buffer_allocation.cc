@@ -0,0 +1,95 @@
+/*
+//@HEADER
+// *****************************************************************************
+//
+//                        benchmark_buffer_allocation.cc
+//                 DARMA/magistrate => Serialization Library
+//
+// Copyright 2019 National Technology & Engineering Solutions of Sandia, LLC
+// (NTESS). Under the terms of Contract DE-NA0003525 with NTESS, the U.S.
+// Government retains certain rights in this software.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+//
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// * Neither the name of the copyright holder nor the names of its
+//   contributors may be used to endorse or promote products derived from this
+//   software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// Questions? Contact darma@sandia.gov
+//
+// *****************************************************************************
+//@HEADER
+*/
+
+#include "benchmark_common.h"
+
+#include <checkpoint/checkpoint.h>
+#include <checkpoint/buffer/allocation.h>
+
+#include <cstring>
+#include <limits>
+#include <memory>
+#include <vector>
+
+int main(int argc, char** argv) {
+  using namespace checkpoint::benchmarks;
+  using checkpoint::buffer::allocateBytes;
+
+  int const reps = getRepetitions(argc, argv, 5);
+
+  std::vector<std::size_t> const sizes = {
+    64ull << 10, 1ull << 20, 16ull << 20, 128ull << 20, 512ull << 20
+  };
+
+  // Source bytes standing in for what the packer copies into the buffer
+  std::vector<char> source(sizes.back(), 'x');
+
+  printHeader("owning buffer allocation + first write of every byte");
+
+  for (auto const size : sizes) {
+    auto const value_init = timeMedian(reps, [&]{
+      auto buf = std::make_unique<char[]>(size);
+      std::memcpy(buf.get(), source.data(), size);
+      doNotOptimize(buf.get());
+    });
+
+    auto const uninit = timeMedian(reps, [&]{
+      auto buf = allocateBytes(size, std::numeric_limits<std::size_t>::max());
+      std::memcpy(buf.get(), source.data(), size);
+      doNotOptimize(buf.get());
+    });
+
+    auto const huge = timeMedian(reps, [&]{
+      auto buf = allocateBytes(size, 0);
+      std::memcpy(buf.get(), source.data(), size);
+      doNotOptimize(buf.get());
+    });
+
+    auto const label = std::to_string(size >> 10) + "KiB";
+    printResult(label + " value-initialized", size, value_init);
+    printResult(label + " uninitialized", size, uninit);
+    printResult(label + " uninitialized+hugepage", size, huge);
+  }
+
+  return 0;
+}
@@ -0,0 +1,143 @@
+/*
+//@HEADER
+// *****************************************************************************
+//
+//                            benchmark_checking.cc
+//                 DARMA/magistrate => Serialization Library
+//
+// Copyright 2019 National Technology & Engineering Solutions of Sandia, LLC
+// (NTESS). Under the terms of Contract DE-NA0003525 with NTESS, the U.S.
+// Government retains certain rights in this software.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+//
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// * Neither the name of the copyright holder nor the names of its
+//   contributors may be used to endorse or promote products derived from this
+//   software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// Questions? Contact darma@sandia.gov
+//
+// *****************************************************************************
+//@HEADER
+*/
+
+#include "benchmark_common.h"
+
+#include <checkpoint/checkpoint.h>
+
+#include <cstdio>
+#include <string>
+#include <vector>
+
+/*
+ * Build once per checking mode (magistrate_serialization_error_checking_enabled
+ * or magistrate_serialization_hash_checking_enabled) and compare the results.
+ */
+
+namespace checkpoint { namespace benchmarks {
+
+struct Particle {
+  template <typename SerializerT>
+  void serialize(SerializerT& s) {
+    s | id | x | y | z | charge;
+  }
+
+  int64_t id = 0;
+  double x = 0, y = 0, z = 0;
+  float charge = 0;
+};
+
+struct Cell {
+  template <typename SerializerT>
+  void serialize(SerializerT& s) {
+    s | index | particles;
+  }
+
+  int index = 0;
+  std::vector<Particle> particles;
+};
+
+struct Payload {
+  Payload() = default;
+  explicit Payload(std::size_t n) : cells(n / 16) {
+    for (std::size_t c = 0; c < cells.size(); c++) {
+      cells[c].index = static_cast<int>(c);
+      cells[c].particles.resize(16);
+      for (std::size_t i = 0; i < 16; i++) {
+        auto& p = cells[c].particles[i];
+        p.id = static_cast<int64_t>(c * 16 + i);
+        p.x = p.y = p.z = 0.5 * i;
+        p.charge = 1.0f;
+      }
+    }
+  }
+
+  template <typename SerializerT>
+  void serialize(SerializerT& s) {
+    s | cells;
+  }
+
+  std::vector<Cell> cells;
+};
+
+char const* getCheckingMode() {
+  #if defined(SERIALIZATION_HASH_CHECKING)
+  return "structure hash checking";
+  #elif defined(SERIALIZATION_ERROR_CHECKING)
+  return "full error checking";
+  #else
+  return "no checking";
+  #endif
+}
+
+}} /* end namespace checkpoint::benchmarks */
+
+int main(int argc, char** argv) {
+  using namespace checkpoint::benchmarks;
+
+  int const reps = getRepetitions(argc, argv, 5);
+
+  Payload payload(1ull << 20);
+  auto const bytes = checkpoint::serialize(payload);
+  auto const size = bytes->getSize();
+
+  printHeader(getCheckingMode());
+  std::printf(
+    "buffer: %llu bytes for %zu particles\n",
+    static_cast<unsigned long long>(size), payload.cells.size() * 16
+  );
+
+  auto const pack = timeMedian(reps, [&]{
+    auto out = checkpoint::serialize(payload);
+    doNotOptimize(out.get());
+  });
+  printResult("serialize", size, pack);
+
+  auto const unpack = timeMedian(reps, [&]{
+    auto out = checkpoint::deserialize<Payload>(bytes->getBuffer());
+    doNotOptimize(out.get());
+  });
+  printResult("deserialize", size, unpack);
+
+  return 0;
+}
@@ -0,0 +1,144 @@
+/*
+//@HEADER
+// *****************************************************************************
+//
+//                            benchmark_checksum.cc
+//                 DARMA/magistrate => Serialization Library
+//
+// Copyright 2019 National Technology & Engineering Solutions of Sandia, LLC
+// (NTESS). Under the terms of Contract DE-NA0003525 with NTESS, the U.S.
+// Government retains certain rights in this software.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+//
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// * Neither the name of the copyright holder nor the names of its
+//   contributors may be used to endorse or promote products derived from this
+//   software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// Questions? Contact darma@sandia.gov
+//
+// *****************************************************************************
+//@HEADER
+*/
+
+#include "benchmark_common.h"
+
+#include <checkpoint/checkpoint.h>
+#include <checkpoint/buffer/checksum.h>
+
+#include <cstdio>
+#include <cstring>
+#include <numeric>
+#include <string>
+#include <vector>
+
+namespace checkpoint { namespace benchmarks {
+
+struct Payload {
+  Payload() = default;
+  explicit Payload(std::size_t n) : values(n) {
+    std::iota(values.begin(), values.end(), 0.5);
+  }
+
+  template <typename SerializerT>
+  void serialize(SerializerT& s) {
+    s | values;
+  }
+
+  std::vector<double> values;
+};
+
+}} /* end namespace checkpoint::benchmarks */
+
+int main(int argc, char** argv) {
+  using namespace checkpoint::benchmarks;
+  namespace buffer = checkpoint::buffer;
+
+  int const reps = getRepetitions(argc, argv, 5);
+
+  std::size_t const len = 256ull << 20;
+  std::vector<char> src(len, 'x'), dst(len);
+  for (std::size_t i = 0; i < len; i += 4096) {
+    src[i] = static_cast<char>(i >> 12);
+  }
+
+  std::printf(
+    "crc32c implementation: %s\n",
+    buffer::hasHardwareCRC32C() ? "sse4.2" : "slicing-by-8"
+  );
+  printHeader("checksum throughput vs memcpy");
+
+  auto const copy = timeMedian(reps, [&]{
+    std::memcpy(dst.data(), src.data(), len);
+    doNotOptimize(dst.data());
+  });
+  printResult("memcpy", len, copy);
+
+  auto const crc = timeMedian(reps, [&]{
+    doNotOptimize(buffer::crc32c(src.data(), len));
+  });
+  printResult("crc32c", len, crc);
+
+  for (unsigned threads : {1u, 4u}) {
+    auto const chunked = timeMedian(reps, [&]{
+      auto crcs = buffer::computeChunkChecksums(
+        src.data(), len, 4ull << 20, threads
+      );
+      doNotOptimize(crcs.data());
+    });
+    printResult(
+      "crc32c 4 MiB chunks, " + std::to_string(threads) + " threads",
+      len, chunked
+    );
+  }
+
+  printHeader("checkpoint file round trip with and without checksums");
+
+  Payload payload(16ull << 20);
+  auto const size = checkpoint::getSize(payload);
+  std::string const file = "benchmark_checksum.out";
+
+  for (bool enabled : {false, true}) {
+    checkpoint::FileWriteOptions options;
+    options.durability = checkpoint::FileDurability::None;
+    options.checksum.enabled = enabled;
+
+    checkpoint::FileReadOptions read_options;
+    read_options.checksum = enabled ?
+      checkpoint::ChecksumVerify::Require : checkpoint::ChecksumVerify::Skip;
+
+    std::string const suffix = enabled ? " (crc32c)" : "";
+    auto const write = timeMedian(reps, [&]{
+      checkpoint::serializeToFile(payload, file, options);
+    });
+    auto const read = timeMedian(reps, [&]{
+      auto out = checkpoint::deserializeFromFile<Payload>(file, read_options);
+      doNotOptimize(out.get());
+    });
+    printResult("serializeToFile" + suffix, size, write);
+    printResult("deserializeFromFile" + suffix, size, read);
+  }
+
+  std::remove(file.c_str());
+  return 0;
+}
@@ -0,0 +1,133 @@
+/*
+//@HEADER
+// *****************************************************************************
+//
+//                              benchmark_common.h
+//                 DARMA/magistrate => Serialization Library
+//
+// Copyright 2019 National Technology & Engineering Solutions of Sandia, LLC
+// (NTESS). Under the terms of Contract DE-NA0003525 with NTESS, the U.S.
+// Government retains certain rights in this software.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+//
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// * Neither the name of the copyright holder nor the names of its
+//   contributors may be used to endorse or promote products derived from this
+//   software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// Questions? Contact darma@sandia.gov
+//
+// *****************************************************************************
+//@HEADER
+*/
+
+#if !defined INCLUDED_BENCHMARKS_BENCHMARK_COMMON_H
+#define INCLUDED_BENCHMARKS_BENCHMARK_COMMON_H
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+namespace checkpoint { namespace benchmarks {
+
+/// Number of timed repetitions, overridable with the first program argument
+inline int getRepetitions(int argc, char** argv, int default_reps = 10) {
+  if (argc > 1) {
+    return std::max(1, std::atoi(argv[1]));
+  }
+  return default_reps;
+}
+
+/**
+ * \brief Run \c fn \c reps times (after one untimed warm-up) and return the
+ * median wall-clock time in seconds
+ */
+template <typename Callable>
+double timeMedian(int reps, Callable&& fn) {
+  using Clock = std::chrono::steady_clock;
+
+  fn();
+
+  std::vector<double> samples;
+  samples.reserve(reps);
+  for (int i = 0; i < reps; i++) {
+    auto const start = Clock::now();
+    fn();
+    auto const end = Clock::now();
+    samples.push_back(std::chrono::duration<double>(end - start).count());
+  }
+
+  std::sort(samples.begin(), samples.end());
+  return samples[samples.size() / 2];
+}
+
+/**
+ * \brief Like \c timeMedian, but run \c setup untimed before every call of
+ * \c fn (e.g., to evict caches)
+ */
+template <typename Setup, typename Callable>
+double timeMedianWithSetup(int reps, Setup&& setup, Callable&& fn) {
+  using Clock = std::chrono::steady_clock;
+
+  std::vector<double> samples;
+  samples.reserve(reps);
+  for (int i = 0; i < reps; i++) {
+    setup();
+    auto const start = Clock::now();
+    fn();
+    auto const end = Clock::now();
+    samples.push_back(std::chrono::duration<double>(end - start).count());
+  }
+
+  std::sort(samples.begin(), samples.end());
+  return samples[samples.size() / 2];
+}
+
+/// Keep the compiler from eliding work whose result is otherwise unused
+template <typename T>
+inline void doNotOptimize(T const& value) {
+  asm volatile("" : : "r,m"(value) : "memory");
+}
+
+inline void printHeader(char const* title) {
+  std::printf("%s\n", title);
+  std::printf(
+    "%-36s %14s %12s %12s\n", "case", "bytes", "median(ms)", "GB/s"
+  );
+}
+
+inline void printResult(
+  std::string const& name, std::size_t bytes, double seconds
+) {
+  double const gbps = seconds > 0.0 ? bytes / seconds / 1e9 : 0.0;
+  std::printf(
+    "%-36s %14zu %12.3f %12.3f\n", name.c_str(), bytes, seconds * 1e3, gbps
+  );
+}
+
+}} /* end namespace checkpoint::benchmarks */
+
+#endif /*INCLUDED_BENCHMARKS_BENCHMARK_COMMON_H*/
@@ -0,0 +1,181 @@
+/*
+//@HEADER
+// *****************************************************************************
+//
+//                             benchmark_compact.cc
+//                 DARMA/magistrate => Serialization Library
+//
+// Copyright 2019 National Technology & Engineering Solutions of Sandia, LLC
+// (NTESS). Under the terms of Contract DE-NA0003525 with NTESS, the U.S.
+// Government retains certain rights in this software.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+//
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// * Neither the name of the copyright holder nor the names of its
+//   contributors may be used to endorse or promote products derived from this
+//   software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// Questions? Contact darma@sandia.gov
+//
+// *****************************************************************************
+//@HEADER
+*/
+
+#include "benchmark_common.h"
+
+#include <checkpoint/checkpoint.h>
+#include <checkpoint/buffer/varint.h>
+
+#include <cstdio>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace checkpoint { namespace benchmarks {
+
+struct Record {
+  template <typename SerializerT>
+  void serialize(SerializerT& s) {
+    s | name | neighbors;
+  }
+
+  std::string name;
+  std::vector<int32_t> neighbors;
+};
+
+struct Payload {
+  Payload() = default;
+  explicit Payload(std::size_t n) : records(n) {
+    std::mt19937 gen(n);
+    for (std::size_t i = 0; i < n; i++) {
+      records[i].name = "r" + std::to_string(i);
+      records[i].neighbors.resize(gen() % 8);
+      for (auto& v : records[i].neighbors) {
+        v = static_cast<int32_t>(gen() % 1000) - 500;
+      }
+    }
+  }
+
+  template <typename SerializerT>
+  void serialize(SerializerT& s) {
+    s | records;
+  }
+
+  std::vector<Record> records;
+};
+
+}} /* end namespace checkpoint::benchmarks */
+
+int main(int argc, char** argv) {
+  using namespace checkpoint::benchmarks;
+  using checkpoint::SerialSizeType;
+
+  int const reps = getRepetitions(argc, argv, 5);
+
+  Payload payload(1ull << 20);
+  auto const size = checkpoint::getSize(payload);
+
+  checkpoint::CompactOptions sizes_only;
+  checkpoint::CompactOptions integers;
+  integers.integers = true;
+
+  printHeader("plain vs compact buffers of many small containers");
+
+  auto const plain = timeMedian(reps, [&]{
+    auto bytes = checkpoint::serialize(payload);
+    doNotOptimize(bytes.get());
+  });
+  printResult("serialize", size, plain);
+
+  for (auto const& options : {sizes_only, integers}) {
+    std::string const kind = options.integers ? ", integers" : ", sizes";
+    auto const label = "serialize compact" + kind;
+    auto bytes = checkpoint::serialize(payload, options);
+    std::printf(
+      "%s: %llu bytes instead of %llu\n", label.c_str(),
+      static_cast<unsigned long long>(bytes->getSize()),
+      static_cast<unsigned long long>(size)
+    );
+
+    auto const pack = timeMedian(reps, [&]{
+      auto out = checkpoint::serialize(payload, options);
+      doNotOptimize(out.get());
+    });
+    printResult(label, size, pack);
+
+    auto const unpack = timeMedian(reps, [&]{
+      auto out = checkpoint::deserializeCompact<Payload>(
+        bytes->getBuffer(), bytes->getSize(), options
+      );
+      doNotOptimize(out.get());
+    });
+    printResult("deserializeCompact" + kind, size, unpack);
+  }
+
+  auto bytes = checkpoint::serialize(payload);
+  auto const unpack = timeMedian(reps, [&]{
+    auto out = checkpoint::deserialize<Payload>(bytes->getBuffer());
+    doNotOptimize(out.get());
+  });
+  printResult("deserialize", size, unpack);
+
+  printHeader("varint decoding, word at a time vs byte loop");
+
+  // Varints of 1 to 8 bytes in random order, so lengths are not predictable
+  std::mt19937_64 gen(7);
+  std::vector<char> encoded;
+  SerialSizeType const count = 8ull << 20;
+  for (SerialSizeType i = 0; i < count; i++) {
+    auto const v = gen() >> (8 * (gen() % 8) + 8);
+    char tmp[checkpoint::buffer::max_varint_size];
+    auto const n = checkpoint::buffer::encodeVarint(v, tmp);
+    encoded.insert(encoded.end(), tmp, tmp + n);
+  }
+
+  auto decodeAll = [&](auto&& decode) {
+    uint64_t sum = 0;
+    SerialSizeType pos = 0;
+    while (pos < encoded.size()) {
+      uint64_t v = 0;
+      pos += decode(encoded.data() + pos, encoded.size() - pos, v);
+      sum += v;
+    }
+    doNotOptimize(sum);
+  };
+
+  auto const fast = timeMedian(reps, [&]{
+    decodeAll([](char const* in, SerialSizeType avail, uint64_t& v) {
+      return checkpoint::buffer::decodeVarint(in, avail, v);
+    });
+  });
+  printResult("decodeVarint", encoded.size(), fast);
+
+  auto const slow = timeMedian(reps, [&]{
+    decodeAll([](char const* in, SerialSizeType avail, uint64_t& v) {
+      return checkpoint::buffer::decodeVarintSlow(in, avail, v);
+    });
+  });
+  printResult("decodeVarintSlow", encoded.size(), slow);
+
+  return 0;
+}
@@ -0,0 +1,136 @@
+/*
+//@HEADER
+// *****************************************************************************
+//
+//                           benchmark_compression.cc
+//                 DARMA/magistrate => Serialization Library
+//
+// Copyright 2019 National Technology & Engineering Solutions of Sandia, LLC
+// (NTESS). Under the terms of Contract DE-NA0003525 with NTESS, the U.S.
+// Government retains certain rights in this software.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+//
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// * Neither the name of the copyright holder nor the names of its
+//   contributors may be used to endorse or promote products derived from this
+//   software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// Questions? Contact darma@sandia.gov
+//
+// *****************************************************************************
+//@HEADER
+*/
+
+#include "benchmark_common.h"
+
+#include <checkpoint/checkpoint.h>
+
+#include <cmath>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+namespace checkpoint { namespace benchmarks {
+
+// Smooth double fields plus repeated labels, typical of simulation state
+struct Fields {
+  Fields() = default;
+  explicit Fields(std::size_t n) : density(n), pressure(n) {
+    for (std::size_t i = 0; i < n; i++) {
+      density[i] = 1.0 + 0.1 * std::sin(i * 1e-4);
+      pressure[i] = 101325.0 + std::cos(i * 3e-5);
+    }
+    for (std::size_t i = 0; i < n / 64; i++) {
+      labels.push_back("material-" + std::to_string(i % 8));
+    }
+  }
+
+  template <typename SerializerT>
+  void serialize(SerializerT& s) {
+    s | density | pressure | labels;
+  }
+
+  std::vector<double> density, pressure;
+  std::vector<std::string> labels;
+};
+
+void run(
+  std::string const& name, Fields& fields, CompressionOptions const& options,
+  int reps
+) {
+  auto const raw = checkpoint::getSize(fields);
+
+  std::size_t compressed = 0;
+  auto const pack = timeMedian(reps, [&]{
+    auto ret = checkpoint::serialize(fields, options);
+    compressed = ret->getSize();
+  });
+
+  auto ret = checkpoint::serialize(fields, options);
+  auto const unpack = timeMedian(reps, [&]{
+    auto out = checkpoint::deserializeCompressed<Fields>(
+      ret->getBuffer(), ret->getSize(), options.num_threads
+    );
+    doNotOptimize(out.get());
+  });
+
+  printResult(name + " pack", raw, pack);
+  printResult(name + " unpack", raw, unpack);
+  std::printf("%-36s %14zu %12s %11.2fx\n", "  compressed", compressed, "",
+              static_cast<double>(raw) / compressed);
+}
+
+}} /* end namespace checkpoint::benchmarks */
+
+int main(int argc, char** argv) {
+  using namespace checkpoint::benchmarks;
+
+  int const reps = getRepetitions(argc, argv, 5);
+
+  Fields fields(1 << 23);
+
+  printHeader("serialize: uncompressed vs framed compression");
+
+  auto const raw = checkpoint::getSize(fields);
+  auto const plain_pack = timeMedian(reps, [&]{
+    auto ret = checkpoint::serialize(fields);
+  });
+  auto plain = checkpoint::serialize(fields);
+  auto const plain_unpack = timeMedian(reps, [&]{
+    auto out = checkpoint::deserialize<Fields>(plain->getBuffer());
+    doNotOptimize(out.get());
+  });
+  printResult("uncompressed pack", raw, plain_pack);
+  printResult("uncompressed unpack", raw, plain_unpack);
+
+  checkpoint::CompressionOptions options;
+  run("lz", fields, options, reps);
+
+  options.shuffle_width = 8;
+  run("lz+shuffle8", fields, options, reps);
+
+  options.num_threads = 4;
+  run("lz+shuffle8 4 threads", fields, options, reps);
+
+  return 0;
+}
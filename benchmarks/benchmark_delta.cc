@@ -0,0 +1,155 @@
+/*
+//@HEADER
+// *****************************************************************************
+//
+//                              benchmark_delta.cc
+//                 DARMA/magistrate => Serialization Library
+//
+// Copyright 2019 National Technology & Engineering Solutions of Sandia, LLC
+// (NTESS). Under the terms of Contract DE-NA0003525 with NTESS, the U.S.
+// Government retains certain rights in this software.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+//
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// * Neither the name of the copyright holder nor the names of its
+//   contributors may be used to endorse or promote products derived from this
+//   software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// Questions? Contact darma@sandia.gov
+//
+// *****************************************************************************
+//@HEADER
+*/
+
+#include "benchmark_common.h"
+
+#include <checkpoint/checkpoint.h>
+#include <checkpoint/buffer/delta_image.h>
+
+#include <cstdio>
+#include <memory>
+#include <numeric>
+#include <string>
+#include <vector>
+
+namespace checkpoint { namespace benchmarks {
+
+struct Payload {
+  Payload() = default;
+  explicit Payload(std::size_t n) : values(n) {
+    std::iota(values.begin(), values.end(), 0.5);
+  }
+
+  template <typename SerializerT>
+  void serialize(SerializerT& s) {
+    s | values;
+  }
+
+  std::vector<double> values;
+};
+
+}} /* end namespace checkpoint::benchmarks */
+
+int main(int argc, char** argv) {
+  using namespace checkpoint::benchmarks;
+  namespace buffer = checkpoint::buffer;
+
+  int const reps = getRepetitions(argc, argv, 5);
+
+  std::size_t const len = 256ull << 20;
+  std::vector<char> src(len, 'x');
+
+  printHeader("block hash throughput");
+
+  auto const whole = timeMedian(reps, [&]{
+    doNotOptimize(buffer::hashBlock(src.data(), len));
+  });
+  printResult("xxh64", len, whole);
+
+  for (unsigned threads : {1u, 4u}) {
+    auto const blocks = timeMedian(reps, [&]{
+      auto hashes = buffer::hashBlocks(
+        reinterpret_cast<checkpoint::SerialByteType const*>(src.data()), len,
+        64ull << 10, threads
+      );
+      doNotOptimize(hashes.data());
+    });
+    printResult(
+      "xxh64 64 KiB blocks, " + std::to_string(threads) + " threads",
+      len, blocks
+    );
+  }
+
+  printHeader("full vs delta checkpoints as the changed fraction grows");
+
+  Payload payload(16ull << 20);
+  auto const size = checkpoint::getSize(payload);
+  std::string const base = "benchmark_delta_base.out";
+  std::string const delta = "benchmark_delta_next.out";
+
+  checkpoint::DeltaOptions options;
+  options.file.durability = checkpoint::FileDurability::None;
+
+  checkpoint::FileWriteOptions full_options;
+  full_options.durability = checkpoint::FileDurability::None;
+
+  auto const full = timeMedian(reps, [&]{
+    checkpoint::serializeToFile(payload, base, full_options);
+  });
+  printResult("serializeToFile", size, full);
+
+  for (double fraction : {0.0, 0.01, 0.1, 1.0}) {
+    // Touch evenly spaced elements so the changes land in separate blocks
+    auto const n = payload.values.size();
+    auto const touched = static_cast<std::size_t>(fraction * (n / 8192));
+    auto const stride = touched > 0 ? n / touched : n;
+
+    checkpoint::DeltaWriteStats stats;
+    std::unique_ptr<checkpoint::DeltaCheckpointer> cp;
+    auto const time = timeMedianWithSetup(reps, [&]{
+      cp = std::make_unique<checkpoint::DeltaCheckpointer>(options);
+      cp->checkpoint(payload, base);
+      for (std::size_t i = 0; i < n; i += stride) {
+        payload.values[i] += 1.0;
+      }
+    }, [&]{
+      stats = cp->checkpoint(payload, delta);
+    });
+    printResult(
+      "delta, " + std::to_string(stats.changed_blocks) + " of " +
+      std::to_string(stats.num_blocks) + " blocks changed",
+      size, time
+    );
+    std::printf("  delta file: %zu bytes\n", stats.bytes_written);
+  }
+
+  auto const restore = timeMedian(reps, [&]{
+    auto out = checkpoint::deserializeFromDeltaFile<Payload>(delta);
+    doNotOptimize(out.get());
+  });
+  printResult("deserializeFromDeltaFile", size, restore);
+
+  std::remove(base.c_str());
+  std::remove(delta.c_str());
+  return 0;
+}
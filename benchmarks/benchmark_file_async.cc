@@ -0,0 +1,121 @@
+/*
+//@HEADER
+// *****************************************************************************
+//
+//                           benchmark_file_async.cc
+//                 DARMA/magistrate => Serialization Library
+//
+// Copyright 2019 National Technology & Engineering Solutions of Sandia, LLC
+// (NTESS). Under the terms of Contract DE-NA0003525 with NTESS, the U.S.
+// Government retains certain rights in this software.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+//
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// * Neither the name of the copyright holder nor the names of its
+//   contributors may be used to endorse or promote products derived from this
+//   software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// Questions? Contact darma@sandia.gov
+//
+// *****************************************************************************
+//@HEADER
+*/
+
+#include "benchmark_common.h"
+
+#include <checkpoint/checkpoint.h>
+
+#include <cstdio>
+#include <string>
+#include <vector>
+
+namespace checkpoint { namespace benchmarks {
+
+struct Restart {
+  Restart() = default;
+  explicit Restart(std::size_t bytes) : field(bytes / sizeof(double), 1.0) { }
+
+  template <typename SerializerT>
+  void serialize(SerializerT& s) {
+    s | field;
+  }
+
+  std::vector<double> field;
+};
+
+// Stand-in for a time step: touch every element of the state
+void compute(Restart& obj) {
+  for (auto& x : obj.field) {
+    x = x * 1.0000001 + 1e-9;
+  }
+  doNotOptimize(obj.field.data());
+}
+
+}} /* end namespace checkpoint::benchmarks */
+
+int main(int argc, char** argv) {
+  using namespace checkpoint::benchmarks;
+
+  int const reps = getRepetitions(argc, argv, 3);
+  std::size_t const mib = argc > 2 ? std::atoi(argv[2]) : 128;
+  std::string const file = argc > 3 ? argv[3] : "benchmark_file_async.bin";
+  int const steps = 4;
+
+  Restart obj(mib << 20);
+  auto const bytes = checkpoint::getSize(obj) * steps;
+
+  printHeader("time-step loop: blocking vs asynchronous checkpoints");
+
+  auto const compute_only = timeMedian(reps, [&]{
+    for (int i = 0; i < steps; i++) {
+      compute(obj);
+    }
+  });
+  auto const blocking = timeMedian(reps, [&]{
+    for (int i = 0; i < steps; i++) {
+      compute(obj);
+      checkpoint::serializeToFile(obj, file + std::to_string(i));
+    }
+  });
+  auto const async = timeMedian(reps, [&]{
+    std::vector<checkpoint::FileWriteHandle> handles;
+    for (int i = 0; i < steps; i++) {
+      compute(obj);
+      handles.push_back(
+        checkpoint::serializeToFileAsync(obj, file + std::to_string(i))
+      );
+    }
+    for (auto& h : handles) {
+      h.wait();
+    }
+  });
+
+  printResult("compute only", bytes, compute_only);
+  printResult("compute + serializeToFile", bytes, blocking);
+  printResult("compute + serializeToFileAsync", bytes, async);
+
+  for (int i = 0; i < steps; i++) {
+    std::remove((file + std::to_string(i)).c_str());
+  }
+  return 0;
+}
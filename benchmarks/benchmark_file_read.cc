@@ -0,0 +1,139 @@
+/*
+//@HEADER
+// *****************************************************************************
+//
+//                            benchmark_file_read.cc
+//                 DARMA/magistrate => Serialization Library
+//
+// Copyright 2019 National Technology & Engineering Solutions of Sandia, LLC
+// (NTESS). Under the terms of Contract DE-NA0003525 with NTESS, the U.S.
+// Government retains certain rights in this software.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+//
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// * Neither the name of the copyright holder nor the names of its
+//   contributors may be used to endorse or promote products derived from this
+//   software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// Questions? Contact darma@sandia.gov
+//
+// *****************************************************************************
+//@HEADER
+*/
+
+#include "benchmark_common.h"
+
+#include <checkpoint/checkpoint.h>
+
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+namespace checkpoint { namespace benchmarks {
+
+struct Restart {
+  template <typename SerializerT>
+  void serialize(SerializerT& s) {
+    s | field | labels;
+  }
+
+  std::vector<double> field;
+  std::vector<std::string> labels;
+};
+
+// Drop the file's pages from the page cache so the next read is cold
+void evictFromPageCache(std::string const& file) {
+  int fd = open(file.c_str(), O_RDONLY);
+  if (fd == -1) {
+    return;
+  }
+  fdatasync(fd);
+  posix_fadvise(fd, 0, 0, POSIX_FADV_DONTNEED);
+  close(fd);
+}
+
+char const* strategyName(FileReadStrategy s) {
+  switch (s) {
+  case FileReadStrategy::Default:    return "default";
+  case FileReadStrategy::Populate:   return "MAP_POPULATE";
+  case FileReadStrategy::Sequential: return "madvise sequential";
+  case FileReadStrategy::FAdvise:    return "posix_fadvise";
+  case FileReadStrategy::ReadAhead:  return "read-ahead thread";
+  case FileReadStrategy::Window:     return "pread window";
+  }
+  return "";
+}
+
+}} /* end namespace checkpoint::benchmarks */
+
+int main(int argc, char** argv) {
+  using namespace checkpoint::benchmarks;
+  using checkpoint::FileReadStrategy;
+
+  int const reps = getRepetitions(argc, argv, 3);
+  std::size_t const mib = argc > 2 ? std::atoi(argv[2]) : 256;
+  std::string const file = argc > 3 ? argv[3] : "benchmark_file_read.bin";
+
+  {
+    Restart obj;
+    obj.field.assign((mib << 20) / sizeof(double), 1.0);
+    for (int i = 0; i < (1 << 16); i++) {
+      obj.labels.push_back("label-" + std::to_string(i));
+    }
+    checkpoint::FileWriteOptions options;
+    options.durability = checkpoint::FileDurability::Full;
+    checkpoint::serializeToFile(obj, file, options);
+  }
+
+  auto const bytes = [&]{
+    auto obj = checkpoint::deserializeFromFile<Restart>(file);
+    return checkpoint::getSize(*obj);
+  }();
+
+  printHeader("cold-cache deserializeFromFile by read strategy");
+
+  for (auto strategy : {
+    FileReadStrategy::Default, FileReadStrategy::Populate,
+    FileReadStrategy::Sequential, FileReadStrategy::FAdvise,
+    FileReadStrategy::ReadAhead, FileReadStrategy::Window
+  }) {
+    checkpoint::FileReadOptions options;
+    options.strategy = strategy;
+
+    auto const t = timeMedianWithSetup(
+      reps,
+      [&]{ evictFromPageCache(file); },
+      [&]{
+        auto out = checkpoint::deserializeFromFile<Restart>(file, options);
+        doNotOptimize(out->field.data());
+      }
+    );
+    printResult(strategyName(strategy), bytes, t);
+  }
+
+  std::remove(file.c_str());
+  return 0;
+}
@@ -0,0 +1,123 @@
+/*
+//@HEADER
+// *****************************************************************************
+//
+//                           benchmark_file_window.cc
+//                 DARMA/magistrate => Serialization Library
+//
+// Copyright 2019 National Technology & Engineering Solutions of Sandia, LLC
+// (NTESS). Under the terms of Contract DE-NA0003525 with NTESS, the U.S.
+// Government retains certain rights in this software.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+//
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// * Neither the name of the copyright holder nor the names of its
+//   contributors may be used to endorse or promote products derived from this
+//   software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// Questions? Contact darma@sandia.gov
+//
+// *****************************************************************************
+//@HEADER
+*/
+
+#include "benchmark_common.h"
+
+#include <checkpoint/checkpoint.h>
+
+#include <cstdio>
+#include <numeric>
+#include <string>
+#include <vector>
+
+namespace checkpoint { namespace benchmarks {
+
+struct Payload {
+  Payload() = default;
+  explicit Payload(std::size_t n) : values(n) {
+    std::iota(values.begin(), values.end(), 0.5);
+    for (std::size_t i = 0; i < n / 1024; i++) {
+      labels.push_back("label" + std::to_string(i));
+    }
+  }
+
+  template <typename SerializerT>
+  void serialize(SerializerT& s) {
+    s | labels | values;
+  }
+
+  std::vector<std::string> labels;
+  std::vector<double> values;
+};
+
+}} /* end namespace checkpoint::benchmarks */
+
+int main(int argc, char** argv) {
+  using namespace checkpoint::benchmarks;
+
+  int const reps = getRepetitions(argc, argv, 5);
+
+  Payload payload(64ull << 20);
+  auto const size = checkpoint::getSize(payload);
+  std::string const file = "benchmark_file_window.out";
+
+  printHeader("mapped vs write-behind writes (data sync)");
+
+  checkpoint::FileWriteOptions mapped;
+  auto const mmap_time = timeMedian(reps, [&]{
+    checkpoint::serializeToFile(payload, file, mapped);
+  });
+  printResult("mmap", size, mmap_time);
+
+  for (checkpoint::SerialSizeType behind : {0ull, 8ull << 20, 64ull << 20}) {
+    checkpoint::FileWriteOptions options;
+    options.backend = checkpoint::FileBackend::PWrite;
+    options.write_behind = behind;
+    auto const time = timeMedian(reps, [&]{
+      checkpoint::serializeToFile(payload, file, options);
+    });
+    printResult("pwrite, write-behind " + std::to_string(behind), size, time);
+  }
+
+  printHeader("mapped vs windowed reads");
+
+  auto const map_read = timeMedian(reps, [&]{
+    auto out = checkpoint::deserializeFromFile<Payload>(file);
+    doNotOptimize(out.get());
+  });
+  printResult("mmap", size, map_read);
+
+  for (checkpoint::SerialSizeType window : {1ull << 20, 8ull << 20}) {
+    checkpoint::FileReadOptions options;
+    options.strategy = checkpoint::FileReadStrategy::Window;
+    options.window = window;
+    auto const time = timeMedian(reps, [&]{
+      auto out = checkpoint::deserializeFromFile<Payload>(file, options);
+      doNotOptimize(out.get());
+    });
+    printResult("window " + std::to_string(window), size, time);
+  }
+
+  std::remove(file.c_str());
+  return 0;
+}
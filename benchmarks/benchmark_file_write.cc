@@ -0,0 +1,141 @@
+/*
+//@HEADER
+// *****************************************************************************
+//
+//                           benchmark_file_write.cc
+//                 DARMA/magistrate => Serialization Library
+//
+// Copyright 2019 National Technology & Engineering Solutions of Sandia, LLC
+// (NTESS). Under the terms of Contract DE-NA0003525 with NTESS, the U.S.
+// Government retains certain rights in this software.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+//
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// * Neither the name of the copyright holder nor the names of its
+//   contributors may be used to endorse or promote products derived from this
+//   software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// Questions? Contact darma@sandia.gov
+//
+// *****************************************************************************
+//@HEADER
+*/
+
+#include "benchmark_common.h"
+
+#include <checkpoint/checkpoint.h>
+
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+namespace checkpoint { namespace benchmarks {
+
+struct Restart {
+  Restart() = default;
+  explicit Restart(std::size_t bytes) : field(bytes / sizeof(double), 1.0) { }
+
+  template <typename SerializerT>
+  void serialize(SerializerT& s) {
+    s | field;
+  }
+
+  std::vector<double> field;
+};
+
+// Baseline: one sequential write of an already packed buffer, then fdatasync
+void plainWrite(
+  std::string const& file, char const* data, std::size_t len, bool sync
+) {
+  int fd = open(file.c_str(), O_CREAT | O_WRONLY | O_TRUNC, 0600);
+  std::size_t off = 0;
+  while (off < len) {
+    auto ret = write(fd, data + off, len - off);
+    if (ret <= 0) {
+      break;
+    }
+    off += ret;
+  }
+  if (sync) {
+    fdatasync(fd);
+  }
+  close(fd);
+}
+
+char const* durabilityName(FileDurability d) {
+  switch (d) {
+  case FileDurability::None:     return "none";
+  case FileDurability::DataSync: return "data-sync";
+  case FileDurability::Full:     return "full";
+  }
+  return "";
+}
+
+}} /* end namespace checkpoint::benchmarks */
+
+int main(int argc, char** argv) {
+  using namespace checkpoint::benchmarks;
+  using checkpoint::FileBackend;
+  using checkpoint::FileDurability;
+
+  int const reps = getRepetitions(argc, argv, 3);
+  std::size_t const mib = argc > 2 ? std::atoi(argv[2]) : 256;
+  std::string const file = argc > 3 ? argv[3] : "benchmark_file_write.bin";
+
+  Restart obj(mib << 20);
+  auto const bytes = checkpoint::getSize(obj);
+
+  printHeader("serializeToFile: mmap vs pwrite backends by durability");
+
+  auto packed = checkpoint::serialize(obj);
+  for (bool sync : {false, true}) {
+    auto const t = timeMedian(reps, [&]{
+      plainWrite(file, packed->getBuffer(), packed->getSize(), sync);
+    });
+    printResult(std::string("plain write ") + (sync ? "data-sync" : "none"), bytes, t);
+  }
+
+  for (auto backend : {FileBackend::MMap, FileBackend::PWrite}) {
+    for (auto durability : {
+      FileDurability::None, FileDurability::DataSync, FileDurability::Full
+    }) {
+      checkpoint::FileWriteOptions options;
+      options.backend = backend;
+      options.durability = durability;
+
+      auto const t = timeMedian(reps, [&]{
+        checkpoint::serializeToFile(obj, file, options);
+      });
+      printResult(
+        std::string(backend == FileBackend::MMap ? "mmap " : "pwrite ") +
+        durabilityName(durability), bytes, t
+      );
+    }
+  }
+
+  std::remove(file.c_str());
+  return 0;
+}
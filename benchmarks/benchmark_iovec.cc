@@ -0,0 +1,128 @@
+/*
+//@HEADER
+// *****************************************************************************
+//
+//                              benchmark_iovec.cc
+//                 DARMA/magistrate => Serialization Library
+//
+// Copyright 2019 National Technology & Engineering Solutions of Sandia, LLC
+// (NTESS). Under the terms of Contract DE-NA0003525 with NTESS, the U.S.
+// Government retains certain rights in this software.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+//
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// * Neither the name of the copyright holder nor the names of its
+//   contributors may be used to endorse or promote products derived from this
+//   software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// Questions? Contact darma@sandia.gov
+//
+// *****************************************************************************
+//@HEADER
+*/
+
+#include "benchmark_common.h"
+
+#include <checkpoint/checkpoint.h>
+
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+namespace checkpoint { namespace benchmarks {
+
+struct Fields {
+  Fields() = default;
+  explicit Fields(std::size_t bytes)
+    : density(bytes / 2 / sizeof(double), 1.0),
+      energy(bytes / 2 / sizeof(double), 2.0)
+  { }
+
+  template <typename SerializerT>
+  void serialize(SerializerT& s) {
+    s | step | time | density | energy;
+  }
+
+  int step = 10;
+  double time = 0.5;
+  std::vector<double> density, energy;
+};
+
+void writeAll(int fd, char const* data, std::size_t len) {
+  std::size_t off = 0;
+  while (off < len) {
+    auto ret = write(fd, data + off, len - off);
+    if (ret <= 0) {
+      break;
+    }
+    off += ret;
+  }
+}
+
+}} /* end namespace checkpoint::benchmarks */
+
+int main(int argc, char** argv) {
+  using namespace checkpoint::benchmarks;
+
+  int const reps = getRepetitions(argc, argv, 5);
+  std::size_t const mib = argc > 2 ? std::atoi(argv[2]) : 256;
+  std::string const file = argc > 3 ? argv[3] : "benchmark_iovec.bin";
+
+  Fields obj(mib << 20);
+  auto const bytes = checkpoint::getSize(obj);
+
+  printHeader("pack + write: flat buffer vs scatter-gather list");
+
+  auto const pack_flat = timeMedian(reps, [&]{
+    auto ret = checkpoint::serialize(obj);
+    doNotOptimize(ret->getBuffer());
+  });
+  auto const pack_iovec = timeMedian(reps, [&]{
+    auto ret = checkpoint::serializeIOVec(obj);
+    doNotOptimize(ret->getSegments().data());
+  });
+
+  auto const write_flat = timeMedian(reps, [&]{
+    auto ret = checkpoint::serialize(obj);
+    int fd = open(file.c_str(), O_CREAT | O_WRONLY | O_TRUNC, 0600);
+    writeAll(fd, ret->getBuffer(), ret->getSize());
+    close(fd);
+  });
+  auto const write_iovec = timeMedian(reps, [&]{
+    auto ret = checkpoint::serializeIOVec(obj);
+    int fd = open(file.c_str(), O_CREAT | O_WRONLY | O_TRUNC, 0600);
+    ret->writeTo(fd);
+    close(fd);
+  });
+
+  printResult("serialize (flat)", bytes, pack_flat);
+  printResult("serializeIOVec", bytes, pack_iovec);
+  printResult("serialize + write", bytes, write_flat);
+  printResult("serializeIOVec + writev", bytes, write_iovec);
+
+  std::remove(file.c_str());
+  return 0;
+}
@@ -0,0 +1,137 @@
+/*
+//@HEADER
+// *****************************************************************************
+//
+//                          benchmark_member_index.cc
+//                 DARMA/magistrate => Serialization Library
+//
+// Copyright 2019 National Technology & Engineering Solutions of Sandia, LLC
+// (NTESS). Under the terms of Contract DE-NA0003525 with NTESS, the U.S.
+// Government retains certain rights in this software.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+//
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// * Neither the name of the copyright holder nor the names of its
+//   contributors may be used to endorse or promote products derived from this
+//   software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// Questions? Contact darma@sandia.gov
+//
+// *****************************************************************************
+//@HEADER
+*/
+
+#include "benchmark_common.h"
+
+#include <checkpoint/checkpoint.h>
+
+#include <cstdio>
+#include <numeric>
+#include <string>
+#include <vector>
+
+namespace checkpoint { namespace benchmarks {
+
+struct Field {
+  template <typename SerializerT>
+  void serialize(SerializerT& s) {
+    s | name | values;
+  }
+
+  std::string name;
+  std::vector<double> values;
+};
+
+struct Payload {
+  Payload() = default;
+  explicit Payload(std::size_t n) {
+    fields.resize(64);
+    for (std::size_t i = 0; i < fields.size(); i++) {
+      fields[i].name = "field" + std::to_string(i);
+      fields[i].values.resize(n / fields.size());
+      std::iota(fields[i].values.begin(), fields[i].values.end(), 0.5);
+    }
+  }
+
+  template <typename SerializerT>
+  void serialize(SerializerT& s) {
+    checkpoint::indexMember(s, "step", step);
+    checkpoint::indexElements(s, "fields", fields);
+  }
+
+  int step = 42;
+  std::vector<Field> fields;
+};
+
+}} /* end namespace checkpoint::benchmarks */
+
+int main(int argc, char** argv) {
+  using namespace checkpoint::benchmarks;
+
+  int const reps = getRepetitions(argc, argv, 5);
+
+  Payload payload(64ull << 20);
+  auto const size = checkpoint::getSize(payload);
+  std::string const file = "benchmark_member_index.out";
+
+  checkpoint::FileWriteOptions options;
+  options.durability = checkpoint::FileDurability::None;
+
+  printHeader("writing with and without a member offset table");
+
+  auto const plain = timeMedian(reps, [&]{
+    checkpoint::serializeToFile(payload, file, options);
+  });
+  printResult("serializeToFile", size, plain);
+
+  auto const indexed = timeMedian(reps, [&]{
+    checkpoint::serializeToIndexedFile(payload, file, options);
+  });
+  printResult("serializeToIndexedFile", size, indexed);
+
+  printHeader("reading one member vs the whole object");
+
+  auto const whole = timeMedian(reps, [&]{
+    auto out = checkpoint::deserializeFromFile<Payload>(file);
+    doNotOptimize(out.get());
+  });
+  printResult("deserializeFromFile", size, whole);
+
+  auto const step = timeMedian(reps, [&]{
+    auto out = checkpoint::deserializeMemberFromFile<int>(file, "step");
+    doNotOptimize(out.get());
+  });
+  printResult("deserializeMemberFromFile step", sizeof(int), step);
+
+  auto const field_size = checkpoint::getSize(payload.fields[31]);
+  auto const field = timeMedian(reps, [&]{
+    auto out = checkpoint::deserializeElementFromFile<Field>(
+      file, "fields", 31
+    );
+    doNotOptimize(out.get());
+  });
+  printResult("deserializeElementFromFile field", field_size, field);
+
+  std::remove(file.c_str());
+  return 0;
+}
@@ -0,0 +1,132 @@
+/*
+//@HEADER
+// *****************************************************************************
+//
+//                          benchmark_parallel_pack.cc
+//                 DARMA/magistrate => Serialization Library
+//
+// Copyright 2019 National Technology & Engineering Solutions of Sandia, LLC
+// (NTESS). Under the terms of Contract DE-NA0003525 with NTESS, the U.S.
+// Government retains certain rights in this software.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+//
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// * Neither the name of the copyright holder nor the names of its
+//   contributors may be used to endorse or promote products derived from this
+//   software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// Questions? Contact darma@sandia.gov
+//
+// *****************************************************************************
+//@HEADER
+*/
+
+#include "benchmark_common.h"
+
+#include <checkpoint/checkpoint.h>
+
+#include <array>
+#include <string>
+#include <vector>
+
+namespace checkpoint { namespace benchmarks {
+
+// A record that is not byte-copyable, so arrays of it are packed per element
+struct Particle {
+  Particle() = default;
+  explicit Particle(int i)
+    : id(i), species("species-" + std::to_string(i % 11)),
+      history(i % 7, static_cast<float>(i))
+  { }
+
+  template <typename SerializerT>
+  void serialize(SerializerT& s) {
+    s | id | position | velocity | species | history;
+  }
+
+  int64_t id = 0;
+  std::array<double, 3> position = {{1.0, 2.0, 3.0}};
+  std::array<double, 3> velocity = {{0.1, 0.2, 0.3}};
+  std::string species;
+  std::vector<float> history;
+};
+
+}} /* end namespace checkpoint::benchmarks */
+
+int main(int argc, char** argv) {
+  using namespace checkpoint::benchmarks;
+
+  int const reps = getRepetitions(argc, argv, 5);
+
+  std::vector<Particle> particles;
+  for (int i = 0; i < (1 << 21); i++) {
+    particles.emplace_back(i);
+  }
+  auto const size = checkpoint::getSize(particles);
+
+  printHeader("serialize: serial vs parallel packing of a large vector");
+
+  auto const serial = timeMedian(reps, [&]{
+    auto ret = checkpoint::serialize(particles);
+    doNotOptimize(ret->getBuffer());
+  });
+  printResult("serial", size, serial);
+
+  for (unsigned threads : {2u, 4u, 8u}) {
+    checkpoint::ParallelPackOptions options;
+    options.num_threads = threads;
+    auto const parallel = timeMedian(reps, [&]{
+      auto ret = checkpoint::serialize(particles, options);
+      doNotOptimize(ret->getBuffer());
+    });
+    printResult(std::to_string(threads) + " threads", size, parallel);
+  }
+
+  printHeader("deserialize: serial vs indexed parallel unpacking");
+
+  auto plain = checkpoint::serialize(particles);
+  auto const serial_unpack = timeMedian(reps, [&]{
+    auto out = checkpoint::deserialize<std::vector<Particle>>(
+      plain->getBuffer()
+    );
+    doNotOptimize(out.get());
+  });
+  printResult("serial", size, serial_unpack);
+
+  checkpoint::ParallelPackOptions indexed;
+  indexed.indexed = true;
+  auto with_index = checkpoint::serialize(particles, indexed);
+  for (unsigned threads : {1u, 2u, 4u, 8u}) {
+    auto const unpack = timeMedian(reps, [&]{
+      auto out = checkpoint::deserializeIndexed<std::vector<Particle>>(
+        with_index->getBuffer(), threads
+      );
+      doNotOptimize(out.get());
+    });
+    printResult(
+      "indexed " + std::to_string(threads) + " threads", size, unpack
+    );
+  }
+
+  return 0;
+}
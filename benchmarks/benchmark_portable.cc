@@ -0,0 +1,114 @@
+/*
+//@HEADER
+// *****************************************************************************
+//
+//                            benchmark_portable.cc
+//                 DARMA/magistrate => Serialization Library
+//
+// Copyright 2019 National Technology & Engineering Solutions of Sandia, LLC
+// (NTESS). Under the terms of Contract DE-NA0003525 with NTESS, the U.S.
+// Government retains certain rights in this software.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+//
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// * Neither the name of the copyright holder nor the names of its
+//   contributors may be used to endorse or promote products derived from this
+//   software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// Questions? Contact darma@sandia.gov
+//
+// *****************************************************************************
+//@HEADER
+*/
+
+#include "benchmark_common.h"
+
+#include <checkpoint/checkpoint.h>
+#include <checkpoint/buffer/byte_order.h>
+
+#include <numeric>
+#include <string>
+#include <vector>
+
+namespace checkpoint { namespace benchmarks {
+
+struct Payload {
+  Payload() = default;
+  explicit Payload(std::size_t n) : values(n), ids(n) {
+    std::iota(values.begin(), values.end(), 0.5);
+    std::iota(ids.begin(), ids.end(), 0);
+  }
+
+  template <typename SerializerT>
+  void serialize(SerializerT& s) {
+    s | values | ids;
+  }
+
+  std::vector<double> values;
+  std::vector<int32_t> ids;
+};
+
+}} /* end namespace checkpoint::benchmarks */
+
+int main(int argc, char** argv) {
+  using namespace checkpoint::benchmarks;
+  using checkpoint::SerialSizeType;
+
+  int const reps = getRepetitions(argc, argv, 5);
+
+  Payload payload(16ull << 20);
+  auto const size = checkpoint::getSize(payload);
+
+  printHeader("native vs portable buffers (little-endian host is free)");
+
+  auto const native = timeMedian(reps, [&]{
+    auto bytes = checkpoint::serialize(payload);
+    doNotOptimize(bytes.get());
+  });
+  printResult("serialize", size, native);
+
+  auto const portable = timeMedian(reps, [&]{
+    auto bytes = checkpoint::serializePortable(payload);
+    doNotOptimize(bytes.get());
+  });
+  printResult("serializePortable", size, portable);
+
+  // What a big-endian host pays per packed array
+  printHeader(
+    checkpoint::buffer::hasVectorByteSwap() ?
+      "byteSwap (vector shuffles)" : "byteSwap (scalar)"
+  );
+
+  std::vector<char> src(size), dst(size);
+  for (SerialSizeType elm_size : {2ull, 4ull, 8ull}) {
+    auto const time = timeMedian(reps, [&]{
+      checkpoint::buffer::byteSwap(
+        dst.data(), src.data(), size / elm_size, elm_size
+      );
+      doNotOptimize(dst.data());
+    });
+    printResult("elements of " + std::to_string(elm_size) + "B", size, time);
+  }
+
+  return 0;
+}
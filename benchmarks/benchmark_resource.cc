@@ -0,0 +1,209 @@
+/*
+//@HEADER
+// *****************************************************************************
+//
+//                            benchmark_resource.cc
+//                 DARMA/magistrate => Serialization Library
+//
+// Copyright 2019 National Technology & Engineering Solutions of Sandia, LLC
+// (NTESS). Under the terms of Contract DE-NA0003525 with NTESS, the U.S.
+// Government retains certain rights in this software.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+//
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// * Neither the name of the copyright holder nor the names of its
+//   contributors may be used to endorse or promote products derived from this
+//   software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// Questions? Contact darma@sandia.gov
+//
+// *****************************************************************************
+//@HEADER
+*/
+
+#include "benchmark_common.h"
+
+#include <checkpoint/checkpoint.h>
+
+#include <algorithm>
+#include <memory>
+#include <memory_resource>
+#include <random>
+#include <vector>
+
+namespace checkpoint { namespace benchmarks {
+
+struct Extra {
+  template <typename SerializerT>
+  void serialize(SerializerT& s) {
+    s | a | b;
+  }
+
+  double a = 0, b = 0;
+};
+
+struct Cell : SerializableBase<Cell> {
+  template <typename SerializerT>
+  void serialize(SerializerT& s) {
+    s | v | extra;
+  }
+
+  double v = 0;
+  std::unique_ptr<Extra> extra;
+};
+
+struct HotCell : SerializableDerived<HotCell, Cell> {
+  template <typename SerializerT>
+  void serialize(SerializerT& s) {
+    s | w;
+  }
+
+  double w = 0;
+};
+
+struct Mesh {
+  explicit Mesh(std::size_t n = 0) {
+    cells.reserve(n);
+    for (std::size_t i = 0; i < n; i++) {
+      std::unique_ptr<Cell> cell;
+      if (i % 4 == 0) {
+        cell = std::make_unique<HotCell>();
+      } else {
+        cell = std::make_unique<Cell>();
+      }
+      cell->v = 0.5 * i;
+      cell->extra = std::make_unique<Extra>();
+      cell->extra->a = i;
+      cells.push_back(std::move(cell));
+    }
+  }
+
+  template <typename SerializerT>
+  void serialize(SerializerT& s) {
+    s | cells;
+  }
+
+  std::pmr::vector<std::unique_ptr<Cell>> cells;
+};
+
+/// Visit every object of the mesh, as a restarted simulation would
+double traverse(Mesh const& mesh) {
+  double sum = 0;
+  for (auto const& cell : mesh.cells) {
+    sum += cell->v + cell->extra->a;
+  }
+  return sum;
+}
+
+/**
+ * \brief Leave the heap fragmented like a long-running process: many small
+ * blocks, a random two thirds of them freed
+ */
+std::vector<std::unique_ptr<char[]>> churnHeap(std::size_t n) {
+  std::mt19937 gen(42);
+  std::uniform_int_distribution<std::size_t> size(16, 96);
+  std::vector<std::unique_ptr<char[]>> blocks(n);
+  for (auto& block : blocks) {
+    block = std::make_unique<char[]>(size(gen));
+  }
+  std::shuffle(blocks.begin(), blocks.end(), gen);
+  blocks.resize(n / 3);
+  return blocks;
+}
+
+}} /* end namespace checkpoint::benchmarks */
+
+int main(int argc, char** argv) {
+  using namespace checkpoint::benchmarks;
+
+  int const reps = getRepetitions(argc, argv, 5);
+  std::size_t const n = 2000000;
+
+  auto bytes = [&]{
+    Mesh mesh(n);
+    return checkpoint::serialize(mesh);
+  }();
+  auto const size = bytes->getSize();
+  auto const keep = churnHeap(6 * n);
+
+  printHeader("restart of a 2M cell mesh (4M objects)");
+
+  std::unique_ptr<Mesh> heap_mesh;
+  auto const heap_unpack = timeMedianWithSetup(
+    reps, [&]{ heap_mesh.reset(); },
+    [&]{ heap_mesh = checkpoint::deserialize<Mesh>(bytes->getBuffer()); }
+  );
+  printResult("deserialize", size, heap_unpack);
+
+  auto const heap_teardown = timeMedianWithSetup(
+    reps,
+    [&]{ heap_mesh = checkpoint::deserialize<Mesh>(bytes->getBuffer()); },
+    [&]{ heap_mesh.reset(); }
+  );
+  printResult("delete", size, heap_teardown);
+
+  std::unique_ptr<std::pmr::monotonic_buffer_resource> arena;
+  Mesh* arena_mesh = nullptr;
+  auto const arena_unpack = timeMedianWithSetup(
+    reps,
+    [&]{ arena = std::make_unique<std::pmr::monotonic_buffer_resource>(); },
+    [&]{
+      arena_mesh = checkpoint::deserializeToResource<Mesh>(
+        bytes->getBuffer(), arena.get()
+      );
+    }
+  );
+  printResult("deserializeToResource", size, arena_unpack);
+
+  auto const arena_teardown = timeMedianWithSetup(
+    reps,
+    [&]{
+      arena = std::make_unique<std::pmr::monotonic_buffer_resource>();
+      arena_mesh = checkpoint::deserializeToResource<Mesh>(
+        bytes->getBuffer(), arena.get()
+      );
+    },
+    [&]{ arena->release(); }
+  );
+  printResult("monotonic_buffer_resource::release", size, arena_teardown);
+
+  printHeader("traversal of the restarted mesh on a fragmented heap");
+
+  heap_mesh = checkpoint::deserialize<Mesh>(bytes->getBuffer());
+  auto const heap_traverse = timeMedian(reps, [&]{
+    doNotOptimize(traverse(*heap_mesh));
+  });
+  printResult("heap objects", size, heap_traverse);
+
+  arena = std::make_unique<std::pmr::monotonic_buffer_resource>();
+  arena_mesh = checkpoint::deserializeToResource<Mesh>(
+    bytes->getBuffer(), arena.get()
+  );
+  auto const arena_traverse = timeMedian(reps, [&]{
+    doNotOptimize(traverse(*arena_mesh));
+  });
+  printResult("arena objects", size, arena_traverse);
+
+  doNotOptimize(keep.data());
+  return 0;
+}
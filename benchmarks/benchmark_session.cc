@@ -0,0 +1,128 @@
+/*
+//@HEADER
+// *****************************************************************************
+//
+//                             benchmark_session.cc
+//                 DARMA/magistrate => Serialization Library
+//
+// Copyright 2019 National Technology & Engineering Solutions of Sandia, LLC
+// (NTESS). Under the terms of Contract DE-NA0003525 with NTESS, the U.S.
+// Government retains certain rights in this software.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+//
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// * Neither the name of the copyright holder nor the names of its
+//   contributors may be used to endorse or promote products derived from this
+//   software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// Questions? Contact darma@sandia.gov
+//
+// *****************************************************************************
+//@HEADER
+*/
+
+#include "benchmark_common.h"
+
+#include <checkpoint/checkpoint.h>
+
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+#include <string>
+#include <vector>
+
+// Count every global allocation so the benchmark can report them per call
+static std::atomic<std::size_t> allocation_count = {0};
+
+void* operator new(std::size_t size) {
+  allocation_count.fetch_add(1, std::memory_order_relaxed);
+  if (void* ptr = std::malloc(size)) {
+    return ptr;
+  }
+  throw std::bad_alloc();
+}
+
+void operator delete(void* ptr) noexcept { std::free(ptr); }
+void operator delete(void* ptr, std::size_t) noexcept { std::free(ptr); }
+
+namespace checkpoint { namespace benchmarks {
+
+struct Message {
+  template <typename SerializerT>
+  void serialize(SerializerT& s) {
+    s | src | dest | tag | payload;
+  }
+
+  int src = 1, dest = 2, tag = 3;
+  std::vector<double> payload = std::vector<double>(64, 1.0);
+};
+
+}} /* end namespace checkpoint::benchmarks */
+
+int main(int argc, char** argv) {
+  using namespace checkpoint::benchmarks;
+
+  int const reps = getRepetitions(argc, argv, 5);
+  int const calls = 200000;
+
+  Message msg;
+  auto const bytes = checkpoint::getSize(msg) * calls;
+
+  printHeader("repeated serialize of a small message");
+
+  auto const before_plain = allocation_count.load();
+  auto const plain = timeMedian(reps, [&]{
+    for (int i = 0; i < calls; i++) {
+      auto ret = checkpoint::serialize(msg);
+      doNotOptimize(ret->getBuffer());
+    }
+  });
+  auto const plain_allocs = allocation_count.load() - before_plain;
+
+  checkpoint::SerializationSession session;
+  auto const before_session = allocation_count.load();
+  auto const pooled = timeMedian(reps, [&]{
+    for (int i = 0; i < calls; i++) {
+      auto ret = session.serialize(msg);
+      doNotOptimize(ret->getBuffer());
+    }
+  });
+  auto const session_allocs = allocation_count.load() - before_session;
+
+  printResult("checkpoint::serialize", bytes, plain);
+  printResult("SerializationSession::serialize", bytes, pooled);
+
+  double const total_calls = static_cast<double>(calls) * (reps + 1);
+  auto const stats = session.getStats();
+  std::printf(
+    "operator new per call: serialize=%.2f session=%.2f\n",
+    plain_allocs / total_calls, session_allocs / total_calls
+  );
+  std::printf(
+    "pool: system=%zu thread-cache=%zu shared=%zu releases=%zu\n",
+    stats.system_allocations, stats.thread_cache_hits, stats.shared_hits,
+    stats.releases
+  );
+  return 0;
+}
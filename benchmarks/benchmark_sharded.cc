@@ -0,0 +1,137 @@
+/*
+//@HEADER
+// *****************************************************************************
+//
+//                             benchmark_sharded.cc
+//                 DARMA/magistrate => Serialization Library
+//
+// Copyright 2019 National Technology & Engineering Solutions of Sandia, LLC
+// (NTESS). Under the terms of Contract DE-NA0003525 with NTESS, the U.S.
+// Government retains certain rights in this software.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+//
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// * Neither the name of the copyright holder nor the names of its
+//   contributors may be used to endorse or promote products derived from this
+//   software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// Questions? Contact darma@sandia.gov
+//
+// *****************************************************************************
+//@HEADER
+*/
+
+#include "benchmark_common.h"
+
+#include <checkpoint/checkpoint.h>
+#include <checkpoint/buffer/shard_image.h>
+
+#include <cstdio>
+#include <numeric>
+#include <string>
+#include <vector>
+
+#include <unistd.h>
+
+namespace checkpoint { namespace benchmarks {
+
+struct Payload {
+  Payload() = default;
+  explicit Payload(std::size_t n) : values(n) {
+    std::iota(values.begin(), values.end(), 0.5);
+  }
+
+  template <typename SerializerT>
+  void serialize(SerializerT& s) {
+    s | values;
+  }
+
+  std::vector<double> values;
+};
+
+void removeShardedImage(std::string const& dir) {
+  std::remove(buffer::getShardManifestFile(dir).c_str());
+  for (int i = 0; ; i++) {
+    auto const shard = buffer::getShardFile(dir, i);
+    if (access(shard.c_str(), F_OK) != 0) {
+      break;
+    }
+    std::remove(shard.c_str());
+  }
+  rmdir(dir.c_str());
+}
+
+}} /* end namespace checkpoint::benchmarks */
+
+int main(int argc, char** argv) {
+  using namespace checkpoint::benchmarks;
+
+  int const reps = getRepetitions(argc, argv, 5);
+
+  Payload payload(64ull << 20);
+  auto const size = checkpoint::getSize(payload);
+  std::string const file = "benchmark_sharded.out";
+  std::string const dir = "benchmark_sharded.dir";
+
+  checkpoint::FileWriteOptions options;
+  options.durability = checkpoint::FileDurability::DataSync;
+
+  printHeader("single file vs sharded directory writes (data sync)");
+
+  auto const single = timeMedian(reps, [&]{
+    checkpoint::serializeToFile(payload, file, options);
+  });
+  printResult("serializeToFile", size, single);
+
+  for (unsigned shards : {1u, 2u, 4u, 8u}) {
+    auto const time = timeMedian(reps, [&]{
+      checkpoint::serializeToDirectory(payload, dir, shards, options);
+    });
+    printResult(
+      "serializeToDirectory, " + std::to_string(shards) + " shards", size, time
+    );
+  }
+
+  printHeader("single file vs sharded directory reads (8 shards)");
+
+  auto const read_single = timeMedian(reps, [&]{
+    auto out = checkpoint::deserializeFromFile<Payload>(file);
+    doNotOptimize(out.get());
+  });
+  printResult("deserializeFromFile", size, read_single);
+
+  for (unsigned threads : {1u, 2u, 4u, 8u}) {
+    auto const time = timeMedian(reps, [&]{
+      auto out = checkpoint::deserializeFromDirectory<Payload>(dir, threads);
+      doNotOptimize(out.get());
+    });
+    printResult(
+      "deserializeFromDirectory, " + std::to_string(threads) + " threads",
+      size, time
+    );
+  }
+
+  std::remove(file.c_str());
+  removeShardedImage(dir);
+  return 0;
+}
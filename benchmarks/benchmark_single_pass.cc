@@ -0,0 +1,138 @@
+/*
+//@HEADER
+// *****************************************************************************
+//
+//                           benchmark_single_pass.cc
+//                 DARMA/magistrate => Serialization Library
+//
+// Copyright 2019 National Technology & Engineering Solutions of Sandia, LLC
+// (NTESS). Under the terms of Contract DE-NA0003525 with NTESS, the U.S.
+// Government retains certain rights in this software.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+//
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// * Neither the name of the copyright holder nor the names of its
+//   contributors may be used to endorse or promote products derived from this
+//   software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// Questions? Contact darma@sandia.gov
+//
+// *****************************************************************************
+//@HEADER
+*/
+
+#include "benchmark_common.h"
+
+#include <checkpoint/checkpoint.h>
+
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace checkpoint { namespace benchmarks {
+
+// Dominated by a few large bytecopyable payloads
+struct BytecopyHeavy {
+  BytecopyHeavy() = default;
+  explicit BytecopyHeavy(std::size_t n)
+    : a(n, 1.0), b(n, 2.0), ids(n / 2, 3)
+  { }
+
+  template <typename SerializerT>
+  void serialize(SerializerT& s) {
+    s | a | b | ids;
+  }
+
+  std::vector<double> a, b;
+  std::vector<int> ids;
+};
+
+struct Leaf {
+  Leaf() = default;
+  explicit Leaf(int in_v) : v(in_v), label("leaf-" + std::to_string(in_v)) { }
+
+  template <typename SerializerT>
+  void serialize(SerializerT& s) {
+    s | v | label;
+  }
+
+  int v = 0;
+  std::string label;
+};
+
+// Dominated by many small, pointer-linked allocations
+struct PointerHeavy {
+  PointerHeavy() = default;
+  explicit PointerHeavy(int n) {
+    for (int i = 0; i < n; i++) {
+      table[i] = std::vector<std::string>(4, "value-" + std::to_string(i));
+      leaves.push_back(std::make_unique<Leaf>(i));
+    }
+  }
+
+  template <typename SerializerT>
+  void serialize(SerializerT& s) {
+    s | table | leaves;
+  }
+
+  std::map<int, std::vector<std::string>> table;
+  std::vector<std::unique_ptr<Leaf>> leaves;
+};
+
+template <typename T>
+void compare(std::string const& name, T& obj, int reps) {
+  auto const bytes = checkpoint::getSize(obj);
+
+  auto const two_pass = timeMedian(reps, [&]{
+    auto ret = checkpoint::serialize(obj);
+  });
+  auto const single_pass = timeMedian(reps, [&]{
+    auto ret = checkpoint::serializeSinglePass(obj);
+  });
+  auto const single_pass_sized = timeMedian(reps, [&]{
+    auto ret = checkpoint::serializeSinglePass(obj, bytes);
+  });
+
+  printResult(name + " two-pass", bytes, two_pass);
+  printResult(name + " single-pass", bytes, single_pass);
+  printResult(name + " single-pass (presized)", bytes, single_pass_sized);
+}
+
+}} /* end namespace checkpoint::benchmarks */
+
+int main(int argc, char** argv) {
+  using namespace checkpoint::benchmarks;
+
+  int const reps = getRepetitions(argc, argv);
+
+  printHeader("serialize: two-pass (Sizer + Packer) vs single-pass");
+
+  BytecopyHeavy bytecopy(1 << 22);
+  compare("bytecopyable", bytecopy, reps);
+
+  PointerHeavy pointers(1 << 17);
+  compare("pointer-heavy", pointers, reps);
+
+  return 0;
+}
@@ -0,0 +1,122 @@
+/*
+//@HEADER
+// *****************************************************************************
+//
+//                             benchmark_stream.cc
+//                 DARMA/magistrate => Serialization Library
+//
+// Copyright 2019 National Technology & Engineering Solutions of Sandia, LLC
+// (NTESS). Under the terms of Contract DE-NA0003525 with NTESS, the U.S.
+// Government retains certain rights in this software.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+//
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// * Neither the name of the copyright holder nor the names of its
+//   contributors may be used to endorse or promote products derived from this
+//   software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// Questions? Contact darma@sandia.gov
+//
+// *****************************************************************************
+//@HEADER
+*/
+
+#include "benchmark_common.h"
+
+#include <checkpoint/checkpoint.h>
+
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace checkpoint { namespace benchmarks {
+
+struct Particle {
+  template <typename SerializerT>
+  void serialize(SerializerT& s) {
+    s | id | x | y | z | alive;
+  }
+
+  int64_t id = 0;
+  double x = 0, y = 0, z = 0;
+  bool alive = true;
+};
+
+struct Payload {
+  Payload() = default;
+  explicit Payload(std::size_t n) : particles(n) {
+    for (std::size_t i = 0; i < n; i++) {
+      particles[i].id = static_cast<int64_t>(i);
+      particles[i].x = i * 0.5;
+    }
+  }
+
+  template <typename SerializerT>
+  void serialize(SerializerT& s) {
+    s | particles;
+  }
+
+  std::vector<Particle> particles;
+};
+
+}} /* end namespace checkpoint::benchmarks */
+
+int main(int argc, char** argv) {
+  using namespace checkpoint::benchmarks;
+
+  int const reps = getRepetitions(argc, argv, 5);
+
+  // Many small fields: one stream call each without coalescing
+  Payload payload(1ull << 20);
+  auto const size = checkpoint::getSize(payload);
+
+  std::string bytes;
+  std::vector<checkpoint::SerialSizeType> const buffer_sizes = {
+    0, 4ull << 10, 64ull << 10
+  };
+
+  printHeader("serializeToStream: many small fields");
+
+  for (auto buffer_size : buffer_sizes) {
+    auto const time = timeMedian(reps, [&]{
+      std::ostringstream stream;
+      checkpoint::serializeToStream(payload, stream, buffer_size);
+      bytes = stream.str();
+    });
+    printResult("buffer " + std::to_string(buffer_size), size, time);
+  }
+
+  printHeader("deserializeFromStream: many small fields");
+
+  for (auto buffer_size : buffer_sizes) {
+    auto const time = timeMedian(reps, [&]{
+      std::istringstream stream(bytes);
+      auto out =
+        checkpoint::deserializeFromStream<Payload>(stream, buffer_size);
+      doNotOptimize(out.get());
+    });
+    printResult("buffer " + std::to_string(buffer_size), size, time);
+  }
+
+  return 0;
+}
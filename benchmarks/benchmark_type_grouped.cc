@@ -0,0 +1,172 @@
+/*
+//@HEADER
+// *****************************************************************************
+//
+//                          benchmark_type_grouped.cc
+//                 DARMA/magistrate => Serialization Library
+//
+// Copyright 2019 National Technology & Engineering Solutions of Sandia, LLC
+// (NTESS). Under the terms of Contract DE-NA0003525 with NTESS, the U.S.
+// Government retains certain rights in this software.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+//
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// * Neither the name of the copyright holder nor the names of its
+//   contributors may be used to endorse or promote products derived from this
+//   software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// Questions? Contact darma@sandia.gov
+//
+// *****************************************************************************
+//@HEADER
+*/
+
+#include "benchmark_common.h"
+
+#include <checkpoint/checkpoint.h>
+
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace checkpoint { namespace benchmarks {
+
+struct Shape : SerializableBase<Shape> {
+  Shape() = default;
+  explicit Shape(int in_id) : id(in_id) { }
+
+  template <typename SerializerT>
+  void serialize(SerializerT& s) {
+    s | id;
+  }
+
+  int id = 0;
+};
+
+struct Circle : SerializableDerived<Circle, Shape> {
+  Circle() = default;
+  explicit Circle(int in_id) : SerializableDerived(in_id), r(0.5 * in_id) { }
+
+  template <typename SerializerT>
+  void serialize(SerializerT& s) {
+    s | r;
+  }
+
+  double r = 0;
+};
+
+struct Rect : SerializableDerived<Rect, Shape> {
+  Rect() = default;
+  explicit Rect(int in_id) : SerializableDerived(in_id), w(in_id), h(2) { }
+
+  template <typename SerializerT>
+  void serialize(SerializerT& s) {
+    s | w | h;
+  }
+
+  float w = 0, h = 0;
+};
+
+struct Square : SerializableDerived<Square, Rect> {
+  Square() = default;
+  explicit Square(int in_id) : SerializableDerived(in_id), rounded(true) { }
+
+  template <typename SerializerT>
+  void serialize(SerializerT& s) {
+    s | rounded;
+  }
+
+  bool rounded = false;
+};
+
+/// Three derived types, either interleaved or in three contiguous runs
+std::vector<std::unique_ptr<Shape>> makeShapes(std::size_t n, bool sorted) {
+  std::vector<std::unique_ptr<Shape>> shapes;
+  shapes.reserve(n);
+  for (std::size_t i = 0; i < n; i++) {
+    auto const id = static_cast<int>(i);
+    auto const kind = sorted ? i * 3 / n : i % 3;
+    switch (kind) {
+    case 0: shapes.push_back(std::make_unique<Circle>(id)); break;
+    case 1: shapes.push_back(std::make_unique<Rect>(id)); break;
+    default: shapes.push_back(std::make_unique<Square>(id)); break;
+    }
+  }
+  return shapes;
+}
+
+struct PlainPayload {
+  template <typename SerializerT>
+  void serialize(SerializerT& s) {
+    s | shapes;
+  }
+
+  std::vector<std::unique_ptr<Shape>> shapes;
+};
+
+struct GroupedPayload {
+  template <typename SerializerT>
+  void serialize(SerializerT& s) {
+    checkpoint::serializeTypeGrouped(s, shapes);
+  }
+
+  std::vector<std::unique_ptr<Shape>> shapes;
+};
+
+template <typename PayloadT>
+void run(int reps, std::string const& label, bool sorted) {
+  PayloadT payload;
+  payload.shapes = makeShapes(5000000, sorted);
+  auto const size = checkpoint::getSize(payload);
+
+  auto const pack = timeMedian(reps, [&]{
+    auto out = checkpoint::serialize(payload);
+    doNotOptimize(out.get());
+  });
+  printResult(label + " serialize", size, pack);
+
+  auto bytes = checkpoint::serialize(payload);
+  auto const unpack = timeMedian(reps, [&]{
+    auto out = checkpoint::deserialize<PayloadT>(bytes->getBuffer());
+    doNotOptimize(out.get());
+  });
+  printResult(label + " deserialize", size, unpack);
+}
+
+}} /* end namespace checkpoint::benchmarks */
+
+int main(int argc, char** argv) {
+  using namespace checkpoint::benchmarks;
+
+  int const reps = getRepetitions(argc, argv, 5);
+
+  printHeader("vector of 5M polymorphic unique_ptr, interleaved types");
+  run<PlainPayload>(reps, "s | vec", false);
+  run<GroupedPayload>(reps, "serializeTypeGrouped", false);
+
+  printHeader("vector of 5M polymorphic unique_ptr, types in runs");
+  run<PlainPayload>(reps, "s | vec", true);
+  run<GroupedPayload>(reps, "serializeTypeGrouped", true);
+
+  return 0;
+}
@@ -0,0 +1,163 @@
+/*
+//@HEADER
+// *****************************************************************************
+//
+//                          benchmark_type_registry.cc
+//                 DARMA/magistrate => Serialization Library
+//
+// Copyright 2019 National Technology & Engineering Solutions of Sandia, LLC
+// (NTESS). Under the terms of Contract DE-NA0003525 with NTESS, the U.S.
+// Government retains certain rights in this software.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+//
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// * Neither the name of the copyright holder nor the names of its
+//   contributors may be used to endorse or promote products derived from this
+//   software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// Questions? Contact darma@sandia.gov
+//
+// *****************************************************************************
+//@HEADER
+*/
+
+#include "benchmark_common.h"
+
+#include <checkpoint/checkpoint.h>
+
+#include <cstdio>
+#include <map>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace checkpoint { namespace benchmarks {
+
+namespace typeregistry = dispatch::typeregistry;
+
+/// Distinct types standing in for the serialized types of an application
+template <std::size_t N>
+struct Tag { };
+
+constexpr std::size_t const num_tags = 1024;
+
+template <typename Fn, std::size_t... I>
+void forEachTag(Fn&& fn, std::index_sequence<I...>) {
+  (fn(static_cast<Tag<I>*>(nullptr)), ...);
+}
+
+template <typename Fn>
+void forEachTag(Fn&& fn) {
+  forEachTag(fn, std::make_index_sequence<num_tags>{});
+}
+
+struct Payload {
+  template <typename SerializerT>
+  void serialize(SerializerT& s) {
+    s | names | table | weights;
+  }
+
+  std::vector<std::string> names = {"a", "b"};
+  std::map<int, std::string> table = {{1, "one"}};
+  std::vector<double> weights = {0.5};
+};
+
+void printTypesResult(
+  std::string const& name, std::size_t types, double seconds
+) {
+  std::printf(
+    "%-36s %14zu %12.3f %12.1f\n", name.c_str(), types, seconds * 1e3,
+    seconds / types * 1e9
+  );
+}
+
+}} /* end namespace checkpoint::benchmarks */
+
+int main(int argc, char** argv) {
+  using namespace checkpoint::benchmarks;
+
+  // Registered while this program was statically initialized: the types
+  // traversed by serializing a Payload (every nested type when
+  // SERIALIZATION_ERROR_CHECKING is on, only the root type otherwise)
+  auto const at_startup = typeregistry::getNumRegistered();
+  std::printf("types registered at startup: %zu\n", at_startup);
+
+  int const reps = getRepetitions(argc, argv, 5);
+
+  Payload payload;
+  auto bytes = checkpoint::serialize(payload);
+  doNotOptimize(bytes.get());
+
+  std::printf("registering %zu types\n", num_tags);
+  std::printf(
+    "%-36s %14s %12s %12s\n", "case", "types", "median(ms)", "ns/type"
+  );
+
+  // What each registration cost when it demangled into a hash map
+  auto const eager = timeMedian(reps, [&]{
+    std::unordered_map<typeregistry::DecodedIndex, std::string> names;
+    typeregistry::DecodedIndex index = 0;
+    forEachTag([&](auto* tag) {
+      using TagT = std::remove_pointer_t<decltype(tag)>;
+      names[index++] = typeregistry::demangle(typeid(TagT).name());
+    });
+    doNotOptimize(names.size());
+  });
+  printTypesResult("demangle at registration", num_tags, eager);
+
+  std::vector<typeregistry::DecodedIndex> indices;
+  auto register_all = [&]{
+    indices.clear();
+    forEachTag([&](auto* tag) {
+      using TagT = std::remove_pointer_t<decltype(tag)>;
+      indices.push_back(typeregistry::Registrar<TagT>().index);
+    });
+  };
+
+  auto const lazy = timeMedian(reps, register_all);
+  printTypesResult("Registrar (mangled name only)", num_tags, lazy);
+
+  // The demangling moved to the first lookup, as when an error is reported
+  auto const first = timeMedianWithSetup(reps, register_all, [&]{
+    for (auto const idx : indices) {
+      doNotOptimize(typeregistry::getTypeNameForIdx(idx).size());
+    }
+  });
+  printTypesResult("getTypeNameForIdx, first lookup", num_tags, first);
+
+  auto const cached = timeMedian(reps, [&]{
+    for (auto const idx : indices) {
+      doNotOptimize(typeregistry::getTypeNameForIdx(idx).size());
+    }
+  });
+  printTypesResult("getTypeNameForIdx, cached", num_tags, cached);
+
+  std::printf(
+    "startup registration of %zu types: %.3f ms eager, %.3f ms lazy\n",
+    at_startup, eager / num_tags * at_startup * 1e3,
+    lazy / num_tags * at_startup * 1e3
+  );
+
+  return 0;
+}
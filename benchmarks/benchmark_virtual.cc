@@ -0,0 +1,154 @@
+/*
+//@HEADER
+// *****************************************************************************
+//
+//                             benchmark_virtual.cc
+//                 DARMA/magistrate => Serialization Library
+//
+// Copyright 2019 National Technology & Engineering Solutions of Sandia, LLC
+// (NTESS). Under the terms of Contract DE-NA0003525 with NTESS, the U.S.
+// Government retains certain rights in this software.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+//
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// * Neither the name of the copyright holder nor the names of its
+//   contributors may be used to endorse or promote products derived from this
+//   software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// Questions? Contact darma@sandia.gov
+//
+// *****************************************************************************
+//@HEADER
+*/
+
+#include "benchmark_common.h"
+
+#include <checkpoint/checkpoint.h>
+
+#include <memory>
+#include <vector>
+
+namespace checkpoint { namespace benchmarks {
+
+struct Shape : SerializableBase<Shape> {
+  Shape() = default;
+  explicit Shape(int in_id) : id(in_id) { }
+
+  template <typename SerializerT>
+  void serialize(SerializerT& s) {
+    s | id;
+  }
+
+  int id = 0;
+};
+
+struct Circle : SerializableDerived<Circle, Shape> {
+  Circle() = default;
+  explicit Circle(int in_id) : SerializableDerived(in_id), r(0.5 * in_id) { }
+
+  template <typename SerializerT>
+  void serialize(SerializerT& s) {
+    s | r;
+  }
+
+  double r = 0;
+};
+
+struct Rect : SerializableDerived<Rect, Shape> {
+  Rect() = default;
+  explicit Rect(int in_id) : SerializableDerived(in_id), w(in_id), h(2) { }
+
+  template <typename SerializerT>
+  void serialize(SerializerT& s) {
+    s | w | h;
+  }
+
+  float w = 0, h = 0;
+};
+
+struct Square : SerializableDerived<Square, Rect> {
+  Square() = default;
+  explicit Square(int in_id) : SerializableDerived(in_id), rounded(true) { }
+
+  template <typename SerializerT>
+  void serialize(SerializerT& s) {
+    s | rounded;
+  }
+
+  bool rounded = false;
+};
+
+struct Payload {
+  Payload() = default;
+  explicit Payload(std::size_t n) {
+    shapes.reserve(n);
+    for (std::size_t i = 0; i < n; i++) {
+      auto const id = static_cast<int>(i);
+      switch (i % 3) {
+      case 0: shapes.push_back(std::make_unique<Circle>(id)); break;
+      case 1: shapes.push_back(std::make_unique<Rect>(id)); break;
+      default: shapes.push_back(std::make_unique<Square>(id)); break;
+      }
+    }
+  }
+
+  template <typename SerializerT>
+  void serialize(SerializerT& s) {
+    s | shapes;
+  }
+
+  std::vector<std::unique_ptr<Shape>> shapes;
+};
+
+}} /* end namespace checkpoint::benchmarks */
+
+int main(int argc, char** argv) {
+  using namespace checkpoint::benchmarks;
+
+  int const reps = getRepetitions(argc, argv, 5);
+
+  Payload payload(5000000);
+  auto const size = checkpoint::getSize(payload);
+
+  printHeader("vector of 5M polymorphic unique_ptr (three derived types)");
+
+  auto const sizing = timeMedian(reps, [&]{
+    doNotOptimize(checkpoint::getSize(payload));
+  });
+  printResult("getSize", size, sizing);
+
+  auto const pack = timeMedian(reps, [&]{
+    auto out = checkpoint::serialize(payload);
+    doNotOptimize(out.get());
+  });
+  printResult("serialize", size, pack);
+
+  auto bytes = checkpoint::serialize(payload);
+  auto const unpack = timeMedian(reps, [&]{
+    auto out = checkpoint::deserialize<Payload>(bytes->getBuffer());
+    doNotOptimize(out.get());
+  });
+  printResult("deserialize", size, unpack);
+
+  return 0;
+}
@@ -41,6 +41,7 @@ cmake -G "${CMAKE_GENERATOR:-Ninja}" \
       -Dmagistrate_asan_enabled="${MAGISTRATE_ASAN_ENABLED:-0}" \
       -Dmagistrate_ubsan_enabled="${MAGISTRATE_UBSAN_ENABLED:-0}" \
       -Dmagistrate_serialization_error_checking_enabled="${MAGISTRATE_SERIALIZATION_ERROR_CHECKING_ENABLED:-$is_debug}" \
+      -Dmagistrate_serialization_hash_checking_enabled="${MAGISTRATE_SERIALIZATION_HASH_CHECKING_ENABLED:-0}" \
       -DCMAKE_BUILD_TYPE="${cmake_build_type}" \
       -DCMAKE_CXX_COMPILER="${CXX:-c++}" \
       -DCMAKE_C_COMPILER="${CC:-cc}" \
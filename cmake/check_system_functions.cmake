@@ -97,9 +97,87 @@ else()
   endif()
 endif()
 
+set(CMAKE_REQUIRED_INCLUDES "stdlib.h")
+check_function_exists(posix_memalign checkpoint_has_posix_memalign)
+
+if (NOT checkpoint_has_posix_memalign)
+  message(STATUS "Could not find posix_memalign(..), optional for huge-page buffers")
+endif()
+
+check_symbol_exists(MADV_HUGEPAGE "sys/mman.h" checkpoint_has_madv_hugepage)
+
+if (NOT checkpoint_has_madv_hugepage)
+  message(STATUS "Could not find MADV_HUGEPAGE, optional for huge-page buffers")
+endif()
+
 set(CMAKE_REQUIRED_INCLUDES "fcntl.h")
 check_function_exists(fallocate checkpoint_has_fallocate)
 
 if (NOT checkpoint_has_fallocate)
   message(STATUS "Could not find fallocate(..), optional for IO")
 endif()
+
+set(CMAKE_REQUIRED_INCLUDES "unistd.h")
+check_function_exists(fdatasync checkpoint_has_fdatasync)
+
+if (NOT checkpoint_has_fdatasync)
+  message(STATUS "Could not find fdatasync(..), optional for IO (falls back to fsync)")
+endif()
+
+set(CMAKE_REQUIRED_INCLUDES "sys/uio.h")
+check_function_exists(pwritev checkpoint_has_pwritev)
+
+if (NOT checkpoint_has_pwritev)
+  message(STATUS "Could not find pwritev(..), optional for IO (falls back to pwrite)")
+endif()
+
+set(CMAKE_REQUIRED_INCLUDES "fcntl.h")
+check_function_exists(sync_file_range checkpoint_has_sync_file_range)
+
+if (NOT checkpoint_has_sync_file_range)
+  message(STATUS "Could not find sync_file_range(..), optional for IO write-behind")
+endif()
+
+check_symbol_exists(MAP_POPULATE "sys/mman.h" checkpoint_has_map_populate)
+
+if (NOT checkpoint_has_map_populate)
+  message(STATUS "Could not find MAP_POPULATE, optional for IO read strategies")
+endif()
+
+set(CMAKE_REQUIRED_INCLUDES "fcntl.h")
+check_function_exists(posix_fadvise checkpoint_has_posix_fadvise)
+
+if (NOT checkpoint_has_posix_fadvise)
+  message(STATUS "Could not find posix_fadvise(..), optional for IO read strategies")
+endif()
+
+include(CheckCXXSourceCompiles)
+set(CMAKE_REQUIRED_INCLUDES "")
+check_cxx_source_compiles("
+  #include <nmmintrin.h>
+  #include <cstdint>
+  __attribute__((target(\"sse4.2\")))
+  std::uint32_t crc(std::uint32_t c, std::uint64_t v) {
+    return static_cast<std::uint32_t>(_mm_crc32_u64(c, v));
+  }
+  int main() { return __builtin_cpu_supports(\"sse4.2\") ? crc(0, 1) : 0; }
+" checkpoint_has_sse42_crc32c)
+
+if (NOT checkpoint_has_sse42_crc32c)
+  message(STATUS "Could not find SSE4.2 CRC32 intrinsics, optional for checksums (falls back to tables)")
+endif()
+
+check_cxx_source_compiles("
+  #include <immintrin.h>
+  __attribute__((target(\"ssse3\")))
+  __m128i s16(__m128i v, __m128i m) { return _mm_shuffle_epi8(v, m); }
+  __attribute__((target(\"avx2\")))
+  __m256i s32(__m256i v, __m256i m) { return _mm256_shuffle_epi8(v, m); }
+  int main() {
+    return __builtin_cpu_supports(\"avx2\") + __builtin_cpu_supports(\"ssse3\");
+  }
+" checkpoint_has_x86_shuffle)
+
+if (NOT checkpoint_has_x86_shuffle)
+  message(STATUS "Could not find SSSE3/AVX2 shuffle intrinsics, optional for portable buffers (falls back to scalar swaps)")
+endif()
@@ -0,0 +1,93 @@
+/*
+//@HEADER
+// *****************************************************************************
+//
+//                                allocation.cc
+//                 DARMA/magistrate => Serialization Library
+//
+// Copyright 2019 National Technology & Engineering Solutions of Sandia, LLC
+// (NTESS). Under the terms of Contract DE-NA0003525 with NTESS, the U.S.
+// Government retains certain rights in this software.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+//
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// * Neither the name of the copyright holder nor the names of its
+//   contributors may be used to endorse or promote products derived from this
+//   software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// Questions? Contact darma@sandia.gov
+//
+// *****************************************************************************
+//@HEADER
+*/
+
+#include "checkpoint/common.h"
+#include "checkpoint/buffer/allocation.h"
+
+#include <cstdlib>
+#include <new>
+
+#include <sys/mman.h>
+
+namespace checkpoint { namespace buffer {
+
+OwnedBytesType allocateBytes(SerialSizeType size, SerialSizeType threshold) {
+  void* ptr = nullptr;
+
+  // malloc(0) may legally return nullptr; always request at least one byte
+  if (size == 0) {
+    size = 1;
+  }
+
+# if defined(checkpoint_has_posix_memalign)
+  if (size >= threshold) {
+    /*
+     * Round up to a whole number of huge pages so the tail of the buffer can
+     * also be backed by a huge page
+     */
+    auto const len = (size + huge_page_size - 1) / huge_page_size * huge_page_size;
+
+    if (posix_memalign(&ptr, huge_page_size, len) != 0) {
+      throw std::bad_alloc();
+    }
+
+#   if defined(checkpoint_has_madv_hugepage)
+    // The advice is best-effort: failure just leaves regular pages in place
+    madvise(ptr, len, MADV_HUGEPAGE);
+#   endif
+
+    debug_checkpoint("allocateBytes: huge-page aligned: size=%lu\n", len);
+    return OwnedBytesType(static_cast<SerialByteType*>(ptr));
+  }
+# else
+  checkpoint_force_use(threshold);
+# endif
+
+  ptr = std::malloc(size);
+  if (ptr == nullptr) {
+    throw std::bad_alloc();
+  }
+  return OwnedBytesType(static_cast<SerialByteType*>(ptr));
+}
+
+}} /* end namespace checkpoint::buffer */
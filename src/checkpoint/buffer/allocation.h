@@ -0,0 +1,93 @@
+/*
+//@HEADER
+// *****************************************************************************
+//
+//                                 allocation.h
+//                 DARMA/magistrate => Serialization Library
+//
+// Copyright 2019 National Technology & Engineering Solutions of Sandia, LLC
+// (NTESS). Under the terms of Contract DE-NA0003525 with NTESS, the U.S.
+// Government retains certain rights in this software.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+//
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// * Neither the name of the copyright holder nor the names of its
+//   contributors may be used to endorse or promote products derived from this
+//   software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// Questions? Contact darma@sandia.gov
+//
+// *****************************************************************************
+//@HEADER
+*/
+
+#if !defined INCLUDED_SRC_CHECKPOINT_BUFFER_ALLOCATION_H
+#define INCLUDED_SRC_CHECKPOINT_BUFFER_ALLOCATION_H
+
+#include "checkpoint/common.h"
+
+#include <cstdlib>
+#include <memory>
+
+namespace checkpoint { namespace buffer {
+
+/// Owning buffers at or above this size are backed by huge pages when possible
+static constexpr SerialSizeType const huge_page_threshold = 4ull << 20;
+
+/// Alignment (and rounding granularity) used for huge-page backed buffers
+static constexpr SerialSizeType const huge_page_size = 2ull << 20;
+
+/**
+ * \struct ByteDeleter
+ *
+ * \brief Release memory obtained from \c allocateBytes
+ */
+struct ByteDeleter {
+  void operator()(SerialByteType* ptr) const { std::free(ptr); }
+};
+
+using OwnedBytesType = std::unique_ptr<SerialByteType, ByteDeleter>;
+
+/**
+ * \brief Allocate \c size bytes of uninitialized storage for an owning buffer
+ *
+ * The bytes are not value-initialized since every owning buffer is completely
+ * overwritten by the packer. Allocations of at least \c threshold bytes are
+ * aligned to \c huge_page_size and advised with \c MADV_HUGEPAGE (when
+ * available) to reduce TLB misses while packing.
+ *
+ * The returned memory may be grown with \c std::realloc and is released with
+ * \c std::free.
+ *
+ * \param[in] size the number of bytes
+ * \param[in] threshold (optional) minimum size for huge-page backing
+ *
+ * \return the uninitialized allocation
+ */
+OwnedBytesType allocateBytes(
+  SerialSizeType size, SerialSizeType threshold = huge_page_threshold
+);
+
+}} /* end namespace checkpoint::buffer */
+
+#endif /*INCLUDED_SRC_CHECKPOINT_BUFFER_ALLOCATION_H*/
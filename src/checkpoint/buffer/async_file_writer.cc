@@ -0,0 +1,172 @@
+/*
+//@HEADER
+// *****************************************************************************
+//
+//                             async_file_writer.cc
+//                 DARMA/magistrate => Serialization Library
+//
+// Copyright 2019 National Technology & Engineering Solutions of Sandia, LLC
+// (NTESS). Under the terms of Contract DE-NA0003525 with NTESS, the U.S.
+// Government retains certain rights in this software.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+//
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// * Neither the name of the copyright holder nor the names of its
+//   contributors may be used to endorse or promote products derived from this
+//   software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// Questions? Contact darma@sandia.gov
+//
+// *****************************************************************************
+//@HEADER
+*/
+
+#include "checkpoint/common.h"
+#include "checkpoint/buffer/async_file_writer.h"
+#include "checkpoint/serializers/file_packer.h"
+#include "checkpoint/serializers/packer.h"
+
+#include <algorithm>
+
+namespace checkpoint { namespace buffer {
+
+/*static*/ AsyncFileWriter& AsyncFileWriter::get() {
+  static AsyncFileWriter writer;
+  return writer;
+}
+
+AsyncFileWriter::AsyncFileWriter()
+  : thread_([this]{ run(); })
+{ }
+
+AsyncFileWriter::~AsyncFileWriter() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stop_ = true;
+  }
+  work_cv_.notify_one();
+  thread_.join();
+}
+
+void AsyncFileWriter::setMaxInFlight(std::size_t max_in_flight) {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    max_in_flight_ = std::max<std::size_t>(max_in_flight, 1);
+  }
+  slot_cv_.notify_all();
+}
+
+void AsyncFileWriter::reserveSlot() {
+  std::unique_lock<std::mutex> lock(mutex_);
+  slot_cv_.wait(lock, [this]{ return in_flight_ < max_in_flight_; });
+  in_flight_++;
+}
+
+void AsyncFileWriter::releaseSlot() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    in_flight_--;
+  }
+  slot_cv_.notify_all();
+}
+
+FileWriteHandle AsyncFileWriter::submit(
+  std::unique_ptr<SerializedInfo> snapshot, std::string const& file,
+  FileWriteOptions const& options
+) {
+  Job job{std::move(snapshot), file, options, std::promise<void>{}};
+  auto future = job.done.get_future().share();
+
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    queue_.push_back(std::move(job));
+  }
+  work_cv_.notify_one();
+
+  return FileWriteHandle{std::move(future)};
+}
+
+void AsyncFileWriter::drain() {
+  std::unique_lock<std::mutex> lock(mutex_);
+  slot_cv_.wait(lock, [this]{ return in_flight_ == 0; });
+}
+
+void AsyncFileWriter::run() {
+  while (true) {
+    Job job;
+
+    {
+      std::unique_lock<std::mutex> lock(mutex_);
+      work_cv_.wait(lock, [this]{ return stop_ or not queue_.empty(); });
+      // Pending writes are finished before stopping
+      if (queue_.empty()) {
+        return;
+      }
+      job = std::move(queue_.front());
+      queue_.pop_front();
+    }
+
+    debug_checkpoint("AsyncFileWriter: writing file=%s\n", job.file.c_str());
+
+    try {
+      write(job);
+      job.snapshot.reset();
+      job.done.set_value();
+    } catch (...) {
+      job.snapshot.reset();
+      job.done.set_exception(std::current_exception());
+    }
+
+    releaseSlot();
+  }
+}
+
+/*static*/ void AsyncFileWriter::write(Job& job) {
+  auto const len = job.snapshot->getSize();
+  auto const bytes = job.snapshot->getBuffer();
+  auto const& options = job.options;
+
+  if (options.backend == FileBackend::PWrite) {
+    FilePacker packer(len, job.file, options);
+    packer.contiguousBytes(bytes, 1, len);
+    packer.closeFile();
+    return;
+  }
+
+  auto const& checksum = options.checksum;
+  auto const trailer = checksum.enabled ?
+    getChecksumTrailerSize(len, checksum.chunk_size) : 0;
+
+  PackerIO packer(
+    len, IOBuffer::WriteToFileTag{}, len + trailer, job.file, options.durability
+  );
+  if (checksum.enabled) {
+    packer.enableChecksum(checksum.chunk_size);
+  }
+  packer.contiguousBytes(bytes, 1, len);
+  if (checksum.enabled) {
+    packer.writeChecksumTrailer();
+  }
+}
+
+}} /* end namespace checkpoint::buffer */
@@ -0,0 +1,190 @@
+/*
+//@HEADER
+// *****************************************************************************
+//
+//                             async_file_writer.h
+//                 DARMA/magistrate => Serialization Library
+//
+// Copyright 2019 National Technology & Engineering Solutions of Sandia, LLC
+// (NTESS). Under the terms of Contract DE-NA0003525 with NTESS, the U.S.
+// Government retains certain rights in this software.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+//
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// * Neither the name of the copyright holder nor the names of its
+//   contributors may be used to endorse or promote products derived from this
+//   software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// Questions? Contact darma@sandia.gov
+//
+// *****************************************************************************
+//@HEADER
+*/
+
+#if !defined INCLUDED_SRC_CHECKPOINT_BUFFER_ASYNC_FILE_WRITER_H
+#define INCLUDED_SRC_CHECKPOINT_BUFFER_ASYNC_FILE_WRITER_H
+
+#include "checkpoint/common.h"
+#include "checkpoint/buffer/buffer.h"
+#include "checkpoint/buffer/io_options.h"
+
+#include <condition_variable>
+#include <deque>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+
+namespace checkpoint { namespace buffer {
+
+/**
+ * \struct FileWriteHandle
+ *
+ * \brief Handle to an asynchronous file write started with
+ * \c serializeToFileAsync
+ */
+struct FileWriteHandle {
+  FileWriteHandle() = default;
+
+  explicit FileWriteHandle(std::shared_future<void> in_future)
+    : future_(std::move(in_future))
+  { }
+
+  /**
+   * \brief Block until the write (including any sync) completes. If the write
+   * failed, the exception raised by the writer is rethrown.
+   */
+  void wait() const { future_.get(); }
+
+  /**
+   * \brief Check without blocking whether the write has completed
+   *
+   * \return whether the write has completed, successfully or not
+   */
+  bool poll() const {
+    return future_.wait_for(std::chrono::seconds(0)) ==
+      std::future_status::ready;
+  }
+
+  /**
+   * \brief Whether this handle refers to a write
+   *
+   * \return whether the handle is valid
+   */
+  bool valid() const { return future_.valid(); }
+
+private:
+  std::shared_future<void> future_;
+};
+
+/**
+ * \struct AsyncFileWriter
+ *
+ * \brief Background thread that writes packed snapshots to files
+ *
+ * The number of snapshots queued or being written is bounded; \c reserveSlot
+ * blocks while the limit is reached so that memory held by snapshots stays
+ * bounded when checkpoints are produced faster than they can be written.
+ */
+struct AsyncFileWriter {
+  /**
+   * \brief Get the process-wide writer, starting its thread on first use
+   *
+   * \return the writer
+   */
+  static AsyncFileWriter& get();
+
+  AsyncFileWriter(AsyncFileWriter const&) = delete;
+  AsyncFileWriter& operator=(AsyncFileWriter const&) = delete;
+
+  ~AsyncFileWriter();
+
+  /**
+   * \brief Set the maximum number of snapshots queued or being written
+   *
+   * \param[in] max_in_flight the limit, at least one
+   */
+  void setMaxInFlight(std::size_t max_in_flight);
+
+  /**
+   * \brief Block until fewer than the maximum writes are in flight, then
+   * claim one of them for a snapshot about to be submitted
+   */
+  void reserveSlot();
+
+  /**
+   * \brief Give back a slot claimed by \c reserveSlot that will not be
+   * submitted
+   */
+  void releaseSlot();
+
+  /**
+   * \brief Queue a packed snapshot to be written to \c file, using a slot
+   * claimed by \c reserveSlot
+   *
+   * \param[in] snapshot the packed bytes, owned by the writer until written
+   * \param[in] file the name of the file to create
+   * \param[in] options block size and durability for the write
+   *
+   * \return handle to wait on or poll the write
+   */
+  FileWriteHandle submit(
+    std::unique_ptr<SerializedInfo> snapshot, std::string const& file,
+    FileWriteOptions const& options
+  );
+
+  /**
+   * \brief Block until every submitted write has completed
+   */
+  void drain();
+
+private:
+  AsyncFileWriter();
+
+  void run();
+
+  struct Job {
+    std::unique_ptr<SerializedInfo> snapshot;
+    std::string file;
+    FileWriteOptions options;
+    std::promise<void> done;
+  };
+
+  /// Write a job's snapshot with the backend in its options
+  static void write(Job& job);
+
+private:
+  std::mutex mutex_;
+  std::condition_variable work_cv_;
+  std::condition_variable slot_cv_;
+  std::deque<Job> queue_;
+  std::size_t in_flight_ = 0;
+  std::size_t max_in_flight_ = 2;
+  bool stop_ = false;
+  std::thread thread_;
+};
+
+}} /* end namespace checkpoint::buffer */
+
+#endif /*INCLUDED_SRC_CHECKPOINT_BUFFER_ASYNC_FILE_WRITER_H*/
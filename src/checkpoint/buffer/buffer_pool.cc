@@ -0,0 +1,261 @@
+/*
+//@HEADER
+// *****************************************************************************
+//
+//                                buffer_pool.cc
+//                 DARMA/magistrate => Serialization Library
+//
+// Copyright 2019 National Technology & Engineering Solutions of Sandia, LLC
+// (NTESS). Under the terms of Contract DE-NA0003525 with NTESS, the U.S.
+// Government retains certain rights in this software.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+//
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// * Neither the name of the copyright holder nor the names of its
+//   contributors may be used to endorse or promote products derived from this
+//   software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// Questions? Contact darma@sandia.gov
+//
+// *****************************************************************************
+//@HEADER
+*/
+
+#include "checkpoint/common.h"
+#include "checkpoint/buffer/buffer_pool.h"
+#include "checkpoint/buffer/allocation.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <new>
+
+namespace checkpoint { namespace buffer {
+
+namespace {
+
+std::atomic<std::uint64_t> next_pool_id = {1};
+
+void freeBlock(SerialByteType* bytes) {
+  ByteDeleter{}(bytes);
+}
+
+/*
+ * Per-thread state: blocks cached per pool and recycled PooledBuffer objects.
+ * Buffers may be destroyed after this thread's cache during thread or program
+ * exit, so a trivially destructible flag records whether it has been torn down.
+ */
+struct ThreadCache {
+  struct PoolEntry {
+    std::uint64_t pool_id = 0;
+    std::weak_ptr<BufferPool> pool;
+    std::array<std::vector<SerialByteType*>, BufferPool::num_classes> blocks;
+  };
+
+  ThreadCache();
+  ~ThreadCache();
+
+  PoolEntry& getEntry(BufferPool& pool);
+
+  std::vector<PoolEntry> entries;
+  std::vector<void*> objects;
+};
+
+thread_local bool thread_cache_destroyed = false;
+thread_local ThreadCache thread_cache;
+
+// Get this thread's cache, constructing it on first use, or null during exit
+ThreadCache* getThreadCache() {
+  return thread_cache_destroyed ? nullptr : &thread_cache;
+}
+
+static constexpr std::size_t const max_cached_objects = 64;
+
+ThreadCache::ThreadCache() = default;
+
+ThreadCache::~ThreadCache() {
+  thread_cache_destroyed = true;
+  for (auto& entry : entries) {
+    for (auto& list : entry.blocks) {
+      for (auto bytes : list) {
+        freeBlock(bytes);
+      }
+    }
+  }
+  for (auto obj : objects) {
+    ::operator delete(obj);
+  }
+}
+
+ThreadCache::PoolEntry& ThreadCache::getEntry(BufferPool& pool) {
+  auto const id = pool.getID();
+  for (auto& entry : entries) {
+    if (entry.pool_id == id) {
+      return entry;
+    }
+  }
+
+  // Drop entries of pools that no longer exist before adding another
+  entries.erase(
+    std::remove_if(entries.begin(), entries.end(), [](PoolEntry& entry) {
+      if (not entry.pool.expired()) {
+        return false;
+      }
+      for (auto& list : entry.blocks) {
+        for (auto bytes : list) {
+          freeBlock(bytes);
+        }
+      }
+      return true;
+    }),
+    entries.end()
+  );
+
+  entries.emplace_back();
+  entries.back().pool_id = id;
+  entries.back().pool = pool.weak_from_this();
+  return entries.back();
+}
+
+} /* end anonymous namespace */
+
+PooledBuffer::~PooledBuffer() {
+  pool_->release(bytes_, size_class_);
+}
+
+/*static*/ void* PooledBuffer::operator new(std::size_t size) {
+  auto cache = getThreadCache();
+  if (cache != nullptr and not cache->objects.empty()) {
+    auto obj = cache->objects.back();
+    cache->objects.pop_back();
+    return obj;
+  }
+  return ::operator new(size);
+}
+
+/*static*/ void PooledBuffer::operator delete(void* ptr) {
+  auto cache = getThreadCache();
+  if (cache != nullptr and cache->objects.size() < max_cached_objects) {
+    cache->objects.push_back(ptr);
+  } else {
+    ::operator delete(ptr);
+  }
+}
+
+BufferPool::BufferPool()
+  : id_(next_pool_id.fetch_add(1, std::memory_order_relaxed))
+{ }
+
+BufferPool::~BufferPool() {
+  trim();
+}
+
+/*static*/ int BufferPool::getSizeClass(SerialSizeType size) {
+  int cls = 0;
+  while (cls < num_classes and (SerialSizeType{1} << (cls + min_class_shift)) < size) {
+    cls++;
+  }
+  return cls < num_classes ? cls : -1;
+}
+
+std::unique_ptr<PooledBuffer> BufferPool::acquire(SerialSizeType size) {
+  auto const cls = getSizeClass(size);
+  auto self = shared_from_this();
+
+  if (cls < 0) {
+    system_allocations_.fetch_add(1, std::memory_order_relaxed);
+    auto bytes = allocateBytes(size).release();
+    return std::make_unique<PooledBuffer>(std::move(self), bytes, size, cls);
+  }
+
+  SerialSizeType const block = SerialSizeType{1} << (cls + min_class_shift);
+
+  auto cache = block <= thread_cache_max_block ? getThreadCache() : nullptr;
+  if (cache != nullptr) {
+    auto& list = cache->getEntry(*this).blocks[cls];
+    if (not list.empty()) {
+      auto bytes = list.back();
+      list.pop_back();
+      thread_cache_hits_.fetch_add(1, std::memory_order_relaxed);
+      return std::make_unique<PooledBuffer>(std::move(self), bytes, size, cls);
+    }
+  }
+
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto& list = shared_[cls];
+    if (not list.empty()) {
+      auto bytes = list.back();
+      list.pop_back();
+      shared_hits_.fetch_add(1, std::memory_order_relaxed);
+      return std::make_unique<PooledBuffer>(std::move(self), bytes, size, cls);
+    }
+  }
+
+  system_allocations_.fetch_add(1, std::memory_order_relaxed);
+  auto bytes = allocateBytes(block).release();
+  return std::make_unique<PooledBuffer>(std::move(self), bytes, size, cls);
+}
+
+void BufferPool::release(SerialByteType* bytes, int size_class) {
+  releases_.fetch_add(1, std::memory_order_relaxed);
+
+  if (size_class < 0) {
+    freeBlock(bytes);
+    return;
+  }
+
+  SerialSizeType const block = SerialSizeType{1} << (size_class + min_class_shift);
+
+  auto cache = block <= thread_cache_max_block ? getThreadCache() : nullptr;
+  if (cache != nullptr) {
+    auto& list = cache->getEntry(*this).blocks[size_class];
+    if (list.size() < thread_cache_blocks) {
+      list.push_back(bytes);
+      return;
+    }
+  }
+
+  std::lock_guard<std::mutex> lock(mutex_);
+  shared_[size_class].push_back(bytes);
+}
+
+BufferPoolStats BufferPool::getStats() const {
+  BufferPoolStats stats;
+  stats.system_allocations = system_allocations_.load(std::memory_order_relaxed);
+  stats.thread_cache_hits = thread_cache_hits_.load(std::memory_order_relaxed);
+  stats.shared_hits = shared_hits_.load(std::memory_order_relaxed);
+  stats.releases = releases_.load(std::memory_order_relaxed);
+  return stats;
+}
+
+void BufferPool::trim() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  for (auto& list : shared_) {
+    for (auto bytes : list) {
+      freeBlock(bytes);
+    }
+    list.clear();
+  }
+}
+
+}} /* end namespace checkpoint::buffer */
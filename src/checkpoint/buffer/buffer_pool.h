@@ -0,0 +1,189 @@
+/*
+//@HEADER
+// *****************************************************************************
+//
+//                                buffer_pool.h
+//                 DARMA/magistrate => Serialization Library
+//
+// Copyright 2019 National Technology & Engineering Solutions of Sandia, LLC
+// (NTESS). Under the terms of Contract DE-NA0003525 with NTESS, the U.S.
+// Government retains certain rights in this software.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+//
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// * Neither the name of the copyright holder nor the names of its
+//   contributors may be used to endorse or promote products derived from this
+//   software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// Questions? Contact darma@sandia.gov
+//
+// *****************************************************************************
+//@HEADER
+*/
+
+#if !defined INCLUDED_SRC_CHECKPOINT_BUFFER_BUFFER_POOL_H
+#define INCLUDED_SRC_CHECKPOINT_BUFFER_BUFFER_POOL_H
+
+#include "checkpoint/common.h"
+#include "checkpoint/buffer/buffer.h"
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace checkpoint { namespace buffer {
+
+struct BufferPool;
+
+/**
+ * \struct BufferPoolStats
+ *
+ * \brief Counters describing how a \c BufferPool satisfied requests
+ */
+struct BufferPoolStats {
+  std::size_t system_allocations = 0; /**< Blocks obtained from the system */
+  std::size_t thread_cache_hits = 0;  /**< Reused from this thread's cache */
+  std::size_t shared_hits = 0;        /**< Reused from the shared free lists */
+  std::size_t releases = 0;           /**< Blocks handed back to the pool */
+};
+
+/**
+ * \struct PooledBuffer
+ *
+ * \brief A buffer whose storage is borrowed from a \c BufferPool and handed
+ * back when the buffer is destroyed
+ *
+ * The buffer objects themselves are also recycled through a small per-thread
+ * cache, so a serialize/destroy cycle does not reach the system allocator once
+ * the pool is warm.
+ */
+struct PooledBuffer final : Buffer {
+  PooledBuffer(
+    std::shared_ptr<BufferPool> in_pool, SerialByteType* in_bytes,
+    SerialSizeType in_size, int in_size_class
+  ) : pool_(std::move(in_pool)), bytes_(in_bytes), size_(in_size),
+      size_class_(in_size_class)
+  { }
+
+  PooledBuffer(PooledBuffer const&) = delete;
+  PooledBuffer& operator=(PooledBuffer const&) = delete;
+
+  virtual ~PooledBuffer();
+
+  virtual SerialByteType* getBuffer() const override {
+    return bytes_;
+  }
+
+  virtual SerialSizeType getSize() const override {
+    return size_;
+  }
+
+  static void* operator new(std::size_t size);
+  static void operator delete(void* ptr);
+
+private:
+  std::shared_ptr<BufferPool> pool_ = nullptr;
+  SerialByteType* bytes_ = nullptr;
+  SerialSizeType size_ = 0;
+  int size_class_ = -1;
+};
+
+/**
+ * \struct BufferPool
+ *
+ * \brief Recycles packing buffers across serialize calls
+ *
+ * Requests are rounded up to a power-of-two size class. Freed blocks go first
+ * to a small cache owned by the releasing thread and then to free lists shared
+ * by all threads. Requests larger than the biggest class are not pooled. A pool
+ * must be owned by a \c std::shared_ptr; buffers keep it alive until they are
+ * destroyed.
+ */
+struct BufferPool : std::enable_shared_from_this<BufferPool> {
+  /// Smallest size class is 2^min_class_shift bytes
+  static constexpr int const min_class_shift = 8;
+  /// Largest size class is 2^max_class_shift bytes
+  static constexpr int const max_class_shift = 30;
+  static constexpr int const num_classes = max_class_shift - min_class_shift + 1;
+  /// Classes above this size bypass the per-thread caches
+  static constexpr SerialSizeType const thread_cache_max_block = 16ull << 20;
+  /// Blocks of each class a thread may keep
+  static constexpr std::size_t const thread_cache_blocks = 4;
+
+  BufferPool();
+  ~BufferPool();
+
+  BufferPool(BufferPool const&) = delete;
+  BufferPool& operator=(BufferPool const&) = delete;
+
+  /**
+   * \brief Get a buffer of \c size bytes, reusing pooled storage if possible
+   *
+   * \param[in] size the number of bytes needed
+   *
+   * \return the buffer, which returns its storage to the pool when destroyed
+   */
+  std::unique_ptr<PooledBuffer> acquire(SerialSizeType size);
+
+  /**
+   * \brief Get a snapshot of the pool's counters
+   *
+   * \return the counters
+   */
+  BufferPoolStats getStats() const;
+
+  /**
+   * \brief Free all blocks held in the shared free lists
+   */
+  void trim();
+
+  /**
+   * \internal \brief Get the unique identifier of this pool
+   *
+   * \return the identifier
+   */
+  std::uint64_t getID() const { return id_; }
+
+private:
+  friend struct PooledBuffer;
+
+  void release(SerialByteType* bytes, int size_class);
+
+  static int getSizeClass(SerialSizeType size);
+
+private:
+  std::uint64_t const id_ = 0;
+  mutable std::mutex mutex_;
+  std::array<std::vector<SerialByteType*>, num_classes> shared_ = {};
+  std::atomic<std::size_t> system_allocations_ = {0};
+  std::atomic<std::size_t> thread_cache_hits_ = {0};
+  std::atomic<std::size_t> shared_hits_ = {0};
+  std::atomic<std::size_t> releases_ = {0};
+};
+
+}} /* end namespace checkpoint::buffer */
+
+#endif /*INCLUDED_SRC_CHECKPOINT_BUFFER_BUFFER_POOL_H*/
@@ -0,0 +1,243 @@
+/*
+//@HEADER
+// *****************************************************************************
+//
+//                                byte_order.cc
+//                 DARMA/magistrate => Serialization Library
+//
+// Copyright 2019 National Technology & Engineering Solutions of Sandia, LLC
+// (NTESS). Under the terms of Contract DE-NA0003525 with NTESS, the U.S.
+// Government retains certain rights in this software.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+//
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// * Neither the name of the copyright holder nor the names of its
+//   contributors may be used to endorse or promote products derived from this
+//   software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// Questions? Contact darma@sandia.gov
+//
+// *****************************************************************************
+//@HEADER
+*/
+
+#include "checkpoint/common.h"
+#include "checkpoint/buffer/byte_order.h"
+
+#include <cstring>
+#include <stdexcept>
+#include <string>
+
+#if defined(checkpoint_has_x86_shuffle)
+  #include <immintrin.h>
+#endif
+
+namespace checkpoint { namespace buffer {
+
+namespace {
+
+inline uint16_t swapValue(uint16_t v) { return __builtin_bswap16(v); }
+inline uint32_t swapValue(uint32_t v) { return __builtin_bswap32(v); }
+inline uint64_t swapValue(uint64_t v) { return __builtin_bswap64(v); }
+
+/// Swap elements one at a time; compilers vectorize this loop where they can
+template <typename U>
+void swapScalar(
+  SerialByteType* dst, SerialByteType const* src, SerialSizeType num_elms
+) {
+  for (SerialSizeType i = 0; i < num_elms; i++) {
+    U v;
+    std::memcpy(&v, src + i * sizeof(U), sizeof(U));
+    v = swapValue(v);
+    std::memcpy(dst + i * sizeof(U), &v, sizeof(U));
+  }
+}
+
+template <typename U>
+void storeLittle(SerialByteType* dst, U v) {
+  if (host_is_big_endian) {
+    v = swapValue(v);
+  }
+  std::memcpy(dst, &v, sizeof(U));
+}
+
+template <typename U>
+U loadLittle(SerialByteType const* src) {
+  U v;
+  std::memcpy(&v, src, sizeof(U));
+  return host_is_big_endian ? swapValue(v) : v;
+}
+
+#if defined(checkpoint_has_x86_shuffle)
+/// Byte permutation reversing each element of \c elm_size bytes in 16 bytes
+inline char shuffleIndex(int i, SerialSizeType elm_size) {
+  auto const e = static_cast<int>(elm_size);
+  return static_cast<char>(i / e * e + (e - 1 - i % e));
+}
+
+/**
+ * Swap whole 32-byte vectors with \c vpshufb; return the number of bytes
+ * swapped. The shuffle works within each 16-byte lane, which never splits an
+ * element.
+ */
+__attribute__((target("avx2")))
+SerialSizeType swapAVX2(
+  SerialByteType* dst, SerialByteType const* src, SerialSizeType len,
+  SerialSizeType elm_size
+) {
+  char idx[32];
+  for (int i = 0; i < 32; i++) {
+    idx[i] = shuffleIndex(i % 16, elm_size);
+  }
+  auto const mask = _mm256_loadu_si256(reinterpret_cast<__m256i const*>(idx));
+
+  SerialSizeType i = 0;
+  for (; i + 32 <= len; i += 32) {
+    auto v = _mm256_loadu_si256(reinterpret_cast<__m256i const*>(src + i));
+    v = _mm256_shuffle_epi8(v, mask);
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i), v);
+  }
+  return i;
+}
+
+/// Swap whole 16-byte vectors with \c pshufb; return the bytes swapped
+__attribute__((target("ssse3")))
+SerialSizeType swapSSSE3(
+  SerialByteType* dst, SerialByteType const* src, SerialSizeType len,
+  SerialSizeType elm_size
+) {
+  char idx[16];
+  for (int i = 0; i < 16; i++) {
+    idx[i] = shuffleIndex(i, elm_size);
+  }
+  auto const mask = _mm_loadu_si128(reinterpret_cast<__m128i const*>(idx));
+
+  SerialSizeType i = 0;
+  for (; i + 16 <= len; i += 16) {
+    auto v = _mm_loadu_si128(reinterpret_cast<__m128i const*>(src + i));
+    v = _mm_shuffle_epi8(v, mask);
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), v);
+  }
+  return i;
+}
+#endif
+
+enum struct VectorSwap : int8_t { None, SSSE3, AVX2 };
+
+VectorSwap detectVectorSwap() {
+#if defined(checkpoint_has_x86_shuffle)
+  if (__builtin_cpu_supports("avx2")) {
+    return VectorSwap::AVX2;
+  }
+  if (__builtin_cpu_supports("ssse3")) {
+    return VectorSwap::SSSE3;
+  }
+#endif
+  return VectorSwap::None;
+}
+
+VectorSwap getVectorSwap() {
+  static VectorSwap const kind = detectVectorSwap();
+  return kind;
+}
+
+} /* end anonymous namespace */
+
+bool hasVectorByteSwap() {
+  return getVectorSwap() != VectorSwap::None;
+}
+
+void byteSwap(
+  SerialByteType* dst, SerialByteType const* src, SerialSizeType num_elms,
+  SerialSizeType elm_size
+) {
+  checkpointAssert(
+    elm_size == 2 or elm_size == 4 or elm_size == 8,
+    "Only elements of 2, 4 or 8 bytes are byte-swapped"
+  );
+
+  SerialSizeType done = 0;
+
+#if defined(checkpoint_has_x86_shuffle)
+  auto const len = num_elms * elm_size;
+  switch (getVectorSwap()) {
+  case VectorSwap::AVX2:
+    done = swapAVX2(dst, src, len, elm_size);
+    break;
+  case VectorSwap::SSSE3:
+    done = swapSSSE3(dst, src, len, elm_size);
+    break;
+  case VectorSwap::None:
+    break;
+  }
+#endif
+
+  // Vectors always hold whole elements, so the tail starts on an element
+  auto const rest = num_elms - done / elm_size;
+  switch (elm_size) {
+  case 2: swapScalar<uint16_t>(dst + done, src + done, rest); break;
+  case 4: swapScalar<uint32_t>(dst + done, src + done, rest); break;
+  case 8: swapScalar<uint64_t>(dst + done, src + done, rest); break;
+  }
+}
+
+void writePortableHeader(SerialByteType* dst, SerialSizeType payload_size) {
+  std::memset(dst, 0, portable_header_size);
+  storeLittle<uint32_t>(dst, portable_magic);
+  dst[4] = static_cast<SerialByteType>(portable_version);
+  dst[5] = static_cast<SerialByteType>(portable_little_endian);
+  storeLittle<uint64_t>(dst + 8, payload_size);
+}
+
+SerialSizeType readPortableHeader(
+  SerialByteType const* bytes, SerialSizeType size
+) {
+  if (size < portable_header_size or
+      loadLittle<uint32_t>(bytes) != portable_magic) {
+    throw std::runtime_error("Not a portable buffer: no portable header");
+  }
+
+  auto const version = static_cast<uint8_t>(bytes[4]);
+  auto const order = static_cast<uint8_t>(bytes[5]);
+  if (version != portable_version) {
+    throw std::runtime_error(
+      "Unsupported portable buffer version " + std::to_string(version)
+    );
+  }
+  if (order != portable_little_endian) {
+    throw std::runtime_error(
+      "Unsupported portable buffer byte order " + std::to_string(order)
+    );
+  }
+
+  auto const payload = loadLittle<uint64_t>(bytes + 8);
+  if (payload > size - portable_header_size) {
+    throw std::runtime_error(
+      "Portable buffer truncated: expected " + std::to_string(payload) +
+      " payload bytes, found " + std::to_string(size - portable_header_size)
+    );
+  }
+  return payload;
+}
+
+}} /* end namespace checkpoint::buffer */
@@ -0,0 +1,145 @@
+/*
+//@HEADER
+// *****************************************************************************
+//
+//                                 byte_order.h
+//                 DARMA/magistrate => Serialization Library
+//
+// Copyright 2019 National Technology & Engineering Solutions of Sandia, LLC
+// (NTESS). Under the terms of Contract DE-NA0003525 with NTESS, the U.S.
+// Government retains certain rights in this software.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+//
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// * Neither the name of the copyright holder nor the names of its
+//   contributors may be used to endorse or promote products derived from this
+//   software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// Questions? Contact darma@sandia.gov
+//
+// *****************************************************************************
+//@HEADER
+*/
+
+#if !defined INCLUDED_SRC_CHECKPOINT_BUFFER_BYTE_ORDER_H
+#define INCLUDED_SRC_CHECKPOINT_BUFFER_BYTE_ORDER_H
+
+#include "checkpoint/common.h"
+
+#include <cstdint>
+#include <type_traits>
+
+namespace checkpoint { namespace buffer {
+
+/*
+ * A portable buffer stores every arithmetic value little-endian, whatever the
+ * byte order of the host that packed it, and starts with a header laid out
+ * (also little-endian) as:
+ *
+ *   uint32_t magic
+ *   uint8_t  version
+ *   uint8_t  byte order of the payload (0 = little-endian)
+ *   uint16_t reserved, zero
+ *   uint64_t payload size
+ *
+ * The header keeps the payload 16-byte aligned relative to the buffer.
+ */
+
+/// "MGE1" read as a little-endian integer
+static constexpr uint32_t const portable_magic = 0x3145474d;
+
+static constexpr uint8_t const portable_version = 1;
+
+/// Byte order recorded for little-endian payloads
+static constexpr uint8_t const portable_little_endian = 0;
+
+/// Bytes before the payload of a portable buffer
+static constexpr SerialSizeType const portable_header_size = 16;
+
+/// Whether this host stores multi-byte values most significant byte first
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+static constexpr bool const host_is_big_endian = true;
+#else
+static constexpr bool const host_is_big_endian = false;
+#endif
+
+/**
+ * \struct IsByteSwappable
+ *
+ * \brief Whether values of \c T are byte-swapped into the portable byte order:
+ * integers, enums and IEEE floating point of 2, 4 or 8 bytes
+ */
+template <typename T>
+struct IsByteSwappable : std::integral_constant<
+  bool,
+  (std::is_arithmetic<T>::value or std::is_enum<T>::value) and
+  (sizeof(T) == 2 or sizeof(T) == 4 or sizeof(T) == 8)
+> { };
+
+/**
+ * \brief Whether \c byteSwap uses vector shuffles on this machine (otherwise a
+ * scalar loop is used)
+ *
+ * \return whether the vector path is used
+ */
+bool hasVectorByteSwap();
+
+/**
+ * \brief Reverse the bytes of each of \c num_elms elements
+ *
+ * \param[out] dst where to write the swapped elements; may equal \c src
+ * \param[in] src the elements
+ * \param[in] num_elms the number of elements
+ * \param[in] elm_size the bytes in each element: 2, 4 or 8
+ */
+void byteSwap(
+  SerialByteType* dst, SerialByteType const* src, SerialSizeType num_elms,
+  SerialSizeType elm_size
+);
+
+/**
+ * \brief Write the header of a portable buffer
+ *
+ * \param[out] dst space for \c portable_header_size bytes
+ * \param[in] payload_size the number of bytes after the header
+ */
+void writePortableHeader(SerialByteType* dst, SerialSizeType payload_size);
+
+/**
+ * \brief Read the header of a portable buffer
+ *
+ * Throws \c std::runtime_error if \c bytes do not start with a valid header
+ * or are shorter than the payload it describes.
+ *
+ * \param[in] bytes the buffer
+ * \param[in] size the number of bytes in the buffer
+ *
+ * \return the payload size
+ */
+SerialSizeType readPortableHeader(
+  SerialByteType const* bytes, SerialSizeType size
+);
+
+}} /* end namespace checkpoint::buffer */
+
+#endif /*INCLUDED_SRC_CHECKPOINT_BUFFER_BYTE_ORDER_H*/
@@ -0,0 +1,449 @@
+/*
+//@HEADER
+// *****************************************************************************
+//
+//                                 checksum.cc
+//                 DARMA/magistrate => Serialization Library
+//
+// Copyright 2019 National Technology & Engineering Solutions of Sandia, LLC
+// (NTESS). Under the terms of Contract DE-NA0003525 with NTESS, the U.S.
+// Government retains certain rights in this software.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+//
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// * Neither the name of the copyright holder nor the names of its
+//   contributors may be used to endorse or promote products derived from this
+//   software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// Questions? Contact darma@sandia.gov
+//
+// *****************************************************************************
+//@HEADER
+*/
+
+#include "checkpoint/common.h"
+#include "checkpoint/buffer/checksum.h"
+#include "checkpoint/buffer/parallel_for.h"
+
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <string>
+#include <utility>
+
+#if defined(checkpoint_has_sse42_crc32c)
+  #include <nmmintrin.h>
+#endif
+
+namespace checkpoint { namespace buffer {
+
+namespace {
+
+/// CRC32C polynomial, bit-reflected
+constexpr uint32_t const poly = 0x82f63b78;
+
+/// Bytes in each of the three interleaved streams of the hardware path
+constexpr SerialSizeType const hw_block = 4096;
+
+/// Multiply \c a and \c b modulo the polynomial (reflected); \c a must be
+/// non-zero
+uint32_t multModP(uint32_t a, uint32_t b) {
+  uint32_t m = 1u << 31;
+  uint32_t p = 0;
+  for (;;) {
+    if (a & m) {
+      p ^= b;
+      if ((a & (m - 1)) == 0) {
+        break;
+      }
+    }
+    m >>= 1;
+    b = (b & 1) ? (b >> 1) ^ poly : b >> 1;
+  }
+  return p;
+}
+
+struct CRCTables {
+  /// Slicing-by-8 tables for the software path
+  std::array<std::array<uint32_t, 256>, 8> slice;
+
+  /// x^(2^k) modulo the polynomial, for shifting a CRC by any length
+  std::array<uint32_t, 64> x2n;
+
+  /// Shift a CRC register past \c hw_block zero bytes, one table per byte
+  std::array<std::array<uint32_t, 256>, 4> shift_block;
+
+  CRCTables() {
+    for (uint32_t n = 0; n < 256; n++) {
+      uint32_t c = n;
+      for (int k = 0; k < 8; k++) {
+        c = (c & 1) ? (c >> 1) ^ poly : c >> 1;
+      }
+      slice[0][n] = c;
+    }
+    for (uint32_t n = 0; n < 256; n++) {
+      for (int t = 1; t < 8; t++) {
+        auto const prev = slice[t - 1][n];
+        slice[t][n] = (prev >> 8) ^ slice[0][prev & 0xff];
+      }
+    }
+
+    uint32_t p = 1u << 30; // x^1
+    x2n[0] = p;
+    for (std::size_t k = 1; k < x2n.size(); k++) {
+      p = multModP(p, p);
+      x2n[k] = p;
+    }
+
+    auto const shift = x2nModP(hw_block, 3);
+    for (uint32_t b = 0; b < 256; b++) {
+      for (int t = 0; t < 4; t++) {
+        shift_block[t][b] = multModP(shift, b << (8 * t));
+      }
+    }
+  }
+
+  /// x^(n * 2^k) modulo the polynomial
+  uint32_t x2nModP(SerialSizeType n, unsigned k) const {
+    uint32_t p = 1u << 31; // x^0
+    while (n) {
+      if (n & 1) {
+        p = multModP(x2n[k & 63], p);
+      }
+      n >>= 1;
+      k++;
+    }
+    return p;
+  }
+
+  uint32_t shiftBlock(uint32_t reg) const {
+    return shift_block[0][reg & 0xff] ^ shift_block[1][(reg >> 8) & 0xff] ^
+      shift_block[2][(reg >> 16) & 0xff] ^ shift_block[3][reg >> 24];
+  }
+};
+
+CRCTables const& getTables() {
+  static CRCTables const tables;
+  return tables;
+}
+
+inline uint64_t load64(unsigned char const* p) {
+  uint64_t v;
+  std::memcpy(&v, p, sizeof(v));
+  return v;
+}
+
+/// Update a raw (unconditioned) CRC register with the slicing-by-8 tables
+uint32_t crc32cSoftware(uint32_t reg, unsigned char const* p, SerialSizeType len) {
+  auto const& t = getTables().slice;
+
+  while (len >= 8) {
+    auto const v = load64(p) ^ reg;
+    reg = t[7][v & 0xff] ^ t[6][(v >> 8) & 0xff] ^
+      t[5][(v >> 16) & 0xff] ^ t[4][(v >> 24) & 0xff] ^
+      t[3][(v >> 32) & 0xff] ^ t[2][(v >> 40) & 0xff] ^
+      t[1][(v >> 48) & 0xff] ^ t[0][v >> 56];
+    p += 8;
+    len -= 8;
+  }
+  while (len--) {
+    reg = (reg >> 8) ^ t[0][(reg ^ *p++) & 0xff];
+  }
+  return reg;
+}
+
+#if defined(checkpoint_has_sse42_crc32c)
+/**
+ * Update a raw CRC register with the \c crc32 instruction. The instruction has
+ * a latency of several cycles, so three independent streams are run side by
+ * side and their registers merged by shifting.
+ */
+__attribute__((target("sse4.2")))
+uint32_t crc32cHardware(uint32_t reg, unsigned char const* p, SerialSizeType len) {
+  auto const& tables = getTables();
+
+  while (len >= 3 * hw_block) {
+    uint64_t a = reg, b = 0, c = 0;
+    for (SerialSizeType i = 0; i < hw_block; i += 8) {
+      a = _mm_crc32_u64(a, load64(p + i));
+      b = _mm_crc32_u64(b, load64(p + hw_block + i));
+      c = _mm_crc32_u64(c, load64(p + 2 * hw_block + i));
+    }
+    auto const ab = tables.shiftBlock(static_cast<uint32_t>(a)) ^
+      static_cast<uint32_t>(b);
+    reg = tables.shiftBlock(ab) ^ static_cast<uint32_t>(c);
+    p += 3 * hw_block;
+    len -= 3 * hw_block;
+  }
+
+  uint64_t r = reg;
+  while (len >= 8) {
+    r = _mm_crc32_u64(r, load64(p));
+    p += 8;
+    len -= 8;
+  }
+  reg = static_cast<uint32_t>(r);
+  while (len--) {
+    reg = _mm_crc32_u8(reg, *p++);
+  }
+  return reg;
+}
+#endif
+
+bool detectHardware() {
+#if defined(checkpoint_has_sse42_crc32c)
+  return __builtin_cpu_supports("sse4.2");
+#else
+  return false;
+#endif
+}
+
+inline SerialSizeType numChunks(SerialSizeType len, SerialSizeType chunk_size) {
+  return (len + chunk_size - 1) / chunk_size;
+}
+
+} /* end anonymous namespace */
+
+bool hasHardwareCRC32C() {
+  static bool const hardware = detectHardware();
+  return hardware;
+}
+
+uint32_t crc32c(void const* data, SerialSizeType len, uint32_t crc) {
+  auto const p = static_cast<unsigned char const*>(data);
+  uint32_t reg = ~crc;
+
+#if defined(checkpoint_has_sse42_crc32c)
+  if (hasHardwareCRC32C()) {
+    return ~crc32cHardware(reg, p, len);
+  }
+#endif
+
+  return ~crc32cSoftware(reg, p, len);
+}
+
+uint32_t crc32cCombine(uint32_t crc1, uint32_t crc2, SerialSizeType len2) {
+  if (len2 == 0) {
+    return crc1;
+  }
+  return multModP(getTables().x2nModP(len2, 3), crc1) ^ crc2;
+}
+
+SerialSizeType getChecksumTrailerSize(
+  SerialSizeType payload_size, SerialSizeType chunk_size
+) {
+  return numChunks(payload_size, chunk_size) * sizeof(uint32_t) +
+    sizeof(ChecksumFooter);
+}
+
+std::vector<uint32_t> computeChunkChecksums(
+  SerialByteType const* bytes, SerialSizeType len, SerialSizeType chunk_size,
+  unsigned num_threads
+) {
+  checkpointAssert(chunk_size > 0, "Checksum chunk size must be positive");
+
+  std::vector<uint32_t> crcs(numChunks(len, chunk_size));
+  parallelFor(crcs.size(), num_threads, [&](SerialSizeType i) {
+    auto const offset = i * chunk_size;
+    crcs[i] = crc32c(bytes + offset, std::min(chunk_size, len - offset));
+  });
+  return crcs;
+}
+
+void writeChecksumTrailer(
+  SerialByteType* dst, std::vector<uint32_t> const& crcs,
+  SerialSizeType payload_size, SerialSizeType chunk_size
+) {
+  checkpointAssert(
+    crcs.size() == numChunks(payload_size, chunk_size),
+    "One checksum per chunk is required"
+  );
+
+  auto const crc_bytes = crcs.size() * sizeof(uint32_t);
+  std::memcpy(dst, crcs.data(), crc_bytes);
+
+  ChecksumFooter footer;
+  footer.payload_size = payload_size;
+  footer.chunk_size = chunk_size;
+  footer.num_chunks = static_cast<uint32_t>(crcs.size());
+  std::memcpy(dst + crc_bytes, &footer, sizeof(footer));
+}
+
+void appendChecksumTrailer(
+  SerialByteType* bytes, SerialSizeType payload_size,
+  ChecksumOptions const& options
+) {
+  auto const crcs = computeChunkChecksums(
+    bytes, payload_size, options.chunk_size, options.num_threads
+  );
+  writeChecksumTrailer(bytes + payload_size, crcs, payload_size, options.chunk_size);
+}
+
+bool readChecksumFooter(
+  SerialByteType const* bytes, SerialSizeType size, ChecksumVerify mode,
+  ChecksumFooter& footer
+) {
+  bool found = size >= sizeof(footer);
+  if (found) {
+    std::memcpy(&footer, bytes + size - sizeof(footer), sizeof(footer));
+    found = isValidChecksumFooter(footer, size);
+  }
+
+  if (not found and mode == ChecksumVerify::Require) {
+    throw checksum_error("No checksum trailer found");
+  }
+  return found;
+}
+
+bool isValidChecksumFooter(ChecksumFooter const& footer, SerialSizeType size) {
+  // Accept the footer only if every field is consistent with \c size
+  return footer.magic == checksum_magic and footer.chunk_size > 0 and
+    footer.payload_size <= size and
+    footer.num_chunks == numChunks(footer.payload_size, footer.chunk_size) and
+    footer.payload_size +
+      getChecksumTrailerSize(footer.payload_size, footer.chunk_size) == size;
+}
+
+void verifyChecksumChunk(
+  SerialByteType const* bytes, ChecksumFooter const& footer,
+  SerialSizeType chunk
+) {
+  auto const begin = chunk * footer.chunk_size;
+  auto const end = std::min(begin + footer.chunk_size, footer.payload_size);
+
+  uint32_t expected = 0;
+  std::memcpy(
+    &expected, bytes + footer.payload_size + chunk * sizeof(uint32_t),
+    sizeof(expected)
+  );
+
+  if (crc32c(bytes + begin, end - begin) != expected) {
+    throw checksum_error(
+      "Checksum mismatch in chunk " + std::to_string(chunk) + " (bytes " +
+      std::to_string(begin) + " to " + std::to_string(end) + ")"
+    );
+  }
+}
+
+SerialSizeType verifyChecksumTrailer(
+  SerialByteType const* bytes, SerialSizeType size, ChecksumVerify mode,
+  unsigned num_threads
+) {
+  if (mode == ChecksumVerify::Skip) {
+    return size;
+  }
+
+  ChecksumFooter footer;
+  if (not readChecksumFooter(bytes, size, mode, footer)) {
+    return size;
+  }
+
+  std::vector<uint32_t> expected(footer.num_chunks);
+  std::memcpy(
+    expected.data(), bytes + footer.payload_size,
+    expected.size() * sizeof(uint32_t)
+  );
+
+  auto const actual = computeChunkChecksums(
+    bytes, footer.payload_size, footer.chunk_size, num_threads
+  );
+  for (SerialSizeType i = 0; i < actual.size(); i++) {
+    if (actual[i] != expected[i]) {
+      // Report the first bad chunk
+      verifyChecksumChunk(bytes, footer, i);
+    }
+  }
+
+  return footer.payload_size;
+}
+
+ChunkChecksummer::ChunkChecksummer(SerialSizeType chunk_size)
+  : chunk_size_(chunk_size)
+{
+  checkpointAssert(chunk_size_ > 0, "Checksum chunk size must be positive");
+}
+
+void ChunkChecksummer::update(SerialByteType const* bytes, SerialSizeType len) {
+  total_ += len;
+  while (len > 0) {
+    auto const n = std::min(len, chunk_size_ - in_chunk_);
+    crc_ = crc32c(bytes, n, crc_);
+    in_chunk_ += n;
+    bytes += n;
+    len -= n;
+    if (in_chunk_ == chunk_size_) {
+      crcs_.push_back(crc_);
+      crc_ = 0;
+      in_chunk_ = 0;
+    }
+  }
+}
+
+SerialSizeType ChunkChecksummer::getTrailerSize() const {
+  return getChecksumTrailerSize(total_, chunk_size_);
+}
+
+void ChunkChecksummer::writeTrailer(SerialByteType* dst) const {
+  auto crcs = crcs_;
+  if (in_chunk_ > 0) {
+    crcs.push_back(crc_);
+  }
+  writeChecksumTrailer(dst, crcs, total_, chunk_size_);
+}
+
+ChunkVerifier::ChunkVerifier(
+  ChecksumFooter const& footer, std::vector<uint32_t> expected
+) : footer_(footer),
+    expected_(std::move(expected))
+{ }
+
+void ChunkVerifier::update(SerialByteType const* bytes, SerialSizeType len) {
+  while (len > 0) {
+    auto const begin = chunk_ * footer_.chunk_size;
+    auto const chunk_len =
+      std::min(footer_.chunk_size, footer_.payload_size - begin);
+    auto const n = std::min(len, chunk_len - in_chunk_);
+    crc_ = crc32c(bytes, n, crc_);
+    in_chunk_ += n;
+    bytes += n;
+    len -= n;
+    if (in_chunk_ == chunk_len) {
+      check();
+    }
+  }
+}
+
+void ChunkVerifier::check() {
+  auto const begin = chunk_ * footer_.chunk_size;
+  if (crc_ != expected_[chunk_]) {
+    throw checksum_error(
+      "Checksum mismatch in chunk " + std::to_string(chunk_) + " (bytes " +
+      std::to_string(begin) + " to " + std::to_string(begin + in_chunk_) + ")"
+    );
+  }
+  chunk_++;
+  in_chunk_ = 0;
+  crc_ = 0;
+}
+
+}} /* end namespace checkpoint::buffer */
@@ -0,0 +1,307 @@
+/*
+//@HEADER
+// *****************************************************************************
+//
+//                                  checksum.h
+//                 DARMA/magistrate => Serialization Library
+//
+// Copyright 2019 National Technology & Engineering Solutions of Sandia, LLC
+// (NTESS). Under the terms of Contract DE-NA0003525 with NTESS, the U.S.
+// Government retains certain rights in this software.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+//
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// * Neither the name of the copyright holder nor the names of its
+//   contributors may be used to endorse or promote products derived from this
+//   software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// Questions? Contact darma@sandia.gov
+//
+// *****************************************************************************
+//@HEADER
+*/
+
+#if !defined INCLUDED_SRC_CHECKPOINT_BUFFER_CHECKSUM_H
+#define INCLUDED_SRC_CHECKPOINT_BUFFER_CHECKSUM_H
+
+#include "checkpoint/common.h"
+#include "checkpoint/buffer/io_options.h"
+
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace checkpoint { namespace buffer {
+
+/*
+ * A checksum trailer follows the bytes it covers:
+ *
+ *   payload
+ *   uint32_t CRC32C of each chunk of the payload
+ *   ChecksumFooter
+ *
+ * Readers that do not know about the trailer still see a valid payload at the
+ * start of the bytes.
+ */
+
+/// "MGC1" read as a little-endian integer
+static constexpr uint32_t const checksum_magic = 0x3143474d;
+
+struct ChecksumFooter {
+  uint64_t payload_size = 0;
+  uint64_t chunk_size = 0;
+  uint32_t num_chunks = 0;
+  uint32_t magic = checksum_magic;
+};
+
+/**
+ * \struct checksum_error
+ *
+ * \brief Thrown when bytes do not match their checksum trailer
+ */
+struct checksum_error : public std::runtime_error {
+  explicit checksum_error(std::string const& msg) : std::runtime_error(msg) { }
+};
+
+/**
+ * \brief Whether CRC32C is computed with the SSE4.2 \c crc32 instruction on
+ * this machine (otherwise a slicing-by-8 table implementation is used)
+ *
+ * \return whether the hardware path is used
+ */
+bool hasHardwareCRC32C();
+
+/**
+ * \brief Compute the CRC32C (Castagnoli) of \c len bytes
+ *
+ * \param[in] data the bytes
+ * \param[in] len the number of bytes
+ * \param[in] crc the CRC of preceding bytes, to continue a running CRC
+ *
+ * \return the CRC of the preceding bytes followed by \c data
+ */
+uint32_t crc32c(void const* data, SerialSizeType len, uint32_t crc = 0);
+
+/**
+ * \brief Combine the CRCs of two adjacent byte ranges
+ *
+ * \param[in] crc1 the CRC of the first range
+ * \param[in] crc2 the CRC of the second range
+ * \param[in] len2 the length of the second range
+ *
+ * \return the CRC of the concatenated ranges
+ */
+uint32_t crc32cCombine(uint32_t crc1, uint32_t crc2, SerialSizeType len2);
+
+/**
+ * \brief Get the number of bytes in a checksum trailer
+ *
+ * \param[in] payload_size the number of bytes covered
+ * \param[in] chunk_size the bytes covered by each CRC
+ *
+ * \return the trailer size
+ */
+SerialSizeType getChecksumTrailerSize(
+  SerialSizeType payload_size, SerialSizeType chunk_size
+);
+
+/**
+ * \brief Compute the CRC of each \c chunk_size chunk of \c bytes
+ *
+ * \param[in] bytes the payload
+ * \param[in] len the payload size
+ * \param[in] chunk_size the bytes covered by each CRC
+ * \param[in] num_threads the number of threads to use
+ *
+ * \return one CRC per chunk
+ */
+std::vector<uint32_t> computeChunkChecksums(
+  SerialByteType const* bytes, SerialSizeType len, SerialSizeType chunk_size,
+  unsigned num_threads = 1
+);
+
+/**
+ * \brief Write a checksum trailer with precomputed chunk CRCs
+ *
+ * \param[out] dst space for \c getChecksumTrailerSize bytes
+ * \param[in] crcs the CRC of each chunk
+ * \param[in] payload_size the number of bytes covered
+ * \param[in] chunk_size the bytes covered by each CRC
+ */
+void writeChecksumTrailer(
+  SerialByteType* dst, std::vector<uint32_t> const& crcs,
+  SerialSizeType payload_size, SerialSizeType chunk_size
+);
+
+/**
+ * \brief Checksum \c payload_size bytes at \c bytes and write the trailer
+ * immediately after them
+ *
+ * \param[in,out] bytes the payload, followed by space for the trailer
+ * \param[in] payload_size the number of bytes covered
+ * \param[in] options the chunk size and thread count
+ */
+void appendChecksumTrailer(
+  SerialByteType* bytes, SerialSizeType payload_size,
+  ChecksumOptions const& options
+);
+
+/**
+ * \brief Verify the checksum trailer at the end of \c bytes
+ *
+ * Throws \c checksum_error if a chunk does not match its CRC, or if
+ * \c mode is \c ChecksumVerify::Require and there is no trailer.
+ *
+ * \param[in] bytes the payload followed by its trailer
+ * \param[in] size the total number of bytes
+ * \param[in] mode whether a trailer is required
+ * \param[in] num_threads the number of threads to use
+ *
+ * \return the size of the payload, or \c size if there is no trailer
+ */
+SerialSizeType verifyChecksumTrailer(
+  SerialByteType const* bytes, SerialSizeType size,
+  ChecksumVerify mode = ChecksumVerify::Require, unsigned num_threads = 1
+);
+
+/**
+ * \brief Read the checksum footer at the end of \c bytes, if it has a valid one
+ *
+ * Throws \c checksum_error if \c mode is \c ChecksumVerify::Require and there
+ * is no trailer.
+ *
+ * \param[in] bytes the payload followed by its trailer
+ * \param[in] size the total number of bytes
+ * \param[in] mode whether a trailer is required
+ * \param[out] footer the footer, if one was found
+ *
+ * \return whether a footer was found
+ */
+bool readChecksumFooter(
+  SerialByteType const* bytes, SerialSizeType size, ChecksumVerify mode,
+  ChecksumFooter& footer
+);
+
+/**
+ * \brief Check that a footer is consistent with the total number of bytes it
+ * was read from
+ *
+ * \param[in] footer the footer
+ * \param[in] size the total number of bytes, including the trailer
+ *
+ * \return whether the footer describes a valid trailer
+ */
+bool isValidChecksumFooter(ChecksumFooter const& footer, SerialSizeType size);
+
+/**
+ * \brief Verify one chunk of a payload against its checksum trailer
+ *
+ * Throws \c checksum_error if the chunk does not match its CRC.
+ *
+ * \param[in] bytes the payload followed by its trailer
+ * \param[in] footer the footer from \c readChecksumFooter
+ * \param[in] chunk the index of the chunk
+ */
+void verifyChecksumChunk(
+  SerialByteType const* bytes, ChecksumFooter const& footer,
+  SerialSizeType chunk
+);
+
+/**
+ * \struct ChunkChecksummer
+ *
+ * \brief Compute chunk CRCs incrementally as a payload is produced
+ */
+struct ChunkChecksummer {
+  explicit ChunkChecksummer(SerialSizeType chunk_size);
+
+  /**
+   * \brief Add the next bytes of the payload
+   *
+   * \param[in] bytes the bytes
+   * \param[in] len the number of bytes
+   */
+  void update(SerialByteType const* bytes, SerialSizeType len);
+
+  /**
+   * \brief Get the size of the trailer for the bytes added so far
+   *
+   * \return the trailer size
+   */
+  SerialSizeType getTrailerSize() const;
+
+  /**
+   * \brief Write the trailer for the bytes added so far
+   *
+   * \param[out] dst space for \c getTrailerSize bytes
+   */
+  void writeTrailer(SerialByteType* dst) const;
+
+private:
+  SerialSizeType chunk_size_ = 0;
+  SerialSizeType total_ = 0;
+  SerialSizeType in_chunk_ = 0; /**< Bytes added to the current chunk */
+  uint32_t crc_ = 0;            /**< CRC of the current chunk */
+  std::vector<uint32_t> crcs_;  /**< CRCs of the completed chunks */
+};
+
+/**
+ * \struct ChunkVerifier
+ *
+ * \brief Verify chunk CRCs incrementally as a payload is consumed in order
+ */
+struct ChunkVerifier {
+  /**
+   * \brief Construct a verifier
+   *
+   * \param[in] footer the footer of the trailer
+   * \param[in] expected the CRC of each chunk, from the trailer
+   */
+  ChunkVerifier(ChecksumFooter const& footer, std::vector<uint32_t> expected);
+
+  /**
+   * \brief Add the next bytes of the payload
+   *
+   * Throws \c checksum_error as soon as a completed chunk does not match its
+   * CRC.
+   *
+   * \param[in] bytes the bytes
+   * \param[in] len the number of bytes
+   */
+  void update(SerialByteType const* bytes, SerialSizeType len);
+
+private:
+  void check();
+
+private:
+  ChecksumFooter footer_ = {};
+  std::vector<uint32_t> expected_;
+  SerialSizeType chunk_ = 0;    /**< Index of the current chunk */
+  SerialSizeType in_chunk_ = 0; /**< Bytes added to the current chunk */
+  uint32_t crc_ = 0;            /**< CRC of the current chunk */
+};
+
+}} /* end namespace checkpoint::buffer */
+
+#endif /*INCLUDED_SRC_CHECKPOINT_BUFFER_CHECKSUM_H*/
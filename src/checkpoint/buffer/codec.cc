@@ -0,0 +1,317 @@
+/*
+//@HEADER
+// *****************************************************************************
+//
+//                                   codec.cc
+//                 DARMA/magistrate => Serialization Library
+//
+// Copyright 2019 National Technology & Engineering Solutions of Sandia, LLC
+// (NTESS). Under the terms of Contract DE-NA0003525 with NTESS, the U.S.
+// Government retains certain rights in this software.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+//
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// * Neither the name of the copyright holder nor the names of its
+//   contributors may be used to endorse or promote products derived from this
+//   software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// Questions? Contact darma@sandia.gov
+//
+// *****************************************************************************
+//@HEADER
+*/
+
+#include "checkpoint/common.h"
+#include "checkpoint/buffer/codec.h"
+
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+
+namespace checkpoint { namespace buffer {
+
+namespace {
+
+constexpr SerialSizeType const min_match = 4;
+constexpr SerialSizeType const max_offset = 65535;
+constexpr int const hash_bits = 14;
+
+inline uint32_t read32(SerialByteType const* p) {
+  uint32_t v;
+  std::memcpy(&v, p, sizeof(v));
+  return v;
+}
+
+inline uint64_t read64(SerialByteType const* p) {
+  uint64_t v;
+  std::memcpy(&v, p, sizeof(v));
+  return v;
+}
+
+inline uint32_t hash(uint32_t seq) {
+  return (seq * 2654435761u) >> (32 - hash_bits);
+}
+
+/// Number of bytes needed to encode the length \c len beyond a 4-bit nibble
+inline SerialSizeType extraLengthBytes(SerialSizeType len) {
+  return len < 15 ? 0 : (len - 15) / 255 + 1;
+}
+
+inline SerialByteType* writeExtraLength(SerialByteType* op, SerialSizeType len) {
+  if (len >= 15) {
+    len -= 15;
+    while (len >= 255) {
+      *op++ = static_cast<SerialByteType>(255);
+      len -= 255;
+    }
+    *op++ = static_cast<SerialByteType>(len);
+  }
+  return op;
+}
+
+[[noreturn]] void corrupt(std::string const& what) {
+  throw std::runtime_error("Corrupt compressed frame: " + what);
+}
+
+inline SerialSizeType readExtraLength(
+  SerialByteType const*& ip, SerialByteType const* iend, SerialSizeType len
+) {
+  if (len == 15) {
+    unsigned char b = 0;
+    do {
+      if (ip >= iend) {
+        corrupt("truncated length");
+      }
+      b = static_cast<unsigned char>(*ip++);
+      len += b;
+    } while (b == 255);
+  }
+  return len;
+}
+
+/**
+ * Emit one sequence: a token, the literals in [lit, lit + lit_len) and, if
+ * \c match_len is non-zero, a match. Returns nullptr if it does not fit.
+ */
+SerialByteType* emitSequence(
+  SerialByteType* op, SerialByteType* oend,
+  SerialByteType const* lit, SerialSizeType lit_len,
+  SerialSizeType offset, SerialSizeType match_len
+) {
+  auto const ml = match_len == 0 ? 0 : match_len - min_match;
+  auto const need = 1 + extraLengthBytes(lit_len) + lit_len +
+    (match_len == 0 ? 0 : 2 + extraLengthBytes(ml));
+  if (static_cast<SerialSizeType>(oend - op) < need) {
+    return nullptr;
+  }
+
+  auto token = op++;
+  *token = static_cast<SerialByteType>(
+    (std::min<SerialSizeType>(lit_len, 15) << 4) | std::min<SerialSizeType>(ml, 15)
+  );
+  op = writeExtraLength(op, lit_len);
+  std::memcpy(op, lit, lit_len);
+  op += lit_len;
+
+  if (match_len != 0) {
+    *op++ = static_cast<SerialByteType>(offset & 0xFF);
+    *op++ = static_cast<SerialByteType>(offset >> 8);
+    op = writeExtraLength(op, ml);
+  }
+  return op;
+}
+
+struct CodecRegistry {
+  std::mutex mutex;
+  std::array<std::shared_ptr<Codec const>, 256> codecs;
+
+  CodecRegistry() {
+    codecs[LZCodec::id] = std::make_shared<LZCodec>();
+  }
+};
+
+CodecRegistry& getRegistry() {
+  static CodecRegistry registry;
+  return registry;
+}
+
+} /* end anonymous namespace */
+
+SerialSizeType LZCodec::getMaxCompressedSize(SerialSizeType len) const {
+  return len + len / 255 + 16;
+}
+
+SerialSizeType LZCodec::compress(
+  SerialByteType const* src, SerialSizeType len,
+  SerialByteType* dst, SerialSizeType capacity
+) const {
+  auto op = dst;
+  auto const oend = dst + capacity;
+
+  SerialSizeType anchor = 0;
+  SerialSizeType ip = 0;
+
+  if (len >= min_match) {
+    auto table = std::make_unique<uint32_t[]>(1u << hash_bits);
+
+    while (ip + min_match <= len) {
+      auto const seq = read32(src + ip);
+      auto const h = hash(seq);
+      SerialSizeType const cand = table[h];
+      table[h] = static_cast<uint32_t>(ip);
+
+      if (cand < ip and ip - cand <= max_offset and read32(src + cand) == seq) {
+        // Extend the match a word at a time, then finish byte by byte
+        auto m = min_match;
+        while (ip + m + 8 <= len and read64(src + cand + m) == read64(src + ip + m)) {
+          m += 8;
+        }
+        while (ip + m < len and src[cand + m] == src[ip + m]) {
+          m++;
+        }
+
+        op = emitSequence(op, oend, src + anchor, ip - anchor, ip - cand, m);
+        if (op == nullptr) {
+          return 0;
+        }
+
+        ip += m;
+        anchor = ip;
+        if (ip + 2 <= len) {
+          table[hash(read32(src + ip - 2))] = static_cast<uint32_t>(ip - 2);
+        }
+      } else {
+        // Step faster through data that does not match
+        ip += 1 + ((ip - anchor) >> 6);
+      }
+    }
+  }
+
+  // The stream always ends with a literal-only sequence
+  op = emitSequence(op, oend, src + anchor, len - anchor, 0, 0);
+  if (op == nullptr) {
+    return 0;
+  }
+  return static_cast<SerialSizeType>(op - dst);
+}
+
+void LZCodec::decompress(
+  SerialByteType const* src, SerialSizeType len,
+  SerialByteType* dst, SerialSizeType raw_len
+) const {
+  auto ip = src;
+  auto const iend = src + len;
+  auto op = dst;
+  auto const oend = dst + raw_len;
+
+  while (true) {
+    if (ip >= iend) {
+      corrupt("missing final sequence");
+    }
+    auto const token = static_cast<unsigned char>(*ip++);
+
+    auto const lit_len = readExtraLength(ip, iend, token >> 4);
+    if (lit_len > static_cast<SerialSizeType>(iend - ip) or
+        lit_len > static_cast<SerialSizeType>(oend - op)) {
+      corrupt("literals out of bounds");
+    }
+    std::memcpy(op, ip, lit_len);
+    ip += lit_len;
+    op += lit_len;
+
+    if (ip == iend) {
+      break;
+    }
+
+    if (iend - ip < 2) {
+      corrupt("truncated offset");
+    }
+    SerialSizeType const offset =
+      static_cast<unsigned char>(ip[0]) |
+      (static_cast<SerialSizeType>(static_cast<unsigned char>(ip[1])) << 8);
+    ip += 2;
+
+    auto const match_len = readExtraLength(ip, iend, token & 0xF) + min_match;
+    if (offset == 0 or offset > static_cast<SerialSizeType>(op - dst) or
+        match_len > static_cast<SerialSizeType>(oend - op)) {
+      corrupt("match out of bounds");
+    }
+
+    auto match = op - offset;
+    if (offset >= match_len) {
+      std::memcpy(op, match, match_len);
+      op += match_len;
+    } else {
+      // Overlapping copy replicates the last \c offset bytes
+      for (SerialSizeType i = 0; i < match_len; i++) {
+        *op++ = *match++;
+      }
+    }
+  }
+
+  if (op != oend) {
+    corrupt("size mismatch");
+  }
+}
+
+void registerCodec(std::shared_ptr<Codec const> codec) {
+  checkpointAssert(codec != nullptr, "Codec must not be null");
+  checkpointAssert(codec->getID() != 0, "Codec id zero is reserved");
+
+  auto const id = codec->getID();
+  auto& registry = getRegistry();
+  std::lock_guard<std::mutex> lock(registry.mutex);
+  registry.codecs[id] = std::move(codec);
+}
+
+std::shared_ptr<Codec const> getCodec(uint8_t id) {
+  auto& registry = getRegistry();
+  std::lock_guard<std::mutex> lock(registry.mutex);
+  auto codec = registry.codecs[id];
+  if (codec == nullptr) {
+    throw std::runtime_error(
+      "No codec registered with id=" + std::to_string(static_cast<int>(id))
+    );
+  }
+  return codec;
+}
+
+std::shared_ptr<Codec const> getCodec(CompressionOptions const& options) {
+  if (options.codec == nullptr) {
+    return getCodec(LZCodec::id);
+  }
+
+  auto& registry = getRegistry();
+  std::lock_guard<std::mutex> lock(registry.mutex);
+  auto& slot = registry.codecs[options.codec->getID()];
+  if (slot == nullptr) {
+    slot = options.codec;
+  }
+  return options.codec;
+}
+
+}} /* end namespace checkpoint::buffer */
@@ -0,0 +1,195 @@
+/*
+//@HEADER
+// *****************************************************************************
+//
+//                                   codec.h
+//                 DARMA/magistrate => Serialization Library
+//
+// Copyright 2019 National Technology & Engineering Solutions of Sandia, LLC
+// (NTESS). Under the terms of Contract DE-NA0003525 with NTESS, the U.S.
+// Government retains certain rights in this software.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+//
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// * Neither the name of the copyright holder nor the names of its
+//   contributors may be used to endorse or promote products derived from this
+//   software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// Questions? Contact darma@sandia.gov
+//
+// *****************************************************************************
+//@HEADER
+*/
+
+#if !defined INCLUDED_SRC_CHECKPOINT_BUFFER_CODEC_H
+#define INCLUDED_SRC_CHECKPOINT_BUFFER_CODEC_H
+
+#include "checkpoint/common.h"
+
+#include <cstdint>
+#include <memory>
+#include <string>
+
+namespace checkpoint { namespace buffer {
+
+/**
+ * \struct Codec
+ *
+ * \brief A block compressor used for each frame of a compressed stream
+ *
+ * Every frame is compressed independently, so implementations must not keep
+ * state between calls; \c compress and \c decompress may be called on the same
+ * codec from several threads at once. The codec id is recorded in the stream
+ * header and used to look the codec up (see \c registerCodec) when reading.
+ */
+struct Codec {
+  virtual ~Codec() = default;
+
+  /**
+   * \brief Get the id stored in the stream header. Zero is reserved and ids
+   * below 128 are reserved for built-in codecs.
+   *
+   * \return the codec id
+   */
+  virtual uint8_t getID() const = 0;
+
+  /**
+   * \brief Get a human-readable name for the codec
+   *
+   * \return the name
+   */
+  virtual std::string getName() const = 0;
+
+  /**
+   * \brief Get the capacity \c compress needs to never run out of space
+   *
+   * \param[in] len the number of uncompressed bytes
+   *
+   * \return the worst-case compressed size
+   */
+  virtual SerialSizeType getMaxCompressedSize(SerialSizeType len) const = 0;
+
+  /**
+   * \brief Compress \c len bytes from \c src into \c dst
+   *
+   * \param[in] src the uncompressed bytes
+   * \param[in] len the number of uncompressed bytes
+   * \param[out] dst the output buffer
+   * \param[in] capacity the size of \c dst
+   *
+   * \return the number of bytes written to \c dst, or zero if the output
+   * would not fit in \c capacity (the frame is then stored uncompressed)
+   */
+  virtual SerialSizeType compress(
+    SerialByteType const* src, SerialSizeType len,
+    SerialByteType* dst, SerialSizeType capacity
+  ) const = 0;
+
+  /**
+   * \brief Decompress exactly \c raw_len bytes into \c dst. Throws
+   * \c std::runtime_error if \c src is corrupt.
+   *
+   * \param[in] src the compressed bytes
+   * \param[in] len the number of compressed bytes
+   * \param[out] dst the output buffer
+   * \param[in] raw_len the number of uncompressed bytes expected
+   */
+  virtual void decompress(
+    SerialByteType const* src, SerialSizeType len,
+    SerialByteType* dst, SerialSizeType raw_len
+  ) const = 0;
+};
+
+/**
+ * \struct LZCodec
+ *
+ * \brief Built-in byte-oriented LZ77 codec tuned for speed over ratio
+ *
+ * Matches are found with a single-probe hash table over 4-byte sequences
+ * within a 64 KiB window; runs of incompressible bytes are skipped with
+ * increasing strides.
+ */
+struct LZCodec final : Codec {
+  static constexpr uint8_t const id = 1;
+
+  uint8_t getID() const override { return id; }
+  std::string getName() const override { return "lz"; }
+  SerialSizeType getMaxCompressedSize(SerialSizeType len) const override;
+  SerialSizeType compress(
+    SerialByteType const* src, SerialSizeType len,
+    SerialByteType* dst, SerialSizeType capacity
+  ) const override;
+  void decompress(
+    SerialByteType const* src, SerialSizeType len,
+    SerialByteType* dst, SerialSizeType raw_len
+  ) const override;
+};
+
+/**
+ * \struct CompressionOptions
+ *
+ * \brief Options for producing a compressed stream
+ *
+ * The packed bytes are cut into frames of \c frame_size bytes that are
+ * compressed independently, so they can be decompressed in parallel or
+ * individually. Setting \c shuffle_width to the size of the dominant element
+ * type (e.g., 8 for \c double) groups the i-th byte of every element together
+ * before compressing, which usually helps for smooth numeric fields.
+ */
+struct CompressionOptions {
+  std::shared_ptr<Codec const> codec = nullptr; /**< \c nullptr: \c LZCodec */
+  SerialSizeType frame_size = 1ull << 20;       /**< Uncompressed frame size */
+  uint8_t shuffle_width = 0;                    /**< Byte shuffle; 0 or 1: off */
+  unsigned num_threads = 1;                     /**< Frames coded concurrently */
+};
+
+/**
+ * \brief Register a codec so streams written with it can be read back. A codec
+ * with the same id replaces the existing one.
+ *
+ * \param[in] codec the codec
+ */
+void registerCodec(std::shared_ptr<Codec const> codec);
+
+/**
+ * \brief Look up a registered codec by id. Throws \c std::runtime_error if no
+ * codec is registered with \c id.
+ *
+ * \param[in] id the codec id
+ *
+ * \return the codec
+ */
+std::shared_ptr<Codec const> getCodec(uint8_t id);
+
+/**
+ * \brief Get the codec selected by \c options, registering it if needed
+ *
+ * \param[in] options the compression options
+ *
+ * \return the codec
+ */
+std::shared_ptr<Codec const> getCodec(CompressionOptions const& options);
+
+}} /* end namespace checkpoint::buffer */
+
+#endif /*INCLUDED_SRC_CHECKPOINT_BUFFER_CODEC_H*/
@@ -0,0 +1,532 @@
+/*
+//@HEADER
+// *****************************************************************************
+//
+//                                delta_image.cc
+//                 DARMA/magistrate => Serialization Library
+//
+// Copyright 2019 National Technology & Engineering Solutions of Sandia, LLC
+// (NTESS). Under the terms of Contract DE-NA0003525 with NTESS, the U.S.
+// Government retains certain rights in this software.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+//
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// * Neither the name of the copyright holder nor the names of its
+//   contributors may be used to endorse or promote products derived from this
+//   software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// Questions? Contact darma@sandia.gov
+//
+// *****************************************************************************
+//@HEADER
+*/
+
+#include "checkpoint/common.h"
+#include "checkpoint/buffer/delta_image.h"
+#include "checkpoint/buffer/io_buffer.h"
+#include "checkpoint/buffer/parallel_for.h"
+#include "checkpoint/serializers/file_packer.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <climits>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace checkpoint { namespace buffer {
+
+namespace {
+
+constexpr uint64_t const prime1 = 0x9e3779b185ebca87ull;
+constexpr uint64_t const prime2 = 0xc2b2ae3d27d4eb4full;
+constexpr uint64_t const prime3 = 0x165667b19e3779f9ull;
+constexpr uint64_t const prime4 = 0x85ebca77c2b2ae63ull;
+constexpr uint64_t const prime5 = 0x27d4eb2f165667c5ull;
+
+/// Blocks hashed by each task handed to \c parallelFor
+constexpr SerialSizeType const blocks_per_task = 64;
+
+/// Deepest chain of base images followed when restoring
+constexpr unsigned const max_restore_depth = 1024;
+
+inline uint64_t rotl(uint64_t x, int r) { return (x << r) | (x >> (64 - r)); }
+
+inline uint64_t read64(SerialByteType const* p) {
+  uint64_t v;
+  std::memcpy(&v, p, sizeof(v));
+  return v;
+}
+
+inline uint32_t read32(SerialByteType const* p) {
+  uint32_t v;
+  std::memcpy(&v, p, sizeof(v));
+  return v;
+}
+
+inline uint64_t round(uint64_t acc, uint64_t input) {
+  acc += input * prime2;
+  acc = rotl(acc, 31);
+  return acc * prime1;
+}
+
+inline uint64_t mergeRound(uint64_t acc, uint64_t val) {
+  acc ^= round(0, val);
+  return acc * prime1 + prime4;
+}
+
+SerialSizeType numBlocks(SerialSizeType len, SerialSizeType block_size) {
+  return (len + block_size - 1) / block_size;
+}
+
+SerialSizeType blockLength(
+  SerialSizeType len, SerialSizeType block_size, SerialSizeType i
+) {
+  return std::min(block_size, len - i * block_size);
+}
+
+/// The directory part of \c file, including the trailing slash
+std::string directoryOf(std::string const& file) {
+  auto const slash = file.rfind('/');
+  return slash == std::string::npos ? "" : file.substr(0, slash + 1);
+}
+
+/// The name a delta written to \c file records for \c base: relative to the
+/// directory of \c file when they share it, absolute otherwise
+std::string baseNameFor(std::string const& base, std::string const& file) {
+  auto const dir = directoryOf(base);
+  if (dir == directoryOf(file)) {
+    return base.substr(dir.size());
+  }
+  if (base.size() > 0 and base[0] == '/') {
+    return base;
+  }
+  char cwd[PATH_MAX];
+  if (getcwd(cwd, sizeof(cwd)) == nullptr) {
+    auto err = std::string("getcwd failed: errno=") + std::to_string(errno) +
+               ": " + strerror(errno);
+    throw std::runtime_error(err);
+  }
+  return std::string(cwd) + "/" + base;
+}
+
+/// Resolve a base name recorded in \c delta_file to a path
+std::string resolveBase(
+  std::string const& base, std::string const& delta_file
+) {
+  return base[0] == '/' ? base : directoryOf(delta_file) + base;
+}
+
+/// Whether \c a and \c b name the same file (by inode when both exist)
+bool sameFile(std::string const& a, std::string const& b) {
+  struct stat sa, sb;
+  if (stat(a.c_str(), &sa) == 0 and stat(b.c_str(), &sb) == 0) {
+    return sa.st_dev == sb.st_dev and sa.st_ino == sb.st_ino;
+  }
+  return a == b;
+}
+
+/**
+ * Read just the header of \c file, and the base name of a delta, without
+ * mapping or verifying it
+ */
+void readDeltaHeader(
+  std::string const& file, DeltaHeader& h, std::string& base
+) {
+  std::ifstream in(file, std::ios::binary);
+  if (not in) {
+    throw std::runtime_error("Failed to open delta image file=" + file);
+  }
+  in.read(reinterpret_cast<char*>(&h), sizeof(h));
+  if (static_cast<SerialSizeType>(in.gcount()) != sizeof(h) or
+      h.magic != delta_magic or h.version != delta_version) {
+    throw std::runtime_error(
+      "Not an incremental checkpoint image file=" + file
+    );
+  }
+  if (h.kind == DeltaImageKind::Full) {
+    if (h.base_name_size != 0) {
+      throw std::runtime_error(
+        "Corrupt full image file=" + file + ": has a base name"
+      );
+    }
+    return;
+  }
+  if (h.kind != DeltaImageKind::Delta) {
+    throw std::runtime_error(
+      "Corrupt delta image file=" + file + ": bad image kind"
+    );
+  }
+  if (h.base_name_size == 0 or h.base_name_size > PATH_MAX) {
+    throw std::runtime_error(
+      "Corrupt delta image file=" + file + ": bad base name"
+    );
+  }
+  base.resize(h.base_name_size);
+  in.read(&base[0], h.base_name_size);
+  if (static_cast<SerialSizeType>(in.gcount()) != h.base_name_size) {
+    throw std::runtime_error(
+      "Corrupt delta image file=" + file + ": truncated base name"
+    );
+  }
+}
+
+/**
+ * Overwrite the image in \c out with the blocks stored in the delta image
+ * \c bytes. Bytes at or past \c out_size are dropped; the final image never
+ * needs them. Returns the size of the image the delta describes.
+ */
+SerialSizeType applyDelta(
+  std::string const& file, SerialByteType const* bytes, SerialSizeType len,
+  SerialByteType* out, SerialSizeType out_size, SerialSizeType covered
+) {
+  auto const corrupt = [&file](char const* what) {
+    return std::runtime_error(
+      std::string("Corrupt delta image file=") + file + ": " + what
+    );
+  };
+
+  if (len < sizeof(DeltaHeader)) {
+    throw corrupt("truncated header");
+  }
+  DeltaHeader h;
+  std::memcpy(&h, bytes, sizeof(h));
+
+  if (h.kind != DeltaImageKind::Delta) {
+    throw corrupt("not a delta");
+  }
+  if (h.block_size == 0) {
+    throw corrupt("zero block size");
+  }
+
+  auto const num_blocks = numBlocks(h.image_size, h.block_size);
+  SerialSizeType offset = sizeof(DeltaHeader);
+
+  if (h.base_name_size > len - offset) {
+    throw corrupt("truncated base name");
+  }
+  offset += h.base_name_size;
+
+  if (h.num_stored > num_blocks or
+      h.num_stored * sizeof(uint64_t) > len - offset) {
+    throw corrupt("truncated block index");
+  }
+  std::vector<uint64_t> stored(h.num_stored);
+  std::memcpy(stored.data(), bytes + offset, h.num_stored * sizeof(uint64_t));
+  offset += h.num_stored * sizeof(uint64_t);
+
+  std::vector<bool> is_stored(num_blocks, false);
+  SerialSizeType next = 0;
+  for (auto const i : stored) {
+    if (i < next or i >= num_blocks) {
+      throw corrupt("block index out of order or range");
+    }
+    auto const n = blockLength(h.image_size, h.block_size, i);
+    if (n > len - offset) {
+      throw corrupt("truncated block data");
+    }
+    auto const pos = i * h.block_size;
+    if (pos < out_size) {
+      std::memcpy(out + pos, bytes + offset, std::min(n, out_size - pos));
+    }
+    offset += n;
+    is_stored[i] = true;
+    next = i + 1;
+  }
+
+  // Blocks not stored here must be unchanged from the base
+  for (SerialSizeType i = 0; i < num_blocks; i++) {
+    auto const end =
+      i * h.block_size + blockLength(h.image_size, h.block_size, i);
+    if (not is_stored[i] and end > covered) {
+      throw corrupt("base image does not cover an unchanged block");
+    }
+  }
+
+  return h.image_size;
+}
+
+} /* end anon namespace */
+
+uint64_t hashBlock(void const* data, SerialSizeType len, uint64_t seed) {
+  auto p = static_cast<SerialByteType const*>(data);
+  auto const end = p + len;
+  uint64_t h = 0;
+
+  if (len >= 32) {
+    // Four independent lanes keep several multiplies in flight at once
+    uint64_t v1 = seed + prime1 + prime2;
+    uint64_t v2 = seed + prime2;
+    uint64_t v3 = seed;
+    uint64_t v4 = seed - prime1;
+    auto const limit = end - 32;
+    do {
+      v1 = round(v1, read64(p));
+      v2 = round(v2, read64(p + 8));
+      v3 = round(v3, read64(p + 16));
+      v4 = round(v4, read64(p + 24));
+      p += 32;
+    } while (p <= limit);
+
+    h = rotl(v1, 1) + rotl(v2, 7) + rotl(v3, 12) + rotl(v4, 18);
+    h = mergeRound(h, v1);
+    h = mergeRound(h, v2);
+    h = mergeRound(h, v3);
+    h = mergeRound(h, v4);
+  } else {
+    h = seed + prime5;
+  }
+
+  h += static_cast<uint64_t>(len);
+
+  while (p + 8 <= end) {
+    h ^= round(0, read64(p));
+    h = rotl(h, 27) * prime1 + prime4;
+    p += 8;
+  }
+  if (p + 4 <= end) {
+    h ^= static_cast<uint64_t>(read32(p)) * prime1;
+    h = rotl(h, 23) * prime2 + prime3;
+    p += 4;
+  }
+  while (p < end) {
+    h ^= static_cast<uint64_t>(*p) * prime5;
+    h = rotl(h, 11) * prime1;
+    p++;
+  }
+
+  h ^= h >> 33;
+  h *= prime2;
+  h ^= h >> 29;
+  h *= prime3;
+  h ^= h >> 32;
+  return h;
+}
+
+std::vector<uint64_t> hashBlocks(
+  SerialByteType const* bytes, SerialSizeType len, SerialSizeType block_size,
+  unsigned num_threads
+) {
+  auto const n = numBlocks(len, block_size);
+  std::vector<uint64_t> hashes(n);
+  auto const num_tasks = (n + blocks_per_task - 1) / blocks_per_task;
+
+  parallelFor(num_tasks, num_threads, [&](SerialSizeType t) {
+    auto const last = std::min(n, (t + 1) * blocks_per_task);
+    for (auto i = t * blocks_per_task; i < last; i++) {
+      hashes[i] = hashBlock(
+        bytes + i * block_size, blockLength(len, block_size, i)
+      );
+    }
+  });
+
+  return hashes;
+}
+
+DeltaImageWriter::DeltaImageWriter(DeltaOptions const& options)
+  : options_(options)
+{
+  if (options_.block_size == 0) {
+    throw std::runtime_error("Delta block size must be non-zero");
+  }
+}
+
+void DeltaImageWriter::reset() {
+  hashes_.clear();
+  image_size_ = 0;
+  chain_.clear();
+}
+
+std::string DeltaImageWriter::getLastFile() const {
+  return chain_.empty() ? std::string{} : chain_.back();
+}
+
+DeltaWriteStats DeltaImageWriter::write(
+  SerialByteType const* bytes, SerialSizeType len, std::string const& file
+) {
+  auto const block_size = options_.block_size;
+  auto hashes = hashBlocks(bytes, len, block_size, options_.num_threads);
+
+  DeltaWriteStats stats;
+  stats.image_size = len;
+  stats.num_blocks = hashes.size();
+
+  /*
+   * A delta cannot overwrite any file of its own chain: the chain would then
+   * be cyclic (or reference a truncated file), so start a new one instead
+   */
+  bool full = chain_.empty() or chain_.size() > options_.max_chain;
+  for (auto const& f : chain_) {
+    full = full or sameFile(f, file);
+  }
+
+  if (full) {
+    DeltaHeader h;
+    h.kind = DeltaImageKind::Full;
+    h.image_size = len;
+    h.block_size = block_size;
+
+    auto const total = sizeof(h) + len;
+
+    FilePacker packer(total, file, options_.file);
+    packer.contiguousBytes(&h, sizeof(h), 1);
+    packer.contiguousBytes(const_cast<SerialByteType*>(bytes), 1, len);
+    packer.closeFile();
+
+    stats.full = true;
+    stats.changed_blocks = stats.num_blocks;
+    stats.bytes_written = total;
+    chain_.clear();
+  } else {
+    auto const prev_blocks = hashes_.size();
+    std::vector<uint64_t> changed;
+    for (SerialSizeType i = 0; i < hashes.size(); i++) {
+      bool const same =
+        i < prev_blocks and
+        blockLength(len, block_size, i) ==
+          blockLength(image_size_, block_size, i) and
+        hashes[i] == hashes_[i];
+      if (not same) {
+        changed.push_back(i);
+      }
+    }
+
+    auto const base = baseNameFor(chain_.back(), file);
+
+    DeltaHeader h;
+    h.image_size = len;
+    h.block_size = block_size;
+    h.num_stored = changed.size();
+    h.base_name_size = base.size();
+
+    SerialSizeType data_size = 0;
+    for (auto const i : changed) {
+      data_size += blockLength(len, block_size, i);
+    }
+    auto const total = sizeof(h) + base.size() +
+                       changed.size() * sizeof(uint64_t) + data_size;
+
+    FilePacker packer(total, file, options_.file);
+    packer.contiguousBytes(&h, sizeof(h), 1);
+    packer.contiguousBytes(
+      const_cast<char*>(base.data()), 1, base.size()
+    );
+    packer.contiguousBytes(changed.data(), sizeof(uint64_t), changed.size());
+    for (auto const i : changed) {
+      packer.contiguousBytes(
+        const_cast<SerialByteType*>(bytes + i * block_size), 1,
+        blockLength(len, block_size, i)
+      );
+    }
+    packer.closeFile();
+
+    stats.changed_blocks = changed.size();
+    stats.bytes_written = total;
+  }
+
+  hashes_ = std::move(hashes);
+  image_size_ = len;
+  chain_.push_back(file);
+  return stats;
+}
+
+std::unique_ptr<ManagedBuffer> readDeltaImage(
+  std::string const& file, FileReadOptions const& options
+) {
+  /*
+   * Resolve the chain from the header of each file first, so the image is
+   * rebuilt in one buffer from the base forward and only one file is open at
+   * a time
+   */
+  std::vector<std::string> chain = {file};
+  SerialSizeType image_size = 0;
+  for (;;) {
+    DeltaHeader h;
+    std::string base;
+    readDeltaHeader(chain.back(), h, base);
+    if (chain.size() == 1) {
+      image_size = h.image_size;
+    }
+    if (h.kind == DeltaImageKind::Full) {
+      break;
+    }
+    auto next = resolveBase(base, chain.back());
+    for (auto const& f : chain) {
+      if (sameFile(f, next)) {
+        throw std::runtime_error(
+          "Delta image chain is cyclic at file=" + chain.back()
+        );
+      }
+    }
+    if (chain.size() > max_restore_depth) {
+      throw std::runtime_error("Delta image chain is too deep at file=" + file);
+    }
+    chain.push_back(std::move(next));
+  }
+
+  std::unique_ptr<ManagedBuffer> image = nullptr;
+  SerialSizeType covered = 0; /**< Size of the image rebuilt so far */
+
+  for (auto it = chain.rbegin(); it != chain.rend(); ++it) {
+    IOBuffer in(IOBuffer::ReadFromFileTag{}, *it, options);
+    auto const bytes = in.getBuffer();
+    auto const len = in.getSize();
+    in.advanceCursor(len);
+
+    if (it == chain.rbegin()) {
+      DeltaHeader h;
+      if (len >= sizeof(h)) {
+        std::memcpy(&h, bytes, sizeof(h));
+      }
+      if (len < sizeof(h) or h.kind != DeltaImageKind::Full or
+          h.image_size != len - sizeof(h)) {
+        throw std::runtime_error(
+          "Corrupt full image file=" + *it + ": inconsistent header"
+        );
+      }
+      image = std::make_unique<ManagedBuffer>(image_size);
+      covered = h.image_size;
+      std::memcpy(
+        image->getBuffer(), bytes + sizeof(h), std::min(covered, image_size)
+      );
+    } else {
+      covered = applyDelta(
+        *it, bytes, len, image->getBuffer(), image_size, covered
+      );
+    }
+  }
+
+  if (covered != image_size) {
+    throw std::runtime_error(
+      "Corrupt delta image file=" + file + ": inconsistent image size"
+    );
+  }
+
+  return image;
+}
+
+}} /* end namespace checkpoint::buffer */
@@ -0,0 +1,236 @@
+/*
+//@HEADER
+// *****************************************************************************
+//
+//                                delta_image.h
+//                 DARMA/magistrate => Serialization Library
+//
+// Copyright 2019 National Technology & Engineering Solutions of Sandia, LLC
+// (NTESS). Under the terms of Contract DE-NA0003525 with NTESS, the U.S.
+// Government retains certain rights in this software.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+//
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// * Neither the name of the copyright holder nor the names of its
+//   contributors may be used to endorse or promote products derived from this
+//   software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// Questions? Contact darma@sandia.gov
+//
+// *****************************************************************************
+//@HEADER
+*/
+
+#if !defined INCLUDED_SRC_CHECKPOINT_BUFFER_DELTA_IMAGE_H
+#define INCLUDED_SRC_CHECKPOINT_BUFFER_DELTA_IMAGE_H
+
+#include "checkpoint/common.h"
+#include "checkpoint/buffer/io_options.h"
+#include "checkpoint/buffer/managed_buffer.h"
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace checkpoint { namespace buffer {
+
+/*
+ * Every file written by \c DeltaImageWriter starts with a \c DeltaHeader
+ * whose kind says whether it holds a full image or a delta, so a reader never
+ * has to guess the kind from the image bytes, which may start with anything.
+ *
+ * A full image is laid out as:
+ *
+ *   DeltaHeader
+ *   the packed bytes of the image
+ *
+ * A delta image is laid out as:
+ *
+ *   DeltaHeader
+ *   name of the base image (base_name_size bytes)
+ *   uint64_t index of each stored block, ascending
+ *   the bytes of each stored block
+ *
+ * Every block except the last holds \c block_size bytes of the full image.
+ * The base is either another delta image or a full image, so the full image is
+ * rebuilt by starting from the full image at the end of the chain and
+ * overwriting the blocks stored in each delta after it.
+ */
+
+/// "MGD1" read as a little-endian integer
+static constexpr uint32_t const delta_magic = 0x3144474d;
+
+static constexpr uint32_t const delta_version = 2;
+
+/**
+ * \enum DeltaImageKind
+ *
+ * \brief What follows the header of an incremental checkpoint file
+ */
+enum struct DeltaImageKind : uint32_t {
+  Full = 0, /**< The packed image */
+  Delta = 1 /**< The blocks that changed since the base image */
+};
+
+struct DeltaHeader {
+  uint32_t magic = delta_magic;
+  uint32_t version = delta_version;
+  DeltaImageKind kind = DeltaImageKind::Delta;
+  uint32_t reserved = 0;
+  uint64_t image_size = 0;     /**< Bytes in the full image */
+  uint64_t block_size = 0;
+  uint64_t num_stored = 0;     /**< Blocks stored in this file */
+  uint64_t base_name_size = 0; /**< Zero for a full image */
+};
+
+/**
+ * \struct DeltaOptions
+ *
+ * \brief Options for writing incremental checkpoints
+ *
+ * After \c max_chain deltas have been written on top of a full image, the next
+ * checkpoint is a full image again; this bounds how many files a restore has
+ * to read.
+ */
+struct DeltaOptions {
+  SerialSizeType block_size = 64ull << 10; /**< Bytes compared per hash */
+  unsigned max_chain = 8;                  /**< Deltas before a full image */
+  unsigned num_threads = 1;                /**< Threads hashing blocks */
+  FileWriteOptions file = {};              /**< Durability and checksums */
+};
+
+/**
+ * \struct DeltaWriteStats
+ *
+ * \brief What an incremental checkpoint wrote
+ */
+struct DeltaWriteStats {
+  bool full = false;                 /**< A full image was written */
+  SerialSizeType image_size = 0;     /**< Bytes in the packed image */
+  SerialSizeType num_blocks = 0;     /**< Blocks in the packed image */
+  SerialSizeType changed_blocks = 0; /**< Blocks written to the file */
+  SerialSizeType bytes_written = 0;  /**< Bytes written to the file */
+};
+
+/**
+ * \brief Hash \c len bytes with a 64-bit non-cryptographic hash (XXH64)
+ *
+ * \param[in] data the bytes
+ * \param[in] len the number of bytes
+ * \param[in] seed the seed
+ *
+ * \return the hash
+ */
+uint64_t hashBlock(void const* data, SerialSizeType len, uint64_t seed = 0);
+
+/**
+ * \brief Hash each \c block_size block of \c bytes
+ *
+ * \param[in] bytes the image
+ * \param[in] len the image size
+ * \param[in] block_size the bytes covered by each hash
+ * \param[in] num_threads the number of threads to use
+ *
+ * \return one hash per block
+ */
+std::vector<uint64_t> hashBlocks(
+  SerialByteType const* bytes, SerialSizeType len, SerialSizeType block_size,
+  unsigned num_threads = 1
+);
+
+/**
+ * \struct DeltaImageWriter
+ *
+ * \brief Writes a sequence of packed images, storing only the blocks that
+ * changed since the previous image
+ *
+ * The block hashes of the last image written are kept in memory, so writing a
+ * delta reads nothing back from disk. Each delta names the file written before
+ * it as its base, relative to its own directory when both are in the same
+ * one. Writing to a file that is already part of the current chain starts a
+ * new chain with a full image, so names may be rotated.
+ */
+struct DeltaImageWriter {
+  explicit DeltaImageWriter(DeltaOptions const& options = DeltaOptions{});
+
+  /**
+   * \brief Write \c bytes to \c file, as a delta against the previously
+   * written file when possible
+   *
+   * \param[in] bytes the packed image
+   * \param[in] len the image size
+   * \param[in] file the file to write
+   *
+   * \return what was written
+   */
+  DeltaWriteStats write(
+    SerialByteType const* bytes, SerialSizeType len, std::string const& file
+  );
+
+  /**
+   * \brief Forget the previous image so the next write is a full image
+   */
+  void reset();
+
+  /**
+   * \brief Get the last file written
+   *
+   * \return the file name, or empty if nothing has been written since the
+   * last reset
+   */
+  std::string getLastFile() const;
+
+  /**
+   * \brief Get the options
+   *
+   * \return the options
+   */
+  DeltaOptions const& getOptions() const { return options_; }
+
+private:
+  DeltaOptions options_ = {};
+  std::vector<uint64_t> hashes_;    /**< Block hashes of the last image */
+  SerialSizeType image_size_ = 0;   /**< Size of the last image */
+  std::vector<std::string> chain_; /**< Files since the last full image */
+};
+
+/**
+ * \brief Rebuild the full image stored in \c file, reading its chain of base
+ * images one at a time from the full image forward into a single buffer.
+ * Checksum trailers are verified according to \c options; a file without a
+ * header, or a chain that is broken or inconsistent, throws
+ * \c std::runtime_error.
+ *
+ * \param[in] file a full or delta image written by \c DeltaImageWriter
+ * \param[in] options how each file is read
+ *
+ * \return the full image
+ */
+std::unique_ptr<ManagedBuffer> readDeltaImage(
+  std::string const& file, FileReadOptions const& options = FileReadOptions{}
+);
+
+}} /* end namespace checkpoint::buffer */
+
+#endif /*INCLUDED_SRC_CHECKPOINT_BUFFER_DELTA_IMAGE_H*/
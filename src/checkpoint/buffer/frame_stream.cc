@@ -0,0 +1,465 @@
+/*
+//@HEADER
+// *****************************************************************************
+//
+//                               frame_stream.cc
+//                 DARMA/magistrate => Serialization Library
+//
+// Copyright 2019 National Technology & Engineering Solutions of Sandia, LLC
+// (NTESS). Under the terms of Contract DE-NA0003525 with NTESS, the U.S.
+// Government retains certain rights in this software.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+//
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// * Neither the name of the copyright holder nor the names of its
+//   contributors may be used to endorse or promote products derived from this
+//   software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// Questions? Contact darma@sandia.gov
+//
+// *****************************************************************************
+//@HEADER
+*/
+
+#include "checkpoint/common.h"
+#include "checkpoint/buffer/frame_stream.h"
+#include "checkpoint/buffer/parallel_for.h"
+
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+
+namespace checkpoint { namespace buffer {
+
+namespace {
+
+[[noreturn]] void invalidStream(std::string const& what) {
+  throw std::runtime_error("Invalid compressed stream: " + what);
+}
+
+inline SerialSizeType numFrames(SerialSizeType raw_size, SerialSizeType frame_size) {
+  return (raw_size + frame_size - 1) / frame_size;
+}
+
+/// Group byte \c b of every \c width byte element together
+void shuffleBytes(
+  SerialByteType const* src, SerialByteType* dst, SerialSizeType len,
+  SerialSizeType width
+) {
+  auto const n = len / width;
+  for (SerialSizeType b = 0; b < width; b++) {
+    for (SerialSizeType i = 0; i < n; i++) {
+      dst[b * n + i] = src[i * width + b];
+    }
+  }
+  std::memcpy(dst + n * width, src + n * width, len - n * width);
+}
+
+void unshuffleBytes(
+  SerialByteType const* src, SerialByteType* dst, SerialSizeType len,
+  SerialSizeType width
+) {
+  auto const n = len / width;
+  for (SerialSizeType b = 0; b < width; b++) {
+    for (SerialSizeType i = 0; i < n; i++) {
+      dst[i * width + b] = src[b * n + i];
+    }
+  }
+  std::memcpy(dst + n * width, src + n * width, len - n * width);
+}
+
+FrameStreamHeader readStreamHeader(SerialByteType const* bytes) {
+  FrameStreamHeader header;
+  std::memcpy(&header, bytes, sizeof(header));
+
+  if (header.magic != frame_stream_magic) {
+    invalidStream("bad magic");
+  }
+  if (header.version != frame_stream_version) {
+    invalidStream("unsupported version=" + std::to_string(header.version));
+  }
+  if (header.frame_size == 0 or header.frame_size > max_frame_size) {
+    invalidStream("bad frame size=" + std::to_string(header.frame_size));
+  }
+  return header;
+}
+
+/**
+ * Check a frame header against the stream header: every frame except the last
+ * is full, so the uncompressed size of each frame is known in advance
+ */
+void checkFrameHeader(
+  Codec const& codec, FrameStreamHeader const& stream,
+  FrameHeader const& frame, SerialSizeType index
+) {
+  auto const expected = std::min<SerialSizeType>(
+    stream.frame_size, stream.raw_size - index * stream.frame_size
+  );
+  if (frame.raw_size != expected) {
+    invalidStream("frame " + std::to_string(index) + " has the wrong size");
+  }
+  if ((frame.flags & frame_flag_stored) and frame.stored_size != frame.raw_size) {
+    invalidStream("stored frame " + std::to_string(index) + " size mismatch");
+  }
+  if (frame.stored_size > codec.getMaxCompressedSize(frame.raw_size)) {
+    invalidStream("frame " + std::to_string(index) + " is too large");
+  }
+}
+
+/// Decompress one frame into \c dst, using \c scratch to undo the shuffle
+void decodeFrame(
+  Codec const& codec, FrameStreamHeader const& stream,
+  FrameHeader const& frame, SerialByteType const* payload,
+  SerialByteType* dst, SerialByteType* scratch
+) {
+  if (frame.flags & frame_flag_stored) {
+    std::memcpy(dst, payload, frame.raw_size);
+  } else if (stream.shuffle_width > 1) {
+    codec.decompress(payload, frame.stored_size, scratch, frame.raw_size);
+    unshuffleBytes(scratch, dst, frame.raw_size, stream.shuffle_width);
+  } else {
+    codec.decompress(payload, frame.stored_size, dst, frame.raw_size);
+  }
+}
+
+} /* end anonymous namespace */
+
+void GrowableFrameSink::write(SerialByteType const* bytes, SerialSizeType len) {
+  auto const size = buffer_->getSize();
+  buffer_->reserve(size + len);
+  std::memcpy(buffer_->getBuffer() + size, bytes, len);
+  buffer_->setSize(size + len);
+}
+
+SerialByteType const* MemoryFrameSource::read(SerialSizeType len) {
+  if (len > size_ - offset_) {
+    invalidStream("unexpected end of data");
+  }
+  auto const bytes = buffer_ + offset_;
+  offset_ += len;
+  return bytes;
+}
+
+FrameEncoder::FrameEncoder(
+  FrameSink& sink, SerialSizeType raw_size, CompressionOptions const& options
+) : sink_(&sink),
+    codec_(getCodec(options)),
+    num_threads_(std::max(options.num_threads, 1u))
+{
+  if (options.frame_size == 0 or options.frame_size > max_frame_size) {
+    throw std::runtime_error(
+      "Compression frame size must be in (0, 2^31]: frame_size=" +
+      std::to_string(options.frame_size)
+    );
+  }
+
+  header_.codec_id = codec_->getID();
+  header_.shuffle_width = options.shuffle_width;
+  header_.frame_size = options.frame_size;
+  header_.raw_size = raw_size;
+
+  // Never allocate more frames, or larger frames, than the stream needs
+  auto const frame_len = std::min<SerialSizeType>(
+    options.frame_size, std::max<SerialSizeType>(raw_size, 1)
+  );
+  auto const slots = std::min<SerialSizeType>(
+    num_threads_, std::max<SerialSizeType>(numFrames(raw_size, frame_len), 1)
+  );
+  num_threads_ = static_cast<unsigned>(slots);
+  max_stored_ = codec_->getMaxCompressedSize(frame_len);
+
+  staging_ = allocateBytes(slots * frame_len);
+  frames_.resize(slots);
+  for (SerialSizeType i = 0; i < slots; i++) {
+    out_.push_back(allocateBytes(max_stored_));
+    if (header_.shuffle_width > 1) {
+      scratch_.push_back(allocateBytes(frame_len));
+    }
+  }
+  offsets_.reserve(numFrames(raw_size, options.frame_size));
+
+  sink_->write(reinterpret_cast<SerialByteType const*>(&header_), sizeof(header_));
+  written_ += sizeof(header_);
+}
+
+void FrameEncoder::write(SerialByteType const* bytes, SerialSizeType len) {
+  auto const capacity = std::min<SerialSizeType>(
+    num_threads_ * header_.frame_size, std::max<SerialSizeType>(header_.raw_size, 1)
+  );
+
+  raw_bytes_ += len;
+  while (len > 0) {
+    auto const n = std::min(len, capacity - staged_);
+    std::memcpy(staging_.get() + staged_, bytes, n);
+    staged_ += n;
+    bytes += n;
+    len -= n;
+    if (staged_ == capacity) {
+      encodeStaged();
+    }
+  }
+}
+
+void FrameEncoder::encodeStaged() {
+  auto const frame_size = header_.frame_size;
+  auto const num = numFrames(staged_, frame_size);
+
+  parallelFor(num, num_threads_, [&](SerialSizeType i) {
+    auto const raw = staging_.get() + i * frame_size;
+    auto const raw_len = std::min<SerialSizeType>(frame_size, staged_ - i * frame_size);
+
+    auto src = raw;
+    if (header_.shuffle_width > 1) {
+      shuffleBytes(raw, scratch_[i].get(), raw_len, header_.shuffle_width);
+      src = scratch_[i].get();
+    }
+
+    auto const stored = codec_->compress(src, raw_len, out_[i].get(), max_stored_);
+
+    auto& frame = frames_[i];
+    frame.raw_size = static_cast<uint32_t>(raw_len);
+    if (stored == 0 or stored >= raw_len) {
+      frame.flags = frame_flag_stored;
+      frame.stored_size = static_cast<uint32_t>(raw_len);
+    } else {
+      frame.flags = 0;
+      frame.stored_size = static_cast<uint32_t>(stored);
+    }
+  });
+
+  for (SerialSizeType i = 0; i < num; i++) {
+    auto const& frame = frames_[i];
+    auto const payload = (frame.flags & frame_flag_stored) ?
+      staging_.get() + i * frame_size : out_[i].get();
+
+    offsets_.push_back(written_);
+    sink_->write(reinterpret_cast<SerialByteType const*>(&frame), sizeof(frame));
+    sink_->write(payload, frame.stored_size);
+    written_ += sizeof(frame) + frame.stored_size;
+  }
+
+  staged_ = 0;
+}
+
+void FrameEncoder::finish() {
+  if (staged_ > 0) {
+    encodeStaged();
+  }
+
+  if (raw_bytes_ != header_.raw_size) {
+    throw std::runtime_error(
+      "Compressed stream size mismatch: expected=" +
+      std::to_string(header_.raw_size) + ", written=" + std::to_string(raw_bytes_)
+    );
+  }
+
+  FrameStreamTrailer trailer;
+  trailer.num_frames = offsets_.size();
+  sink_->write(
+    reinterpret_cast<SerialByteType const*>(offsets_.data()),
+    offsets_.size() * sizeof(uint64_t)
+  );
+  sink_->write(reinterpret_cast<SerialByteType const*>(&trailer), sizeof(trailer));
+  written_ += offsets_.size() * sizeof(uint64_t) + sizeof(trailer);
+}
+
+FrameDecoder::FrameDecoder(FrameSource& source, unsigned num_threads)
+  : source_(&source),
+    num_threads_(std::max(num_threads, 1u))
+{
+  header_ = readStreamHeader(source_->read(sizeof(FrameStreamHeader)));
+  codec_ = getCodec(header_.codec_id);
+  frames_left_ = numFrames(header_.raw_size, header_.frame_size);
+
+  auto const frame_len = std::min<SerialSizeType>(
+    header_.frame_size, std::max<SerialSizeType>(header_.raw_size, 1)
+  );
+  auto const slots = std::min<SerialSizeType>(
+    num_threads_, std::max<SerialSizeType>(frames_left_, 1)
+  );
+  num_threads_ = static_cast<unsigned>(slots);
+
+  decoded_ = allocateBytes(slots * frame_len);
+  if (header_.shuffle_width > 1) {
+    scratch_ = allocateBytes(slots * frame_len);
+  }
+  if (not source_->isStable()) {
+    copies_.resize(slots);
+  }
+
+  if (frames_left_ == 0) {
+    decodeBatch();
+  }
+}
+
+void FrameDecoder::read(SerialByteType* dst, SerialSizeType len) {
+  while (len > 0) {
+    if (decoded_pos_ == decoded_len_) {
+      if (frames_left_ == 0) {
+        throw std::runtime_error("Read past the end of the compressed stream");
+      }
+
+      // Decode a frame that is wanted in full straight into the destination
+      auto const total = numFrames(header_.raw_size, header_.frame_size);
+      auto const index = total - frames_left_;
+      auto const next_len = std::min<SerialSizeType>(
+        header_.frame_size, header_.raw_size - index * header_.frame_size
+      );
+      if (num_threads_ == 1 and next_len <= len) {
+        FrameHeader frame;
+        std::memcpy(&frame, source_->read(sizeof(frame)), sizeof(frame));
+        checkFrameHeader(*codec_, header_, frame, index);
+        auto const payload = source_->read(frame.stored_size);
+        decodeFrame(*codec_, header_, frame, payload, dst, scratch_.get());
+        dst += frame.raw_size;
+        len -= frame.raw_size;
+        if (--frames_left_ == 0) {
+          decodeBatch();
+        }
+        continue;
+      }
+
+      decodeBatch();
+    }
+
+    auto const n = std::min(len, decoded_len_ - decoded_pos_);
+    std::memcpy(dst, decoded_.get() + decoded_pos_, n);
+    decoded_pos_ += n;
+    dst += n;
+    len -= n;
+  }
+}
+
+void FrameDecoder::decodeBatch() {
+  auto const total = numFrames(header_.raw_size, header_.frame_size);
+  auto const first = total - frames_left_;
+  auto const num = std::min<SerialSizeType>(num_threads_, frames_left_);
+
+  std::vector<FrameHeader> frames(num);
+  std::vector<SerialByteType const*> payloads(num);
+  for (SerialSizeType i = 0; i < num; i++) {
+    std::memcpy(&frames[i], source_->read(sizeof(FrameHeader)), sizeof(FrameHeader));
+    checkFrameHeader(*codec_, header_, frames[i], first + i);
+    payloads[i] = source_->read(frames[i].stored_size);
+    if (not source_->isStable()) {
+      copies_[i].assign(payloads[i], payloads[i] + frames[i].stored_size);
+      payloads[i] = copies_[i].data();
+    }
+  }
+
+  auto const frame_size = header_.frame_size;
+  parallelFor(num, num_threads_, [&](SerialSizeType i) {
+    decodeFrame(
+      *codec_, header_, frames[i], payloads[i],
+      decoded_.get() + i * frame_size,
+      scratch_ == nullptr ? nullptr : scratch_.get() + i * frame_size
+    );
+  });
+
+  decoded_len_ = 0;
+  for (auto const& frame : frames) {
+    decoded_len_ += frame.raw_size;
+  }
+  decoded_pos_ = 0;
+  frames_left_ -= num;
+
+  // Consume the index and trailer so a stream is left after this object
+  if (frames_left_ == 0) {
+    source_->read(total * sizeof(uint64_t));
+    FrameStreamTrailer trailer;
+    std::memcpy(&trailer, source_->read(sizeof(trailer)), sizeof(trailer));
+    if (trailer.magic != frame_stream_magic or trailer.num_frames != total) {
+      invalidStream("bad trailer");
+    }
+  }
+}
+
+FrameStreamView::FrameStreamView(SerialByteType const* buffer, SerialSizeType size)
+  : buffer_(buffer), size_(size)
+{
+  if (size_ < sizeof(FrameStreamHeader) + sizeof(FrameStreamTrailer)) {
+    invalidStream("too small");
+  }
+
+  header_ = readStreamHeader(buffer_);
+  codec_ = getCodec(header_.codec_id);
+
+  FrameStreamTrailer trailer;
+  std::memcpy(&trailer, buffer_ + size_ - sizeof(trailer), sizeof(trailer));
+  auto const num = numFrames(header_.raw_size, header_.frame_size);
+  if (trailer.magic != frame_stream_magic or trailer.num_frames != num) {
+    invalidStream("bad trailer");
+  }
+
+  auto const index_len = num * sizeof(uint64_t);
+  if (index_len > size_ - sizeof(FrameStreamHeader) - sizeof(trailer)) {
+    invalidStream("index out of bounds");
+  }
+  offsets_.resize(num);
+  std::memcpy(
+    offsets_.data(), buffer_ + size_ - sizeof(trailer) - index_len, index_len
+  );
+}
+
+SerialSizeType FrameStreamView::decompressFrame(
+  SerialSizeType frame, SerialByteType* dst
+) const {
+  checkpointAssert(frame < offsets_.size(), "Frame index out of range");
+
+  auto const offset = offsets_[frame];
+  if (offset > size_ or size_ - offset < sizeof(FrameHeader)) {
+    invalidStream("frame offset out of bounds");
+  }
+
+  FrameHeader header;
+  std::memcpy(&header, buffer_ + offset, sizeof(header));
+  checkFrameHeader(*codec_, header_, header, frame);
+  if (header.stored_size > size_ - offset - sizeof(header)) {
+    invalidStream("frame payload out of bounds");
+  }
+
+  OwnedBytesType scratch = nullptr;
+  if (header_.shuffle_width > 1) {
+    scratch = allocateBytes(header.raw_size);
+  }
+  decodeFrame(
+    *codec_, header_, header, buffer_ + offset + sizeof(header), dst,
+    scratch.get()
+  );
+  return header.raw_size;
+}
+
+std::unique_ptr<ManagedBuffer> FrameStreamView::decompressAll(
+  unsigned num_threads
+) const {
+  auto out = std::make_unique<ManagedBuffer>(header_.raw_size);
+  auto const base = out->getBuffer();
+  auto const frame_size = header_.frame_size;
+  parallelFor(getNumFrames(), num_threads, [&](SerialSizeType i) {
+    decompressFrame(i, base + i * frame_size);
+  });
+  return out;
+}
+
+}} /* end namespace checkpoint::buffer */
@@ -0,0 +1,457 @@
+/*
+//@HEADER
+// *****************************************************************************
+//
+//                                frame_stream.h
+//                 DARMA/magistrate => Serialization Library
+//
+// Copyright 2019 National Technology & Engineering Solutions of Sandia, LLC
+// (NTESS). Under the terms of Contract DE-NA0003525 with NTESS, the U.S.
+// Government retains certain rights in this software.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+//
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// * Neither the name of the copyright holder nor the names of its
+//   contributors may be used to endorse or promote products derived from this
+//   software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// Questions? Contact darma@sandia.gov
+//
+// *****************************************************************************
+//@HEADER
+*/
+
+#if !defined INCLUDED_SRC_CHECKPOINT_BUFFER_FRAME_STREAM_H
+#define INCLUDED_SRC_CHECKPOINT_BUFFER_FRAME_STREAM_H
+
+#include "checkpoint/common.h"
+#include "checkpoint/buffer/buffer.h"
+#include "checkpoint/buffer/codec.h"
+#include "checkpoint/buffer/growable_buffer.h"
+#include "checkpoint/buffer/io_buffer.h"
+#include "checkpoint/buffer/io_options.h"
+#include "checkpoint/buffer/managed_buffer.h"
+#include "checkpoint/serializers/file_packer.h"
+
+#include <cstdint>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace checkpoint { namespace buffer {
+
+/*
+ * A compressed (frame) stream is laid out as:
+ *
+ *   FrameStreamHeader
+ *   { FrameHeader, payload } for each frame
+ *   uint64_t offset of each FrameHeader from the start of the stream
+ *   FrameStreamTrailer
+ *
+ * Every frame except the last holds \c frame_size uncompressed bytes, so the
+ * frame containing any uncompressed offset is found without decoding, and the
+ * trailing index gives its position in the stream.
+ */
+
+/// "MGZ1" read as a little-endian integer
+static constexpr uint32_t const frame_stream_magic = 0x315a474d;
+
+static constexpr uint16_t const frame_stream_version = 1;
+
+/// Largest supported uncompressed frame
+static constexpr SerialSizeType const max_frame_size = 1ull << 31;
+
+struct FrameStreamHeader {
+  uint32_t magic = frame_stream_magic;
+  uint16_t version = frame_stream_version;
+  uint8_t codec_id = 0;
+  uint8_t shuffle_width = 0;
+  uint64_t frame_size = 0;
+  uint64_t raw_size = 0;     /**< Total uncompressed bytes in the stream */
+};
+
+/// The frame payload is stored without compression
+static constexpr uint32_t const frame_flag_stored = 1;
+
+struct FrameHeader {
+  uint32_t raw_size = 0;
+  uint32_t stored_size = 0;
+  uint32_t flags = 0;
+  uint32_t reserved = 0;
+};
+
+struct FrameStreamTrailer {
+  uint64_t num_frames = 0;
+  uint32_t magic = frame_stream_magic;
+  uint32_t reserved = 0;
+};
+
+/**
+ * \struct FrameSink
+ *
+ * \brief Destination for the bytes of a compressed stream
+ */
+struct FrameSink {
+  virtual ~FrameSink() = default;
+
+  /**
+   * \brief Append bytes to the stream
+   *
+   * \param[in] bytes the bytes
+   * \param[in] len the number of bytes
+   */
+  virtual void write(SerialByteType const* bytes, SerialSizeType len) = 0;
+};
+
+/**
+ * \struct FrameSource
+ *
+ * \brief Sequential reader of the bytes of a compressed stream
+ */
+struct FrameSource {
+  virtual ~FrameSource() = default;
+
+  /**
+   * \brief Read the next \c len bytes. Throws \c std::runtime_error if the
+   * stream ends early.
+   *
+   * \param[in] len the number of bytes
+   *
+   * \return pointer to the bytes, valid until the next call unless
+   * \c isStable returns true
+   */
+  virtual SerialByteType const* read(SerialSizeType len) = 0;
+
+  /**
+   * \brief Whether pointers returned from \c read stay valid for the lifetime
+   * of the source (i.e., the source is backed by memory)
+   */
+  virtual bool isStable() const { return false; }
+};
+
+/**
+ * \struct GrowableFrameSink
+ *
+ * \brief Collect a compressed stream in memory
+ */
+struct GrowableFrameSink final : FrameSink {
+  explicit GrowableFrameSink(SerialSizeType initial_capacity)
+    : buffer_(std::make_unique<GrowableBuffer>(initial_capacity))
+  { }
+
+  void write(SerialByteType const* bytes, SerialSizeType len) override;
+
+  /**
+   * \brief Take the bytes written so far
+   *
+   * \return the buffer, sized to the bytes written
+   */
+  std::unique_ptr<GrowableBuffer> extractBuffer() { return std::move(buffer_); }
+
+private:
+  std::unique_ptr<GrowableBuffer> buffer_ = nullptr;
+};
+
+/**
+ * \struct FileFrameSink
+ *
+ * \brief Write a compressed stream to a file through \c FilePacker
+ */
+struct FileFrameSink final : FrameSink {
+  /**
+   * \brief Create or truncate \c file
+   *
+   * \param[in] size_hint an upper bound on the bytes that will be written
+   * \param[in] file the name of the file
+   * \param[in] options block size and durability options
+   */
+  FileFrameSink(
+    SerialSizeType size_hint, std::string const& file,
+    FileWriteOptions const& options
+  ) : packer_(size_hint, file, options)
+  { }
+
+  void write(SerialByteType const* bytes, SerialSizeType len) override {
+    packer_.contiguousBytes(const_cast<SerialByteType*>(bytes), 1, len);
+  }
+
+  /**
+   * \brief Flush, synchronize and close the file
+   */
+  void closeFile() { packer_.closeFile(); }
+
+private:
+  FilePacker packer_;
+};
+
+/**
+ * \struct StreamFrameSink
+ *
+ * \brief Write a compressed stream to a \c std::ostream-like stream
+ */
+template <typename StreamT>
+struct StreamFrameSink final : FrameSink {
+  explicit StreamFrameSink(StreamT& stream) : stream_(stream) { }
+
+  void write(SerialByteType const* bytes, SerialSizeType len) override {
+    stream_.write(bytes, len);
+  }
+
+private:
+  StreamT& stream_;
+};
+
+/**
+ * \struct MemoryFrameSource
+ *
+ * \brief Read a compressed stream held in memory
+ */
+struct MemoryFrameSource final : FrameSource {
+  MemoryFrameSource(SerialByteType const* buffer, SerialSizeType size)
+    : buffer_(buffer), size_(size)
+  { }
+
+  SerialByteType const* read(SerialSizeType len) override;
+
+  bool isStable() const override { return true; }
+
+  /**
+   * \brief Get the number of bytes read so far
+   *
+   * \return the offset
+   */
+  SerialSizeType getOffset() const { return offset_; }
+
+private:
+  SerialByteType const* buffer_ = nullptr;
+  SerialSizeType size_ = 0;
+  SerialSizeType offset_ = 0;
+};
+
+/**
+ * \struct MappedFileFrameSource
+ *
+ * \brief Read a compressed stream from a mapped file
+ */
+struct MappedFileFrameSource final : FrameSource {
+  MappedFileFrameSource(
+    std::string const& file, FileReadOptions const& options
+  ) : buffer_(IOBuffer::ReadFromFileTag{}, file, options),
+      source_(buffer_.getBuffer(), buffer_.getSize())
+  { }
+
+  SerialByteType const* read(SerialSizeType len) override {
+    buffer_.advanceCursor(source_.getOffset() + len);
+    return source_.read(len);
+  }
+
+  bool isStable() const override { return true; }
+
+private:
+  IOBuffer buffer_;
+  MemoryFrameSource source_;
+};
+
+/**
+ * \struct StreamFrameSource
+ *
+ * \brief Read a compressed stream from a \c std::istream-like stream
+ */
+template <typename StreamT>
+struct StreamFrameSource final : FrameSource {
+  explicit StreamFrameSource(StreamT& stream) : stream_(stream) { }
+
+  SerialByteType const* read(SerialSizeType len) override {
+    if (scratch_.size() < len) {
+      scratch_.resize(len);
+    }
+    stream_.read(scratch_.data(), len);
+    if (!stream_) {
+      throw std::runtime_error("Stream unable to read required number of bytes!");
+    }
+    return scratch_.data();
+  }
+
+private:
+  StreamT& stream_;
+  std::vector<SerialByteType> scratch_;
+};
+
+/**
+ * \struct FrameEncoder
+ *
+ * \brief Cut a byte stream into frames, compress them and write the result
+ * to a \c FrameSink
+ *
+ * Bytes are staged until \c num_threads frames are full; those frames are then
+ * compressed concurrently and written in order. Frames that do not shrink are
+ * stored uncompressed.
+ */
+struct FrameEncoder {
+  /**
+   * \brief Write the stream header to \c sink
+   *
+   * \param[in] sink where the stream is written
+   * \param[in] raw_size the total number of bytes that will be written
+   * \param[in] options codec, frame size, shuffle and thread count
+   */
+  FrameEncoder(
+    FrameSink& sink, SerialSizeType raw_size,
+    CompressionOptions const& options
+  );
+
+  /**
+   * \brief Append uncompressed bytes
+   *
+   * \param[in] bytes the bytes
+   * \param[in] len the number of bytes
+   */
+  void write(SerialByteType const* bytes, SerialSizeType len);
+
+  /**
+   * \brief Compress the remaining bytes and write the frame index. Throws
+   * \c std::runtime_error if the number of bytes written does not match the
+   * size given at construction.
+   */
+  void finish();
+
+private:
+  void encodeStaged();
+
+private:
+  FrameSink* sink_ = nullptr;
+  std::shared_ptr<Codec const> codec_ = nullptr;
+  FrameStreamHeader header_ = {};
+  unsigned num_threads_ = 1;
+  OwnedBytesType staging_ = nullptr;
+  SerialSizeType staged_ = 0;
+  SerialSizeType max_stored_ = 0;
+  std::vector<OwnedBytesType> scratch_; /**< Per-slot shuffle space */
+  std::vector<OwnedBytesType> out_;     /**< Per-slot compressed output */
+  std::vector<FrameHeader> frames_;
+  std::vector<uint64_t> offsets_;
+  SerialSizeType written_ = 0;   /**< Bytes written to the sink */
+  SerialSizeType raw_bytes_ = 0; /**< Uncompressed bytes received */
+};
+
+/**
+ * \struct FrameDecoder
+ *
+ * \brief Read uncompressed bytes from a compressed stream one frame at a time
+ *
+ * At most \c num_threads frames are held decompressed at once; with more than
+ * one thread, the next batch of frames is decompressed concurrently. With a
+ * single thread, frames that a read covers completely are decompressed
+ * straight into the destination.
+ */
+struct FrameDecoder {
+  /**
+   * \brief Read and validate the stream header from \c source
+   *
+   * \param[in] source where the stream is read from
+   * \param[in] num_threads the number of frames decompressed concurrently
+   */
+  explicit FrameDecoder(FrameSource& source, unsigned num_threads = 1);
+
+  /**
+   * \brief Read the next \c len uncompressed bytes
+   *
+   * \param[out] dst where the bytes are written
+   * \param[in] len the number of bytes
+   */
+  void read(SerialByteType* dst, SerialSizeType len);
+
+  /**
+   * \brief Get the total number of uncompressed bytes in the stream
+   *
+   * \return the size
+   */
+  SerialSizeType getRawSize() const { return header_.raw_size; }
+
+private:
+  void decodeBatch();
+
+private:
+  FrameSource* source_ = nullptr;
+  std::shared_ptr<Codec const> codec_ = nullptr;
+  FrameStreamHeader header_ = {};
+  unsigned num_threads_ = 1;
+  SerialSizeType frames_left_ = 0;
+  OwnedBytesType decoded_ = nullptr; /**< Decompressed frames of a batch */
+  OwnedBytesType scratch_ = nullptr; /**< Space to unshuffle from */
+  std::vector<std::vector<SerialByteType>> copies_; /**< Unstable payloads */
+  SerialSizeType decoded_len_ = 0;
+  SerialSizeType decoded_pos_ = 0;
+};
+
+/**
+ * \struct FrameStreamView
+ *
+ * \brief Random access to the frames of a compressed stream held in memory
+ */
+struct FrameStreamView {
+  /**
+   * \brief Validate the header and trailer and load the frame index. Throws
+   * \c std::runtime_error if \c buffer is not a valid compressed stream.
+   *
+   * \param[in] buffer the compressed stream
+   * \param[in] size the number of bytes in \c buffer
+   */
+  FrameStreamView(SerialByteType const* buffer, SerialSizeType size);
+
+  SerialSizeType getRawSize() const { return header_.raw_size; }
+  SerialSizeType getFrameSize() const { return header_.frame_size; }
+  SerialSizeType getNumFrames() const { return offsets_.size(); }
+
+  /**
+   * \brief Decompress one frame
+   *
+   * \param[in] frame the frame index
+   * \param[out] dst space for the frame's uncompressed bytes (\c
+   * getFrameSize bytes, or fewer for the last frame)
+   *
+   * \return the number of bytes written to \c dst
+   */
+  SerialSizeType decompressFrame(SerialSizeType frame, SerialByteType* dst) const;
+
+  /**
+   * \brief Decompress every frame into a new buffer
+   *
+   * \param[in] num_threads the number of frames decompressed concurrently
+   *
+   * \return the uncompressed bytes
+   */
+  std::unique_ptr<ManagedBuffer> decompressAll(unsigned num_threads = 1) const;
+
+private:
+  SerialByteType const* buffer_ = nullptr;
+  SerialSizeType size_ = 0;
+  std::shared_ptr<Codec const> codec_ = nullptr;
+  FrameStreamHeader header_ = {};
+  std::vector<uint64_t> offsets_;
+};
+
+}} /* end namespace checkpoint::buffer */
+
+#endif /*INCLUDED_SRC_CHECKPOINT_BUFFER_FRAME_STREAM_H*/
@@ -0,0 +1,155 @@
+/*
+//@HEADER
+// *****************************************************************************
+//
+//                              growable_buffer.h
+//                 DARMA/magistrate => Serialization Library
+//
+// Copyright 2019 National Technology & Engineering Solutions of Sandia, LLC
+// (NTESS). Under the terms of Contract DE-NA0003525 with NTESS, the U.S.
+// Government retains certain rights in this software.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+//
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// * Neither the name of the copyright holder nor the names of its
+//   contributors may be used to endorse or promote products derived from this
+//   software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// Questions? Contact darma@sandia.gov
+//
+// *****************************************************************************
+//@HEADER
+*/
+
+#if !defined INCLUDED_SRC_CHECKPOINT_BUFFER_GROWABLE_BUFFER_H
+#define INCLUDED_SRC_CHECKPOINT_BUFFER_GROWABLE_BUFFER_H
+
+#include "checkpoint/common.h"
+#include "checkpoint/buffer/buffer.h"
+#include "checkpoint/buffer/allocation.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+#include <type_traits>
+
+namespace checkpoint { namespace buffer {
+
+/**
+ * \struct GrowableBuffer
+ *
+ * \brief An owning buffer whose capacity grows geometrically while packing.
+ *
+ * Used for single-pass serialization, where the final size is not known until
+ * the traversal completes. The reported size is the number of bytes actually
+ * committed by the packer, which may be less than the capacity.
+ */
+struct GrowableBuffer : Buffer {
+  explicit GrowableBuffer(SerialSizeType const& initial_capacity)
+    : capacity_(std::max<SerialSizeType>(initial_capacity, 1)),
+      buffer_(allocateBytes(capacity_))
+  { }
+
+  virtual SerialByteType* getBuffer() const override {
+    return buffer_.get();
+  }
+
+  virtual SerialSizeType getSize() const override {
+    return size_;
+  }
+
+  /**
+   * \brief Get the number of bytes currently allocated
+   *
+   * \return the capacity in bytes
+   */
+  SerialSizeType getCapacity() const {
+    return capacity_;
+  }
+
+  /**
+   * \brief Set the number of committed bytes reported by \c getSize
+   *
+   * \param[in] size the committed size, must not exceed the capacity
+   */
+  void setSize(SerialSizeType const& size) {
+    checkpointAssert(size <= capacity_, "Size must not exceed capacity");
+    size_ = size;
+  }
+
+  /**
+   * \brief Ensure the buffer can hold at least \c required bytes, preserving
+   * the bytes already written. The capacity at least doubles on each growth.
+   *
+   * Below \c huge_page_threshold growth goes through \c realloc, which may
+   * extend the allocation in place. At or above it the storage comes from
+   * \c allocateBytes and the old bytes are copied, since \c realloc would
+   * lose the huge-page alignment and advice; the capacity is then rounded up
+   * to whole huge pages, which \c allocateBytes reserves anyway.
+   *
+   * \param[in] required the minimum capacity needed
+   */
+  void reserve(SerialSizeType const& required) {
+    if (required <= capacity_) {
+      return;
+    }
+
+    auto new_capacity = std::max(required, capacity_ * 2);
+    if (new_capacity >= huge_page_threshold) {
+      new_capacity =
+        (new_capacity + huge_page_size - 1) / huge_page_size * huge_page_size;
+      auto grown = allocateBytes(new_capacity);
+      std::memcpy(grown.get(), buffer_.get(), capacity_);
+      buffer_ = std::move(grown);
+      capacity_ = new_capacity;
+      return;
+    }
+
+    auto ptr = std::realloc(buffer_.get(), new_capacity);
+    if (ptr == nullptr) {
+      throw std::bad_alloc();
+    }
+    buffer_.release();
+    buffer_.reset(static_cast<SerialByteType*>(ptr));
+    capacity_ = new_capacity;
+  }
+
+private:
+  SerialSizeType size_ = 0;
+
+  SerialSizeType capacity_ = 0;
+
+  OwnedBytesType buffer_ = nullptr;
+};
+
+/// Trait for buffers that may reallocate while a packer writes into them
+template <typename BufferT>
+struct IsGrowableBuffer : std::false_type { };
+
+template <>
+struct IsGrowableBuffer<GrowableBuffer> : std::true_type { };
+
+}} /* end namespace checkpoint::buffer */
+
+#endif /*INCLUDED_SRC_CHECKPOINT_BUFFER_GROWABLE_BUFFER_H*/
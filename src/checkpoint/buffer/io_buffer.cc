@@ -46,7 +46,11 @@
 
 #include "checkpoint/common.h"
 #include "checkpoint/buffer/io_buffer.h"
+#include "checkpoint/buffer/checksum.h"
 
+#include <algorithm>
+#include <limits>
+#include <mutex>
 #include <string>
 #include <stdexcept>
 
@@ -90,16 +94,35 @@ void IOBuffer::setupForRead() {
   }
 
   size_ = sb.st_size;
+  map_size_ = size_;
 
   debug_checkpoint("IOBuffer: got file size=%lu\n", size_);
 
+# if defined(checkpoint_has_posix_fadvise)
+  if (read_options_.strategy == FileReadStrategy::FAdvise and size_ > 0) {
+    debug_checkpoint("IOBuffer: posix_fadvise sequential, willneed\n");
+
+    // Advice is best effort, so failures are not fatal
+    posix_fadvise(fd_, 0, size_, POSIX_FADV_SEQUENTIAL);
+    posix_fadvise(fd_, 0, size_, POSIX_FADV_WILLNEED);
+  }
+# endif
+
+  int flags = MAP_SHARED;
+
+# if defined(checkpoint_has_map_populate)
+  if (read_options_.strategy == FileReadStrategy::Populate) {
+    flags |= MAP_POPULATE;
+  }
+# endif
+
   /*
    * mmap or mmap64 the file descriptor in READ mode
    */
   void* addr = nullptr;
 
 # if defined(checkpoint_has_mmap64)
-  addr = mmap64(nullptr, size_, PROT_READ, MAP_SHARED, fd_, 0);
+  addr = mmap64(nullptr, size_, PROT_READ, flags, fd_, 0);
 
   if (addr == MAP_FAILED) {
     auto err = std::string("mmap64 failed for writing file: errno=") +
@@ -107,7 +130,7 @@ void IOBuffer::setupForRead() {
     throw std::runtime_error(err);
   }
 # else
-  addr = mmap(nullptr, size_, PROT_READ, MAP_SHARED, fd_, 0);
+  addr = mmap(nullptr, size_, PROT_READ, flags, fd_, 0);
 
   if (addr == MAP_FAILED) {
     auto err = std::string("mmap failed for writing file: errno=") +
@@ -122,12 +145,157 @@ void IOBuffer::setupForRead() {
    */
   buffer_ = static_cast<SerialByteType*>(addr);
 
+  if (read_options_.strategy == FileReadStrategy::Sequential) {
+    debug_checkpoint("IOBuffer: madvise sequential, willneed\n");
+
+    // Advice is best effort, so failures are not fatal
+    madvise(addr, size_, MADV_SEQUENTIAL);
+    madvise(addr, size_, MADV_WILLNEED);
+  }
+
+  /*
+   * Verify the checksum trailer (if any) before handing out the bytes; the
+   * reported size then excludes the trailer. With read-ahead, only the footer
+   * is read here and the read-ahead thread verifies the chunks as it goes.
+   */
+  if (read_options_.checksum != ChecksumVerify::Skip) {
+    try {
+      if (read_options_.strategy == FileReadStrategy::ReadAhead) {
+        verify_ahead_ = readChecksumFooter(
+          buffer_, map_size_, read_options_.checksum, footer_
+        );
+        if (verify_ahead_) {
+          size_ = footer_.payload_size;
+        }
+      } else {
+        size_ = verifyChecksumTrailer(
+          buffer_, map_size_, read_options_.checksum,
+          read_options_.checksum_threads
+        );
+      }
+    } catch (checksum_error const& err) {
+      closeFile();
+      throw checksum_error(std::string(err.what()) + ": file=" + file_);
+    }
+  }
+
+  if (read_options_.strategy == FileReadStrategy::ReadAhead) {
+    startReadAhead();
+  }
+
   return;
 }
 
+void IOBuffer::startReadAhead() {
+  debug_checkpoint(
+    "IOBuffer: starting read-ahead: window=%lu\n", read_options_.read_ahead
+  );
+
+  read_ahead_thread_ = std::thread([this]{ readAhead(); });
+}
+
+void IOBuffer::stopReadAhead() {
+  if (read_ahead_thread_.joinable()) {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      stop_read_ahead_.store(true);
+      read_ahead_cv_.notify_one();
+    }
+    read_ahead_thread_.join();
+  }
+}
+
+void IOBuffer::wakeReadAhead() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  read_ahead_cv_.notify_one();
+}
+
+void IOBuffer::waitForVerified(SerialSizeType const offset) {
+  auto const end = std::min(offset, size_);
+
+  std::unique_lock<std::mutex> lock(mutex_);
+  verified_cv_.wait(lock, [&]{
+    return verify_failed_ or verified_.load() >= end;
+  });
+
+  if (verify_failed_) {
+    throw checksum_error(verify_error_);
+  }
+}
+
+bool IOBuffer::verifyAhead(SerialSizeType const chunk) {
+  bool ok = true;
+  std::string error;
+
+  // Checksumming the chunk reads it, which faults its pages in
+  try {
+    verifyChecksumChunk(buffer_, footer_, chunk);
+  } catch (checksum_error const& err) {
+    ok = false;
+    error = std::string(err.what()) + ": file=" + file_;
+  }
+
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (ok) {
+    verified_.store(
+      std::min(size_, (chunk + 1) * footer_.chunk_size),
+      std::memory_order_release
+    );
+  } else {
+    verify_failed_ = true;
+    verify_error_ = error;
+  }
+  verified_cv_.notify_all();
+  return ok;
+}
+
+void IOBuffer::readAhead() {
+  SerialSizeType const page = sysconf(_SC_PAGESIZE);
+  SerialSizeType const window = read_options_.read_ahead;
+  SerialSizeType touched = 0;
+
+  while (touched < size_ and not stop_read_ahead_.load()) {
+    auto const cursor = cursor_.load();
+    auto const target = std::min(size_, cursor + window);
+
+    if (touched >= target) {
+      // Caught up with the window; wait for the unpacker to move on
+      std::unique_lock<std::mutex> lock(mutex_);
+      resume_at_.store(touched - window + 1);
+      read_ahead_cv_.wait(lock, [&]{
+        return stop_read_ahead_.load() or cursor_.load() >= resume_at_.load();
+      });
+      resume_at_.store(std::numeric_limits<SerialSizeType>::max());
+      continue;
+    }
+
+    if (verify_ahead_) {
+      // Every chunk is verified, including those the unpacker has reached
+      auto const chunk = touched / footer_.chunk_size;
+      if (not verifyAhead(chunk)) {
+        return;
+      }
+      touched = verified_.load(std::memory_order_relaxed);
+      continue;
+    }
+
+    // Never spend time behind the unpacker, it has faulted those pages in
+    touched = std::max(touched, cursor - cursor % page);
+
+    // Reading one byte per page faults the page into the shared mapping
+    auto const bytes = static_cast<SerialByteType volatile*>(buffer_);
+    for (; touched < target; touched += page) {
+      SerialByteType const value = bytes[touched];
+      checkpoint_force_use(value);
+    }
+  }
+}
+
 void IOBuffer::setupForWrite() {
   debug_checkpoint("IOBuffer: opening file for write: %s\n", file_.c_str());
 
+  map_size_ = size_;
+
   /*
    * Start by opening the file, create/read-write/truncate mode
    */
@@ -170,17 +338,8 @@ void IOBuffer::setupForWrite() {
   }
 
   /*
-   * Sync the file with the new size to the file system
+   * Syncing is deferred until the data has been written; see closeFile
    */
-  debug_checkpoint("IOBuffer: syncing file\n");
-
-  ret = fsync(fd_);
-
-  if (ret != 0) {
-    auto err = std::string("fsync failed on file: errno=") +
-               std::to_string(errno) + ": " + strerror(errno);
-    throw std::runtime_error(err);
-  }
 
   debug_checkpoint("IOBuffer: mmap file: len=%lu\n", size_);
 
@@ -235,18 +394,22 @@ void IOBuffer::closeFile() {
     return;
   }
 
+  // The read-ahead thread touches the mapping, so stop it before unmapping
+  stopReadAhead();
+
   auto addr = static_cast<void*>(buffer_);
 
   int ret = 0;
 
   /*
-   * msync/msync64 the mapped file causing the file to be written out
+   * msync/msync64 the mapped file causing the file to be written out, unless
+   * the durability policy leaves it to normal writeback
    */
-  if (mode_ == ModeEnum::WriteToFile) {
+  if (mode_ == ModeEnum::WriteToFile and durability_ != FileDurability::None) {
     debug_checkpoint("~IOBuffer: msync: file=%s, len=%lu\n", file_.c_str(), size_);
 
 #   if defined(checkpoint_has_msync64)
-    ret = msync64(addr, size_, MS_SYNC);
+    ret = msync64(addr, map_size_, MS_SYNC);
 
     if (ret != 0) {
       auto err = std::string("msync64 failed on file after write: errno=") +
@@ -255,7 +418,7 @@ void IOBuffer::closeFile() {
     }
 
 #   else
-    ret = msync(addr, size_, MS_SYNC);
+    ret = msync(addr, map_size_, MS_SYNC);
 
     if (ret != 0) {
       auto err = std::string("msync failed on file after write: errno=") +
@@ -263,6 +426,14 @@ void IOBuffer::closeFile() {
       throw std::runtime_error(err);
     }
 #   endif
+
+    /*
+     * msync already wrote the data; a full sync also persists the metadata
+     * and the directory entry
+     */
+    if (durability_ == FileDurability::Full) {
+      syncFile(fd_, file_, FileDurability::Full);
+    }
   }
 
   /*
@@ -271,7 +442,7 @@ void IOBuffer::closeFile() {
   debug_checkpoint("~IOBuffer: munmap\n");
 
 # if defined(checkpoint_has_munmap64)
-  ret = munmap64(addr, size_);
+  ret = munmap64(addr, map_size_);
 
   if (ret != 0) {
     auto err = std::string("munmap64 failed on after write: errno=") +
@@ -280,7 +451,7 @@ void IOBuffer::closeFile() {
   }
 
 # else
-  ret = munmap(addr, size_);
+  ret = munmap(addr, map_size_);
 
   if (ret != 0) {
     auto err = std::string("munmap failed on file after write: errno=") +
@@ -46,8 +46,16 @@
 
 #include "checkpoint/common.h"
 #include "checkpoint/buffer/buffer.h"
+#include "checkpoint/buffer/io_options.h"
+#include "checkpoint/buffer/checksum.h"
 
+#include <atomic>
+#include <condition_variable>
+#include <limits>
+#include <mutex>
 #include <string>
+#include <thread>
+#include <type_traits>
 
 namespace checkpoint { namespace buffer {
 
@@ -64,15 +72,19 @@ private:
 
 public:
   IOBuffer(
-    WriteToFileTag, SerialSizeType const& in_size, std::string const& in_file
-  ) : mode_(ModeEnum::WriteToFile), file_(in_file), size_(in_size)
+    WriteToFileTag, SerialSizeType const& in_size, std::string const& in_file,
+    FileDurability in_durability = FileDurability::DataSync
+  ) : mode_(ModeEnum::WriteToFile), file_(in_file), size_(in_size),
+      durability_(in_durability)
   {
     setupFile();
   }
 
   IOBuffer(
-    ReadFromFileTag, std::string const& in_file
-  ) : mode_(ModeEnum::ReadFromFile), file_(in_file)
+    ReadFromFileTag, std::string const& in_file,
+    FileReadOptions const& in_read_options = FileReadOptions{}
+  ) : mode_(ModeEnum::ReadFromFile), file_(in_file),
+      read_options_(in_read_options)
   {
     setupFile();
   }
@@ -82,6 +94,12 @@ private:
   void closeFile();
   void setupForRead();
   void setupForWrite();
+  void startReadAhead();
+  void stopReadAhead();
+  void readAhead();
+  bool verifyAhead(SerialSizeType chunk);
+  void wakeReadAhead();
+  void waitForVerified(SerialSizeType offset);
 
 public:
 
@@ -95,14 +113,61 @@ public:
     return size_;
   }
 
+  /**
+   * \brief Report how far the unpacker is about to read, so the read-ahead
+   * thread (if any) can stay ahead of it
+   *
+   * When the read-ahead thread verifies a checksum trailer, this waits until
+   * the bytes before \c offset have been verified and throws
+   * \c checksum_error if they do not match.
+   *
+   * \param[in] offset the end of the bytes about to be read
+   */
+  void advanceCursor(SerialSizeType const offset) {
+    cursor_.store(offset);
+    if (offset >= resume_at_.load()) {
+      wakeReadAhead();
+    }
+    if (verify_ahead_ and offset > verified_.load(std::memory_order_acquire)) {
+      waitForVerified(offset);
+    }
+  }
+
 private:
   ModeEnum mode_ = ModeEnum::WriteToFile;
   std::string file_ = "";
   SerialSizeType size_ = 0;
+  SerialSizeType map_size_ = 0; /**< Mapped bytes, including any trailer */
   SerialByteType* buffer_ = nullptr;
   int fd_ = -1;
+  FileDurability durability_ = FileDurability::DataSync;
+  FileReadOptions read_options_ = {};
+  std::atomic<SerialSizeType> cursor_ = {0};
+  std::atomic<bool> stop_read_ahead_ = {false};
+  std::thread read_ahead_thread_;
+
+  /// Cursor at which a waiting read-ahead thread must be woken
+  std::atomic<SerialSizeType> resume_at_ = {
+    std::numeric_limits<SerialSizeType>::max()
+  };
+  std::mutex mutex_;
+  std::condition_variable read_ahead_cv_; /**< Wakes the read-ahead thread */
+  std::condition_variable verified_cv_;   /**< Wakes the unpacker */
+
+  bool verify_ahead_ = false; /**< Whether read-ahead verifies the checksum */
+  ChecksumFooter footer_ = {};
+  std::atomic<SerialSizeType> verified_ = {0};
+  bool verify_failed_ = false; /**< Guarded by \c mutex_ */
+  std::string verify_error_ = ""; /**< Guarded by \c mutex_ */
 };
 
+/// Trait for buffers that want to be told the unpacker's read position
+template <typename BufferT>
+struct IsReadCursorBuffer : std::false_type { };
+
+template <>
+struct IsReadCursorBuffer<IOBuffer> : std::true_type { };
+
 }} /* end namespace checkpoint::buffer */
 
 #endif /*INCLUDED_SRC_CHECKPOINT_BUFFER_IO_BUFFER_H*/
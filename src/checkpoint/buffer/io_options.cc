@@ -0,0 +1,115 @@
+/*
+//@HEADER
+// *****************************************************************************
+//
+//                                io_options.cc
+//                 DARMA/magistrate => Serialization Library
+//
+// Copyright 2019 National Technology & Engineering Solutions of Sandia, LLC
+// (NTESS). Under the terms of Contract DE-NA0003525 with NTESS, the U.S.
+// Government retains certain rights in this software.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+//
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// * Neither the name of the copyright holder nor the names of its
+//   contributors may be used to endorse or promote products derived from this
+//   software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// Questions? Contact darma@sandia.gov
+//
+// *****************************************************************************
+//@HEADER
+*/
+
+#include "checkpoint/common.h"
+#include "checkpoint/buffer/io_options.h"
+
+#include <string>
+#include <stdexcept>
+
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <errno.h>
+#include <string.h>
+
+namespace checkpoint { namespace buffer {
+
+void syncParentDirectory(std::string const& file) {
+  auto const pos = file.find_last_of('/');
+  std::string const dir =
+    pos == std::string::npos ? "." : (pos == 0 ? "/" : file.substr(0, pos));
+
+  debug_checkpoint("syncParentDirectory: dir=%s\n", dir.c_str());
+
+  int dir_fd = open(dir.c_str(), O_RDONLY);
+  if (dir_fd == -1) {
+    auto err = std::string("Failed to open directory=") + dir + ": errno=" +
+               std::to_string(errno) + ": " + strerror(errno);
+    throw std::runtime_error(err);
+  }
+
+  int ret = fsync(dir_fd);
+  int const sync_errno = errno;
+  close(dir_fd);
+
+  if (ret != 0) {
+    auto err = std::string("fsync failed on directory=") + dir + ": errno=" +
+               std::to_string(sync_errno) + ": " + strerror(sync_errno);
+    throw std::runtime_error(err);
+  }
+}
+
+void syncFile(int fd, std::string const& file, FileDurability durability) {
+  int ret = 0;
+
+  switch (durability) {
+  case FileDurability::None:
+    return;
+  case FileDurability::DataSync:
+    debug_checkpoint("syncFile: data sync: file=%s\n", file.c_str());
+#   if defined(checkpoint_has_fdatasync)
+    ret = fdatasync(fd);
+#   else
+    ret = fsync(fd);
+#   endif
+    break;
+  case FileDurability::Full:
+    debug_checkpoint("syncFile: full sync: file=%s\n", file.c_str());
+    ret = fsync(fd);
+    break;
+  }
+
+  if (ret != 0) {
+    auto err = std::string("sync failed on file=") + file + ": errno=" +
+               std::to_string(errno) + ": " + strerror(errno);
+    throw std::runtime_error(err);
+  }
+
+  if (durability == FileDurability::Full) {
+    syncParentDirectory(file);
+  }
+}
+
+}} /* end namespace checkpoint::buffer */
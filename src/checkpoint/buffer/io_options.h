@@ -0,0 +1,195 @@
+/*
+//@HEADER
+// *****************************************************************************
+//
+//                                 io_options.h
+//                 DARMA/magistrate => Serialization Library
+//
+// Copyright 2019 National Technology & Engineering Solutions of Sandia, LLC
+// (NTESS). Under the terms of Contract DE-NA0003525 with NTESS, the U.S.
+// Government retains certain rights in this software.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+//
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// * Neither the name of the copyright holder nor the names of its
+//   contributors may be used to endorse or promote products derived from this
+//   software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// Questions? Contact darma@sandia.gov
+//
+// *****************************************************************************
+//@HEADER
+*/
+
+#if !defined INCLUDED_SRC_CHECKPOINT_BUFFER_IO_OPTIONS_H
+#define INCLUDED_SRC_CHECKPOINT_BUFFER_IO_OPTIONS_H
+
+#include "checkpoint/common.h"
+
+#include <string>
+
+namespace checkpoint { namespace buffer {
+
+/**
+ * \enum FileDurability
+ *
+ * \brief How much synchronization is performed before a file write returns
+ */
+enum struct FileDurability : int8_t {
+  None = 0,     /**< No explicit sync; rely on normal kernel writeback */
+  DataSync = 1, /**< Sync the file data once, after all bytes are written */
+  Full = 2      /**< Sync data and metadata, then the containing directory */
+};
+
+/**
+ * \enum FileBackend
+ *
+ * \brief The mechanism used to get packed bytes into a file
+ */
+enum struct FileBackend : int8_t {
+  MMap = 0,  /**< Map the whole file and pack directly into the mapping */
+  PWrite = 1 /**< Pack into staging blocks that are written with pwrite(v) */
+};
+
+/**
+ * \struct ChecksumOptions
+ *
+ * \brief Options for appending a CRC32C trailer to packed bytes
+ *
+ * The bytes are checksummed in chunks of \c chunk_size so that the checksums
+ * can be computed and verified on several threads.
+ */
+struct ChecksumOptions {
+  bool enabled = false;                   /**< Append a checksum trailer */
+  SerialSizeType chunk_size = 4ull << 20; /**< Bytes covered by each CRC */
+  unsigned num_threads = 1;               /**< Threads computing CRCs */
+};
+
+/**
+ * \struct CompactOptions
+ *
+ * \brief Options for compact buffers
+ *
+ * Container sizes, capacities and variant indices are always written as
+ * LEB128 varints. With \c integers set, integral fields of 2, 4 or 8 bytes
+ * (and arrays of them) are written as varints as well, zigzag-mapped if
+ * signed: values close to zero shrink to one or two bytes, at the cost of
+ * encoding and decoding each value. Character types and \c bool are always
+ * copied as bytes. Buffers must be read with the options they were written
+ * with.
+ */
+struct CompactOptions {
+  bool integers = false; /**< Write integral fields as varints */
+};
+
+/**
+ * \enum ChecksumVerify
+ *
+ * \brief Whether a checksum trailer is verified when bytes are read
+ */
+enum struct ChecksumVerify : int8_t {
+  Auto = 0,    /**< Verify if the bytes end with a checksum trailer */
+  Require = 1, /**< Verify, failing if there is no checksum trailer */
+  Skip = 2     /**< Do not look for a checksum trailer */
+};
+
+/**
+ * \struct FileWriteOptions
+ *
+ * \brief Options for serializing to a file
+ */
+struct FileWriteOptions {
+  FileBackend backend = FileBackend::MMap;           /**< Write mechanism */
+  FileDurability durability = FileDurability::DataSync; /**< Sync policy */
+  SerialSizeType block_size = 8ull << 20; /**< Staging block for \c PWrite */
+  ChecksumOptions checksum = {};          /**< Optional CRC32C trailer */
+  /**
+   * With \c PWrite, once this many bytes are written they are handed to
+   * writeback and the window before them is waited on and dropped from the
+   * page cache, so dirty pages stay bounded; zero disables write-behind
+   */
+  SerialSizeType write_behind = 0;
+};
+
+/**
+ * \enum FileReadStrategy
+ *
+ * \brief How pages of a mapped file are brought in while deserializing
+ */
+enum struct FileReadStrategy : int8_t {
+  Default = 0,    /**< No hints; pages are faulted in on demand */
+  Populate = 1,   /**< Map with \c MAP_POPULATE to read the file up front */
+  Sequential = 2, /**< \c madvise the mapping sequential and will-need */
+  FAdvise = 3,    /**< \c posix_fadvise the file sequential and will-need */
+  /**
+   * A thread touches pages ahead of the unpacker; a checksum trailer is
+   * verified chunk by chunk by that thread, and the unpacker waits for the
+   * bytes it reads to be verified
+   */
+  ReadAhead = 4,
+  /**
+   * The file is not mapped; it is read with \c pread through a buffer of
+   * \c FileReadOptions::window bytes, so memory use does not grow with the
+   * file size. Readers that lend out the file's bytes map it as \c Default
+   */
+  Window = 5
+};
+
+/**
+ * \struct FileReadOptions
+ *
+ * \brief Options for deserializing from a file
+ */
+struct FileReadOptions {
+  FileReadStrategy strategy = FileReadStrategy::Default; /**< Page-in policy */
+  SerialSizeType read_ahead = 32ull << 20; /**< Window for \c ReadAhead */
+  ChecksumVerify checksum = ChecksumVerify::Auto; /**< Trailer verification */
+  unsigned checksum_threads = 1; /**< Threads verifying the trailer */
+  SerialSizeType window = 8ull << 20; /**< Read buffer for \c Window */
+};
+
+/**
+ * \brief Synchronize an open file according to a durability policy
+ *
+ * For \c FileDurability::DataSync only the file data is synchronized; for
+ * \c FileDurability::Full the metadata and the directory entry of \c file are
+ * synchronized as well. If an error occurs \c std::runtime_error is thrown
+ * with the corresponding errno.
+ *
+ * \param[in] fd the open file descriptor
+ * \param[in] file the name of the file (used to find its directory)
+ * \param[in] durability the policy to apply
+ */
+void syncFile(int fd, std::string const& file, FileDurability durability);
+
+/**
+ * \brief Synchronize the directory containing \c file so a newly created
+ * entry survives a crash
+ *
+ * \param[in] file the name of the file whose directory is synchronized
+ */
+void syncParentDirectory(std::string const& file);
+
+}} /* end namespace checkpoint::buffer */
+
+#endif /*INCLUDED_SRC_CHECKPOINT_BUFFER_IO_OPTIONS_H*/
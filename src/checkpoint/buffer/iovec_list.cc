@@ -0,0 +1,108 @@
+/*
+//@HEADER
+// *****************************************************************************
+//
+//                                iovec_list.cc
+//                 DARMA/magistrate => Serialization Library
+//
+// Copyright 2019 National Technology & Engineering Solutions of Sandia, LLC
+// (NTESS). Under the terms of Contract DE-NA0003525 with NTESS, the U.S.
+// Government retains certain rights in this software.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+//
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// * Neither the name of the copyright holder nor the names of its
+//   contributors may be used to endorse or promote products derived from this
+//   software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// Questions? Contact darma@sandia.gov
+//
+// *****************************************************************************
+//@HEADER
+*/
+
+#include "checkpoint/common.h"
+#include "checkpoint/buffer/iovec_list.h"
+
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+
+#include <limits.h>
+#include <unistd.h>
+#include <errno.h>
+#include <string.h>
+
+namespace checkpoint { namespace buffer {
+
+void IOVecList::writeTo(int fd) const {
+# if defined(IOV_MAX)
+  std::size_t const max_batch = IOV_MAX;
+# else
+  std::size_t const max_batch = 1024;
+# endif
+
+  // Work on a copy so partial writes can adjust the current segment
+  std::vector<struct iovec> iov = segments_;
+  std::size_t cur = 0;
+
+  while (cur < iov.size()) {
+    auto const batch = static_cast<int>(std::min(max_batch, iov.size() - cur));
+    auto ret = writev(fd, iov.data() + cur, batch);
+
+    if (ret < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      auto err = std::string("writev failed: errno=") +
+                 std::to_string(errno) + ": " + strerror(errno);
+      throw std::runtime_error(err);
+    }
+
+    auto written = static_cast<SerialSizeType>(ret);
+    while (cur < iov.size() and written >= iov[cur].iov_len) {
+      written -= iov[cur].iov_len;
+      cur++;
+    }
+    if (cur < iov.size()) {
+      iov[cur].iov_base = static_cast<SerialByteType*>(iov[cur].iov_base) + written;
+      iov[cur].iov_len -= written;
+    }
+  }
+}
+
+void IOVecList::writeTo(std::ostream& os) const {
+  for (auto const& seg : segments_) {
+    os.write(static_cast<char const*>(seg.iov_base), seg.iov_len);
+  }
+}
+
+void IOVecList::copyTo(SerialByteType* dst) const {
+  for (auto const& seg : segments_) {
+    std::memcpy(dst, seg.iov_base, seg.iov_len);
+    dst += seg.iov_len;
+  }
+}
+
+}} /* end namespace checkpoint::buffer */
@@ -0,0 +1,123 @@
+/*
+//@HEADER
+// *****************************************************************************
+//
+//                                 iovec_list.h
+//                 DARMA/magistrate => Serialization Library
+//
+// Copyright 2019 National Technology & Engineering Solutions of Sandia, LLC
+// (NTESS). Under the terms of Contract DE-NA0003525 with NTESS, the U.S.
+// Government retains certain rights in this software.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+//
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// * Neither the name of the copyright holder nor the names of its
+//   contributors may be used to endorse or promote products derived from this
+//   software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// Questions? Contact darma@sandia.gov
+//
+// *****************************************************************************
+//@HEADER
+*/
+
+#if !defined INCLUDED_SRC_CHECKPOINT_BUFFER_IOVEC_LIST_H
+#define INCLUDED_SRC_CHECKPOINT_BUFFER_IOVEC_LIST_H
+
+#include "checkpoint/common.h"
+#include "checkpoint/buffer/growable_buffer.h"
+
+#include <memory>
+#include <ostream>
+#include <vector>
+
+#include <sys/uio.h>
+
+namespace checkpoint { namespace buffer {
+
+/// Default size at and above which \c PackerIOVec references source memory
+static constexpr SerialSizeType const iovec_reference_threshold = 16384;
+
+/**
+ * \struct IOVecList
+ *
+ * \brief The result of scatter-gather packing: an ordered list of segments
+ * that together form the serialized bytes
+ *
+ * Segments either point into a side buffer owned by the list (for small
+ * fields) or directly at the memory of the object that was serialized (for
+ * large contiguous fields). The latter are only valid while that object is
+ * alive and unmodified.
+ */
+struct IOVecList {
+  IOVecList(
+    std::unique_ptr<GrowableBuffer> in_side, std::vector<struct iovec> in_segs,
+    SerialSizeType in_size
+  ) : side_(std::move(in_side)), segments_(std::move(in_segs)), size_(in_size)
+  { }
+
+  /**
+   * \brief Get the segments, suitable for passing to \c writev
+   *
+   * \return the segments in stream order
+   */
+  std::vector<struct iovec> const& getSegments() const { return segments_; }
+
+  /**
+   * \brief Get the total number of serialized bytes
+   *
+   * \return the size in bytes
+   */
+  SerialSizeType getSize() const { return size_; }
+
+  /**
+   * \brief Write all segments to a file descriptor with \c writev, handling
+   * partial writes. Throws \c std::runtime_error with the errno on failure.
+   *
+   * \param[in] fd the file descriptor to write to
+   */
+  void writeTo(int fd) const;
+
+  /**
+   * \brief Write all segments to a stream
+   *
+   * \param[in] os the stream to write to
+   */
+  void writeTo(std::ostream& os) const;
+
+  /**
+   * \brief Copy all segments into one contiguous buffer
+   *
+   * \param[in] dst the destination, at least \c getSize() bytes
+   */
+  void copyTo(SerialByteType* dst) const;
+
+private:
+  std::unique_ptr<GrowableBuffer> side_ = nullptr;
+  std::vector<struct iovec> segments_;
+  SerialSizeType size_ = 0;
+};
+
+}} /* end namespace checkpoint::buffer */
+
+#endif /*INCLUDED_SRC_CHECKPOINT_BUFFER_IOVEC_LIST_H*/
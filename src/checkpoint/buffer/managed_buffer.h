@@ -46,16 +46,13 @@
 
 #include "checkpoint/common.h"
 #include "checkpoint/buffer/buffer.h"
-
-#include <memory>
+#include "checkpoint/buffer/allocation.h"
 
 namespace checkpoint { namespace buffer {
 
 struct ManagedBuffer : Buffer {
-  using ByteType = SerialByteType[];
-
   ManagedBuffer(SerialSizeType const& size)
-    : size_(size), buffer_(std::make_unique<ByteType>(size))
+    : size_(size), buffer_(allocateBytes(size))
   { }
 
   virtual SerialByteType* getBuffer() const override {
@@ -69,7 +66,7 @@ struct ManagedBuffer : Buffer {
 private:
   SerialSizeType size_ = 0;
 
-  std::unique_ptr<ByteType> buffer_ = nullptr;
+  OwnedBytesType buffer_ = nullptr;
 };
 
 }} /* end namespace checkpoint::buffer */
@@ -0,0 +1,279 @@
+/*
+//@HEADER
+// *****************************************************************************
+//
+//                               member_table.cc
+//                 DARMA/magistrate => Serialization Library
+//
+// Copyright 2019 National Technology & Engineering Solutions of Sandia, LLC
+// (NTESS). Under the terms of Contract DE-NA0003525 with NTESS, the U.S.
+// Government retains certain rights in this software.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+//
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// * Neither the name of the copyright holder nor the names of its
+//   contributors may be used to endorse or promote products derived from this
+//   software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// Questions? Contact darma@sandia.gov
+//
+// *****************************************************************************
+//@HEADER
+*/
+
+#include "checkpoint/common.h"
+#include "checkpoint/buffer/member_table.h"
+#include "checkpoint/buffer/parallel_for.h"
+
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+
+namespace checkpoint { namespace buffer {
+
+namespace {
+
+std::runtime_error corruptTable(char const* what) {
+  return std::runtime_error(
+    std::string("Corrupt member offset table: ") + what
+  );
+}
+
+} /* end anon namespace */
+
+void MemberTable::add(
+  char const* name, SerialSizeType index, SerialSizeType offset,
+  SerialSizeType size
+) {
+  // Elements of one container share a name, so the last one is checked first
+  uint64_t id = 0;
+  if (not names_.empty() and names_.back() == name) {
+    id = names_.size() - 1;
+  } else {
+    auto const it = ids_.emplace(name, names_.size());
+    if (it.second) {
+      names_.emplace_back(name);
+    }
+    id = it.first->second;
+  }
+
+  MemberEntry e;
+  e.name = id;
+  e.index = index;
+  e.offset = offset;
+  e.size = size;
+  entries_.push_back(e);
+}
+
+MemberEntry const* MemberTable::find(
+  std::string const& name, SerialSizeType index
+) const {
+  auto const it = ids_.find(name);
+  if (it == ids_.end()) {
+    return nullptr;
+  }
+  for (auto const& e : entries_) {
+    if (e.name == it->second and e.index == index) {
+      return &e;
+    }
+  }
+  return nullptr;
+}
+
+std::vector<SerialByteType> MemberTable::encode(
+  SerialSizeType image_size
+) const {
+  SerialSizeType names_size = 0;
+  for (auto const& name : names_) {
+    names_size += sizeof(uint64_t) + name.size();
+  }
+
+  MemberTableFooter f;
+  f.image_size = image_size;
+  f.num_names = names_.size();
+  f.num_entries = entries_.size();
+  f.table_size =
+    names_size + entries_.size() * sizeof(MemberEntry) + sizeof(f);
+
+  std::vector<SerialByteType> bytes(f.table_size);
+  auto out = bytes.data();
+  for (auto const& name : names_) {
+    uint64_t const len = name.size();
+    std::memcpy(out, &len, sizeof(len));
+    std::memcpy(out + sizeof(len), name.data(), len);
+    out += sizeof(len) + len;
+  }
+  std::memcpy(out, entries_.data(), entries_.size() * sizeof(MemberEntry));
+  out += entries_.size() * sizeof(MemberEntry);
+  std::memcpy(out, &f, sizeof(f));
+  return bytes;
+}
+
+/*static*/ MemberTable MemberTable::decode(
+  SerialByteType const* bytes, SerialSizeType len, SerialSizeType& image_size
+) {
+  MemberTableFooter f;
+  if (len < sizeof(f)) {
+    throw std::runtime_error("No member offset table found");
+  }
+  std::memcpy(&f, bytes + len - sizeof(f), sizeof(f));
+  if (f.magic != member_table_magic) {
+    throw std::runtime_error("No member offset table found");
+  }
+  if (f.version != member_table_version) {
+    throw corruptTable("unsupported version");
+  }
+  if (f.table_size < sizeof(f) or f.table_size > len or
+      f.image_size != len - f.table_size) {
+    throw corruptTable("inconsistent size");
+  }
+
+  MemberTable table;
+  SerialSizeType pos = f.image_size;
+  SerialSizeType const end = len - sizeof(f);
+
+  for (uint64_t i = 0; i < f.num_names; i++) {
+    uint64_t name_len = 0;
+    if (end - pos < sizeof(name_len)) {
+      throw corruptTable("truncated names");
+    }
+    std::memcpy(&name_len, bytes + pos, sizeof(name_len));
+    pos += sizeof(name_len);
+    if (name_len > end - pos) {
+      throw corruptTable("truncated names");
+    }
+    std::string name(bytes + pos, name_len);
+    pos += name_len;
+    if (not table.ids_.emplace(name, i).second) {
+      throw corruptTable("duplicate name");
+    }
+    table.names_.push_back(std::move(name));
+  }
+
+  if (f.num_entries > (end - pos) / sizeof(MemberEntry) or
+      f.num_entries * sizeof(MemberEntry) != end - pos) {
+    throw corruptTable("truncated entries");
+  }
+  table.entries_.resize(f.num_entries);
+  std::memcpy(
+    table.entries_.data(), bytes + pos, f.num_entries * sizeof(MemberEntry)
+  );
+
+  for (auto const& e : table.entries_) {
+    if (e.name >= f.num_names or e.offset > f.image_size or
+        e.size > f.image_size - e.offset) {
+      throw corruptTable("entry out of range");
+    }
+  }
+
+  image_size = f.image_size;
+  return table;
+}
+
+MemberTableReader::MemberTableReader(
+  std::string const& file, FileReadOptions const& options
+) : file_(file),
+    options_(options)
+{
+  // The trailer is handled here, so only the chunks that are used are read
+  FileReadOptions map_options;
+  map_options.checksum = ChecksumVerify::Skip;
+  buffer_ = std::make_unique<IOBuffer>(
+    IOBuffer::ReadFromFileTag{}, file_, map_options
+  );
+
+  auto const bytes = buffer_->getBuffer();
+  auto payload = buffer_->getSize();
+
+  if (options_.checksum != ChecksumVerify::Skip) {
+    try {
+      verify_ = readChecksumFooter(bytes, payload, options_.checksum, footer_);
+    } catch (checksum_error const& err) {
+      throw checksum_error(std::string(err.what()) + ": file=" + file_);
+    }
+    if (verify_) {
+      payload = footer_.payload_size;
+      verified_.assign(footer_.num_chunks, false);
+    }
+  }
+
+  // Verify the table footer, then the rest of the table, before decoding it
+  if (verify_ and payload >= sizeof(MemberTableFooter)) {
+    verify(payload - sizeof(MemberTableFooter), payload);
+    MemberTableFooter f;
+    std::memcpy(&f, bytes + payload - sizeof(f), sizeof(f));
+    verify(payload - std::min<SerialSizeType>(f.table_size, payload), payload);
+  }
+
+  try {
+    table_ = MemberTable::decode(bytes, payload, image_size_);
+  } catch (std::runtime_error const& err) {
+    throw std::runtime_error(std::string(err.what()) + ": file=" + file_);
+  }
+}
+
+MemberEntry const& MemberTableReader::lookup(
+  std::string const& name, SerialSizeType index
+) {
+  auto const e = table_.find(name, index);
+  if (e == nullptr) {
+    throw std::runtime_error(
+      "No member \"" + name + "\" with index " + std::to_string(index) +
+      " in the offset table: file=" + file_
+    );
+  }
+  verify(e->offset, e->offset + e->size);
+  return *e;
+}
+
+void MemberTableReader::verify(SerialSizeType begin, SerialSizeType end) {
+  if (not verify_ or begin >= end) {
+    return;
+  }
+
+  std::vector<SerialSizeType> chunks;
+  auto const first = begin / footer_.chunk_size;
+  auto const last = (end - 1) / footer_.chunk_size;
+  for (auto c = first; c <= last; c++) {
+    if (not verified_[c]) {
+      chunks.push_back(c);
+    }
+  }
+
+  try {
+    auto const bytes = buffer_->getBuffer();
+    auto const threads = options_.checksum_threads;
+    parallelFor(chunks.size(), threads, [&](SerialSizeType i) {
+      verifyChecksumChunk(bytes, footer_, chunks[i]);
+    });
+  } catch (checksum_error const& err) {
+    throw checksum_error(std::string(err.what()) + ": file=" + file_);
+  }
+
+  for (auto const c : chunks) {
+    verified_[c] = true;
+  }
+}
+
+}} /* end namespace checkpoint::buffer */
@@ -0,0 +1,232 @@
+/*
+//@HEADER
+// *****************************************************************************
+//
+//                                member_table.h
+//                 DARMA/magistrate => Serialization Library
+//
+// Copyright 2019 National Technology & Engineering Solutions of Sandia, LLC
+// (NTESS). Under the terms of Contract DE-NA0003525 with NTESS, the U.S.
+// Government retains certain rights in this software.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+//
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// * Neither the name of the copyright holder nor the names of its
+//   contributors may be used to endorse or promote products derived from this
+//   software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// Questions? Contact darma@sandia.gov
+//
+// *****************************************************************************
+//@HEADER
+*/
+
+#if !defined INCLUDED_SRC_CHECKPOINT_BUFFER_MEMBER_TABLE_H
+#define INCLUDED_SRC_CHECKPOINT_BUFFER_MEMBER_TABLE_H
+
+#include "checkpoint/common.h"
+#include "checkpoint/buffer/io_options.h"
+#include "checkpoint/buffer/io_buffer.h"
+#include "checkpoint/buffer/checksum.h"
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace checkpoint { namespace buffer {
+
+/*
+ * An indexed file holds the packed image followed by a member offset table
+ * (and then the checksum trailer, if any, covering both):
+ *
+ *   packed image (image_size bytes)
+ *   for each name: uint64_t length, then the characters
+ *   MemberEntry for each recorded member or element
+ *   MemberTableFooter
+ *
+ * The image is exactly what \c serializeToFile writes, so the whole object
+ * can still be read with \c deserializeFromFile.
+ */
+
+/// "MGT1" read as a little-endian integer
+static constexpr uint32_t const member_table_magic = 0x3154474d;
+
+static constexpr uint32_t const member_table_version = 1;
+
+struct MemberEntry {
+  uint64_t name = 0;   /**< Index into the table's names */
+  uint64_t index = 0;  /**< Element index; zero for a single member */
+  uint64_t offset = 0; /**< Start of the member in the packed image */
+  uint64_t size = 0;   /**< Packed bytes of the member */
+};
+
+struct MemberTableFooter {
+  uint64_t image_size = 0;
+  uint64_t num_names = 0;
+  uint64_t num_entries = 0;
+  uint64_t table_size = 0; /**< Bytes of the table, including this footer */
+  uint32_t magic = member_table_magic;
+  uint32_t version = member_table_version;
+};
+
+/**
+ * \struct MemberTable
+ *
+ * \brief The byte offsets of the members and elements recorded while sizing
+ * an object, keyed by name and element index
+ */
+struct MemberTable {
+  /**
+   * \brief Record a member
+   *
+   * \param[in] name the name of the member
+   * \param[in] index the element index, zero for a single member
+   * \param[in] offset the start of the member in the packed image
+   * \param[in] size the packed bytes of the member
+   */
+  void add(
+    char const* name, SerialSizeType index, SerialSizeType offset,
+    SerialSizeType size
+  );
+
+  /**
+   * \brief Find a member; if a name was recorded more than once with the same
+   * index, the first one is found
+   *
+   * \param[in] name the name of the member
+   * \param[in] index the element index
+   *
+   * \return the entry, or \c nullptr if there is none
+   */
+  MemberEntry const* find(std::string const& name, SerialSizeType index) const;
+
+  /**
+   * \brief Get the distinct names recorded, in the order first seen
+   *
+   * \return the names
+   */
+  std::vector<std::string> const& getNames() const { return names_; }
+
+  /**
+   * \brief Get the recorded entries, in traversal order
+   *
+   * \return the entries
+   */
+  std::vector<MemberEntry> const& getEntries() const { return entries_; }
+
+  /**
+   * \brief Encode the table and its footer to follow an image
+   *
+   * \param[in] image_size the size of the packed image
+   *
+   * \return the bytes to write after the image
+   */
+  std::vector<SerialByteType> encode(SerialSizeType image_size) const;
+
+  /**
+   * \brief Decode the table at the end of \c bytes; throws
+   * \c std::runtime_error if there is none or it is inconsistent
+   *
+   * \param[in] bytes the image followed by the table
+   * \param[in] len the total number of bytes
+   * \param[out] image_size the size of the packed image
+   *
+   * \return the table
+   */
+  static MemberTable decode(
+    SerialByteType const* bytes, SerialSizeType len, SerialSizeType& image_size
+  );
+
+private:
+  std::vector<std::string> names_;
+  std::unordered_map<std::string, uint64_t> ids_;
+  std::vector<MemberEntry> entries_;
+};
+
+/**
+ * \struct MemberTableReader
+ *
+ * \brief Maps an indexed file and looks up members in its offset table
+ *
+ * Only the table and the members asked for are read. If the file has a
+ * checksum trailer and \c options.checksum is not \c ChecksumVerify::Skip,
+ * the chunks holding the table are verified when the file is opened and the
+ * chunks holding a member when it is looked up. The read strategy in
+ * \c options is not used: pages are faulted in on demand.
+ */
+struct MemberTableReader {
+  MemberTableReader(
+    std::string const& file, FileReadOptions const& options = FileReadOptions{}
+  );
+
+  /**
+   * \brief Find a member and verify its bytes; throws \c std::runtime_error
+   * if it is not in the table
+   *
+   * \param[in] name the name of the member
+   * \param[in] index the element index
+   *
+   * \return the entry
+   */
+  MemberEntry const& lookup(std::string const& name, SerialSizeType index);
+
+  /**
+   * \brief Get the packed image
+   *
+   * \return the start of the image
+   */
+  SerialByteType* getImage() const { return buffer_->getBuffer(); }
+
+  /**
+   * \brief Get the size of the packed image
+   *
+   * \return the size
+   */
+  SerialSizeType getImageSize() const { return image_size_; }
+
+  /**
+   * \brief Get the offset table
+   *
+   * \return the table
+   */
+  MemberTable const& getTable() const { return table_; }
+
+private:
+  void verify(SerialSizeType begin, SerialSizeType end);
+
+private:
+  std::string file_;
+  FileReadOptions options_ = {};
+  std::unique_ptr<IOBuffer> buffer_ = nullptr;
+  bool verify_ = false;     /**< Whether chunks are verified */
+  ChecksumFooter footer_ = {};
+  std::vector<bool> verified_; /**< Chunks verified so far */
+  SerialSizeType image_size_ = 0;
+  MemberTable table_;
+};
+
+}} /* end namespace checkpoint::buffer */
+
+#endif /*INCLUDED_SRC_CHECKPOINT_BUFFER_MEMBER_TABLE_H*/
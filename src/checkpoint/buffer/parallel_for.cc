@@ -0,0 +1,176 @@
+/*
+//@HEADER
+// *****************************************************************************
+//
+//                               parallel_for.cc
+//                 DARMA/magistrate => Serialization Library
+//
+// Copyright 2019 National Technology & Engineering Solutions of Sandia, LLC
+// (NTESS). Under the terms of Contract DE-NA0003525 with NTESS, the U.S.
+// Government retains certain rights in this software.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+//
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// * Neither the name of the copyright holder nor the names of its
+//   contributors may be used to endorse or promote products derived from this
+//   software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// Questions? Contact darma@sandia.gov
+//
+// *****************************************************************************
+//@HEADER
+*/
+
+#include "checkpoint/common.h"
+#include "checkpoint/buffer/parallel_for.h"
+
+#include <algorithm>
+#include <atomic>
+#include <exception>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace checkpoint { namespace buffer {
+
+struct ThreadPool::Job {
+  std::function<void(SerialSizeType)> const* fn = nullptr;
+  SerialSizeType n = 0;
+  std::atomic<SerialSizeType> next = {0};
+  unsigned helpers_wanted = 0; /**< Workers still to join; pool mutex */
+  unsigned active = 0;         /**< Workers running the body; pool mutex */
+  std::condition_variable done;
+  std::exception_ptr error = nullptr;
+  std::mutex error_mutex;
+
+  void execute() {
+    SerialSizeType i;
+    while ((i = next.fetch_add(1)) < n) {
+      try {
+        (*fn)(i);
+      } catch (...) {
+        std::lock_guard<std::mutex> lock(error_mutex);
+        if (error == nullptr) {
+          error = std::current_exception();
+        }
+      }
+    }
+  }
+};
+
+ThreadPool::~ThreadPool() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stop_ = true;
+  }
+  cv_.notify_all();
+  for (auto& worker : workers_) {
+    worker.join();
+  }
+}
+
+/*static*/ ThreadPool& ThreadPool::global() {
+  static ThreadPool pool;
+  return pool;
+}
+
+std::size_t ThreadPool::getNumWorkers() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return workers_.size();
+}
+
+void ThreadPool::work() {
+  std::unique_lock<std::mutex> lock(mutex_);
+  for (;;) {
+    cv_.wait(lock, [this]{ return stop_ or not jobs_.empty(); });
+    if (stop_) {
+      return;
+    }
+
+    auto job = jobs_.front();
+    if (--job->helpers_wanted == 0) {
+      jobs_.pop_front();
+    }
+    job->active++;
+
+    lock.unlock();
+    job->execute();
+    lock.lock();
+
+    if (--job->active == 0) {
+      job->done.notify_all();
+    }
+  }
+}
+
+void ThreadPool::run(
+  SerialSizeType n, unsigned num_threads,
+  std::function<void(SerialSizeType)> const& fn
+) {
+  auto const threads = std::min<SerialSizeType>(num_threads, n);
+  if (threads <= 1) {
+    for (SerialSizeType i = 0; i < n; i++) {
+      fn(i);
+    }
+    return;
+  }
+
+  auto job = std::make_shared<Job>();
+  job->fn = &fn;
+  job->n = n;
+  job->helpers_wanted = static_cast<unsigned>(threads - 1);
+
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    while (workers_.size() < threads - 1) {
+      workers_.emplace_back([this]{ work(); });
+    }
+    jobs_.push_back(job);
+  }
+  cv_.notify_all();
+
+  // The caller works too, so the job finishes even if every worker is busy
+  job->execute();
+
+  {
+    std::unique_lock<std::mutex> lock(mutex_);
+    auto it = std::find(jobs_.begin(), jobs_.end(), job);
+    if (it != jobs_.end()) {
+      jobs_.erase(it);
+    }
+    job->done.wait(lock, [&]{ return job->active == 0; });
+  }
+
+  if (job->error != nullptr) {
+    std::rethrow_exception(job->error);
+  }
+}
+
+void parallelFor(
+  SerialSizeType n, unsigned num_threads,
+  std::function<void(SerialSizeType)> const& fn
+) {
+  ThreadPool::global().run(n, num_threads, fn);
+}
+
+}} /* end namespace checkpoint::buffer */
@@ -0,0 +1,134 @@
+/*
+//@HEADER
+// *****************************************************************************
+//
+//                                parallel_for.h
+//                 DARMA/magistrate => Serialization Library
+//
+// Copyright 2019 National Technology & Engineering Solutions of Sandia, LLC
+// (NTESS). Under the terms of Contract DE-NA0003525 with NTESS, the U.S.
+// Government retains certain rights in this software.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+//
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// * Neither the name of the copyright holder nor the names of its
+//   contributors may be used to endorse or promote products derived from this
+//   software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// Questions? Contact darma@sandia.gov
+//
+// *****************************************************************************
+//@HEADER
+*/
+
+#if !defined INCLUDED_SRC_CHECKPOINT_BUFFER_PARALLEL_FOR_H
+#define INCLUDED_SRC_CHECKPOINT_BUFFER_PARALLEL_FOR_H
+
+#include "checkpoint/common.h"
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace checkpoint { namespace buffer {
+
+/**
+ * \struct ThreadPool
+ *
+ * \brief Worker threads that are started once and reused by \c parallelFor
+ *
+ * Workers are added on demand, up to the largest number of helpers any call
+ * has asked for, and live until the pool is destroyed. Every call also runs
+ * its body on the calling thread and never waits for a worker to become free,
+ * so calls may be made concurrently and from inside a body.
+ */
+struct ThreadPool {
+  ThreadPool() = default;
+  ThreadPool(ThreadPool const&) = delete;
+  ThreadPool& operator=(ThreadPool const&) = delete;
+  ~ThreadPool();
+
+  /**
+   * \brief Get the pool shared by the library
+   *
+   * \return the pool
+   */
+  static ThreadPool& global();
+
+  /**
+   * \brief Run \c fn(i) for every i in [0, n) on up to \c num_threads threads
+   * (see \c parallelFor)
+   *
+   * \param[in] n the number of indices
+   * \param[in] num_threads the maximum number of threads to use
+   * \param[in] fn the body
+   */
+  void run(
+    SerialSizeType n, unsigned num_threads,
+    std::function<void(SerialSizeType)> const& fn
+  );
+
+  /**
+   * \brief Get the number of worker threads started so far
+   *
+   * \return the number of workers
+   */
+  std::size_t getNumWorkers() const;
+
+private:
+  struct Job;
+
+  void work();
+
+  mutable std::mutex mutex_;
+  std::condition_variable cv_;
+  std::deque<std::shared_ptr<Job>> jobs_;
+  std::vector<std::thread> workers_;
+  bool stop_ = false;
+};
+
+/**
+ * \brief Run \c fn(i) for every i in [0, n) on up to \c num_threads threads
+ * (including the calling thread), returning once all calls complete
+ *
+ * Indices are handed out dynamically, so calls of uneven cost balance across
+ * threads. If any call throws, the first exception is rethrown after all
+ * threads have finished with the body. The helper threads come from
+ * \c ThreadPool::global().
+ *
+ * \param[in] n the number of indices
+ * \param[in] num_threads the maximum number of threads to use
+ * \param[in] fn the body
+ */
+void parallelFor(
+  SerialSizeType n, unsigned num_threads,
+  std::function<void(SerialSizeType)> const& fn
+);
+
+}} /* end namespace checkpoint::buffer */
+
+#endif /*INCLUDED_SRC_CHECKPOINT_BUFFER_PARALLEL_FOR_H*/
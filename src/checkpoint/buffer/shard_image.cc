@@ -0,0 +1,232 @@
+/*
+//@HEADER
+// *****************************************************************************
+//
+//                                shard_image.cc
+//                 DARMA/magistrate => Serialization Library
+//
+// Copyright 2019 National Technology & Engineering Solutions of Sandia, LLC
+// (NTESS). Under the terms of Contract DE-NA0003525 with NTESS, the U.S.
+// Government retains certain rights in this software.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+//
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// * Neither the name of the copyright holder nor the names of its
+//   contributors may be used to endorse or promote products derived from this
+//   software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// Questions? Contact darma@sandia.gov
+//
+// *****************************************************************************
+//@HEADER
+*/
+
+#include "checkpoint/common.h"
+#include "checkpoint/buffer/shard_image.h"
+#include "checkpoint/buffer/io_buffer.h"
+#include "checkpoint/buffer/parallel_for.h"
+#include "checkpoint/serializers/file_packer.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace checkpoint { namespace buffer {
+
+namespace {
+
+/// Shard boundaries are multiples of this many bytes
+constexpr SerialSizeType const shard_alignment = 4096;
+
+/// Most shards accepted when reading a manifest
+constexpr uint64_t const max_shards = 1ull << 20;
+
+std::runtime_error corruptImage(
+  std::string const& dir, std::string const& what
+) {
+  return std::runtime_error("Corrupt sharded image dir=" + dir + ": " + what);
+}
+
+void makeDirectory(std::string const& dir) {
+  if (mkdir(dir.c_str(), 0700) != 0 and errno != EEXIST) {
+    auto err = std::string("Failed to create directory=") + dir + ": errno=" +
+               std::to_string(errno) + ": " + strerror(errno);
+    throw std::runtime_error(err);
+  }
+}
+
+void removeFile(std::string const& file) {
+  if (unlink(file.c_str()) != 0 and errno != ENOENT) {
+    auto err = std::string("Failed to remove file=") + file + ": errno=" +
+               std::to_string(errno) + ": " + strerror(errno);
+    throw std::runtime_error(err);
+  }
+}
+
+/// Split \c len bytes into \c num_shards page-aligned consecutive pieces
+std::vector<uint64_t> shardSizes(SerialSizeType len, unsigned num_shards) {
+  auto const per_shard = (len + num_shards - 1) / num_shards;
+  auto const aligned =
+    (per_shard + shard_alignment - 1) / shard_alignment * shard_alignment;
+
+  std::vector<uint64_t> sizes(num_shards);
+  SerialSizeType offset = 0;
+  for (auto& size : sizes) {
+    size = std::min(aligned, len - offset);
+    offset += size;
+  }
+  return sizes;
+}
+
+} /* end anon namespace */
+
+std::string getShardManifestFile(std::string const& dir) {
+  return dir + "/manifest";
+}
+
+std::string getShardFile(std::string const& dir, SerialSizeType shard) {
+  return dir + "/shard." + std::to_string(shard);
+}
+
+void writeShardedImage(
+  SerialByteType const* bytes, SerialSizeType len, std::string const& dir,
+  unsigned num_shards, FileWriteOptions const& options
+) {
+  if (num_shards == 0) {
+    throw std::runtime_error("Number of shards must be non-zero");
+  }
+
+  makeDirectory(dir);
+
+  // Until the new manifest is written, the directory holds no valid image
+  auto const manifest = getShardManifestFile(dir);
+  removeFile(manifest);
+
+  auto const sizes = shardSizes(len, num_shards);
+  std::vector<SerialSizeType> offsets(num_shards, 0);
+  for (unsigned i = 1; i < num_shards; i++) {
+    offsets[i] = offsets[i - 1] + sizes[i - 1];
+  }
+
+  parallelFor(num_shards, num_shards, [&](SerialSizeType i) {
+    FilePacker packer(sizes[i], getShardFile(dir, i), options);
+    packer.contiguousBytes(
+      const_cast<SerialByteType*>(bytes + offsets[i]), 1, sizes[i]
+    );
+    packer.closeFile();
+  });
+
+  // Shards past the new count belong to an earlier, larger write
+  for (auto i = num_shards; ; i++) {
+    auto const stale = getShardFile(dir, i);
+    if (access(stale.c_str(), F_OK) != 0) {
+      break;
+    }
+    removeFile(stale);
+  }
+
+  ShardManifestHeader h;
+  h.image_size = len;
+  h.num_shards = num_shards;
+
+  FilePacker packer(
+    sizeof(h) + sizes.size() * sizeof(uint64_t), manifest, options
+  );
+  packer.contiguousBytes(&h, sizeof(h), 1);
+  packer.contiguousBytes(
+    const_cast<uint64_t*>(sizes.data()), sizeof(uint64_t), sizes.size()
+  );
+  packer.closeFile();
+}
+
+std::unique_ptr<ManagedBuffer> readShardedImage(
+  std::string const& dir, unsigned num_threads, FileReadOptions const& options
+) {
+  ShardManifestHeader h;
+  std::vector<uint64_t> sizes;
+
+  {
+    auto const manifest = getShardManifestFile(dir);
+    IOBuffer in(IOBuffer::ReadFromFileTag{}, manifest, options);
+    auto const bytes = in.getBuffer();
+    auto const len = in.getSize();
+    in.advanceCursor(len);
+
+    if (len < sizeof(h)) {
+      throw corruptImage(dir, "truncated manifest");
+    }
+    std::memcpy(&h, bytes, sizeof(h));
+    if (h.magic != shard_magic or h.version != shard_version) {
+      throw corruptImage(dir, "not a shard manifest");
+    }
+    if (h.num_shards == 0 or h.num_shards > max_shards or
+        h.num_shards * sizeof(uint64_t) != len - sizeof(h)) {
+      throw corruptImage(dir, "bad number of shards");
+    }
+    sizes.resize(h.num_shards);
+    std::memcpy(
+      sizes.data(), bytes + sizeof(h), h.num_shards * sizeof(uint64_t)
+    );
+  }
+
+  std::vector<SerialSizeType> offsets(h.num_shards, 0);
+  SerialSizeType total = 0;
+  for (SerialSizeType i = 0; i < h.num_shards; i++) {
+    if (sizes[i] > h.image_size - total) {
+      throw corruptImage(dir, "shards exceed the image size");
+    }
+    offsets[i] = total;
+    total += sizes[i];
+  }
+  if (total != h.image_size) {
+    throw corruptImage(dir, "shards do not cover the image");
+  }
+
+  auto image = std::make_unique<ManagedBuffer>(h.image_size);
+  auto const out = image->getBuffer();
+  auto const threads =
+    num_threads == 0 ? static_cast<unsigned>(h.num_shards) : num_threads;
+
+  parallelFor(h.num_shards, threads, [&](SerialSizeType i) {
+    if (sizes[i] == 0) {
+      return;
+    }
+    auto const file = getShardFile(dir, i);
+    IOBuffer in(IOBuffer::ReadFromFileTag{}, file, options);
+    if (in.getSize() != sizes[i]) {
+      throw corruptImage(dir, "wrong size of shard file=" + file);
+    }
+    in.advanceCursor(sizes[i]);
+    std::memcpy(out + offsets[i], in.getBuffer(), sizes[i]);
+  });
+
+  return image;
+}
+
+}} /* end namespace checkpoint::buffer */
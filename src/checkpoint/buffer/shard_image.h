@@ -0,0 +1,143 @@
+/*
+//@HEADER
+// *****************************************************************************
+//
+//                                shard_image.h
+//                 DARMA/magistrate => Serialization Library
+//
+// Copyright 2019 National Technology & Engineering Solutions of Sandia, LLC
+// (NTESS). Under the terms of Contract DE-NA0003525 with NTESS, the U.S.
+// Government retains certain rights in this software.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+//
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// * Neither the name of the copyright holder nor the names of its
+//   contributors may be used to endorse or promote products derived from this
+//   software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// Questions? Contact darma@sandia.gov
+//
+// *****************************************************************************
+//@HEADER
+*/
+
+#if !defined INCLUDED_SRC_CHECKPOINT_BUFFER_SHARD_IMAGE_H
+#define INCLUDED_SRC_CHECKPOINT_BUFFER_SHARD_IMAGE_H
+
+#include "checkpoint/common.h"
+#include "checkpoint/buffer/io_options.h"
+#include "checkpoint/buffer/managed_buffer.h"
+
+#include <cstdint>
+#include <memory>
+#include <string>
+
+namespace checkpoint { namespace buffer {
+
+/*
+ * A sharded image is a directory holding the packed bytes cut into
+ * consecutive pieces, one per shard file, and a manifest laid out as:
+ *
+ *   ShardManifestHeader
+ *   uint64_t size of each shard, in order
+ *
+ * Concatenating the shards gives exactly the bytes written by
+ * \c serializeToFile, so the image may be read back with any number of
+ * threads regardless of how many shards it was written with. The manifest is
+ * removed before the shards are written and recreated after all of them are,
+ * so a directory whose write was interrupted has no manifest.
+ */
+
+/// "MGS1" read as a little-endian integer
+static constexpr uint32_t const shard_magic = 0x3153474d;
+
+static constexpr uint32_t const shard_version = 1;
+
+struct ShardManifestHeader {
+  uint32_t magic = shard_magic;
+  uint32_t version = shard_version;
+  uint64_t image_size = 0; /**< Bytes in the full image */
+  uint64_t num_shards = 0;
+};
+
+/**
+ * \brief Get the name of the manifest of the sharded image in \c dir
+ *
+ * \param[in] dir the directory
+ *
+ * \return the file name
+ */
+std::string getShardManifestFile(std::string const& dir);
+
+/**
+ * \brief Get the name of a shard of the sharded image in \c dir
+ *
+ * \param[in] dir the directory
+ * \param[in] shard the index of the shard
+ *
+ * \return the file name
+ */
+std::string getShardFile(std::string const& dir, SerialSizeType shard);
+
+/**
+ * \brief Write \c bytes to \c dir as \c num_shards shard files and a manifest
+ *
+ * The shards are written concurrently, one thread per shard, each through its
+ * own \c FilePacker; the durability and checksum settings in \c options apply
+ * to every shard and to the manifest. Shard boundaries are page aligned, so
+ * trailing shards of a small image may be empty. \c dir is created if it does
+ * not exist, and shards left over from an earlier write with more shards are
+ * removed.
+ *
+ * \param[in] bytes the packed image
+ * \param[in] len the image size
+ * \param[in] dir the directory to write
+ * \param[in] num_shards the number of shard files, at least one
+ * \param[in] options the write options
+ */
+void writeShardedImage(
+  SerialByteType const* bytes, SerialSizeType len, std::string const& dir,
+  unsigned num_shards, FileWriteOptions const& options = FileWriteOptions{}
+);
+
+/**
+ * \brief Read the sharded image in \c dir into a single buffer, mapping and
+ * copying the shards concurrently. Checksum trailers are verified according
+ * to \c options; a missing or inconsistent manifest or shard throws
+ * \c std::runtime_error.
+ *
+ * \param[in] dir the directory
+ * \param[in] num_threads the number of shards read at once, or zero for one
+ * thread per shard
+ * \param[in] options how each file is read
+ *
+ * \return the full image
+ */
+std::unique_ptr<ManagedBuffer> readShardedImage(
+  std::string const& dir, unsigned num_threads = 0,
+  FileReadOptions const& options = FileReadOptions{}
+);
+
+}} /* end namespace checkpoint::buffer */
+
+#endif /*INCLUDED_SRC_CHECKPOINT_BUFFER_SHARD_IMAGE_H*/
@@ -0,0 +1,236 @@
+/*
+//@HEADER
+// *****************************************************************************
+//
+//                                   varint.h
+//                 DARMA/magistrate => Serialization Library
+//
+// Copyright 2019 National Technology & Engineering Solutions of Sandia, LLC
+// (NTESS). Under the terms of Contract DE-NA0003525 with NTESS, the U.S.
+// Government retains certain rights in this software.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+//
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// * Neither the name of the copyright holder nor the names of its
+//   contributors may be used to endorse or promote products derived from this
+//   software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// Questions? Contact darma@sandia.gov
+//
+// *****************************************************************************
+//@HEADER
+*/
+
+#if !defined INCLUDED_SRC_CHECKPOINT_BUFFER_VARINT_H
+#define INCLUDED_SRC_CHECKPOINT_BUFFER_VARINT_H
+
+#include "checkpoint/common.h"
+#include "checkpoint/buffer/byte_order.h"
+
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <stdexcept>
+#include <type_traits>
+
+namespace checkpoint { namespace buffer {
+
+/*
+ * Varints are unsigned LEB128: seven bits per byte, least significant group
+ * first, with the high bit of every byte but the last set. Signed values are
+ * zigzag-mapped first (0, -1, 1, -2, ... => 0, 1, 2, 3, ...) so that small
+ * negative values stay short.
+ */
+
+/// Most bytes taken by the varint of a 64-bit value
+static constexpr SerialSizeType const max_varint_size = 10;
+
+/**
+ * \struct IsVarintType
+ *
+ * \brief Whether values of \c T may be written as varints: integers wider than
+ * a byte, excluding \c bool and character types
+ */
+template <typename T, typename U = std::remove_cv_t<T>>
+struct IsVarintType : std::integral_constant<
+  bool,
+  std::is_integral<U>::value and
+  (sizeof(U) == 2 or sizeof(U) == 4 or sizeof(U) == 8) and
+  not std::is_same<U, wchar_t>::value and
+  not std::is_same<U, char16_t>::value and
+  not std::is_same<U, char32_t>::value
+> { };
+
+/**
+ * \brief Map \c val to the unsigned value encoded for it
+ *
+ * \param[in] val the value
+ *
+ * \return \c val, zigzag-mapped if \c T is signed
+ */
+template <typename T>
+inline uint64_t toVarint(T val) {
+  if constexpr (std::is_signed<T>::value) {
+    auto const v = static_cast<int64_t>(val);
+    return (static_cast<uint64_t>(v) << 1) ^ static_cast<uint64_t>(v >> 63);
+  } else {
+    return static_cast<uint64_t>(val);
+  }
+}
+
+/**
+ * \brief Map a decoded varint back to a \c T
+ *
+ * Throws \c std::runtime_error if the value does not fit in a \c T.
+ *
+ * \param[in] v the decoded value
+ *
+ * \return the value of \c T
+ */
+template <typename T>
+inline T fromVarint(uint64_t v) {
+  using UnsignedT = std::make_unsigned_t<T>;
+  if constexpr (sizeof(T) < sizeof(uint64_t)) {
+    if (v > std::numeric_limits<UnsignedT>::max()) {
+      throw std::runtime_error("Corrupt varint: value out of range");
+    }
+  }
+  if constexpr (std::is_signed<T>::value) {
+    auto const u = static_cast<UnsignedT>(v);
+    return static_cast<T>(
+      static_cast<UnsignedT>(u >> 1) ^ static_cast<UnsignedT>(-(u & 1))
+    );
+  } else {
+    return static_cast<T>(v);
+  }
+}
+
+/**
+ * \brief Get the number of bytes in the varint of \c v
+ *
+ * \param[in] v the value
+ *
+ * \return the number of bytes, between 1 and \c max_varint_size
+ */
+inline SerialSizeType varintSize(uint64_t v) {
+  auto const bits = 64 - __builtin_clzll(v | 1);
+  return (bits + 6) / 7;
+}
+
+/**
+ * \brief Encode \c v
+ *
+ * \param[in] v the value
+ * \param[out] out space for \c varintSize(v) bytes
+ *
+ * \return the number of bytes written
+ */
+inline SerialSizeType encodeVarint(uint64_t v, SerialByteType* out) {
+  SerialSizeType n = 0;
+  while (v >= 0x80) {
+    out[n++] = static_cast<SerialByteType>(v | 0x80);
+    v >>= 7;
+  }
+  out[n++] = static_cast<SerialByteType>(v);
+  return n;
+}
+
+/**
+ * \brief Decode a varint one byte at a time
+ *
+ * Throws \c std::runtime_error if the varint is longer than \c avail bytes or
+ * does not fit in 64 bits.
+ *
+ * \param[in] in the encoded bytes
+ * \param[in] avail the number of readable bytes at \c in
+ * \param[out] v the value
+ *
+ * \return the number of bytes read
+ */
+inline SerialSizeType decodeVarintSlow(
+  SerialByteType const* in, SerialSizeType avail, uint64_t& v
+) {
+  uint64_t result = 0;
+  for (SerialSizeType i = 0; i < max_varint_size; i++) {
+    if (i == avail) {
+      throw std::runtime_error("Corrupt varint: truncated");
+    }
+    auto const byte = static_cast<uint8_t>(in[i]);
+    if (i == max_varint_size - 1 and byte > 1) {
+      throw std::runtime_error("Corrupt varint: more than 64 bits");
+    }
+    result |= static_cast<uint64_t>(byte & 0x7f) << (7 * i);
+    if (byte < 0x80) {
+      v = result;
+      return i + 1;
+    }
+  }
+  throw std::runtime_error("Corrupt varint: more than 64 bits");
+}
+
+/**
+ * \brief Decode a varint
+ *
+ * Single bytes are returned directly. Otherwise, when eight bytes are
+ * readable, they are loaded as one word: the length comes from the first clear
+ * continuation bit and the seven-bit groups are packed together with three
+ * mask-and-shift steps, without a branch per byte. Longer varints (over 56
+ * bits) and the end of the buffer use \c decodeVarintSlow.
+ *
+ * \param[in] in the encoded bytes
+ * \param[in] avail the number of readable bytes at \c in
+ * \param[out] v the value
+ *
+ * \return the number of bytes read
+ */
+inline SerialSizeType decodeVarint(
+  SerialByteType const* in, SerialSizeType avail, uint64_t& v
+) {
+  // Most sizes fit in one byte; the branch keeps them off the word path
+  if (avail > 0 and static_cast<uint8_t>(in[0]) < 0x80) {
+    v = static_cast<uint8_t>(in[0]);
+    return 1;
+  }
+  if constexpr (not host_is_big_endian) {
+    if (avail >= sizeof(uint64_t)) {
+      uint64_t word = 0;
+      std::memcpy(&word, in, sizeof(word));
+      uint64_t const stops = ~word & 0x8080808080808080ull;
+      if (stops != 0) {
+        auto const bits = __builtin_ctzll(stops) + 1;
+        uint64_t x = bits == 64 ? word : word & ((1ull << bits) - 1);
+        x &= 0x7f7f7f7f7f7f7f7full;
+        x = (x & 0x007f007f007f007full) | ((x & 0x7f007f007f007f00ull) >> 1);
+        x = (x & 0x00003fff00003fffull) | ((x & 0x3fff00003fff0000ull) >> 2);
+        x = (x & 0x000000000fffffffull) | ((x & 0x0fffffff00000000ull) >> 4);
+        v = x;
+        return static_cast<SerialSizeType>(bits) / 8;
+      }
+    }
+  }
+  return decodeVarintSlow(in, avail, v);
+}
+
+}} /* end namespace checkpoint::buffer */
+
+#endif /*INCLUDED_SRC_CHECKPOINT_BUFFER_VARINT_H*/
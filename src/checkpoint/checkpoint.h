@@ -58,11 +58,13 @@
 #include "checkpoint/container/queue_serialize.h"
 #include "checkpoint/container/raw_ptr_serialize.h"
 #include "checkpoint/container/shared_ptr_serialize.h"
+#include "checkpoint/container/span_serialize.h"
 #include "checkpoint/container/string_serialize.h"
 #include "checkpoint/container/thread_serialize.h"
 #include "checkpoint/container/tuple_serialize.h"
 #include "checkpoint/container/vector_serialize.h"
 #include "checkpoint/container/unique_ptr_serialize.h"
+#include "checkpoint/container/type_grouped_serialize.h"
 #include "checkpoint/container/view_serialize.h"
 #include "checkpoint/container/variant_serialize.h"
 #include "checkpoint/container/optional_serialize.h"
@@ -74,6 +76,10 @@
 
 #include "checkpoint/checkpoint_api.h"
 #include "checkpoint/checkpoint_api.impl.h"
+#include "checkpoint/serialization_session.h"
+#include "checkpoint/delta_checkpoint.h"
+#include "checkpoint/sharded_checkpoint.h"
+#include "checkpoint/member_index.h"
 
 // Add namespace alias for the new name of the library
 namespace magistrate = checkpoint;
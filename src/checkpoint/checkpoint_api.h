@@ -44,12 +44,37 @@
 #if !defined INCLUDED_SRC_CHECKPOINT_CHECKPOINT_API_H
 #define INCLUDED_SRC_CHECKPOINT_CHECKPOINT_API_H
 
+#include "checkpoint/buffer/io_options.h"
+#include "checkpoint/buffer/codec.h"
+#include "checkpoint/serializers/stream_serializer.h"
+
 #include <cstdlib>
 #include <functional>
 #include <memory>
+#include <memory_resource>
 
 namespace checkpoint {
 
+namespace buffer {
+struct FileWriteHandle;
+struct IOVecList;
+} /* end namespace buffer */
+
+struct ParallelPackOptions;
+
+using FileWriteHandle = buffer::FileWriteHandle;
+using IOVecList = buffer::IOVecList;
+using FileWriteOptions = buffer::FileWriteOptions;
+using FileDurability = buffer::FileDurability;
+using FileBackend = buffer::FileBackend;
+using FileReadOptions = buffer::FileReadOptions;
+using FileReadStrategy = buffer::FileReadStrategy;
+using ChecksumOptions = buffer::ChecksumOptions;
+using CompactOptions = buffer::CompactOptions;
+using ChecksumVerify = buffer::ChecksumVerify;
+using CompressionOptions = buffer::CompressionOptions;
+using Codec = buffer::Codec;
+
 /// Callback for user to allocate bytes during serialization
 using BufferCallbackType = std::function<char*(std::size_t size)>;
 
@@ -81,6 +106,267 @@ using SerializedReturnType = std::unique_ptr<SerializedInfo>;
 template <typename T>
 SerializedReturnType serialize(T& target, BufferCallbackType fn = nullptr);
 
+/**
+ * \brief Serialize \c T into a byte buffer with a single traversal
+ *
+ * Unlike \c serialize, no sizing pass is run before packing. The object is
+ * packed once into a buffer that grows geometrically as bytes are written, so
+ * the underlying allocation may be larger than the size reported by the
+ * returned \c SerializedInfo. The bytes produced are identical to those of \c
+ * serialize.
+ *
+ * \param[in] target the \c T to serialize
+ * \param[in] initial_capacity (optional) number of bytes to allocate before
+ * packing starts
+ *
+ * \return a \c std::unique_ptr to a \c SerializedInfo containing the buffer
+ * with serialized data and the exact number of bytes serialized
+ */
+template <typename T>
+SerializedReturnType serializeSinglePass(
+  T& target, std::size_t initial_capacity = 4096
+);
+
+/**
+ * \brief Serialize \c T into a scatter-gather list without copying large
+ * contiguous fields
+ *
+ * Fields of at least \c threshold bytes (e.g., the data of a large
+ * \c std::vector) are referenced in place; everything else is copied into a
+ * side buffer owned by the list. The segments can be passed straight to
+ * \c writev (see \c IOVecList::writeTo). The list refers to \c target's
+ * memory, so \c target must stay alive and unmodified until the list has
+ * been consumed.
+ *
+ * \param[in] target the \c T to serialize
+ * \param[in] threshold the field size at which memory is referenced
+ *
+ * \return the segments making up the serialized bytes
+ */
+template <typename T>
+std::unique_ptr<IOVecList> serializeIOVec(
+  T& target, std::size_t threshold = 16384
+);
+
+/**
+ * \brief Serialize \c T into a compressed byte buffer
+ *
+ * The packed bytes are cut into frames that are compressed independently with
+ * the codec in \c options, followed by an index of the frames. The result is
+ * read back with \c deserializeCompressed, or decompressed frame by frame with
+ * \c buffer::FrameStreamView.
+ *
+ * \param[in] target the \c T to serialize
+ * \param[in] options codec, frame size, shuffle and thread count
+ *
+ * \return a \c std::unique_ptr to a \c SerializedInfo containing the
+ * compressed bytes
+ */
+template <typename T>
+SerializedReturnType serialize(T& target, CompressionOptions const& options);
+
+/**
+ * \brief Serialize \c T into a compact byte buffer
+ *
+ * Container sizes are written as varints and, with \c options.integers,
+ * integral fields as well (see \c CompactOptions), which shrinks buffers of
+ * many small containers or small integers. The result is read back with \c
+ * deserializeCompact and the same \c options.
+ *
+ * \param[in] target the \c T to serialize
+ * \param[in] options whether integral fields are written as varints
+ *
+ * \return a \c std::unique_ptr to a \c SerializedInfo containing the compact
+ * bytes
+ */
+template <typename T>
+SerializedReturnType serialize(T& target, CompactOptions const& options);
+
+/**
+ * \brief Serialize \c T into a byte buffer followed by a CRC32C trailer
+ *
+ * The returned bytes start with exactly the bytes produced by \c serialize, so
+ * they can be passed to \c deserialize unchanged; \c verifyChecksum checks
+ * them against the trailer. If \c options.enabled is false no trailer is
+ * added.
+ *
+ * \param[in] target the \c T to serialize
+ * \param[in] options the chunk size and number of threads for the CRCs
+ *
+ * \return a \c std::unique_ptr to a \c SerializedInfo containing the
+ * serialized bytes and the trailer
+ */
+template <typename T>
+SerializedReturnType serialize(T& target, ChecksumOptions const& options);
+
+/**
+ * \brief Verify bytes produced by \c serialize with \c ChecksumOptions
+ *
+ * Throws \c buffer::checksum_error if there is no trailer or any chunk does
+ * not match its CRC.
+ *
+ * \param[in] buf the serialized bytes followed by the trailer
+ * \param[in] size the number of bytes in \c buf, including the trailer
+ * \param[in] num_threads the number of threads verifying chunks
+ *
+ * \return the number of serialized bytes, excluding the trailer
+ */
+inline std::size_t verifyChecksum(
+  char const* buf, std::size_t size, unsigned num_threads = 1
+);
+
+/**
+ * \brief Serialize \c T into a byte buffer, sizing and packing large arrays
+ * on several threads
+ *
+ * Arrays with at least \c options.min_elements elements that are not
+ * byte-copyable are cut into chunks that are sized and packed concurrently
+ * (see \c ParallelPackOptions). The bytes are identical to \c serialize, so
+ * they are read back with \c deserialize.
+ *
+ * \param[in] target the \c T to serialize
+ * \param[in] options the number of threads and chunking of arrays
+ *
+ * \return a \c std::unique_ptr to a \c SerializedInfo containing the
+ * serialized bytes
+ */
+template <typename T>
+SerializedReturnType serialize(T& target, ParallelPackOptions const& options);
+
+/**
+ * \brief De-serialize and reify \c T from bytes packed with
+ * \c ParallelPackOptions::indexed, unpacking the chunks of indexed arrays on
+ * several threads
+ *
+ * \param[in] buf the bytes produced by \c serialize with indexed
+ * \c ParallelPackOptions
+ * \param[in] num_threads the number of chunks unpacked concurrently
+ *
+ * \return a unique pointer to the newly reified \c T
+ */
+template <typename T>
+std::unique_ptr<T> deserializeIndexed(char* buf, unsigned num_threads = 1);
+
+/**
+ * \brief Convenience function for de-serializing and reify \c T directly from
+ * the return value of \c serialize with indexed \c ParallelPackOptions
+ *
+ * \param[in] in the serialized bytes
+ * \param[in] num_threads the number of chunks unpacked concurrently
+ *
+ * \return a unique pointer to the newly reified \c T
+ */
+template <typename T>
+std::unique_ptr<T> deserializeIndexed(
+  SerializedReturnType&& in, unsigned num_threads = 1
+);
+
+/**
+ * \brief Serialize \c T into a portable byte buffer that can be read on hosts
+ * of either byte order
+ *
+ * The bytes start with a header recording the byte order of the payload, in
+ * which every arithmetic value is stored little-endian. On little-endian hosts
+ * packing costs the same as \c serialize; big-endian hosts byte-swap arrays of
+ * values with vector shuffles as they are packed. Types declared byte-copyable
+ * that are not arithmetic are copied as raw bytes and are not portable.
+ *
+ * \param[in] target the \c T to serialize
+ *
+ * \return a \c std::unique_ptr to a \c SerializedInfo containing the buffer
+ * with the header and payload
+ */
+template <typename T>
+SerializedReturnType serializePortable(T& target);
+
+/**
+ * \brief De-serialize and reify \c T from a portable byte buffer
+ *
+ * Throws \c std::runtime_error if \c buf does not start with a portable header
+ * in a byte order this version reads, or is shorter than the payload.
+ *
+ * \param[in] buf the bytes produced by \c serializePortable
+ * \param[in] size the number of bytes in \c buf
+ *
+ * \return a unique pointer to the newly reified \c T
+ */
+template <typename T>
+std::unique_ptr<T> deserializePortable(char const* buf, std::size_t size);
+
+/**
+ * \brief Convenience function for de-serializing and reify \c T directly from
+ * the return value of \c serializePortable
+ *
+ * \param[in] in the serialized bytes
+ *
+ * \return a unique pointer to the newly reified \c T
+ */
+template <typename T>
+std::unique_ptr<T> deserializePortable(SerializedReturnType&& in);
+
+/**
+ * \brief De-serialize and reify \c T from a compact byte buffer
+ *
+ * Throws \c std::runtime_error if a varint is malformed or runs past the end
+ * of \c buf.
+ *
+ * \param[in] buf the bytes produced by \c serialize with \c CompactOptions
+ * \param[in] size the number of bytes in \c buf
+ * \param[in] options the options \c buf was written with
+ *
+ * \return a unique pointer to the newly reified \c T
+ */
+template <typename T>
+std::unique_ptr<T> deserializeCompact(
+  char const* buf, std::size_t size, CompactOptions const& options = {}
+);
+
+/**
+ * \brief Convenience function for de-serializing and reify \c T directly from
+ * the return value of \c serialize with \c CompactOptions
+ *
+ * \param[in] in the serialized bytes
+ * \param[in] options the options \c in was written with
+ *
+ * \return a unique pointer to the newly reified \c T
+ */
+template <typename T>
+std::unique_ptr<T> deserializeCompact(
+  SerializedReturnType&& in, CompactOptions const& options = {}
+);
+
+/**
+ * \brief De-serialize and reify \c T from a compressed byte buffer
+ *
+ * Frames are decompressed as the unpacker reaches them; at most
+ * \c num_threads frames are held uncompressed at a time.
+ *
+ * \param[in] buf the compressed bytes produced by \c serialize with
+ * \c CompressionOptions
+ * \param[in] size the number of bytes in \c buf
+ * \param[in] num_threads the number of frames decompressed concurrently
+ *
+ * \return a unique pointer to the newly reified \c T
+ */
+template <typename T>
+std::unique_ptr<T> deserializeCompressed(
+  char const* buf, std::size_t size, unsigned num_threads = 1
+);
+
+/**
+ * \brief Convenience function for de-serializing and reify \c T directly from
+ * the return value of \c serialize with \c CompressionOptions
+ *
+ * \param[in] in the compressed bytes
+ * \param[in] num_threads the number of frames decompressed concurrently
+ *
+ * \return a unique pointer to the newly reified \c T
+ */
+template <typename T>
+std::unique_ptr<T> deserializeCompressed(
+  SerializedReturnType&& in, unsigned num_threads = 1
+);
+
 /**
  * \brief De-serialize and reify \c T from a byte buffer and corresponding \c
  * size
@@ -135,6 +421,31 @@ std::unique_ptr<T> deserialize(char* buf);
 template <typename T>
 void deserializeInPlace(char* buf, T* t);
 
+/**
+ * \brief De-serialize and reify \c T from a byte buffer into memory from
+ * \c resource, such as a \c std::pmr::monotonic_buffer_resource used as an
+ * arena
+ *
+ * \c T itself, every object reconstructed through a pointer (including
+ * virtually serialized objects) and the elements of every \c std::pmr::vector
+ * are allocated from \c resource, so a restored object graph is laid out in
+ * the order it is unpacked. Other members allocate as usual.
+ *
+ * The objects are torn down all at once by releasing the resource, without
+ * running destructors; destroying or deleting them individually frees memory
+ * that was not allocated with \c new. So this suits types whose members own
+ * nothing outside the resource: \c std::shared_ptr targets, \c std::string
+ * and containers other than \c std::pmr::vector would leak. If unpacking
+ * throws, the objects built so far are also left to the resource.
+ *
+ * \param[in] buf the buffer containing the bytes to reify \c T
+ * \param[in] resource the resource to allocate the objects from
+ *
+ * \return a pointer to the newly reified \c T, owned by \c resource
+ */
+template <typename T>
+T* deserializeToResource(char* buf, std::pmr::memory_resource* resource);
+
 /**
  * \brief Convenience function for de-serializing and reify \c T directly from \c
  * in the return value from \c serialize
@@ -146,6 +457,23 @@ void deserializeInPlace(char* buf, T* t);
 template <typename T>
 std::unique_ptr<T> deserialize(SerializedReturnType&& in);
 
+/**
+ * \brief De-serialize and reify \c T from the return value of \c serialize,
+ * letting borrowed members point into the serialized bytes
+ *
+ * Members such as \c std::string_view and \c checkpoint::span<T> are not
+ * copied out of \c in but refer to it directly. The returned pointer shares
+ * ownership of \c in, which is released when the last copy is destroyed.
+ * The other \c deserialize functions release their bytes when they return,
+ * so they throw \c serialization_error for such members.
+ *
+ * \param[in] in the buffer and size combo returned from \c serialize
+ *
+ * \return a shared pointer to \c T that keeps \c in alive
+ */
+template <typename T>
+std::shared_ptr<T> deserializeBorrowed(SerializedReturnType&& in);
+
 /**
  * \brief Get the number of bytes that \c target requires for serialization.
  *
@@ -181,11 +509,98 @@ std::size_t getMemoryFootprint(T& target, std::size_t size_offset = 0);
  * will be thrown with an appropriate error message containing the corresponding
  * errno.
  *
+ * The \c options select how bytes reach the file: packing directly into a
+ * shared mapping (\c FileBackend::MMap) or into staging blocks written with
+ * \c pwrite (\c FileBackend::PWrite). They also select how much syncing is
+ * done before returning; the default, \c FileDurability::DataSync, syncs the
+ * data once after it has all been written. With \c options.checksum enabled,
+ * a CRC32C trailer is appended that \c deserializeFromFile verifies. For
+ * checkpoints larger than memory, \c FileBackend::PWrite with
+ * \c options.write_behind keeps both the staging memory and the dirty pages
+ * bounded.
+ *
+ * \param[in] target the \c T to serialize
+ * \param[in] file name of the file to create
+ * \param[in] options backend and durability options
+ */
+template <typename T>
+void serializeToFile(
+  T& target, std::string const& file,
+  FileWriteOptions const& options = FileWriteOptions{}
+);
+
+/**
+ * \brief Serialize \c T to a compressed file with filename \c file
+ *
+ * Same as \c serializeToFile, but the packed bytes are compressed frame by
+ * frame (see \c serialize with \c CompressionOptions) and written with the
+ * \c FileBackend::PWrite path; \c options.backend is ignored.
+ *
  * \param[in] target the \c T to serialize
  * \param[in] file name of the file to create
+ * \param[in] compression codec, frame size, shuffle and thread count
+ * \param[in] options block size and durability options
  */
 template <typename T>
-void serializeToFile(T& target, std::string const& file);
+void serializeToFile(
+  T& target, std::string const& file, CompressionOptions const& compression,
+  FileWriteOptions const& options = FileWriteOptions{}
+);
+
+/**
+ * \brief Serialize \c T to file with filename \c file, sizing and packing
+ * large arrays on several threads
+ *
+ * Same as \c serializeToFile, but large arrays are packed concurrently (see
+ * \c serialize with \c ParallelPackOptions) into the mapped file. Parallel
+ * packing needs random access to the output, so with \c FileBackend::PWrite
+ * the bytes are packed serially as they are written, unless
+ * \c parallel.indexed is set; indexed bytes are then packed into memory first.
+ * Files written with \c parallel.indexed are read with
+ * \c deserializeIndexedFromFile.
+ *
+ * \param[in] target the \c T to serialize
+ * \param[in] file name of the file to create
+ * \param[in] parallel the number of threads and chunking of arrays
+ * \param[in] options backend, durability and checksum options
+ */
+template <typename T>
+void serializeToFile(
+  T& target, std::string const& file, ParallelPackOptions const& parallel,
+  FileWriteOptions const& options = FileWriteOptions{}
+);
+
+/**
+ * \brief Serialize \c T to file with filename \c file without waiting for the
+ * I/O to complete
+ *
+ * Packs \c target into an in-memory snapshot before returning, so the caller
+ * may modify \c target immediately. The snapshot is then written by a
+ * background thread with the backend, durability and checksum in \c options.
+ * At most a bounded number of writes are in flight (see
+ * \c setMaxAsyncFileWrites); when the limit is reached this call blocks until
+ * an earlier write completes. Errors during the write are rethrown from
+ * \c FileWriteHandle::wait.
+ *
+ * \param[in] target the \c T to serialize
+ * \param[in] file name of the file to create
+ * \param[in] options block size and durability options
+ *
+ * \return handle to \c wait on or \c poll the write
+ */
+template <typename T>
+FileWriteHandle serializeToFileAsync(
+  T& target, std::string const& file,
+  FileWriteOptions const& options = FileWriteOptions{}
+);
+
+/**
+ * \brief Set the maximum number of \c serializeToFileAsync writes that may be
+ * queued or in progress at once (default 2)
+ *
+ * \param[in] max_in_flight the limit, at least one
+ */
+inline void setMaxAsyncFileWrites(std::size_t max_in_flight);
 
 /**
  * \brief De-serialize and reify \c T from a file
@@ -196,12 +611,74 @@ void serializeToFile(T& target, std::string const& file);
  * detection, \c T will either be default constructed or reconstructed based on
  * a user-defined reconstruct method.
  *
+ * The \c options select how the mapped file is paged in, e.g., populating the
+ * whole mapping up front or touching pages from a read-ahead thread. With
+ * \c FileReadStrategy::Window the file is not mapped but read through a
+ * buffer of \c options.window bytes. If the file ends with a checksum trailer
+ * it is verified before unpacking (see \c FileReadOptions::checksum); a
+ * mismatch throws \c buffer::checksum_error.
+ *
+ * \param[in] file the filename to read with bytes for \c T
+ * \param[in] options the read strategy
+ *
+ * \return unique pointer to the new object \c T
+ */
+template <typename T>
+std::unique_ptr<T> deserializeFromFile(
+  std::string const& file, FileReadOptions const& options = FileReadOptions{}
+);
+
+/**
+ * \brief De-serialize and reify \c T from a file, letting borrowed members
+ * point into the file mapping
+ *
+ * Members such as \c std::string_view and \c checkpoint::span<T const> refer
+ * directly to the read-only mapping of \c file instead of copying the data.
+ * The mapping stays open as long as the returned pointer, or any copy of it,
+ * is alive. \c deserializeFromFile unmaps the file when it returns, so it
+ * throws \c serialization_error for such members.
+ *
+ * \param[in] file the filename to read with bytes for \c T
+ * \param[in] options the read strategy
+ *
+ * \return a shared pointer to \c T that keeps the file mapped
+ */
+template <typename T>
+std::shared_ptr<T> deserializeBorrowedFromFile(
+  std::string const& file, FileReadOptions const& options = FileReadOptions{}
+);
+
+/**
+ * \brief De-serialize and reify \c T from a file written by
+ * \c serializeToFile with indexed \c ParallelPackOptions
+ *
  * \param[in] file the filename to read with bytes for \c T
+ * \param[in] num_threads the number of chunks unpacked concurrently
+ * \param[in] options the read strategy for the mapped file
  *
  * \return unique pointer to the new object \c T
  */
 template <typename T>
-std::unique_ptr<T> deserializeFromFile(std::string const& file);
+std::unique_ptr<T> deserializeIndexedFromFile(
+  std::string const& file, unsigned num_threads = 1,
+  FileReadOptions const& options = FileReadOptions{}
+);
+
+/**
+ * \brief De-serialize and reify \c T from a file written by
+ * \c serializeToFile with \c CompressionOptions
+ *
+ * \param[in] file the filename to read with bytes for \c T
+ * \param[in] num_threads the number of frames decompressed concurrently
+ * \param[in] options the read strategy for the mapped file
+ *
+ * \return unique pointer to the new object \c T
+ */
+template <typename T>
+std::unique_ptr<T> deserializeCompressedFromFile(
+  std::string const& file, unsigned num_threads = 1,
+  FileReadOptions const& options = FileReadOptions{}
+);
 
 /**
  * \brief De-serialize and reify \c T from a file in place on an existing
@@ -213,9 +690,13 @@ std::unique_ptr<T> deserializeFromFile(std::string const& file);
  *
  * \param[in] file the filename to read with bytes for \c T
  * \param[in] t a valid, constructed \c T to deserialize into
+ * \param[in] options the read strategy
  */
 template <typename T>
-void deserializeInPlaceFromFile(std::string const& file, T* buf);
+void deserializeInPlaceFromFile(
+  std::string const& file, T* buf,
+  FileReadOptions const& options = FileReadOptions{}
+);
 
 /**
  * \brief Serialize \c T to a stream
@@ -224,11 +705,33 @@ void deserializeInPlaceFromFile(std::string const& file, T* buf);
  * to the stream will be handled by the stream itself, e.g. any exceptions
  * or status bits to check will depend on stream type.
  *
+ * Small pieces are coalesced in a buffer of up to \c buffer_size bytes, sized
+ * by the packed size of \c T, so the stream sees few large writes.
+ *
  * \param[in] target the \c T to serialize
  * \param[in] stream to serialize into, with tellp and write functions.
+ * \param[in] buffer_size the largest coalescing buffer; zero disables it
  */
 template <typename T, typename StreamT>
-void serializeToStream(T& target, StreamT& stream);
+void serializeToStream(
+  T& target, StreamT& stream,
+  SerialSizeType buffer_size = default_stream_buffer_size
+);
+
+/**
+ * \brief Serialize \c T to a stream as a compressed stream
+ *
+ * The stream receives the same bytes as \c serialize with
+ * \c CompressionOptions, one frame at a time.
+ *
+ * \param[in] target the \c T to serialize
+ * \param[in] stream to serialize into, with a write function
+ * \param[in] options codec, frame size, shuffle and thread count
+ */
+template <typename T, typename StreamT>
+void serializeToStream(
+  T& target, StreamT& stream, CompressionOptions const& options
+);
 
 /**
  * \brief De-serialize and reify \c T from a stream
@@ -239,12 +742,18 @@ void serializeToStream(T& target, StreamT& stream);
  * detection, \c T will either be default constructed or reconstructed based on
  * a user-defined reconstruct method.
  *
+ * Bytes are read ahead into a buffer of \c buffer_size bytes; any that do not
+ * belong to \c T are given back with \c seekg before returning.
+ *
  * \param[in] stream the stream to read with bytes for \c T, with tellg and read functions
+ * \param[in] buffer_size the size of the read-ahead buffer; zero disables it
  *
  * \return unique pointer to the new object \c T
  */
 template <typename T, typename StreamT>
-std::unique_ptr<T> deserializeFromStream(StreamT& stream);
+std::unique_ptr<T> deserializeFromStream(
+  StreamT& stream, SerialSizeType buffer_size = default_stream_buffer_size
+);
 
 /**
  * \brief De-serialize and reify \c T from a stream in place on an existing
@@ -256,9 +765,30 @@ std::unique_ptr<T> deserializeFromStream(StreamT& stream);
  *
  * \param[in] stream the stream to read with bytes for \c T, with tellg and read functions
  * \param[in] t a valid, constructed \c T to deserialize into
+ * \param[in] buffer_size the size of the read-ahead buffer; zero disables it
+ */
+template <typename T, typename StreamT>
+void deserializeInPlaceFromStream(
+  StreamT& stream, T* buf,
+  SerialSizeType buffer_size = default_stream_buffer_size
+);
+
+/**
+ * \brief De-serialize and reify \c T from a compressed stream written by
+ * \c serializeToStream with \c CompressionOptions
+ *
+ * The whole compressed stream, including its frame index, is consumed.
+ *
+ * \param[in] stream the stream to read with bytes for \c T, with a read
+ * function
+ * \param[in] num_threads the number of frames decompressed concurrently
+ *
+ * \return unique pointer to the new object \c T
  */
 template <typename T, typename StreamT>
-void deserializeInPlaceFromStream(StreamT& stream, T* buf);
+std::unique_ptr<T> deserializeCompressedFromStream(
+  StreamT& stream, unsigned num_threads = 1
+);
 
 
 } /* end namespace checkpoint */
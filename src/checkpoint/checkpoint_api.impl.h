@@ -48,11 +48,62 @@
 #include <checkpoint/checkpoint.h>
 #include "checkpoint/checkpoint_api.h"
 #include "buffer/buffer.h"
+#include "checkpoint/buffer/async_file_writer.h"
+#include "checkpoint/buffer/checksum.h"
 
 #include <memory>
 
 namespace checkpoint {
 
+namespace detail {
+
+/// Keeps serialized bytes alive for as long as an object borrows from them
+template <typename T>
+struct BorrowedHolder {
+  // Declared first so the object is destroyed before the bytes it refers to
+  std::unique_ptr<SerializedInfo> bytes = nullptr;
+  std::unique_ptr<T> object = nullptr;
+};
+
+template <typename T>
+std::shared_ptr<T> makeBorrowed(
+  std::unique_ptr<SerializedInfo> bytes, std::unique_ptr<T> object
+) {
+  auto holder = std::make_shared<BorrowedHolder<T>>();
+  holder->bytes = std::move(bytes);
+  holder->object = std::move(object);
+  auto const ptr = holder->object.get();
+  return std::shared_ptr<T>(std::move(holder), ptr);
+}
+
+template <typename T, typename PackerT, typename... Args>
+void packToMappedFile(
+  T& target, SerialSizeType len, std::string const& file,
+  FileWriteOptions const& options, Args&&... args
+) {
+  auto const& checksum = options.checksum;
+  if (not checksum.enabled) {
+    dispatch::Standard::pack<T, PackerT>(
+      target, len, std::forward<Args>(args)...,
+      buffer::IOBuffer::WriteToFileTag{}, len, file, options.durability
+    );
+    return;
+  }
+
+  // Checksum the bytes as they are packed, while they are still in cache
+  auto const trailer = buffer::getChecksumTrailerSize(len, checksum.chunk_size);
+  PackerT p(
+    len, std::forward<Args>(args)..., buffer::IOBuffer::WriteToFileTag{},
+    len + trailer, file, options.durability
+  );
+  p.enableChecksum(checksum.chunk_size);
+  dispatch::Traverse::withRoot<T>(target, p);
+  dispatch::validatePackerBufferSize<T>(p, len);
+  p.writeChecksumTrailer();
+}
+
+} /* end namespace detail */
+
 template <typename T>
 SerializedReturnType serialize(T& target, BufferCallbackType fn) {
   auto ret = dispatch::serializeType<T>(target, fn);
@@ -63,6 +114,83 @@ SerializedReturnType serialize(T& target, BufferCallbackType fn) {
   return base_ptr;
 }
 
+template <typename T>
+SerializedReturnType serializeSinglePass(
+  T& target, std::size_t initial_capacity
+) {
+  auto ret = dispatch::serializeTypeSinglePass<T>(target, initial_capacity);
+  auto& buf = std::get<0>(ret);
+  std::unique_ptr<SerializedInfo> base_ptr(
+    static_cast<SerializedInfo*>(buf.release())
+  );
+  return base_ptr;
+}
+
+template <typename T>
+SerializedReturnType serialize(T& target, CompressionOptions const& options) {
+  auto len = getSize<T>(target);
+  buffer::GrowableFrameSink sink(len / 4 + 64);
+  auto p = dispatch::Standard::pack<T, CompressedPacker>(
+    target, len, sink, options
+  );
+  dispatch::validatePackerBufferSize<T>(p, len);
+  p.finish();
+  return SerializedReturnType(sink.extractBuffer().release());
+}
+
+template <typename T>
+SerializedReturnType serialize(T& target, CompactOptions const& options) {
+  auto len = dispatch::Standard::size<T, CompactSizer>(target, options);
+  auto p = dispatch::Standard::pack<T, CompactPacker>(target, len, options);
+  dispatch::validatePackerBufferSize<T>(p, len);
+  return SerializedReturnType(p.extractPackedBuffer().release());
+}
+
+template <typename T>
+SerializedReturnType serialize(
+  T& target, ParallelPackOptions const& options
+) {
+  auto plan = std::make_shared<ParallelChunkPlan>();
+  auto len = dispatch::Standard::size<T, ParallelSizer>(target, options, plan);
+  auto p = dispatch::Standard::pack<T, ParallelPacker>(
+    target, len, options, plan
+  );
+  dispatch::validatePackerBufferSize<T>(p, len);
+  return SerializedReturnType(p.extractPackedBuffer().release());
+}
+
+template <typename T>
+SerializedReturnType serialize(T& target, ChecksumOptions const& options) {
+  if (not options.enabled) {
+    return serialize<T>(target);
+  }
+
+  auto len = getSize<T>(target);
+  auto const trailer = buffer::getChecksumTrailerSize(len, options.chunk_size);
+  Packer p(len, std::make_unique<buffer::ManagedBuffer>(len + trailer));
+  p.enableChecksum(options.chunk_size);
+  dispatch::Traverse::withRoot<T>(target, p);
+  dispatch::validatePackerBufferSize<T>(p, len);
+  p.writeChecksumTrailer();
+  return SerializedReturnType(p.extractPackedBuffer().release());
+}
+
+inline std::size_t verifyChecksum(
+  char const* buf, std::size_t size, unsigned num_threads
+) {
+  return buffer::verifyChecksumTrailer(
+    buf, size, ChecksumVerify::Require, num_threads
+  );
+}
+
+template <typename T>
+std::unique_ptr<IOVecList> serializeIOVec(T& target, std::size_t threshold) {
+  auto len = getSize<T>(target);
+  auto p = dispatch::Standard::pack<T, PackerIOVec>(target, len, threshold);
+  dispatch::validatePackerBufferSize<T>(p, len);
+  return p.extractIOVecList();
+}
+
 template <typename T>
 T* deserialize(char* buf, char* object_buf) {
   return dispatch::deserializeType<T>(buf, object_buf);
@@ -80,11 +208,108 @@ std::unique_ptr<T> deserialize(SerializedReturnType&& in) {
   return std::unique_ptr<T>(t);
 }
 
+template <typename T>
+std::unique_ptr<T> deserializeIndexed(char* buf, unsigned num_threads) {
+  auto mem = dispatch::Standard::allocate<T>();
+  auto t = std::unique_ptr<T>(dispatch::Standard::construct<T>(mem));
+  dispatch::Standard::unpack<T, ParallelUnpacker>(t.get(), num_threads, buf);
+  return t;
+}
+
+template <typename T>
+std::unique_ptr<T> deserializeIndexed(
+  SerializedReturnType&& in, unsigned num_threads
+) {
+  return deserializeIndexed<T>(in->getBuffer(), num_threads);
+}
+
+template <typename T>
+SerializedReturnType serializePortable(T& target) {
+  auto len = getSize<T>(target);
+  auto const header = buffer::portable_header_size;
+  PortablePacker p(
+    header + len, std::make_unique<buffer::ManagedBuffer>(header + len)
+  );
+  buffer::writePortableHeader(p.claimBytes(header), len);
+  dispatch::Traverse::withRoot<T>(target, p);
+  dispatch::validatePackerBufferSize<T>(p, header + len);
+  return SerializedReturnType(p.extractPackedBuffer().release());
+}
+
+template <typename T>
+std::unique_ptr<T> deserializePortable(char const* buf, std::size_t size) {
+  buffer::readPortableHeader(buf, size);
+  auto const payload = const_cast<char*>(buf) + buffer::portable_header_size;
+  auto mem = dispatch::Standard::allocate<T>();
+  T* t_buf = dispatch::Standard::construct<T>(mem);
+  auto t = dispatch::Standard::unpack<T, PortableUnpacker>(t_buf, payload);
+  return std::unique_ptr<T>(t);
+}
+
+template <typename T>
+std::unique_ptr<T> deserializePortable(SerializedReturnType&& in) {
+  return deserializePortable<T>(in->getBuffer(), in->getSize());
+}
+
+template <typename T>
+std::unique_ptr<T> deserializeCompact(
+  char const* buf, std::size_t size, CompactOptions const& options
+) {
+  auto mem = dispatch::Standard::allocate<T>();
+  T* t_buf = dispatch::Standard::construct<T>(mem);
+  auto t = dispatch::Standard::unpack<T, CompactUnpacker>(
+    t_buf, const_cast<char*>(buf), size, options
+  );
+  return std::unique_ptr<T>(t);
+}
+
+template <typename T>
+std::unique_ptr<T> deserializeCompact(
+  SerializedReturnType&& in, CompactOptions const& options
+) {
+  return deserializeCompact<T>(in->getBuffer(), in->getSize(), options);
+}
+
+template <typename T>
+std::unique_ptr<T> deserializeCompressed(
+  char const* buf, std::size_t size, unsigned num_threads
+) {
+  buffer::MemoryFrameSource source(buf, size);
+  auto mem = dispatch::Standard::allocate<T>();
+  T* t_buf = dispatch::Standard::construct<T>(mem);
+  auto t = dispatch::Standard::unpack<T, CompressedUnpacker>(
+    t_buf, source, num_threads
+  );
+  return std::unique_ptr<T>(t);
+}
+
+template <typename T>
+std::unique_ptr<T> deserializeCompressed(
+  SerializedReturnType&& in, unsigned num_threads
+) {
+  return deserializeCompressed<T>(in->getBuffer(), in->getSize(), num_threads);
+}
+
+template <typename T>
+std::shared_ptr<T> deserializeBorrowed(SerializedReturnType&& in) {
+  auto mem = dispatch::Standard::allocate<T>();
+  auto t = std::unique_ptr<T>(dispatch::Standard::construct<T>(mem));
+  UnpackerBuffer<buffer::UserBuffer> u(in->getBuffer());
+  u.setLendingBytes(true);
+  dispatch::Traverse::withRoot(*t, u);
+  return detail::makeBorrowed<T>(std::move(in), std::move(t));
+}
+
 template <typename T>
 void deserializeInPlace(char* buf, T* t) {
   return dispatch::deserializeType<T>(dispatch::InPlaceTag{}, buf, t);
 }
 
+template <typename T>
+T* deserializeToResource(char* buf, std::pmr::memory_resource* resource) {
+  return dispatch::deserializeTypeToResource<T>(buf, resource);
+}
+
 template <typename T>
 std::size_t getSize(T& target) {
   return dispatch::Standard::size<T, Sizer>(target);
@@ -99,53 +324,208 @@ std::size_t getMemoryFootprint(T& target, std::size_t size_offset) {
 }
 
 template <typename T>
-void serializeToFile(T& target, std::string const& file) {
+void serializeToFile(
+  T& target, std::string const& file, FileWriteOptions const& options
+) {
   auto len = getSize<T>(target);
-  dispatch::Standard::pack<T, PackerBuffer<buffer::IOBuffer>>(
-    target, len, buffer::IOBuffer::WriteToFileTag{}, len, file
+  if (options.backend == FileBackend::PWrite) {
+    auto packer = dispatch::Standard::pack<T, FilePacker>(
+      target, len, file, options
+    );
+    packer.closeFile();
+  } else {
+    detail::packToMappedFile<T, PackerIO>(target, len, file, options);
+  }
+}
+
+template <typename T>
+void serializeToFile(
+  T& target, std::string const& file, ParallelPackOptions const& parallel,
+  FileWriteOptions const& options
+) {
+  if (options.backend == FileBackend::PWrite and not parallel.indexed) {
+    serializeToFile<T>(target, file, options);
+  } else if (options.backend == FileBackend::PWrite) {
+    auto bytes = serialize<T>(target, parallel);
+    FilePacker packer(bytes->getSize(), file, options);
+    packer.contiguousBytes(bytes->getBuffer(), 1, bytes->getSize());
+    packer.closeFile();
+  } else {
+    auto plan = std::make_shared<ParallelChunkPlan>();
+    auto len = dispatch::Standard::size<T, ParallelSizer>(
+      target, parallel, plan
+    );
+    detail::packToMappedFile<T, ParallelPackerIO>(
+      target, len, file, options, parallel, plan
+    );
+  }
+}
+
+template <typename T>
+void serializeToFile(
+  T& target, std::string const& file, CompressionOptions const& compression,
+  FileWriteOptions const& options
+) {
+  auto len = getSize<T>(target);
+
+  // Only reserve one block up front; the compressed size is not known yet
+  buffer::FileFrameSink sink(std::min(len, options.block_size), file, options);
+  auto p = dispatch::Standard::pack<T, CompressedPacker>(
+    target, len, sink, compression
   );
+  dispatch::validatePackerBufferSize<T>(p, len);
+  p.finish();
+  sink.closeFile();
 }
 
 template <typename T>
-std::unique_ptr<T> deserializeFromFile(std::string const& file) {
+FileWriteHandle serializeToFileAsync(
+  T& target, std::string const& file, FileWriteOptions const& options
+) {
+  auto& writer = buffer::AsyncFileWriter::get();
+
+  // Reserve a slot before packing so the number of live snapshots stays
+  // bounded, even with concurrent callers
+  writer.reserveSlot();
+
+  std::unique_ptr<SerializedInfo> snapshot = nullptr;
+  try {
+    snapshot = serialize<T>(target);
+  } catch (...) {
+    writer.releaseSlot();
+    throw;
+  }
+  return writer.submit(std::move(snapshot), file, options);
+}
+
+inline void setMaxAsyncFileWrites(std::size_t max_in_flight) {
+  buffer::AsyncFileWriter::get().setMaxInFlight(max_in_flight);
+}
+
+template <typename T>
+std::unique_ptr<T> deserializeFromFile(
+  std::string const& file, FileReadOptions const& options
+) {
   auto mem = dispatch::Standard::allocate<T>();
   T* t_buf = dispatch::Standard::construct<T>(mem);
+  if (options.strategy == FileReadStrategy::Window) {
+    auto t = dispatch::Standard::unpack<T, FileUnpacker>(t_buf, file, options);
+    return std::unique_ptr<T>(t);
+  }
   auto t = dispatch::Standard::unpack<T, UnpackerBuffer<buffer::IOBuffer>>(
-    t_buf, buffer::IOBuffer::ReadFromFileTag{}, file
+    t_buf, buffer::IOBuffer::ReadFromFileTag{}, file, options
   );
   return std::unique_ptr<T>(t);
 }
 
 template <typename T>
-void deserializeInPlaceFromFile(std::string const& file, T* t) {
+std::shared_ptr<T> deserializeBorrowedFromFile(
+  std::string const& file, FileReadOptions const& options
+) {
+  auto mem = dispatch::Standard::allocate<T>();
+  auto t = std::unique_ptr<T>(dispatch::Standard::construct<T>(mem));
+  UnpackerBuffer<buffer::IOBuffer> u(
+    buffer::IOBuffer::ReadFromFileTag{}, file, options
+  );
+  u.setLendingBytes(true);
+  dispatch::Traverse::withRoot(*t, u);
+  return detail::makeBorrowed<T>(u.extractBuffer(), std::move(t));
+}
+
+template <typename T>
+std::unique_ptr<T> deserializeIndexedFromFile(
+  std::string const& file, unsigned num_threads, FileReadOptions const& options
+) {
+  auto mem = dispatch::Standard::allocate<T>();
+  auto t = std::unique_ptr<T>(dispatch::Standard::construct<T>(mem));
+  dispatch::Standard::unpack<T, ParallelUnpackerIO>(
+    t.get(), num_threads, buffer::IOBuffer::ReadFromFileTag{}, file, options
+  );
+  return t;
+}
+
+template <typename T>
+std::unique_ptr<T> deserializeCompressedFromFile(
+  std::string const& file, unsigned num_threads, FileReadOptions const& options
+) {
+  buffer::MappedFileFrameSource source(file, options);
+  auto mem = dispatch::Standard::allocate<T>();
+  T* t_buf = dispatch::Standard::construct<T>(mem);
+  auto t = dispatch::Standard::unpack<T, CompressedUnpacker>(
+    t_buf, source, num_threads
+  );
+  return std::unique_ptr<T>(t);
+}
+
+template <typename T>
+void deserializeInPlaceFromFile(
+  std::string const& file, T* t, FileReadOptions const& options
+) {
+  if (options.strategy == FileReadStrategy::Window) {
+    dispatch::Standard::unpack<T, FileUnpacker>(t, file, options);
+    return;
+  }
   dispatch::Standard::unpack<T, UnpackerBuffer<buffer::IOBuffer>>(
-    t, buffer::IOBuffer::ReadFromFileTag{}, file
+    t, buffer::IOBuffer::ReadFromFileTag{}, file, options
+  );
+}
+
+template <typename T, typename StreamT>
+void serializeToStream(
+  T& target, StreamT& stream, SerialSizeType buffer_size
+) {
+  auto len = getSize<T>(target);
+  auto p = dispatch::Standard::pack<T, StreamPacker<StreamT>>(
+    target, len, stream, buffer_size
   );
+  p.flush();
 }
 
 template <typename T, typename StreamT>
-void serializeToStream(T& target, StreamT& stream) {
+void serializeToStream(
+  T& target, StreamT& stream, CompressionOptions const& options
+) {
   auto len = getSize<T>(target);
-  dispatch::Standard::pack<T, StreamPacker<StreamT>>(
-    target, len, stream
+  buffer::StreamFrameSink<StreamT> sink(stream);
+  auto p = dispatch::Standard::pack<T, CompressedPacker>(
+    target, len, sink, options
   );
+  dispatch::validatePackerBufferSize<T>(p, len);
+  p.finish();
 }
 
 template <typename T, typename StreamT>
-std::unique_ptr<T> deserializeFromStream(StreamT& stream) {
+std::unique_ptr<T> deserializeFromStream(
+  StreamT& stream, SerialSizeType buffer_size
+) {
   auto mem = dispatch::Standard::allocate<T>();
   T* t_buf = dispatch::Standard::construct<T>(mem);
   auto t = dispatch::Standard::unpack<T, StreamUnpacker<StreamT>>(
-    t_buf, stream
+    t_buf, stream, buffer_size
   );
   return std::unique_ptr<T>(t);
 }
 
 template <typename T, typename StreamT>
-void deserializeInPlaceFromStream(StreamT& stream, T* t) {
+void deserializeInPlaceFromStream(
+  StreamT& stream, T* t, SerialSizeType buffer_size
+) {
   dispatch::Standard::unpack<T, StreamUnpacker<StreamT>>(
-    t, stream
+    t, stream, buffer_size
+  );
+}
+
+template <typename T, typename StreamT>
+std::unique_ptr<T> deserializeCompressedFromStream(
+  StreamT& stream, unsigned num_threads
+) {
+  buffer::StreamFrameSource<StreamT> source(stream);
+  auto mem = dispatch::Standard::allocate<T>();
+  T* t_buf = dispatch::Standard::construct<T>(mem);
+  auto t = dispatch::Standard::unpack<T, CompressedUnpacker>(
+    t_buf, source, num_threads
   );
+  return std::unique_ptr<T>(t);
 }
 
 } /* end namespace checkpoint */
@@ -49,6 +49,22 @@
 
 namespace checkpoint {
 
+/**
+ * \brief Serialize the size (or other count) of a container: as a varint with
+ * compact serializers, otherwise as a plain value
+ *
+ * \param[in] s the serializer
+ * \param[in,out] size the size
+ */
+template <typename Serializer, typename SizeT>
+inline void serializeSize(Serializer& s, SizeT& size) {
+  if constexpr (IsCompactSerializer<Serializer>::value) {
+    s.varint(size);
+  } else {
+    s | size;
+  }
+}
+
 template <typename Serializer, typename ContainerT>
 inline typename ContainerT::size_type
 serializeContainerSize(Serializer& s, ContainerT& cont) {
@@ -56,7 +72,7 @@ serializeContainerSize(Serializer& s, ContainerT& cont) {
   if (s.isFootprinting()) {
     s.countBytes(cont);
   } else {
-    s | cont_size;
+    serializeSize(s, cont_size);
   }
   return cont_size;
 }
@@ -66,7 +82,7 @@ inline typename ContainerT::size_type
 serializeContainerCapacity(Serializer& s, ContainerT& cont) {
   typename ContainerT::size_type cont_capacity = cont.capacity();
   if (!s.isFootprinting()) {
-    s | cont_capacity;
+    serializeSize(s, cont_capacity);
   }
   return cont_capacity;
 }
@@ -67,6 +67,8 @@ void serializeKokkosUnorderedMapElems(
   using mapSizeType =
     typename Kokkos::UnorderedMap<Key, Value, Device, Hasher, EqualTo>::size_type;
 
+  // The keys and values are packed from local copies
+  s.beginTransient();
   for (mapSizeType i = 0; i < map.capacity(); i++) {
     Key keyAtI = map.key_at(i);
     if (map.exists(keyAtI)) {
@@ -76,6 +78,7 @@ void serializeKokkosUnorderedMapElems(
       s | val;
     }
   }
+  s.endTransient();
 }
 
 template <
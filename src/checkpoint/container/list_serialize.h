@@ -48,12 +48,53 @@
 #include "checkpoint/dispatch/allocator.h"
 #include "checkpoint/serializers/serializers_headers.h"
 #include "checkpoint/container/container_serialize.h"
+#include "checkpoint/dispatch/dispatch_parallel.h"
+#include "checkpoint/dispatch/structure_hash.h"
 
+#include <iterator>
 #include <list>
 #include <deque>
+#include <type_traits>
 
 namespace checkpoint {
 
+/**
+ * \brief Serialize the elements of a sized list or deque. Deques are split
+ * into chunks by parallel serializers (see \c dispatch::serializeChunks).
+ *
+ * \param[in] s the serializer
+ * \param[in] cont the container, already sized when unpacking
+ */
+template <typename Serializer, typename ContainerT>
+inline void serializeOrderedElems(Serializer& s, ContainerT& cont) {
+  using IteratorT = typename ContainerT::iterator;
+  using CategoryT = typename std::iterator_traits<IteratorT>::iterator_category;
+  constexpr bool random_access =
+    std::is_same<CategoryT, std::random_access_iterator_tag>::value;
+
+  if constexpr (random_access) {
+    auto const chunked = dispatch::serializeChunks(
+      s, cont.size(),
+      [&cont](auto& sub, SerialSizeType begin, SerialSizeType n) {
+        auto it = cont.begin() + begin;
+        for (SerialSizeType i = 0; i < n; i++, ++it) {
+          sub | *it;
+        }
+      }
+    );
+    if (chunked) {
+      // The chunk serializers hashed the elements on behalf of s
+      using ElmT = typename dispatch::CleanType<
+        typename ContainerT::value_type
+      >::CleanT;
+      dispatch::withTypeHash<ElmT>(s, 1, cont.size());
+      return;
+    }
+  }
+
+  serializeContainerElems<Serializer, ContainerT>(s, cont);
+}
+
 template <typename Serializer, typename ContainerT, typename ElmT>
 inline typename std::enable_if_t<
   not checkpoint::is_footprinter_v<Serializer>, void
@@ -69,9 +110,7 @@ deserializeOrderedElems(
   Alloc allocated;
   auto* reconstructed = Reconstructor::construct(allocated.buf);
   cont.resize(size, *reconstructed);
-  for (auto& val : cont) {
-    s | val;
-  }
+  serializeOrderedElems(s, cont);
 }
 
 template <typename Serializer, typename ContainerT, typename ElmT>
@@ -110,6 +149,9 @@ inline void serializeOrderedContainer(Serializer& s, ContainerT& cont) {
 
   if (s.isUnpacking()) {
     deserializeOrderedElems<Serializer, ContainerT, ValueT>(s, cont, size);
+  } else if constexpr (std::is_copy_constructible<ValueT>::value) {
+    // Matches the chunking done when unpacking copy-constructible elements
+    serializeOrderedElems(s, cont);
   } else {
     serializeContainerElems<Serializer, ContainerT>(s, cont);
   }
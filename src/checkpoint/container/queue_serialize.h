@@ -51,36 +51,76 @@
 
 namespace checkpoint {
 
-template<typename SerializerT, typename T>
-void deserializeQueueElems(SerializerT& s, std::queue<T>& q, typename std::queue<T>::size_type size) {
+template <typename T, typename Container>
+T const& queueNextElem(std::queue<T, Container> const& q) {
+  return q.front();
+}
+
+template <typename T, typename Container, typename Compare>
+T const& queueNextElem(std::priority_queue<T, Container, Compare> const& q) {
+  return q.top();
+}
+
+template <typename T, typename Container>
+T const& queueNextElem(std::stack<T, Container> const& q) {
+  return q.top();
+}
+
+template <typename SerializerT, typename Q>
+void deserializeQueueElems(
+  SerializerT& s, Q& q, typename Q::size_type size
+) {
+  using T = typename Q::value_type;
   using Reconstructor =
     dispatch::Reconstructor<typename dispatch::CleanType<T>::CleanT>;
 
   dispatch::Allocator<T> allocated;
-  for (typename std::queue<T>::size_type i = 0; i < size; ++i) {
+  for (typename Q::size_type i = 0; i < size; ++i) {
     auto* reconstructed = Reconstructor::construct(allocated.buf);
     s | *reconstructed;
     q.push(std::move(*reconstructed));
   }
 }
 
-template<typename SerializerT, typename T>
-void serializeQueueElems(SerializerT& s, std::queue<T> q) {
+template <typename SerializerT, typename Q>
+void serializeQueueElems(SerializerT& s, Q q) {
+  // The elements are packed from a by-value copy that does not outlive packing
+  s.beginTransient();
+  while(!q.empty()) {
+    s | queueNextElem(q);
+    q.pop();
+  }
+  s.endTransient();
+}
+
+/**
+ * \brief Pack a stack bottom-up so unpacking can push each element in turn
+ */
+template <typename SerializerT, typename T, typename Container>
+void serializeQueueElems(SerializerT& s, std::stack<T, Container> q) {
+  std::stack<T, Container> reversed;
   while(!q.empty()) {
-    s | q.front();
+    reversed.push(std::move(q.top()));
     q.pop();
   }
+
+  s.beginTransient();
+  while(!reversed.empty()) {
+    s | reversed.top();
+    reversed.pop();
+  }
+  s.endTransient();
 }
 
 template <
   typename SerializerT,
-  typename T,
+  typename Q,
   typename = std::enable_if_t<
     not std::is_same_v<SerializerT, checkpoint::Footprinter>
   >
 >
-void serializeQueueLikeContainer(SerializerT& s, std::queue<T>& q) {
-  typename std::queue<T>::size_type size = serializeContainerSize(s, q);
+void serializeQueueLikeContainer(SerializerT& s, Q& q) {
+  typename Q::size_type size = serializeContainerSize(s, q);
 
   if (s.isUnpacking()) {
     deserializeQueueElems(s, q, size);
@@ -89,18 +129,32 @@ void serializeQueueLikeContainer(SerializerT& s, std::queue<T>& q) {
   }
 }
 
-template <typename Serializer, typename T>
-void serialize(Serializer& s, std::queue<T>& q) {
+template <typename Serializer, typename T, typename Container>
+void serialize(Serializer& s, std::queue<T, Container>& q) {
+  serializeQueueLikeContainer(s, q);
+}
+
+template <typename Serializer, typename T, typename Container, typename Compare>
+void serialize(
+  Serializer& s, std::priority_queue<T, Container, Compare>& q
+) {
   serializeQueueLikeContainer(s, q);
 }
 
-template <typename Serializer, typename T>
-void serialize(Serializer& s, const std::priority_queue<T>& q) {
+template <typename Serializer, typename T, typename Container, typename Compare>
+void serialize(
+  Serializer& s, const std::priority_queue<T, Container, Compare>& q
+) {
   serializeQueueLikeContainer(s, q);
 }
 
-template <typename Serializer, typename T>
-void serialize(Serializer& s, const std::stack<T>& stack) {
+template <typename Serializer, typename T, typename Container>
+void serialize(Serializer& s, std::stack<T, Container>& stack) {
+  serializeQueueLikeContainer(s, stack);
+}
+
+template <typename Serializer, typename T, typename Container>
+void serialize(Serializer& s, const std::stack<T, Container>& stack) {
   serializeQueueLikeContainer(s, stack);
 }
 
@@ -0,0 +1,127 @@
+/*
+//@HEADER
+// *****************************************************************************
+//
+//                               span_serialize.h
+//                 DARMA/magistrate => Serialization Library
+//
+// Copyright 2019 National Technology & Engineering Solutions of Sandia, LLC
+// (NTESS). Under the terms of Contract DE-NA0003525 with NTESS, the U.S.
+// Government retains certain rights in this software.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+//
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// * Neither the name of the copyright holder nor the names of its
+//   contributors may be used to endorse or promote products derived from this
+//   software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// Questions? Contact darma@sandia.gov
+//
+// *****************************************************************************
+//@HEADER
+*/
+
+#if !defined INCLUDED_SRC_CHECKPOINT_CONTAINER_SPAN_SERIALIZE_H
+#define INCLUDED_SRC_CHECKPOINT_CONTAINER_SPAN_SERIALIZE_H
+
+#include "checkpoint/common.h"
+#include "checkpoint/container/container_serialize.h"
+#include "checkpoint/dispatch/dispatch.h"
+#include "checkpoint/traits/serializable_traits.h"
+
+#include <cstdlib>
+#include <type_traits>
+
+namespace checkpoint {
+
+/**
+ * \struct span
+ *
+ * \brief A non-owning view of contiguous elements of \c T
+ *
+ * When packed, the elements are written aligned to \c alignof(T). When
+ * unpacked, the span points directly into the buffer or file mapping being
+ * deserialized instead of copying the elements, so that storage must outlive
+ * the span: only \c deserializeBorrowed and \c deserializeBorrowedFromFile
+ * unpack spans. Memory mapped from a file is read-only, so borrowed spans
+ * should use a \c const element type.
+ */
+template <typename T>
+struct span {
+  using element_type = T;
+  using value_type = std::remove_cv_t<T>;
+  using size_type = std::size_t;
+  using iterator = T*;
+
+  span() = default;
+  span(T* in_data, size_type in_size) : data_(in_data), size_(in_size) { }
+
+  template <typename ContainerT>
+  explicit span(ContainerT& c) : data_(c.data()), size_(c.size()) { }
+
+  T* data() const { return data_; }
+  size_type size() const { return size_; }
+  bool empty() const { return size_ == 0; }
+
+  T& operator[](size_type i) const { return data_[i]; }
+
+  iterator begin() const { return data_; }
+  iterator end() const { return data_ + size_; }
+
+private:
+  T* data_ = nullptr;
+  size_type size_ = 0;
+};
+
+/**
+ * \brief Serialize span \c view, borrowing the elements when unpacking
+ *
+ * \param[in] s the serializer
+ * \param[in] view the span to serialize
+ */
+template <typename SerializerT, typename T>
+void serialize(SerializerT& s, span<T>& view) {
+  static_assert(
+    SerializableTraits<std::remove_cv_t<T>, void>::is_bytecopyable,
+    "Only spans of byte-copyable types can be serialized"
+  );
+
+  if (s.isFootprinting()) {
+    s.countBytes(view);
+    return;
+  }
+
+  SerialSizeType len = view.size();
+  serializeSize(s, len);
+
+  T* data = view.data();
+  dispatch::serializeBorrowedArray(s, data, len, alignof(T));
+
+  if (s.isUnpacking()) {
+    view = len > 0 ? span<T>(data, len) : span<T>{};
+  }
+}
+
+} /* end namespace checkpoint */
+
+#endif /*INCLUDED_SRC_CHECKPOINT_CONTAINER_SPAN_SERIALIZE_H*/
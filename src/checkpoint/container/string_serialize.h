@@ -45,15 +45,17 @@
 #define INCLUDED_SRC_CHECKPOINT_CONTAINER_STRING_SERIALIZE_H
 
 #include "checkpoint/common.h"
+#include "checkpoint/container/container_serialize.h"
 
 #include <string>
+#include <string_view>
 
 namespace checkpoint {
 
 template <typename Serializer>
 void serializeStringMeta(Serializer& s, std::string& str) {
   SerialSizeType str_size = str.size();
-  s | str_size;
+  serializeSize(s, str_size);
   str.resize(str_size);
 }
 
@@ -78,6 +80,36 @@ void serialize(Serializer& s, std::string& str) {
   }
 }
 
+/**
+ * \brief Serialize string view \c str
+ *
+ * Lays out the size and characters like \c std::string. When unpacking, the
+ * view borrows the characters from the buffer being deserialized instead of
+ * copying them, so that buffer must outlive the view: only
+ * \c deserializeBorrowed and \c deserializeBorrowedFromFile allow it, and
+ * other unpacking throws \c serialization_error.
+ *
+ * \param[in] serializer serializer to use
+ * \param[in] str string view to serialize
+ */
+template <typename Serializer>
+void serialize(Serializer& s, std::string_view& str) {
+  if (s.isFootprinting()) {
+    s.countBytes(str);
+    return;
+  }
+
+  SerialSizeType str_size = str.size();
+  serializeSize(s, str_size);
+
+  char const* data = str.data();
+  dispatch::serializeBorrowedArray(s, data, str_size);
+
+  if (s.isUnpacking()) {
+    str = str_size > 0 ? std::string_view(data, str_size) : std::string_view{};
+  }
+}
+
 } /* end namespace checkpoint */
 
 #endif /*INCLUDED_SRC_CHECKPOINT_CONTAINER_STRING_SERIALIZE_H*/
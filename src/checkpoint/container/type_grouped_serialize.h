@@ -0,0 +1,203 @@
+/*
+//@HEADER
+// *****************************************************************************
+//
+//                           type_grouped_serialize.h
+//                 DARMA/magistrate => Serialization Library
+//
+// Copyright 2019 National Technology & Engineering Solutions of Sandia, LLC
+// (NTESS). Under the terms of Contract DE-NA0003525 with NTESS, the U.S.
+// Government retains certain rights in this software.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+//
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// * Neither the name of the copyright holder nor the names of its
+//   contributors may be used to endorse or promote products derived from this
+//   software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// Questions? Contact darma@sandia.gov
+//
+// *****************************************************************************
+//@HEADER
+*/
+
+#if !defined INCLUDED_SRC_CHECKPOINT_CONTAINER_TYPE_GROUPED_SERIALIZE_H
+#define INCLUDED_SRC_CHECKPOINT_CONTAINER_TYPE_GROUPED_SERIALIZE_H
+
+#include "checkpoint/common.h"
+#include "checkpoint/container/container_serialize.h"
+#include "checkpoint/dispatch/vrt/virtual_serialize.h"
+
+#include <memory>
+#include <stdexcept>
+#include <vector>
+
+namespace checkpoint {
+
+/**
+ * \brief Serialize a vector of pointers to virtually serialized objects with
+ * the objects grouped by their concrete type
+ *
+ * The element count is packed first, then the concrete type of every element
+ * as a run-length encoded column (null elements have their own runs). The
+ * objects follow one type after another, in order of first appearance, each
+ * type's objects in element order. Every type is looked up once: unpacking
+ * constructs all objects of a type with one registry entry, and they are all
+ * serialized through one dispatcher that calls the serializer of the type
+ * directly instead of through a virtual call. This pays off when equal types
+ * are adjacent; when they alternate, every element starts a run and the
+ * column is larger than the per-element type of \c s | \c vec.
+ *
+ * This is not the layout of \c s | \c vec, so the same call must be made when
+ * unpacking. Elements that already hold an object of the right type are
+ * unpacked in place.
+ *
+ * \param[in] s the serializer
+ * \param[in,out] vec the elements
+ */
+template <typename SerializerT, typename T, typename Deleter, typename A>
+void serializeTypeGrouped(
+  SerializerT& s, std::vector<std::unique_ptr<T, Deleter>, A>& vec
+) {
+  static_assert(
+    dispatch::vrt::VirtualSerializeTraits<T>::has_virtual_serialize,
+    "serializeTypeGrouped requires a virtually serialized element type"
+  );
+
+  using BaseT = dispatch::vrt::checkpoint_base_type_t<T>;
+  using dispatch::vrt::TypeIdx;
+  using dispatch::vrt::no_type_idx;
+  namespace objregistry = dispatch::vrt::objregistry;
+
+  if (s.isFootprinting()) {
+    s | vec;
+    return;
+  }
+
+  // The concrete type of every element, packed as (type id, count) runs
+  SerialSizeType num = vec.size();
+  std::vector<TypeIdx> ids(num, no_type_idx);
+  SerialSizeType num_runs = 0;
+  if (not s.isUnpacking()) {
+    for (SerialSizeType i = 0; i < num; i++) {
+      if (vec[i] != nullptr) {
+        ids[i] = vec[i]->_checkpointDynamicTypeIndex();
+      }
+      if (i == 0 or ids[i] != ids[i - 1]) {
+        num_runs++;
+      }
+    }
+  }
+
+  serializeSize(s, num);
+  serializeSize(s, num_runs);
+  if (s.isUnpacking()) {
+    if (num_runs > num) {
+      throw std::runtime_error("Corrupt type column: too many runs");
+    }
+    ids.assign(num, no_type_idx);
+    vec.resize(num);
+  }
+
+  // The distinct types, in order of first appearance, with their entries
+  std::vector<TypeIdx> types;
+  std::vector<objregistry::ObjectEntry<BaseT>*> entries;
+
+  SerialSizeType begin = 0;
+  for (SerialSizeType r = 0; r < num_runs; r++) {
+    TypeIdx id = ids[begin];
+    SerialSizeType count = 0;
+    if (not s.isUnpacking()) {
+      while (begin + count < num and ids[begin + count] == id) {
+        count++;
+      }
+    }
+    s | id;
+    serializeSize(s, count);
+    if (count == 0 or count > num - begin) {
+      throw std::runtime_error("Corrupt type column: bad run length");
+    }
+    auto const end = begin + count;
+
+    if (id == no_type_idx) {
+      if (s.isUnpacking()) {
+        for (auto i = begin; i < end; i++) {
+          vec[i].reset();
+        }
+      }
+      begin = end;
+      continue;
+    }
+
+    std::size_t g = 0;
+    while (g < types.size() and types[g] != id) {
+      g++;
+    }
+    if (g == types.size()) {
+      types.push_back(id);
+      entries.push_back(&objregistry::getEntry<BaseT>(id));
+    }
+
+    if (s.isUnpacking()) {
+      auto const& entry = *entries[g];
+      auto const resource = s.getMemoryResource();
+      for (auto i = begin; i < end; i++) {
+        ids[i] = id;
+        auto& elm = vec[i];
+        if (elm == nullptr or elm->_checkpointDynamicTypeIndex() != id) {
+          auto const buf = resource != nullptr ?
+            resource->allocate(entry.size_, entry.align_) : entry.allocator_();
+          elm.reset(static_cast<T*>(entry.constructor_(buf)));
+        }
+      }
+    }
+    begin = end;
+  }
+  if (begin != num) {
+    throw std::runtime_error("Corrupt type column: runs do not cover the size");
+  }
+
+  // Serialize the objects of each type in batches through one dispatcher
+  constexpr std::size_t batch_size = 256;
+  BaseT* batch[batch_size];
+  auto const ser_idx =
+    dispatch::vrt::serializer_registry::makeObjIdx<BaseT, SerializerT>();
+  for (std::size_t g = 0; g < types.size(); g++) {
+    auto const run_fn = entries[g]->serialize_run_;
+    std::size_t len = 0;
+    for (SerialSizeType i = 0; i < num; i++) {
+      if (ids[i] == types[g]) {
+        batch[len++] = vec[i].get();
+        if (len == batch_size) {
+          run_fn(&s, batch, len, ser_idx);
+          len = 0;
+        }
+      }
+    }
+    run_fn(&s, batch, len, ser_idx);
+  }
+}
+
+} /* end namespace checkpoint */
+
+#endif /*INCLUDED_SRC_CHECKPOINT_CONTAINER_TYPE_GROUPED_SERIALIZE_H*/
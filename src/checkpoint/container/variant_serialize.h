@@ -45,6 +45,7 @@
 #define INCLUDED_SRC_CHECKPOINT_CONTAINER_VARIANT_SERIALIZE_H
 
 #include "checkpoint/common.h"
+#include "checkpoint/container/container_serialize.h"
 #include "checkpoint/serializers/serializers_headers.h"
 #include "checkpoint/dispatch/allocator.h"
 
@@ -118,7 +119,7 @@ struct ByteCopyNonIntrusive<std::variant<Args...>> {
 template <typename SerializerT, typename... Args>
 void serialize(SerializerT& s, std::variant<Args...>& v) {
   std::size_t entry = v.index();
-  s | entry;
+  serializeSize(s, entry);
   detail::SerializeEntry<Args...>::serialize(s, v, entry, 0);
 }
 
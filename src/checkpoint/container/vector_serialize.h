@@ -45,26 +45,55 @@
 #define INCLUDED_SRC_CHECKPOINT_CONTAINER_VECTOR_SERIALIZE_H
 
 #include "checkpoint/common.h"
+#include "checkpoint/container/container_serialize.h"
 #include "checkpoint/dispatch/allocator.h"
 #include "checkpoint/dispatch/dispatch.h"
 #include "checkpoint/dispatch/reconstructor.h"
 #include "checkpoint/serializers/serializers_headers.h"
 
+#include <memory_resource>
+#include <new>
 #include <vector>
 
 namespace checkpoint {
 
+/**
+ * \brief Make a \c std::pmr::vector being unpacked allocate from the memory
+ * resource of the serializer, if it has one
+ *
+ * \param[in] s the serializer
+ * \param[in,out] vec the vector, whose contents are discarded if rebound
+ */
+template <typename SerializerT, typename T, typename VectorAllocator>
+void useMemoryResource(SerializerT& s, std::vector<T, VectorAllocator>& vec) {
+  using VectorT = std::vector<T, VectorAllocator>;
+  if constexpr (
+    std::is_same<VectorAllocator, std::pmr::polymorphic_allocator<T>>::value
+  ) {
+    auto const resource = s.getMemoryResource();
+    if (resource != nullptr and vec.get_allocator().resource() != resource) {
+      // A polymorphic allocator does not propagate on assignment or swap
+      vec.~VectorT();
+      ::new (&vec) VectorT(VectorAllocator(resource));
+    }
+  }
+}
+
 template <typename SerializerT, typename T, typename VectorAllocator>
 typename std::enable_if_t<
   not checkpoint::is_footprinter_v<SerializerT>, SerialSizeType
 >
 serializeVectorMeta(SerializerT& s, std::vector<T, VectorAllocator>& vec) {
+  if (s.isUnpacking()) {
+    useMemoryResource(s, vec);
+  }
+
   SerialSizeType vec_capacity = vec.capacity();
-  s | vec_capacity;
+  serializeSize(s, vec_capacity);
   vec.reserve(vec_capacity);
 
   SerialSizeType vec_size = vec.size();
-  s | vec_size;
+  serializeSize(s, vec_size);
   return vec_size;
 }
 
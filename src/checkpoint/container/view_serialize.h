@@ -289,6 +289,12 @@ inline void serialize_impl(SerializerT& s, Kokkos::DynRankView<T,Args...>& view)
       deepCopyWithLocalFence(host_view, view);
     }
 
+    // A separate mirror is destroyed on return, so it must not be referenced
+    bool const transient = host_view.data() != view.data();
+    if (transient) {
+      s.beginTransient();
+    }
+
     // Serialize the actual data owned by the Kokkos::View
     if (is_contig) {
       // Serialize the data directly out of the data buffer
@@ -317,6 +323,10 @@ inline void serialize_impl(SerializerT& s, Kokkos::DynRankView<T,Args...>& view)
       }
     }
 
+    if (transient) {
+      s.endTransient();
+    }
+
     if (s.isUnpacking()) {
       deepCopyWithLocalFence(view, host_view);
     }
@@ -388,6 +398,12 @@ inline void serialize_impl(SerializerT& s, Kokkos::View<T,Args...>& view) {
       deepCopyWithLocalFence(host_view, view);
     }
 
+    // A separate mirror is destroyed on return, so it must not be referenced
+    bool const transient = host_view.data() != view.data();
+    if (transient) {
+      s.beginTransient();
+    }
+
     // Serialize the actual data owned by the Kokkos::View
     if (is_contig) {
       // Serialize the data directly out of the data buffer
@@ -410,6 +426,10 @@ inline void serialize_impl(SerializerT& s, Kokkos::View<T,Args...>& view) {
 #endif
     }
 
+    if (transient) {
+      s.endTransient();
+    }
+
     if (s.isUnpacking()) {
       deepCopyWithLocalFence(view, host_view);
     }
@@ -424,7 +444,9 @@ inline void serialize_const(SerializerT& s, Kokkos::View<T,Args...>& view) {
   if (s.isPacking()) {
     deepCopyWithLocalFence(tmp_non_const, view);
   }
+  s.beginTransient();
   serialize_impl(s, tmp_non_const);
+  s.endTransient();
   if (s.isUnpacking()) {
     view = tmp_non_const;
   }
@@ -0,0 +1,129 @@
+/*
+//@HEADER
+// *****************************************************************************
+//
+//                              delta_checkpoint.h
+//                 DARMA/magistrate => Serialization Library
+//
+// Copyright 2019 National Technology & Engineering Solutions of Sandia, LLC
+// (NTESS). Under the terms of Contract DE-NA0003525 with NTESS, the U.S.
+// Government retains certain rights in this software.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+//
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// * Neither the name of the copyright holder nor the names of its
+//   contributors may be used to endorse or promote products derived from this
+//   software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// Questions? Contact darma@sandia.gov
+//
+// *****************************************************************************
+//@HEADER
+*/
+
+#if !defined INCLUDED_SRC_CHECKPOINT_DELTA_CHECKPOINT_H
+#define INCLUDED_SRC_CHECKPOINT_DELTA_CHECKPOINT_H
+
+#include "checkpoint/common.h"
+#include "checkpoint/checkpoint_api.h"
+#include "checkpoint/buffer/delta_image.h"
+
+#include <memory>
+#include <string>
+
+namespace checkpoint {
+
+using DeltaOptions = buffer::DeltaOptions;
+using DeltaWriteStats = buffer::DeltaWriteStats;
+
+/**
+ * \struct DeltaCheckpointer
+ *
+ * \brief Writes a series of checkpoints of one object, storing in each file
+ * only the blocks of the packed image that changed since the previous one
+ *
+ * The first checkpoint (and every one after \c DeltaOptions::max_chain
+ * deltas) is a full image; the others name the previous file as their base.
+ * Each file is tagged as full or delta, so read any of them back with
+ * \c deserializeFromDeltaFile.
+ */
+struct DeltaCheckpointer {
+  explicit DeltaCheckpointer(DeltaOptions const& options = DeltaOptions{})
+    : writer_(options)
+  { }
+
+  /**
+   * \brief Serialize \c target and write it to \c file
+   *
+   * \param[in] target the \c T to serialize
+   * \param[in] file the file to write
+   *
+   * \return what was written
+   */
+  template <typename T>
+  DeltaWriteStats checkpoint(T& target, std::string const& file) {
+    auto image = ::checkpoint::serialize<T>(target);
+    return writer_.write(
+      reinterpret_cast<SerialByteType const*>(image->getBuffer()),
+      image->getSize(), file
+    );
+  }
+
+  /**
+   * \brief Make the next checkpoint a full image
+   */
+  void reset() { writer_.reset(); }
+
+  /**
+   * \brief Get the last file written
+   *
+   * \return the file name, or empty if nothing has been written since the
+   * last reset
+   */
+  std::string getLastFile() const { return writer_.getLastFile(); }
+
+private:
+  buffer::DeltaImageWriter writer_;
+};
+
+/**
+ * \brief Rebuild the image in a full or delta checkpoint file from its chain
+ * of base files and deserialize it
+ *
+ * \param[in] file the checkpoint file
+ * \param[in] options how each file in the chain is read
+ *
+ * \return a \c std::unique_ptr to the new \c T
+ */
+template <typename T>
+std::unique_ptr<T> deserializeFromDeltaFile(
+  std::string const& file, FileReadOptions const& options = FileReadOptions{}
+) {
+  return deserialize<T>(
+    SerializedReturnType(buffer::readDeltaImage(file, options).release())
+  );
+}
+
+} /* end namespace checkpoint */
+
+#endif /*INCLUDED_SRC_CHECKPOINT_DELTA_CHECKPOINT_H*/
@@ -52,6 +52,7 @@
 #include "checkpoint/dispatch/reconstructor.h"
 
 #include <functional>
+#include <memory_resource>
 
 #include <tuple>
 
@@ -101,6 +102,19 @@ struct Traverse {
   template <typename T, typename TraverserT, typename... Args>
   static TraverserT with(T& target, Args&&... args);
 
+  /**
+   * \brief Traverse a top-level \c target of type \c T with an already
+   * constructed traverser, framing it exactly as \c with(target, args...)
+   * does (e.g., to configure the traverser before it runs)
+   *
+   * \param[in,out] target the target to traverse
+   * \param[in,out] t a reference to the traverser
+   *
+   * \return the traverser after traversal is complete
+   */
+  template <typename T, typename TraverserT>
+  static TraverserT& withRoot(T& target, TraverserT& t);
+
   /**
    * \brief Reconstruct in place a \c T on allocated memory \c mem. The buffer
    * \c mem must contain enough memory to hold \c sizeof(T). This calls the
@@ -196,15 +210,45 @@ buffer::ImplReturnType packBuffer(
 template <typename Serializer, typename T>
 inline void serializeArray(Serializer& s, T* array, SerialSizeType const len);
 
+/**
+ * \brief Serialize a byte-copyable array that is borrowed, not copied, when
+ * unpacking
+ *
+ * Packing writes the elements like \c serializeArray, preceded by zero
+ * padding so the elements start at a multiple of \c align from the beginning
+ * of the stream. Unpacking sets \c array to point at the elements inside the
+ * serializer's buffer. A \c serialization_error is thrown if the serializer
+ * cannot lend its buffer or the buffer is not suitably aligned.
+ *
+ * \param[in] s the serializer
+ * \param[in,out] array the elements to pack, or the borrowed pointer
+ * \param[in] len the number of elements
+ * \param[in] align the alignment of the elements in the stream
+ */
+template <typename Serializer, typename T>
+inline void serializeBorrowedArray(
+  Serializer& s, T*& array, SerialSizeType const len,
+  SerialSizeType const align = 1
+);
+
 template <typename T>
 buffer::ImplReturnType serializeType(T& target, BufferObtainFnType fn = nullptr);
 
+template <typename T>
+buffer::ImplReturnType
+serializeTypeSinglePass(T& target, SerialSizeType initial_capacity);
+
 template <typename T>
 T* deserializeType(SerialByteType* data, SerialByteType* allocBuf = nullptr);
 
 template <typename T>
 void deserializeType(InPlaceTag, SerialByteType* data, T* t);
 
+template <typename T>
+T* deserializeTypeToResource(
+  SerialByteType* data, std::pmr::memory_resource* resource
+);
+
 template <typename T>
 std::size_t sizeType(T& t);
 
@@ -47,7 +47,12 @@
 #include "checkpoint/common.h"
 #include "checkpoint/dispatch/dispatch.h"
 #include "checkpoint/dispatch/type_registry.h"
+#include "checkpoint/dispatch/serialization_error.h"
+#include "checkpoint/dispatch/structure_hash.h"
 
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
 #include <stdexcept>
 #include <string>
 
@@ -62,14 +67,6 @@ inline Serializer& operator|(Serializer& s, T& target) {
 
 namespace checkpoint { namespace dispatch {
 
-struct serialization_error : public std::runtime_error {
-  explicit serialization_error(std::string const& msg, int const depth = 0)
-    : std::runtime_error(msg),
-      depth_(depth) { }
-
-  int const depth_ = 0;
-};
-
 template <typename T, typename TraverserT>
 TraverserT& withTypeIdx(TraverserT& t) {
   using CleanT = typename CleanType<typeregistry::DecodedIndex>::CleanT;
@@ -143,6 +140,8 @@ TraverserT& Traverse::with(T& target, TraverserT& t, SerialSizeType len) {
   withTypeIdx<CleanT>(t);
   #endif
 
+  withTypeHash<CleanT>(t, len);
+
   auto val = cleanType(&target);
   SerializerDispatch<TraverserT, CleanT, DispatchType> ap;
 
@@ -166,19 +165,25 @@ TraverserT& Traverse::with(T& target, TraverserT& t, SerialSizeType len) {
   return t;
 }
 
-template <typename T, typename TraverserT, typename... Args>
-TraverserT Traverse::with(T& target, Args&&... args) {
+template <typename T, typename TraverserT>
+TraverserT& Traverse::withRoot(T& target, TraverserT& t) {
   #if !defined(SERIALIZATION_ERROR_CHECKING)
   using CleanT = typename CleanType<T>::CleanT;
-  #endif
-
-  TraverserT t(std::forward<Args>(args)...);
-
-  #if !defined(SERIALIZATION_ERROR_CHECKING)
   withTypeIdx<CleanT>(t);
   #endif
 
+  #if defined(SERIALIZATION_HASH_CHECKING)
+  detail::getStructureTrace().clear();
+  try {
+    with(target, t);
+  } catch (serialization_error const& err) {
+    throw serialization_error(
+      std::string(err.what()) + detail::takeStructureTrace()
+    );
+  }
+  #else
   with(target, t);
+  #endif
 
   #if !defined(SERIALIZATION_ERROR_CHECKING)
   withMemUsed<CleanT>(t, 1);
@@ -187,6 +192,13 @@ TraverserT Traverse::with(T& target, Args&&... args) {
   return t;
 }
 
+template <typename T, typename TraverserT, typename... Args>
+TraverserT Traverse::with(T& target, Args&&... args) {
+  TraverserT t(std::forward<Args>(args)...);
+  withRoot(target, t);
+  return t;
+}
+
 template <typename T>
 T* Traverse::reconstruct(SerialByteType* mem) {
   return Reconstructor<typename CleanType<T>::CleanT>::construct(mem);
@@ -233,6 +245,64 @@ inline void serializeArray(Serializer& s, T* array, SerialSizeType const len) {
   }
 }
 
+template <typename Serializer, typename T>
+inline void serializeBorrowedArray(
+  Serializer& s, T*& array, SerialSizeType const len,
+  SerialSizeType const align
+) {
+  using CleanT = typename CleanType<T>::CleanT;
+
+  if (len == 0 or s.isFootprinting()) {
+    return;
+  }
+
+  #if defined(SERIALIZATION_ERROR_CHECKING)
+  withTypeIdx<CleanT>(s);
+  #endif
+
+  // Pad relative to the stream start, which is how packers/sizers count bytes
+  SerialSizeType const pad = align > 1 ?
+    (align - s.usedBufferSize() % align) % align : 0;
+
+  if (s.isUnpacking()) {
+    if (not s.isLendingBytes()) {
+      throw serialization_error(
+        "Type '" + typeregistry::getTypeName<CleanT>() + "' borrows from the "
+        "bytes being unpacked, which do not outlive it; deserialize it with "
+        "deserializeBorrowed or deserializeBorrowedFromFile"
+      );
+    }
+    auto const spot = s.borrowBytes(pad + sizeof(T) * len);
+    if (spot == nullptr) {
+      throw serialization_error(
+        "Serializer cannot lend its buffer to borrow type '" +
+        typeregistry::getTypeName<CleanT>() + "'"
+      );
+    }
+    auto const data = spot + pad;
+    if (reinterpret_cast<std::uintptr_t>(data) % alignof(T) != 0) {
+      throw serialization_error(
+        "Buffer is not aligned to borrow type '" +
+        typeregistry::getTypeName<CleanT>() + "'"
+      );
+    }
+    array = reinterpret_cast<T*>(data);
+  } else {
+    SerialByteType zeros[alignof(std::max_align_t)] = {};
+    for (SerialSizeType left = pad; left > 0; ) {
+      auto const n = std::min<SerialSizeType>(left, sizeof(zeros));
+      s.contiguousBytes(zeros, 1, n);
+      left -= n;
+    }
+    auto val = const_cast<CleanT*>(array);
+    s.contiguousTyped(s, val, len);
+  }
+
+  #if defined(SERIALIZATION_ERROR_CHECKING)
+  withMemUsed<CleanT>(s, len);
+  #endif
+}
+
 template <typename TargetT, typename PackerT>
 inline void
 validatePackerBufferSize(PackerT const& p, SerialSizeType bufferSize) {
@@ -272,6 +342,17 @@ buffer::ImplReturnType serializeType(T& target, BufferObtainFnType fn) {
   return packBuffer<T>(target, len, fn);
 }
 
+template <typename T>
+buffer::ImplReturnType
+serializeTypeSinglePass(T& target, SerialSizeType initial_capacity) {
+  auto p = Standard::pack<T, PackerBuffer<buffer::GrowableBuffer>>(
+    target, initial_capacity
+  );
+  auto const len = p.usedBufferSize();
+  debug_checkpoint("serializeTypeSinglePass: len=%ld\n", len);
+  return std::make_tuple(std::move(p.extractPackedBuffer()), len);
+}
+
 template <typename T>
 T* deserializeType(SerialByteType* data, SerialByteType* allocBuf) {
   auto mem = allocBuf ? allocBuf : Standard::allocate<T>();
@@ -287,6 +368,21 @@ void deserializeType(InPlaceTag, SerialByteType* data, T* t) {
   Standard::unpack<T, UnpackerBuffer<buffer::UserBuffer>>(t, data);
 }
 
+template <typename T>
+T* deserializeTypeToResource(
+  SerialByteType* data, std::pmr::memory_resource* resource
+) {
+  // Nothing is freed on failure: memory from the resource goes back with it
+  auto mem = static_cast<SerialByteType*>(
+    resource->allocate(sizeof(T), alignof(T))
+  );
+  T* t = Standard::construct<T>(mem);
+  UnpackerBuffer<buffer::UserBuffer> u(data);
+  u.setMemoryResource(resource);
+  Traverse::withRoot(*t, u);
+  return t;
+}
+
 }} /* end namespace checkpoint::dispatch */
 
 #endif /*INCLUDED_SRC_CHECKPOINT_DISPATCH_DISPATCH_IMPL_H*/
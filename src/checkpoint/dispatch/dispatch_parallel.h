@@ -0,0 +1,279 @@
+/*
+//@HEADER
+// *****************************************************************************
+//
+//                             dispatch_parallel.h
+//                 DARMA/magistrate => Serialization Library
+//
+// Copyright 2019 National Technology & Engineering Solutions of Sandia, LLC
+// (NTESS). Under the terms of Contract DE-NA0003525 with NTESS, the U.S.
+// Government retains certain rights in this software.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+//
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// * Neither the name of the copyright holder nor the names of its
+//   contributors may be used to endorse or promote products derived from this
+//   software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// Questions? Contact darma@sandia.gov
+//
+// *****************************************************************************
+//@HEADER
+*/
+
+#if !defined INCLUDED_SRC_CHECKPOINT_DISPATCH_DISPATCH_PARALLEL_H
+#define INCLUDED_SRC_CHECKPOINT_DISPATCH_DISPATCH_PARALLEL_H
+
+#include "checkpoint/common.h"
+#include "checkpoint/serializers/sizer.h"
+#include "checkpoint/serializers/packer.h"
+#include "checkpoint/serializers/unpacker.h"
+#include "checkpoint/serializers/parallel_serializer.h"
+#include "checkpoint/buffer/parallel_for.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+namespace checkpoint { namespace dispatch {
+
+/*
+ * With ParallelPackOptions::indexed, every array of at least two elements that
+ * goes through serializeChunks is preceded by an element index:
+ *
+ *   uint8_t  1 if the index follows, 0 if the elements are packed serially
+ *   uint64_t number of chunks
+ *   uint64_t elements per chunk (the last chunk may be shorter)
+ *   uint64_t packed bytes of each chunk
+ *
+ * Chunks are packed independently, so a reader can start unpacking each chunk
+ * at the prefix sum of the preceding chunk sizes.
+ */
+
+/// Number of chunks an array is cut into when building an element index
+static constexpr SerialSizeType const indexed_chunks = 256;
+
+namespace detail {
+
+template <typename SerializerT, typename ChunkFn>
+bool sizeOrPackChunks(SerializerT& s, SerialSizeType num, ChunkFn& fn) {
+  auto const& options = s.getParallelOptions();
+  auto const threads = std::max(options.num_threads, 1u);
+  bool const indexed = options.indexed and num >= 2;
+  if (not indexed and threads < 2) {
+    return false;
+  }
+
+  std::uint8_t marker = 0;
+  auto const min_elements = std::max<SerialSizeType>(options.min_elements, 2);
+  if (num < min_elements) {
+    if (indexed) {
+      s.contiguousBytes(&marker, 1, 1);
+    }
+    return false;
+  }
+
+  auto const target_chunks = indexed ?
+    std::max<SerialSizeType>(indexed_chunks, SerialSizeType{threads} * 8) :
+    SerialSizeType{threads} * 8;
+  auto const chunk = options.chunk_elements > 0 ?
+    options.chunk_elements :
+    std::max<SerialSizeType>(1, num / target_chunks);
+  auto const num_chunks = (num + chunk - 1) / chunk;
+  auto const chunkLength = [&](SerialSizeType c) {
+    return std::min(chunk, num - c * chunk);
+  };
+
+  /*
+   * A packer replays the chunk sizes its ParallelSizer recorded (an empty
+   * entry: the array was not chunked) instead of sizing every chunk again
+   */
+  std::vector<std::uint64_t> sizes;
+  bool sized = false;
+  auto plan = s.getChunkPlan();
+  if constexpr (not std::is_base_of<Sizer, SerializerT>::value) {
+    if (plan != nullptr and plan->next < plan->sizes.size()) {
+      sizes = std::move(plan->sizes[plan->next++]);
+      sized = true;
+      if (not sizes.empty() and sizes.size() != num_chunks) {
+        throw std::runtime_error(
+          "Parallel packing: chunk plan has " + std::to_string(sizes.size()) +
+          " chunks, but the array has " + std::to_string(num_chunks)
+        );
+      }
+    }
+  }
+
+  if (not sized) {
+    sizes.assign(num_chunks, 0);
+    std::atomic<bool> offset_used{false};
+    buffer::parallelFor(num_chunks, threads, [&](SerialSizeType c) {
+      Sizer sizer;
+      fn(sizer, c * chunk, chunkLength(c));
+      sizes[c] = sizer.getSize();
+      if (sizer.isOffsetUsed()) {
+        offset_used = true;
+      }
+    });
+    if (offset_used) {
+      sizes.clear();
+    }
+    if constexpr (std::is_base_of<Sizer, SerializerT>::value) {
+      if (plan != nullptr) {
+        plan->sizes.push_back(sizes);
+      }
+    }
+  }
+
+  if (sizes.empty()) {
+    if (indexed) {
+      s.contiguousBytes(&marker, 1, 1);
+    }
+    return false;
+  }
+
+  if (indexed) {
+    marker = 1;
+    std::uint64_t header[2] = {num_chunks, chunk};
+    s.contiguousBytes(&marker, 1, 1);
+    s.contiguousBytes(header, sizeof(std::uint64_t), 2);
+    s.contiguousBytes(sizes.data(), sizeof(std::uint64_t), num_chunks);
+  }
+
+  std::vector<SerialSizeType> offsets(num_chunks + 1, 0);
+  for (SerialSizeType c = 0; c < num_chunks; c++) {
+    offsets[c + 1] = offsets[c] + sizes[c];
+  }
+  auto const total = offsets[num_chunks];
+
+  if constexpr (std::is_base_of<Sizer, SerializerT>::value) {
+    s.contiguousBytes(nullptr, 1, total);
+  } else {
+    SerialByteType* const spot = s.claimBytes(total);
+    buffer::parallelFor(num_chunks, threads, [&](SerialSizeType c) {
+      auto const len = sizes[c];
+      PackerUserBuf packer(
+        len, std::make_unique<buffer::UserBuffer>(spot + offsets[c], len)
+      );
+      fn(packer, c * chunk, chunkLength(c));
+      if (packer.usedBufferSize() != len) {
+        throw std::runtime_error(
+          "Parallel packing: chunk " + std::to_string(c) + " was sized " +
+          std::to_string(len) + "B, but packed " +
+          std::to_string(packer.usedBufferSize()) + "B"
+        );
+      }
+    });
+  }
+  return true;
+}
+
+template <typename SerializerT, typename ChunkFn>
+bool unpackChunks(SerializerT& s, SerialSizeType num, ChunkFn& fn) {
+  if (num < 2) {
+    return false;
+  }
+
+  std::uint8_t marker = 0;
+  s.contiguousBytes(&marker, 1, 1);
+  if (marker == 0) {
+    return false;
+  }
+
+  std::uint64_t header[2] = {0, 0};
+  s.contiguousBytes(header, sizeof(std::uint64_t), 2);
+  auto const num_chunks = static_cast<SerialSizeType>(header[0]);
+  auto const chunk = static_cast<SerialSizeType>(header[1]);
+  if (marker != 1 or chunk == 0 or num_chunks != (num + chunk - 1) / chunk) {
+    throw std::runtime_error(
+      "Parallel unpacking: corrupt element index for " + std::to_string(num) +
+      " elements"
+    );
+  }
+
+  std::vector<std::uint64_t> sizes(num_chunks, 0);
+  s.contiguousBytes(sizes.data(), sizeof(std::uint64_t), num_chunks);
+  std::vector<SerialSizeType> offsets(num_chunks + 1, 0);
+  for (SerialSizeType c = 0; c < num_chunks; c++) {
+    offsets[c + 1] = offsets[c] + sizes[c];
+  }
+
+  SerialByteType* const spot = s.borrowBytes(offsets[num_chunks]);
+  buffer::parallelFor(num_chunks, s.getNumThreads(), [&](SerialSizeType c) {
+    auto const len = static_cast<SerialSizeType>(sizes[c]);
+    Unpacker unpacker(spot + offsets[c], len);
+    unpacker.setLendingBytes(s.isLendingBytes());
+    fn(unpacker, c * chunk, std::min(chunk, num - c * chunk));
+    if (unpacker.usedBufferSize() != len) {
+      throw std::runtime_error(
+        "Parallel unpacking: chunk " + std::to_string(c) + " was packed as " +
+        std::to_string(len) + "B, but unpacked " +
+        std::to_string(unpacker.usedBufferSize()) + "B"
+      );
+    }
+  });
+  return true;
+}
+
+} /* end namespace detail */
+
+/**
+ * \brief Serialize \c num elements in chunks, on several threads when \c s is
+ * a parallel serializer (\c ParallelSizer, \c ParallelPackerBuffer or
+ * \c ParallelUnpackerBuffer)
+ *
+ * Every chunk is sized with its own \c Sizer while \c ParallelSizer runs,
+ * and the sizes are recorded in its \c ParallelChunkPlan; packing reuses them
+ * to claim the total from \c s and packs each chunk with a \c PackerUserBuf at its offset from
+ * the prefix sum of the sizes, so without an index the bytes match a serial
+ * traversal. With \c ParallelPackOptions::indexed the chunk sizes are written
+ * ahead of the chunks so \c ParallelUnpackerBuffer can unpack the chunks
+ * concurrently. If an element's size depends on where it lands in the buffer
+ * (alignment padding), nothing is chunked.
+ *
+ * \param[in] s the serializer
+ * \param[in] num the number of elements
+ * \param[in] fn called as \c fn(sub, begin, n) to serialize elements
+ * [begin, begin + n) with the chunk serializer \c sub
+ *
+ * \return whether the elements were serialized; if not, the caller must
+ * serialize them serially with \c s
+ */
+template <typename SerializerT, typename ChunkFn>
+bool serializeChunks(SerializerT& s, SerialSizeType num, ChunkFn&& fn) {
+  if constexpr (IsParallelUnpacker<SerializerT>::value) {
+    return detail::unpackChunks(s, num, fn);
+  } else if constexpr (IsParallelSerializer<SerializerT>::value) {
+    return detail::sizeOrPackChunks(s, num, fn);
+  } else {
+    return false;
+  }
+}
+
+}} /* end namespace checkpoint::dispatch */
+#endif /*INCLUDED_SRC_CHECKPOINT_DISPATCH_DISPATCH_PARALLEL_H*/
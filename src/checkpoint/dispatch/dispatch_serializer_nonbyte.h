@@ -48,6 +48,8 @@
 #include "checkpoint/traits/serializable_traits.h"
 #include "checkpoint/dispatch/vrt/virtual_serialize_traits.h"
 #include "checkpoint/dispatch/vrt/virtual_serialize.h"
+#include "checkpoint/dispatch/dispatch_parallel.h"
+#include "checkpoint/dispatch/structure_hash.h"
 
 #include <type_traits>
 #include <tuple>
@@ -171,6 +173,28 @@ struct SerializerDispatchNonByte {
     s.contiguousBytes(val, sizeof(T), num);
   }
 
+  /**
+   * \brief Serialize an array in chunks, on several threads when \c s is a
+   * parallel serializer (see \c serializeChunks)
+   *
+   * \param[in] s serializer to use
+   * \param[in] val pointer to the array of objects
+   * \param[in] num number of objects in the array
+   *
+   * \return whether the array was serialized
+   */
+  bool applyParallel(SerializerT& s, T* val, SerialSizeType num) {
+    return serializeChunks(
+      s, num, [val](auto& sub, SerialSizeType begin, SerialSizeType n) {
+        using SubT = std::decay_t<decltype(sub)>;
+        using SubDispatch = SerializerDispatchNonByte<
+          SubT, T, typename SubT::template DispatcherType<SubT, T>
+        >;
+        SubDispatch{}.applyStatic(sub, val + begin, n);
+      }
+    );
+  }
+
   template <typename U = T>
   void applyStatic(
     SerializerT& s, T* val, SerialSizeType num, hasInSerialize<U>* = nullptr
@@ -180,8 +204,13 @@ struct SerializerDispatchNonByte {
       static_cast<void*>(&val),
       typeid(val).name()
     );
+    if (applyParallel(s, val, num)) {
+      return;
+    }
     for (SerialSizeType i = 0; i < num; i++) {
-      Dispatcher::serializeIntrusive(s, val[i]);
+      withStructureHash<T>(s, [&]{
+        Dispatcher::serializeIntrusive(s, val[i]);
+      });
       applyElm(s, val+i);
     }
   }
@@ -195,8 +224,13 @@ struct SerializerDispatchNonByte {
       static_cast<void*>(&val),
       typeid(val).name()
     );
+    if (applyParallel(s, val, num)) {
+      return;
+    }
     for (SerialSizeType i = 0; i < num; i++) {
-      Dispatcher::serializeNonIntrusive(s, val[i]);
+      withStructureHash<T>(s, [&]{
+        Dispatcher::serializeNonIntrusive(s, val[i]);
+      });
     }
   }
 
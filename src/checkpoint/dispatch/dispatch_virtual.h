@@ -151,11 +151,13 @@
  * for each \c T ) we must match up the entry across registries for a derived
  * type when we invoke the serialize from that registry entry on it. Thus, we
  * use \c linkDerivedToBase<SerializerT,DerivedT,BaseT>() to link the
- * entries---store the base index in the derived index's entry. Using this, when
- * picking the right serializer for the derived, we check the dervied entries
- * for the one that matches the base index. This ensures that no matter what
+ * entries---store the base index in the derived index's entry, and the
+ * derived entry's dispatch function in a flat table of the derived type indexed
+ * by the base index. Using this, picking the right serializer for the derived
+ * is a single lookup of the base index. This ensures that no matter what
  * order the static serializer registries are created in we get the right
- * serializer across multiple registries.
+ * serializer across multiple registries. Registering and linking happen on the
+ * first \c _checkpointDynamicSerialize call for each type.
  *
  * During unpacking a user's \c T -- which is virtually serialized -- we have to
  * construct the correct derived type based on what was actually instantiated
@@ -0,0 +1,222 @@
+/*
+//@HEADER
+// *****************************************************************************
+//
+//                               structure_hash.h
+//                 DARMA/magistrate => Serialization Library
+//
+// Copyright 2019 National Technology & Engineering Solutions of Sandia, LLC
+// (NTESS). Under the terms of Contract DE-NA0003525 with NTESS, the U.S.
+// Government retains certain rights in this software.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+//
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// * Neither the name of the copyright holder nor the names of its
+//   contributors may be used to endorse or promote products derived from this
+//   software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// Questions? Contact darma@sandia.gov
+//
+// *****************************************************************************
+//@HEADER
+*/
+
+#if !defined INCLUDED_SRC_CHECKPOINT_DISPATCH_STRUCTURE_HASH_H
+#define INCLUDED_SRC_CHECKPOINT_DISPATCH_STRUCTURE_HASH_H
+
+#include "checkpoint/common.h"
+#include "checkpoint/serializers/base_serializer.h"
+#include "checkpoint/dispatch/serialization_error.h"
+#include "checkpoint/dispatch/type_registry.h"
+
+#include <cstdint>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+namespace checkpoint { namespace dispatch {
+
+/*
+ * With SERIALIZATION_HASH_CHECKING, every field traversed folds its type and
+ * element count into a rolling hash kept by the serializer. Each object that
+ * is serialized by a serialize method (including containers) starts a hash
+ * of its own, which is written as 4 little-endian bytes after its members
+ * and compared when unpacking. A mismatch throws a serialization_error whose
+ * message ends with the types of the enclosing objects, innermost first:
+ *
+ *   #0 Inner
+ *   #1 Outer
+ *
+ * The trace is collected while the exception unwinds, so the fields pay for
+ * no tag in the buffer.
+ */
+
+namespace detail {
+
+/// Types of the objects an error unwound through, innermost first
+inline std::vector<typeregistry::DecodedIndex>& getStructureTrace() {
+  static thread_local std::vector<typeregistry::DecodedIndex> trace;
+  return trace;
+}
+
+/**
+ * \brief Format and clear the trace recorded while an error unwound
+ *
+ * \return the trace, one "\n#N TypeName" line per object
+ */
+inline std::string takeStructureTrace() {
+  auto& trace = getStructureTrace();
+  std::string out;
+  for (std::size_t i = 0; i < trace.size(); i++) {
+    out += "\n#" + std::to_string(i) + " " +
+      typeregistry::getTypeNameForIdx(trace[i]);
+  }
+  trace.clear();
+  return out;
+}
+
+/**
+ * \brief Add \c T to the trace of an error unwinding through it
+ */
+template <typename T>
+inline void traceStructure() {
+  try {
+    getStructureTrace().push_back(typeregistry::getTypeIdx<T>());
+  } catch (...) { }
+}
+
+/*
+ * Only a rotate and xor depend on the previous field, so hashing a long run of
+ * fields is not bound by multiply latency; the multiply in finishing the hash
+ * spreads the bits again.
+ */
+inline std::uint64_t mixStructureHash(
+  std::uint64_t hash, std::uint64_t type_hash, SerialSizeType len
+) {
+  return (hash << 7 | hash >> 57) ^ type_hash ^ (len * 0x9e3779b97f4a7c15ull);
+}
+
+inline std::uint32_t finishStructureHash(std::uint64_t hash) {
+  hash *= 0xff51afd7ed558ccdull;
+  return static_cast<std::uint32_t>(hash ^ (hash >> 32));
+}
+
+} /* end namespace detail */
+
+/**
+ * \brief Fold the type and number of elements of a traversed field into the
+ * hash of the enclosing object
+ *
+ * \param[in] s the serializer
+ * \param[in] len the number of elements
+ * \param[in] times how many such fields were traversed in a row (e.g., by
+ * chunk serializers on behalf of \c s)
+ */
+template <typename T, typename SerializerT>
+inline void withTypeHash(
+  SerializerT& s, SerialSizeType len, SerialSizeType times = 1
+) {
+  #if defined(SERIALIZATION_HASH_CHECKING)
+  if constexpr (std::is_base_of<BaseSerializer, SerializerT>::value) {
+    // Sizing only needs to know that each object is followed by a hash
+    if (s.isSizing()) {
+      return;
+    }
+    auto const type_hash = typeregistry::getTypeHash<T>();
+    auto hash = s.getStructureHash();
+    for (SerialSizeType i = 0; i < times; i++) {
+      hash = detail::mixStructureHash(hash, type_hash, len);
+    }
+    s.setStructureHash(hash);
+  }
+  #else
+  (void)s;
+  (void)len;
+  (void)times;
+  #endif
+}
+
+/**
+ * \brief Serialize one object of type \c T with \c fn, writing (or checking,
+ * when unpacking) the hash of the fields it traversed afterwards
+ *
+ * \param[in] s the serializer
+ * \param[in] fn serializes the members of the object
+ */
+template <typename T, typename SerializerT, typename Fn>
+inline void withStructureHash(SerializerT& s, Fn&& fn) {
+  #if defined(SERIALIZATION_HASH_CHECKING)
+  if constexpr (std::is_base_of<BaseSerializer, SerializerT>::value) {
+    // Custom traversers and footprinters see the same fields as without it
+    if (not s.isPacking() and not s.isSizing() and not s.isUnpacking()) {
+      fn();
+      return;
+    }
+
+    auto const parent = s.getStructureHash();
+    s.setStructureHash(typeregistry::getTypeHash<T>());
+    try {
+      fn();
+    } catch (...) {
+      detail::traceStructure<T>();
+      throw;
+    }
+
+    auto folded = detail::finishStructureHash(s.getStructureHash());
+    s.setStructureHash(parent);
+
+    // Always 4 little-endian bytes: never a varint, nor in host byte order
+    SerialByteType bytes[sizeof(folded)] = {};
+    if (s.isUnpacking()) {
+      s.contiguousBytes(bytes, 1, sizeof(bytes));
+      std::uint32_t expected = 0;
+      for (std::size_t i = 0; i < sizeof(bytes); i++) {
+        auto const b = static_cast<unsigned char>(bytes[i]);
+        expected |= static_cast<std::uint32_t>(b) << (8 * i);
+      }
+      if (expected != folded) {
+        detail::traceStructure<T>();
+        throw serialization_error(
+          "Unpacking a different structure than was packed for type '" +
+          typeregistry::getTypeName<T>() + "': hash=" +
+          std::to_string(folded) + ", expected=" + std::to_string(expected)
+        );
+      }
+    } else {
+      for (std::size_t i = 0; i < sizeof(bytes); i++) {
+        bytes[i] = static_cast<SerialByteType>((folded >> (8 * i)) & 0xff);
+      }
+      s.contiguousBytes(bytes, 1, sizeof(bytes));
+    }
+  } else {
+    fn();
+  }
+  #else
+  (void)s;
+  fn();
+  #endif
+}
+
+}} /* end namespace checkpoint::dispatch */
+
+#endif /*INCLUDED_SRC_CHECKPOINT_DISPATCH_STRUCTURE_HASH_H*/
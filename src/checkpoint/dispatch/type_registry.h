@@ -46,8 +46,11 @@
 
 #include <cstddef>
 #include <cstdint>
+#include <mutex>
 #include <string>
+#include <typeinfo>
 #include <unordered_map>
+#include <vector>
 
 #if defined __GNUG__
   #include <cstdlib>
@@ -78,13 +81,35 @@ inline std::string demangle(const char* name) {
 #endif
 
 using DecodedIndex = std::uint32_t;
-using TypeNames = std::unordered_map<DecodedIndex, std::string>;
+
+/**
+ * \struct TypeNames
+ *
+ * \brief The names of registered types. Registration, which runs during
+ * static initialization for every serialized type, only appends the mangled
+ * name; a type is demangled the first time its name is asked for, which is
+ * normally when an error message is built.
+ */
+struct TypeNames {
+  std::vector<char const*> mangled; /**< Mangled names by \c TypeIndex */
+  std::mutex mutex;                 /**< Guards \c demangled */
+  std::unordered_map<DecodedIndex, std::string> demangled; /**< Requested */
+};
 
 inline TypeNames& getRegisteredNames() {
   static TypeNames registered_names;
   return registered_names;
 }
 
+/**
+ * \brief Get the number of types registered so far
+ *
+ * \return the number of types
+ */
+inline std::size_t getNumRegistered() {
+  return getRegisteredNames().mangled.size();
+}
+
 using TypeIndex = std::uint16_t;
 
 inline TypeIndex getIndex() {
@@ -104,7 +129,7 @@ template <typename ObjT>
 struct Registrar {
   Registrar() {
     index = (getIndex() << 8) | dead_mark;
-    getRegisteredNames()[index] = demangle(typeid(ObjT).name());
+    getRegisteredNames().mangled.push_back(typeid(ObjT).name());
   }
 
   DecodedIndex index;
@@ -124,7 +149,15 @@ inline DecodedIndex getTypeIdx() {
 }
 
 inline std::string const& getTypeNameForIdx(DecodedIndex const typeIdx) {
-  return getRegisteredNames()[typeIdx];
+  auto& names = getRegisteredNames();
+  auto const i = static_cast<std::size_t>((typeIdx & ~dead_mask) >> 8);
+
+  std::lock_guard<std::mutex> lock(names.mutex);
+  auto const it = names.demangled.emplace(typeIdx, std::string{});
+  if (it.second and validateIndex(typeIdx) and i < names.mangled.size()) {
+    it.first->second = demangle(names.mangled[i]);
+  }
+  return it.first->second;
 }
 
 template <typename ObjT>
@@ -132,6 +165,35 @@ inline std::string const& getTypeName() {
   return getTypeNameForIdx(getTypeIdx<ObjT>());
 }
 
+using TypeHash = std::uint64_t;
+
+/**
+ * \brief Hash a type name with 64-bit FNV-1a
+ *
+ * \param[in] name the type name
+ *
+ * \return the hash
+ */
+inline TypeHash hashTypeName(char const* name) {
+  TypeHash hash = 0xcbf29ce484222325ull;
+  for (; *name != '\0'; name++) {
+    hash = (hash ^ static_cast<unsigned char>(*name)) * 0x100000001b3ull;
+  }
+  return hash;
+}
+
+/**
+ * \brief Get a hash of the mangled name of \c ObjT, which unlike its index
+ * does not depend on the order types were registered in
+ *
+ * \return the hash
+ */
+template <typename ObjT>
+inline TypeHash getTypeHash() {
+  static TypeHash const hash = hashTypeName(typeid(ObjT).name());
+  return hash;
+}
+
 }}} /* end namespace checkpoint::dispatch::typeregistry */
 
 #endif /*INCLUDED_SRC_CHECKPOINT_DISPATCH_TYPE_REGISTRY_H*/
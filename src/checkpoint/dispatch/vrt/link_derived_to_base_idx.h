@@ -56,6 +56,14 @@ inline void linkDerivedToBase() {
   // Link the DerivedT entry to the BaseT entry
   auto& entry = getObjIdxRef<DerivedT>(derived_idx);
   entry.base_idx_ = base_idx;
+
+  // Index the dispatch by the base entry so lookups need no scan
+  auto& table = getBaseTable<DerivedT>();
+  auto const idx = static_cast<std::size_t>(base_idx);
+  if (table.size() <= idx) {
+    table.resize(idx + 1, nullptr);
+  }
+  table[idx] = entry.serializer_;
 }
 
 }}} /* end namespace checkpoint::dispatch::vrt */
@@ -47,38 +47,63 @@
 #include "checkpoint/common.h"
 #include "checkpoint/dispatch/vrt/registry_common.h"
 #include "checkpoint/dispatch/reconstructor.h"
+#include "checkpoint/dispatch/type_registry.h"
+#include "checkpoint/detector.h"
 
-#include <functional>
+#include <cstring>
+#include <memory_resource>
+#include <stdexcept>
+#include <string>
 #include <vector>
 #include <tuple>
 
 namespace checkpoint { namespace dispatch { namespace vrt {
 namespace objregistry {
 
+using AllocatorFnType = void* (*)();
+
+template <typename T>
+using ConstructorFnType = T* (*)(void*);
+
+/// Serialize \c num objects of one concrete type through their base pointers
+template <typename T>
+using SerializeRunFnType = void (*)(void*, T* const*, std::size_t, TypeIdx);
+
 template <typename T>
 struct ObjectEntry {
 
-  template <typename Allocator, typename Constructor>
   ObjectEntry(
     TypeIdx in_idx,
+    char const* in_name,
     std::size_t in_size,
-    Allocator&& in_allocator,
-    Constructor&& in_constructor
+    std::size_t in_align,
+    AllocatorFnType in_allocator,
+    ConstructorFnType<T> in_constructor,
+    SerializeRunFnType<T> in_serialize_run
   ) : idx_(in_idx),
+      name_(in_name),
       size_(in_size),
+      align_(in_align),
       allocator_(in_allocator),
-      constructor_(in_constructor)
+      constructor_(in_constructor),
+      serialize_run_(in_serialize_run)
   { }
 
-  TypeIdx idx_ = no_type_idx;              /**< The type index for this ObjT */
-  std::size_t size_ = 0;                   /**< The registered object size */
-  std::function<void*(void)> allocator_;   /**< Do standard allocation for object */
-  std::function<T*(void*)> constructor_;   /**< Construct object on memory */
+  TypeIdx idx_ = no_type_idx;                 /**< The type id for this ObjT */
+  char const* name_ = nullptr;                /**< The mangled type name */
+  std::size_t size_ = 0;                      /**< The registered object size */
+  std::size_t align_ = 0;                     /**< The registered object alignment */
+  AllocatorFnType allocator_ = nullptr;       /**< Do standard allocation for object */
+  ConstructorFnType<T> constructor_ = nullptr; /**< Construct object on memory */
+  SerializeRunFnType<T> serialize_run_ = nullptr; /**< Serialize a run of objects */
 };
 
 template <typename T>
 using RegistryType = std::vector<ObjectEntry<T>>;
 
+template <typename T>
+using user_type_id_t = decltype(VirtualTypeId<T>::value);
+
 template <typename ObjT>
 struct Registrar {
   Registrar();
@@ -96,23 +121,144 @@ inline RegistryType<T>& getRegistry() {
   return reg;
 }
 
+/**
+ * \brief Open-addressed table from type id to one plus the position of its
+ * entry in the registry (zero marks an empty slot), at most half full
+ */
+template <typename T>
+inline std::vector<std::size_t>& getIdTable() {
+  static std::vector<std::size_t> table;
+  return table;
+}
+
+inline std::size_t getIdSlot(TypeIdx id, std::size_t mask) {
+  auto const h = static_cast<std::uint64_t>(id) * 0x9e3779b97f4a7c15ull;
+  return static_cast<std::size_t>(h >> 32) & mask;
+}
+
+/**
+ * \brief Get the type id written for \c ObjT: its \c VirtualTypeId if
+ * specialized, otherwise a hash of its mangled name, which is the same in
+ * every build and run
+ *
+ * \return the type id
+ */
+template <typename ObjT>
+inline TypeIdx makeTypeId() {
+  if constexpr (::detection::is_detected<user_type_id_t, ObjT>::value) {
+    constexpr TypeIdx id = VirtualTypeId<ObjT>::value;
+    static_assert(id >= 0, "A VirtualTypeId must not be negative");
+    return id;
+  } else {
+    auto const h = typeregistry::hashTypeName(typeid(ObjT).name());
+    return static_cast<TypeIdx>((h ^ (h >> 32)) & 0x7fffffff);
+  }
+}
+
+template <typename T>
+inline void insertIdTable(std::size_t pos) {
+  auto& reg = getRegistry<T>();
+  auto& table = getIdTable<T>();
+
+  if (table.size() < 2 * reg.size()) {
+    std::size_t size = 16;
+    while (size < 2 * reg.size()) {
+      size *= 2;
+    }
+    table.assign(size, 0);
+    for (std::size_t i = 0; i < reg.size(); i++) {
+      if (i != pos) {
+        insertIdTable<T>(i);
+      }
+    }
+  }
+
+  auto const mask = table.size() - 1;
+  auto slot = getIdSlot(reg[pos].idx_, mask);
+  while (table[slot] != 0) {
+    slot = (slot + 1) & mask;
+  }
+  table[slot] = pos + 1;
+}
+
+template <typename T>
+inline ObjectEntry<T>& getEntry(TypeIdx han) {
+  auto& reg = getRegistry<T>();
+  auto const& table = getIdTable<T>();
+  if (not table.empty()) {
+    auto const mask = table.size() - 1;
+    for (auto slot = getIdSlot(han, mask); table[slot] != 0;
+         slot = (slot + 1) & mask) {
+      auto& entry = reg[table[slot] - 1];
+      if (entry.idx_ == han) {
+        return entry;
+      }
+    }
+  }
+  throw std::runtime_error(
+    "Unknown type id=" + std::to_string(han) + " for virtually serialized "
+    "type " + typeregistry::getTypeName<T>() + ": the derived type was not "
+    "registered in this binary"
+  );
+}
+
+/**
+ * \brief Serialize objects whose concrete type is \c ObjT with a direct call
+ * to the hierarchy serializer of \c ObjT instead of a virtual call per object
+ *
+ * \param[in] s the serializer
+ * \param[in] objs the objects, as pointers to the base of the hierarchy
+ * \param[in] num the number of objects
+ * \param[in] ser_idx the serializer index in the registry of the base
+ */
+template <typename ObjT>
+void serializeRun(
+  void* s, checkpoint_base_type_t<ObjT>* const* objs, std::size_t num,
+  TypeIdx ser_idx
+) {
+  for (std::size_t i = 0; i < num; i++) {
+    static_cast<ObjT*>(objs[i])->ObjT::_checkpointDynamicSerialize(
+      s, ser_idx, no_type_idx
+    );
+  }
+}
+
 template <typename ObjT>
 Registrar<ObjT>::Registrar() {
   using BaseType = ::checkpoint::dispatch::vrt::checkpoint_base_type_t<ObjT>;
 
   auto& reg = getRegistry<BaseType>();
-  index = static_cast<TypeIdx>(reg.size());
+  auto const name = typeid(ObjT).name();
+  index = makeTypeId<ObjT>();
+
+  debug_checkpoint("object registrar: %d, %s\n", index, name);
 
-  debug_checkpoint("object registrar: %zu, %s\n", reg.size(), typeid(ObjT).name());
+  for (auto const& entry : reg) {
+    if (entry.idx_ == index) {
+      // The same type may be registered again from another shared library
+      if (std::strcmp(entry.name_, name) == 0) {
+        return;
+      }
+      throw std::runtime_error(
+        std::string("Virtually serialized types ") + entry.name_ + " and " +
+        name + " have the same type id=" + std::to_string(index) +
+        "; specialize checkpoint::VirtualTypeId for one of them"
+      );
+    }
+  }
 
   reg.emplace_back(
     ObjectEntry<BaseType>{
       index,
+      name,
       sizeof(ObjT),
+      alignof(ObjT),
       []()          -> void*       { return std::allocator<ObjT>{}.allocate(1); },
-      [](void* buf) -> BaseType*   { return dispatch::Reconstructor<ObjT>::constructAllowFail(buf); }
+      [](void* buf) -> BaseType*   { return dispatch::Reconstructor<ObjT>::constructAllowFail(buf); },
+      &serializeRun<ObjT>
     }
   );
+  insertIdTable<BaseType>(reg.size() - 1);
 }
 
 template <typename ObjT>
@@ -121,22 +267,42 @@ TypeIdx const Type<ObjT>::idx = Registrar<ObjT>().index;
 template <typename T>
 inline auto getObjIdx(TypeIdx han) {
   debug_checkpoint("getObjIdx: han=%d, size=%ld\n", han, getRegistry<T>().size());
-  return getRegistry<T>().at(han).idx_;
+  return getEntry<T>(han).idx_;
 }
 
 template <typename T>
 inline auto getSizeConcreteType(TypeIdx han) {
-  return getRegistry<T>().at(han).size_;
+  return getEntry<T>(han).size_;
 }
 
 template <typename T>
 inline auto allocateConcreteType(TypeIdx han) {
-  return getRegistry<T>().at(han).allocator_();
+  return getEntry<T>(han).allocator_();
+}
+
+/**
+ * \brief Allocate memory for the concrete type with id \c han from
+ * \c resource, or with \c std::allocator if \c resource is \c nullptr
+ *
+ * \param[in] han the type id
+ * \param[in] resource the memory resource
+ *
+ * \return the memory
+ */
+template <typename T>
+inline void* allocateConcreteType(
+  TypeIdx han, std::pmr::memory_resource* resource
+) {
+  auto const& entry = getEntry<T>(han);
+  if (resource != nullptr) {
+    return resource->allocate(entry.size_, entry.align_);
+  }
+  return entry.allocator_();
 }
 
 template <typename T>
 inline auto constructConcreteType(TypeIdx han, void* buf) {
-  return getRegistry<T>().at(han).constructor_(buf);
+  return getEntry<T>(han).constructor_(buf);
 }
 
 template <typename ObjT>
@@ -72,4 +72,24 @@ using checkpoint_base_type_t =
 
 }}} /* end namespace checkpoint::dispatch::vrt */
 
+namespace checkpoint {
+
+/**
+ * \struct VirtualTypeId
+ *
+ * \brief Specialize with a non-negative
+ * <tt>static constexpr dispatch::vrt::TypeIdx value</tt> to give a virtually
+ * serialized type a fixed id on the wire instead of the hash of its name,
+ * e.g., to keep reading checkpoints after the type is renamed:
+ *
+ *   template <>
+ *   struct checkpoint::VirtualTypeId<MyDerived> {
+ *     static constexpr checkpoint::dispatch::vrt::TypeIdx value = 42;
+ *   };
+ */
+template <typename T>
+struct VirtualTypeId { };
+
+} /* end namespace checkpoint */
+
 #endif /*INCLUDED_SRC_CHECKPOINT_DISPATCH_VRT_REGISTRY_COMMON_H*/
@@ -120,7 +120,13 @@ namespace checkpoint {
 
 template <typename ObjT, typename... SerializerTs>
 inline void instantiateObjSerializer() {
-  dispatch::vrt::InstantiateTupleHelper<ObjT, SerializerTs...>::_recur_register();
+  // Registering and linking only has to happen once per object type, not on
+  // every virtual serialize call
+  static bool const registered = (
+    dispatch::vrt::InstantiateTupleHelper<ObjT, SerializerTs...>::_recur_register(),
+    true
+  );
+  (void)registered;
 }
 
 } /* end namespace checkpoint */
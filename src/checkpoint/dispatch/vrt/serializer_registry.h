@@ -47,34 +47,43 @@
 #include "checkpoint/common.h"
 #include "checkpoint/dispatch/vrt/registry_common.h"
 
-#include <functional>
 #include <vector>
 #include <tuple>
 
 namespace checkpoint { namespace dispatch { namespace vrt {
 namespace serializer_registry {
 
+/// Type-erased serialize dispatch: the serializer is passed as \c void*
 template <typename T>
-struct SerializerEntry {
+using DispatchFnType = void (*)(void*, T&);
 
-  template <typename Serializer>
+template <typename T>
+struct SerializerEntry {
   SerializerEntry(
     TypeIdx in_this_idx,
     TypeIdx in_base_idx,
-    Serializer&& in_serializer
+    DispatchFnType<T> in_serializer
   ) : this_idx_(in_this_idx),
       base_idx_(in_base_idx),
       serializer_(in_serializer)
   { }
 
-  TypeIdx this_idx_ = no_type_idx;            /**< This entry type idx */
-  TypeIdx base_idx_ = no_type_idx;            /**< The base class type idx */
-  std::function<void(void*, T&)> serializer_; /**< Type-erased serialize dispatch */
+  TypeIdx this_idx_ = no_type_idx;         /**< This entry type idx */
+  TypeIdx base_idx_ = no_type_idx;         /**< The base class type idx */
+  DispatchFnType<T> serializer_ = nullptr; /**< Type-erased serialize dispatch */
 };
 
 template <typename ObjT>
 using RegistryType = std::vector<SerializerEntry<ObjT>>;
 
+/**
+ * \brief Dispatch functions of \c DerivedT indexed by the entry index of
+ * the same serializer in the registry of its base, filled by
+ * \c linkDerivedToBase
+ */
+template <typename DerivedT>
+using BaseTableType = std::vector<DispatchFnType<DerivedT>>;
+
 template <typename ObjT, typename SerializerT>
 struct Registrar {
   Registrar();
@@ -92,11 +101,26 @@ inline RegistryType<ObjT>& getRegistry() {
   return reg;
 }
 
+template <typename DerivedT>
+inline BaseTableType<DerivedT>& getBaseTable() {
+  static BaseTableType<DerivedT> table;
+  return table;
+}
+
 template <typename ObjT, typename SerializerT>
 inline TypeIdx makeObjIdx() {
   return Type<ObjT, SerializerT>::idx;
 }
 
+template <typename ObjT, typename SerializerT>
+void dispatchSerializer(void* s, ObjT& obj) {
+  auto& ser = *reinterpret_cast<SerializerT*>(s);
+  // Disable virtual serializer dispatch because we are already in a
+  // virtualSerialize and otherwise we will recurse indefinitely
+  ser.setVirtualDisabled(true);
+  ser | obj;
+}
+
 template <typename ObjT, typename SerializerT>
 Registrar<ObjT, SerializerT>::Registrar() {
   auto& reg = getRegistry<ObjT>();
@@ -113,13 +137,7 @@ Registrar<ObjT, SerializerT>::Registrar() {
     SerializerEntry<ObjT>{
       index,
       no_type_idx, // Set later when linkDerivedToBase is called
-      [=](void* s, ObjT& obj) {
-        auto& ser = *reinterpret_cast<SerializerT*>(s);
-        // Disable virtual serializer dispatch because we are already in a
-        // virtualSerialize and otherwise we will recurse indefinitely
-        ser.setVirtualDisabled(true);
-        ser | obj;
-      }
+      &dispatchSerializer<ObjT, SerializerT>
     }
   );
 }
@@ -139,18 +157,16 @@ inline auto& getObjIdxRef(TypeIdx han) {
 }
 
 template <typename ObjT>
-inline auto getObjIdx(TypeIdx han) {
-  auto elm = getObjIdxRef<ObjT>(han);
-  return elm.serializer_;
+inline DispatchFnType<ObjT> getObjIdx(TypeIdx han) {
+  return getObjIdxRef<ObjT>(han).serializer_;
 }
 
 template <typename DerivedT>
-inline std::function<void(void*, DerivedT&)> getBaseIdx(TypeIdx base_idx) {
-  auto& reg = getRegistry<DerivedT>();
-  for (auto entry : reg) {
-    if (entry.base_idx_ == base_idx) {
-      return entry.serializer_;
-    }
+inline DispatchFnType<DerivedT> getBaseIdx(TypeIdx base_idx) {
+  auto const& table = getBaseTable<DerivedT>();
+  auto const idx = static_cast<std::size_t>(base_idx);
+  if (base_idx >= 0 and idx < table.size() and table[idx] != nullptr) {
+    return table[idx];
   }
   checkpointAssert(
     false, "Error, could not find corresponding entry in derived for base"
@@ -149,9 +149,12 @@ struct ReconstructAsVirtualIfNeeded<
     not std::is_same<SerializerT, checkpoint::Footprinter>::value
   >
 > {
-  static T* apply(SerializerT&, dispatch::vrt::TypeIdx) {
+  static T* apply(SerializerT& s, dispatch::vrt::TypeIdx) {
     // no type idx needed in this case, static construction in default case
-    auto t = std::allocator<T>{}.allocate(1);
+    auto const resource = s.getMemoryResource();
+    auto t = resource != nullptr ?
+      static_cast<T*>(resource->allocate(sizeof(T), alignof(T))) :
+      std::allocator<T>{}.allocate(1);
     return dispatch::Reconstructor<T>::construct(t);
   }
 };
@@ -176,11 +179,13 @@ struct ReconstructAsVirtualIfNeeded<
     dispatch::vrt::VirtualSerializeTraits<T>::has_virtual_serialize
   >
 > {
-  static T* apply(SerializerT&, dispatch::vrt::TypeIdx entry) {
+  static T* apply(SerializerT& s, dispatch::vrt::TypeIdx entry) {
     using BaseT = ::checkpoint::dispatch::vrt::checkpoint_base_type_t<T>;
 
     // use type idx here, registration needed for proper type re-construction
-    auto t = dispatch::vrt::objregistry::allocateConcreteType<BaseT>(entry);
+    auto t = dispatch::vrt::objregistry::allocateConcreteType<BaseT>(
+      entry, s.getMemoryResource()
+    );
     return static_cast<T*>(
                            dispatch::vrt::objregistry::constructConcreteType<BaseT>(entry, t)
                            );
@@ -0,0 +1,257 @@
+/*
+//@HEADER
+// *****************************************************************************
+//
+//                                member_index.h
+//                 DARMA/magistrate => Serialization Library
+//
+// Copyright 2019 National Technology & Engineering Solutions of Sandia, LLC
+// (NTESS). Under the terms of Contract DE-NA0003525 with NTESS, the U.S.
+// Government retains certain rights in this software.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+//
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// * Neither the name of the copyright holder nor the names of its
+//   contributors may be used to endorse or promote products derived from this
+//   software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// Questions? Contact darma@sandia.gov
+//
+// *****************************************************************************
+//@HEADER
+*/
+
+#if !defined INCLUDED_SRC_CHECKPOINT_MEMBER_INDEX_H
+#define INCLUDED_SRC_CHECKPOINT_MEMBER_INDEX_H
+
+#include "checkpoint/common.h"
+#include "checkpoint/checkpoint_api.h"
+#include "checkpoint/buffer/member_table.h"
+#include "checkpoint/serializers/member_index_sizer.h"
+
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace checkpoint {
+
+using MemberTableReader = buffer::MemberTableReader;
+
+namespace detail {
+
+template <typename SerializerT, typename T>
+void serializeIndexed(
+  SerializerT& s, char const* name, SerialSizeType index, T& value
+) {
+  if constexpr (IsMemberIndexSizer<SerializerT>::value) {
+    auto const begin = s.getSize();
+    s | value;
+    s.recordMember(name, index, begin);
+  } else {
+    s | value;
+  }
+}
+
+} /* end namespace detail */
+
+/**
+ * \brief Serialize \c value as \c s | \c value does, recording its offset
+ * under \c name when writing with \c serializeToIndexedFile
+ *
+ * Call this from a \c serialize method for the members that should be
+ * readable on their own with \c deserializeMemberFromFile. The bytes produced
+ * are the same as \c s | \c value.
+ *
+ * \param[in] s the serializer
+ * \param[in] name the name to record, which should be unique in the object
+ * \param[in] value the member
+ */
+template <typename SerializerT, typename T>
+void indexMember(SerializerT& s, char const* name, T& value) {
+  detail::serializeIndexed(s, name, 0, value);
+}
+
+/**
+ * \brief Serialize the elements of \c vec one at a time, recording the offset
+ * of every element under \c name and its index when writing with
+ * \c serializeToIndexedFile
+ *
+ * The element count is packed first, followed by each element; this is not
+ * the layout of \c s | \c vec, so the same call must be made when unpacking.
+ * Elements are default constructed before they are unpacked. Read one back
+ * with \c deserializeElementFromFile.
+ *
+ * \param[in] s the serializer
+ * \param[in] name the name to record
+ * \param[in] vec the elements
+ */
+template <typename SerializerT, typename E, typename A>
+void indexElements(SerializerT& s, char const* name, std::vector<E, A>& vec) {
+  if (s.isFootprinting()) {
+    s | vec;
+    return;
+  }
+
+  SerialSizeType num = vec.size();
+  s | num;
+  if (s.isUnpacking()) {
+    vec.resize(num);
+  }
+  for (SerialSizeType i = 0; i < num; i++) {
+    detail::serializeIndexed(s, name, i, vec[i]);
+  }
+}
+
+/**
+ * \brief Serialize \c T to file with filename \c file, followed by a table of
+ * the offsets of the members marked with \c indexMember and
+ * \c indexElements
+ *
+ * The offsets are recorded by the sizing pass, so packing is unchanged. The
+ * file starts with exactly the bytes \c serializeToFile writes and can still
+ * be read whole with \c deserializeFromFile. The backend, durability and
+ * checksum in \c options apply as for \c serializeToFile; a checksum trailer
+ * covers the table too.
+ *
+ * \param[in] target the \c T to serialize
+ * \param[in] file name of the file to create
+ * \param[in] options backend, durability and checksum options
+ */
+template <typename T>
+void serializeToIndexedFile(
+  T& target, std::string const& file,
+  FileWriteOptions const& options = FileWriteOptions{}
+) {
+  MemberIndexSizer sizer;
+  dispatch::Traverse::withRoot<T>(target, sizer);
+  auto const len = sizer.getSize();
+  auto table = sizer.getTable().encode(len);
+  auto const total = len + table.size();
+  auto const& checksum = options.checksum;
+
+  if (options.backend == FileBackend::PWrite) {
+    FilePacker p(total, file, options);
+    dispatch::Traverse::withRoot<T>(target, p);
+    dispatch::validatePackerBufferSize<T>(p, len);
+    p.contiguousBytes(table.data(), 1, table.size());
+    p.closeFile();
+    return;
+  }
+
+  auto const trailer = checksum.enabled ?
+    buffer::getChecksumTrailerSize(total, checksum.chunk_size) : 0;
+  PackerIO p(
+    total, buffer::IOBuffer::WriteToFileTag{}, total + trailer, file,
+    options.durability
+  );
+  if (checksum.enabled) {
+    p.enableChecksum(checksum.chunk_size);
+  }
+  dispatch::Traverse::withRoot<T>(target, p);
+  dispatch::validatePackerBufferSize<T>(p, len);
+  p.contiguousBytes(table.data(), 1, table.size());
+  if (checksum.enabled) {
+    p.writeChecksumTrailer();
+  }
+}
+
+/**
+ * \brief De-serialize and reify one member or element \c U from a file opened
+ * with a \c MemberTableReader
+ *
+ * Only the bytes of the member are unpacked, so several members can be read
+ * from one mapping of the file. \c U must be the type that was serialized
+ * under \c name.
+ *
+ * \param[in] reader the mapped file
+ * \param[in] name the name passed to \c indexMember or \c indexElements
+ * \param[in] index the element index, zero for a single member
+ *
+ * \return a \c std::unique_ptr to the new \c U
+ */
+template <typename U>
+std::unique_ptr<U> deserializeMember(
+  MemberTableReader& reader, std::string const& name, SerialSizeType index = 0
+) {
+  auto const& e = reader.lookup(name, index);
+
+  auto mem = dispatch::Standard::allocate<U>();
+  auto t = std::unique_ptr<U>(dispatch::Standard::construct<U>(mem));
+
+  // Start at the image so alignment padding is computed as it was packed
+  Unpacker u(reader.getImage(), reader.getImageSize());
+  u.borrowBytes(e.offset);
+  dispatch::Traverse::with(*t, u);
+
+  if (u.usedBufferSize() != e.offset + e.size) {
+    throw dispatch::serialization_error(
+      "Member \"" + name + "\" was packed as " + std::to_string(e.size) +
+      "B, but unpacked " + std::to_string(u.usedBufferSize() - e.offset) + "B"
+    );
+  }
+  return t;
+}
+
+/**
+ * \brief De-serialize and reify the member \c U recorded under \c name from a
+ * file written by \c serializeToIndexedFile, without unpacking the rest of
+ * the object
+ *
+ * \param[in] file the filename
+ * \param[in] name the name passed to \c indexMember
+ * \param[in] options checksum verification (see \c MemberTableReader)
+ *
+ * \return a \c std::unique_ptr to the new \c U
+ */
+template <typename U>
+std::unique_ptr<U> deserializeMemberFromFile(
+  std::string const& file, std::string const& name,
+  FileReadOptions const& options = FileReadOptions{}
+) {
+  MemberTableReader reader(file, options);
+  return deserializeMember<U>(reader, name);
+}
+
+/**
+ * \brief De-serialize and reify element \c index of the elements recorded
+ * under \c name from a file written by \c serializeToIndexedFile
+ *
+ * \param[in] file the filename
+ * \param[in] name the name passed to \c indexElements
+ * \param[in] index the element index
+ * \param[in] options checksum verification (see \c MemberTableReader)
+ *
+ * \return a \c std::unique_ptr to the new \c U
+ */
+template <typename U>
+std::unique_ptr<U> deserializeElementFromFile(
+  std::string const& file, std::string const& name, SerialSizeType index,
+  FileReadOptions const& options = FileReadOptions{}
+) {
+  MemberTableReader reader(file, options);
+  return deserializeMember<U>(reader, name, index);
+}
+
+} /* end namespace checkpoint */
+
+#endif /*INCLUDED_SRC_CHECKPOINT_MEMBER_INDEX_H*/
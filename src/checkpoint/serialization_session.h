@@ -0,0 +1,118 @@
+/*
+//@HEADER
+// *****************************************************************************
+//
+//                           serialization_session.h
+//                 DARMA/magistrate => Serialization Library
+//
+// Copyright 2019 National Technology & Engineering Solutions of Sandia, LLC
+// (NTESS). Under the terms of Contract DE-NA0003525 with NTESS, the U.S.
+// Government retains certain rights in this software.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+//
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// * Neither the name of the copyright holder nor the names of its
+//   contributors may be used to endorse or promote products derived from this
+//   software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// Questions? Contact darma@sandia.gov
+//
+// *****************************************************************************
+//@HEADER
+*/
+
+#if !defined INCLUDED_SRC_CHECKPOINT_SERIALIZATION_SESSION_H
+#define INCLUDED_SRC_CHECKPOINT_SERIALIZATION_SESSION_H
+
+#include "checkpoint/common.h"
+#include "checkpoint/checkpoint_api.h"
+#include "checkpoint/buffer/buffer_pool.h"
+#include "checkpoint/dispatch/dispatch.h"
+#include "checkpoint/serializers/packer.h"
+#include "checkpoint/serializers/sizer.h"
+
+#include <memory>
+
+namespace checkpoint {
+
+using BufferPool = buffer::BufferPool;
+using BufferPoolStats = buffer::BufferPoolStats;
+
+/**
+ * \struct SerializationSession
+ *
+ * \brief Serializes repeatedly into buffers recycled through a \c BufferPool
+ *
+ * The \c SerializedInfo returned by \c serialize gives its storage back to the
+ * pool when destroyed, so steady-state serialization of similarly sized
+ * objects does not allocate. A session may be shared between threads, or
+ * several sessions may share one pool.
+ */
+struct SerializationSession {
+  SerializationSession()
+    : pool_(std::make_shared<BufferPool>())
+  { }
+
+  explicit SerializationSession(std::shared_ptr<BufferPool> in_pool)
+    : pool_(std::move(in_pool))
+  { }
+
+  /**
+   * \brief Serialize \c T into a pooled byte buffer
+   *
+   * \param[in] target the \c T to serialize
+   *
+   * \return a \c std::unique_ptr to a \c SerializedInfo whose storage returns
+   * to the pool when it is destroyed
+   */
+  template <typename T>
+  SerializedReturnType serialize(T& target) {
+    auto const len = dispatch::Standard::size<T, Sizer>(target);
+    auto p = dispatch::Standard::pack<T, PackerPooled>(
+      target, len, pool_->acquire(len)
+    );
+    dispatch::validatePackerBufferSize<T>(p, len);
+    return SerializedReturnType(p.extractPackedBuffer().release());
+  }
+
+  /**
+   * \brief Get the pool backing this session
+   *
+   * \return the pool
+   */
+  std::shared_ptr<BufferPool> const& getPool() const { return pool_; }
+
+  /**
+   * \brief Get the pool's allocation counters
+   *
+   * \return the counters
+   */
+  BufferPoolStats getStats() const { return pool_->getStats(); }
+
+private:
+  std::shared_ptr<BufferPool> pool_ = nullptr;
+};
+
+} /* end namespace checkpoint */
+
+#endif /*INCLUDED_SRC_CHECKPOINT_SERIALIZATION_SESSION_H*/
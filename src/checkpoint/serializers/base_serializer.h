@@ -47,7 +47,9 @@
 #include "checkpoint/common.h"
 
 #include <type_traits>
+#include <cstdint>
 #include <cstdlib>
+#include <memory_resource>
 
 namespace checkpoint {
 
@@ -172,6 +174,18 @@ struct BaseSerializer {
   template <typename... Args>
   void skip(Args&&...) { }
 
+  /**
+   * \brief Mark the start of packing memory that will not outlive the
+   * \c serialize call (e.g., a temporary copy), so serializers that keep
+   * references to packed memory copy it instead. Default empty implementation.
+   */
+  void beginTransient() { }
+
+  /**
+   * \brief Mark the end of memory started with \c beginTransient
+   */
+  void endTransient() { }
+
   /**
    * \brief Get a buffer if it is associated with the serializer
    *
@@ -189,6 +203,18 @@ struct BaseSerializer {
    */
   SerialByteType* getSpotIncrement(SerialSizeType const) { return nullptr; }
 
+  /**
+   * \brief Lend the next bytes of the buffer being unpacked and advance past
+   * them, for deserializing borrowed views (only when \c isLendingBytes) or
+   * skipping bytes. By default borrowing is not supported and \c nullptr is
+   * returned.
+   *
+   * \param[in] len the number of bytes to borrow
+   *
+   * \return pointer to the bytes inside the buffer
+   */
+  SerialByteType* borrowBytes(SerialSizeType const) { return nullptr; }
+
   /**
    * \brief Check if virtual serialization is disabled
    *
@@ -203,9 +229,61 @@ struct BaseSerializer {
    */
   void setVirtualDisabled(bool val) { virtual_disabled_ = val; }
 
+  /**
+   * \brief Get the structure hash of the object being traversed
+   *
+   * \return the hash
+   */
+  std::uint64_t getStructureHash() const { return structure_hash_; }
+
+  /**
+   * \brief Set the structure hash of the object being traversed
+   *
+   * \param[in] hash the hash
+   */
+  void setStructureHash(std::uint64_t hash) { structure_hash_ = hash; }
+
+  /**
+   * \brief Get the memory resource that objects reconstructed while unpacking
+   * are allocated from, if any
+   *
+   * \return the resource, or \c nullptr to allocate with \c std::allocator
+   */
+  std::pmr::memory_resource* getMemoryResource() const { return resource_; }
+
+  /**
+   * \brief Set the memory resource that objects reconstructed while unpacking
+   * are allocated from
+   *
+   * \param[in] resource the resource, or \c nullptr for \c std::allocator
+   */
+  void setMemoryResource(std::pmr::memory_resource* resource) {
+    resource_ = resource;
+  }
+
+  /**
+   * \brief Check whether the bytes being unpacked outlive the unpacked object,
+   * so borrowed views may point into them
+   *
+   * \return whether the bytes are lent to borrowed views
+   */
+  bool isLendingBytes() const { return lending_bytes_; }
+
+  /**
+   * \brief Set whether borrowed views may point into the bytes being unpacked.
+   * Only set when the caller keeps the bytes alive as long as the unpacked
+   * object, as \c deserializeBorrowed does.
+   *
+   * \param[in] val whether the bytes are lent to borrowed views
+   */
+  void setLendingBytes(bool val) { lending_bytes_ = val; }
+
 protected:
   ModeType cur_mode_ = ModeType::Invalid; /**< The current mode */
   bool virtual_disabled_ = false;         /**< Virtual serialization disabled */
+  std::uint64_t structure_hash_ = 0;      /**< Hash of the fields traversed */
+  std::pmr::memory_resource* resource_ = nullptr; /**< Reconstructed objects */
+  bool lending_bytes_ = false;            /**< Borrowed views allowed */
 };
 
 } /* end namespace checkpoint */
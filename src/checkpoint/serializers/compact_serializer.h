@@ -0,0 +1,238 @@
+/*
+//@HEADER
+// *****************************************************************************
+//
+//                             compact_serializer.h
+//                 DARMA/magistrate => Serialization Library
+//
+// Copyright 2019 National Technology & Engineering Solutions of Sandia, LLC
+// (NTESS). Under the terms of Contract DE-NA0003525 with NTESS, the U.S.
+// Government retains certain rights in this software.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+//
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// * Neither the name of the copyright holder nor the names of its
+//   contributors may be used to endorse or promote products derived from this
+//   software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// Questions? Contact darma@sandia.gov
+//
+// *****************************************************************************
+//@HEADER
+*/
+
+#if !defined INCLUDED_SRC_CHECKPOINT_SERIALIZERS_COMPACT_SERIALIZER_H
+#define INCLUDED_SRC_CHECKPOINT_SERIALIZERS_COMPACT_SERIALIZER_H
+
+#include "checkpoint/common.h"
+#include "checkpoint/serializers/sizer.h"
+#include "checkpoint/serializers/packer.h"
+#include "checkpoint/serializers/unpacker.h"
+#include "checkpoint/buffer/io_options.h"
+#include "checkpoint/buffer/varint.h"
+
+#include <type_traits>
+
+namespace checkpoint {
+
+using CompactOptions = buffer::CompactOptions;
+
+/**
+ * \struct CompactSizer
+ *
+ * \brief Sizer for compact buffers (see \c CompactOptions)
+ */
+struct CompactSizer : Sizer {
+  /**
+   * \internal \brief Construct a compact sizer
+   *
+   * \param[in] options whether integral fields are written as varints
+   */
+  explicit CompactSizer(CompactOptions const& options = {})
+    : integers_(options.integers)
+  { }
+
+  /**
+   * \brief Count the varint of \c val
+   *
+   * \param[in] val the value
+   */
+  template <typename T>
+  void varint(T& val) {
+    contiguousBytes(nullptr, buffer::varintSize(buffer::toVarint(val)), 1);
+  }
+
+  template <typename SerializerT, typename T>
+  void contiguousTyped(SerializerT& serdes, T* ptr, SerialSizeType num_elms) {
+    if constexpr (buffer::IsVarintType<T>::value) {
+      if (integers_) {
+        SerialSizeType len = 0;
+        for (SerialSizeType i = 0; i < num_elms; i++) {
+          len += buffer::varintSize(buffer::toVarint(ptr[i]));
+        }
+        contiguousBytes(nullptr, len, 1);
+        return;
+      }
+    }
+    serdes.contiguousBytes(static_cast<void*>(ptr), sizeof(T), num_elms);
+  }
+
+private:
+  bool integers_ = false;
+};
+
+/**
+ * \struct CompactPacker
+ *
+ * \brief Packer that writes container sizes (and, with \c
+ * CompactOptions::integers, integral fields) as varints. The buffer is sized
+ * by \c CompactSizer with the same options.
+ */
+struct CompactPacker : PackerBuffer<buffer::ManagedBuffer> {
+  /**
+   * \internal \brief Construct a compact packer
+   *
+   * \param[in] size the number of bytes counted by \c CompactSizer
+   * \param[in] options whether integral fields are written as varints
+   */
+  explicit CompactPacker(
+    SerialSizeType const& size, CompactOptions const& options = {}
+  ) : PackerBuffer<buffer::ManagedBuffer>(size),
+      integers_(options.integers)
+  { }
+
+  /**
+   * \brief Write the varint of \c val
+   *
+   * \param[in] val the value
+   */
+  template <typename T>
+  void varint(T& val) {
+    auto const v = buffer::toVarint(val);
+    buffer::encodeVarint(v, claimBytes(buffer::varintSize(v)));
+  }
+
+  template <typename SerializerT, typename T>
+  void contiguousTyped(SerializerT& serdes, T* ptr, SerialSizeType num_elms) {
+    if constexpr (buffer::IsVarintType<T>::value) {
+      if (integers_) {
+        SerialSizeType len = 0;
+        for (SerialSizeType i = 0; i < num_elms; i++) {
+          len += buffer::varintSize(buffer::toVarint(ptr[i]));
+        }
+        auto out = claimBytes(len);
+        for (SerialSizeType i = 0; i < num_elms; i++) {
+          out += buffer::encodeVarint(buffer::toVarint(ptr[i]), out);
+        }
+        return;
+      }
+    }
+    serdes.contiguousBytes(static_cast<void*>(ptr), sizeof(T), num_elms);
+  }
+
+private:
+  bool integers_ = false;
+};
+
+/**
+ * \struct CompactUnpacker
+ *
+ * \brief Unpacker for the bytes of \c CompactPacker. Varints are decoded a
+ * word at a time while eight bytes remain in the buffer; a varint running
+ * past the end of the buffer throws \c std::runtime_error.
+ */
+struct CompactUnpacker : UnpackerBuffer<buffer::UserBuffer> {
+  /**
+   * \internal \brief Construct a compact unpacker
+   *
+   * \param[in] buf the packed bytes
+   * \param[in] size the number of bytes in \c buf
+   * \param[in] options whether integral fields were written as varints
+   */
+  CompactUnpacker(
+    SerialByteType* buf, SerialSizeType size, CompactOptions const& options
+  ) : UnpackerBuffer<buffer::UserBuffer>(buf),
+      size_(size),
+      integers_(options.integers)
+  { }
+
+  /**
+   * \brief Read the varint of \c val
+   *
+   * \param[out] val the value
+   */
+  template <typename T>
+  void varint(T& val) {
+    uint64_t v = 0;
+    auto const len = buffer::decodeVarint(cur_, remaining(), v);
+    val = buffer::fromVarint<std::remove_cv_t<T>>(v);
+    borrowBytes(len);
+  }
+
+  template <typename SerializerT, typename T>
+  void contiguousTyped(SerializerT& serdes, T* ptr, SerialSizeType num_elms) {
+    if constexpr (buffer::IsVarintType<T>::value) {
+      if (integers_) {
+        SerialByteType const* in = cur_;
+        auto avail = remaining();
+        for (SerialSizeType i = 0; i < num_elms; i++) {
+          uint64_t v = 0;
+          auto const len = buffer::decodeVarint(in, avail, v);
+          ptr[i] = buffer::fromVarint<T>(v);
+          in += len;
+          avail -= len;
+        }
+        borrowBytes(static_cast<SerialSizeType>(in - cur_));
+        return;
+      }
+    }
+    serdes.contiguousBytes(static_cast<void*>(ptr), sizeof(T), num_elms);
+  }
+
+private:
+  SerialSizeType remaining() const {
+    auto const used = usedBufferSize();
+    return used < size_ ? size_ - used : 0;
+  }
+
+private:
+  SerialSizeType size_ = 0;
+  bool integers_ = false;
+};
+
+/**
+ * \struct IsCompactSerializer
+ *
+ * \brief Whether \c SerializerT writes container sizes as varints
+ */
+template <typename SerializerT>
+struct IsCompactSerializer : std::integral_constant<
+  bool,
+  std::is_same<SerializerT, CompactSizer>::value or
+  std::is_same<SerializerT, CompactPacker>::value or
+  std::is_same<SerializerT, CompactUnpacker>::value
+> { };
+
+} /* end namespace checkpoint */
+
+#endif /*INCLUDED_SRC_CHECKPOINT_SERIALIZERS_COMPACT_SERIALIZER_H*/
@@ -0,0 +1,128 @@
+/*
+//@HEADER
+// *****************************************************************************
+//
+//                           compressed_serializer.h
+//                 DARMA/magistrate => Serialization Library
+//
+// Copyright 2019 National Technology & Engineering Solutions of Sandia, LLC
+// (NTESS). Under the terms of Contract DE-NA0003525 with NTESS, the U.S.
+// Government retains certain rights in this software.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+//
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// * Neither the name of the copyright holder nor the names of its
+//   contributors may be used to endorse or promote products derived from this
+//   software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// Questions? Contact darma@sandia.gov
+//
+// *****************************************************************************
+//@HEADER
+*/
+
+#if !defined INCLUDED_SRC_CHECKPOINT_SERIALIZERS_COMPRESSED_SERIALIZER_H
+#define INCLUDED_SRC_CHECKPOINT_SERIALIZERS_COMPRESSED_SERIALIZER_H
+
+#include "checkpoint/common.h"
+#include "checkpoint/serializers/base_serializer.h"
+#include "checkpoint/buffer/codec.h"
+#include "checkpoint/buffer/frame_stream.h"
+
+namespace checkpoint {
+
+/**
+ * \struct CompressedPacker
+ *
+ * \brief Packer that compresses the packed bytes frame by frame into a
+ * \c buffer::FrameSink
+ *
+ * \c finish must be called once packing completes to compress the last frame
+ * and write the frame index.
+ */
+struct CompressedPacker : BaseSerializer {
+  /**
+   * \brief Start a compressed stream on \c sink
+   *
+   * \param[in] size the number of bytes that will be packed
+   * \param[in] sink where the compressed stream is written
+   * \param[in] options codec, frame size, shuffle and thread count
+   */
+  CompressedPacker(
+    SerialSizeType size, buffer::FrameSink& sink,
+    buffer::CompressionOptions const& options = buffer::CompressionOptions{}
+  ) : BaseSerializer(ModeType::Packing),
+      encoder_(sink, size, options)
+  { }
+
+  void contiguousBytes(void* ptr, SerialSizeType size, SerialSizeType num_elms) {
+    encoder_.write(static_cast<SerialByteType const*>(ptr), size * num_elms);
+    n_bytes_ += size * num_elms;
+  }
+
+  SerialSizeType usedBufferSize() const { return n_bytes_; }
+
+  /**
+   * \brief Compress the remaining bytes and write the frame index
+   */
+  void finish() { encoder_.finish(); }
+
+private:
+  buffer::FrameEncoder encoder_;
+  SerialSizeType n_bytes_ = 0;
+};
+
+/**
+ * \struct CompressedUnpacker
+ *
+ * \brief Unpacker that decompresses a stream written by \c CompressedPacker
+ * one frame (or batch of frames) at a time
+ */
+struct CompressedUnpacker : BaseSerializer {
+  /**
+   * \brief Read the stream header from \c source
+   *
+   * \param[in] source where the compressed stream is read from
+   * \param[in] num_threads the number of frames decompressed concurrently
+   */
+  explicit CompressedUnpacker(
+    buffer::FrameSource& source, unsigned num_threads = 1
+  ) : BaseSerializer(ModeType::Unpacking),
+      decoder_(source, num_threads)
+  { }
+
+  void contiguousBytes(void* ptr, SerialSizeType size, SerialSizeType num_elms) {
+    decoder_.read(static_cast<SerialByteType*>(ptr), size * num_elms);
+    n_bytes_ += size * num_elms;
+  }
+
+  SerialSizeType usedBufferSize() const { return n_bytes_; }
+
+private:
+  buffer::FrameDecoder decoder_;
+  SerialSizeType n_bytes_ = 0;
+};
+
+} /* end namespace checkpoint */
+
+#endif /*INCLUDED_SRC_CHECKPOINT_SERIALIZERS_COMPRESSED_SERIALIZER_H*/
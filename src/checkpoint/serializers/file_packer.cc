@@ -0,0 +1,304 @@
+/*
+//@HEADER
+// *****************************************************************************
+//
+//                                file_packer.cc
+//                 DARMA/magistrate => Serialization Library
+//
+// Copyright 2019 National Technology & Engineering Solutions of Sandia, LLC
+// (NTESS). Under the terms of Contract DE-NA0003525 with NTESS, the U.S.
+// Government retains certain rights in this software.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+//
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// * Neither the name of the copyright holder nor the names of its
+//   contributors may be used to endorse or promote products derived from this
+//   software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// Questions? Contact darma@sandia.gov
+//
+// *****************************************************************************
+//@HEADER
+*/
+
+#include "checkpoint/common.h"
+#include "checkpoint/serializers/file_packer.h"
+
+#include <algorithm>
+#include <cstring>
+#include <string>
+#include <stdexcept>
+#include <vector>
+
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/uio.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <errno.h>
+#include <string.h>
+
+namespace checkpoint {
+
+namespace {
+
+# if defined(checkpoint_has_sync_file_range)
+void syncRange(
+  int fd, std::string const& file, SerialSizeType offset, SerialSizeType len,
+  unsigned int flags
+) {
+  int ret = 0;
+  do {
+    ret = sync_file_range(fd, offset, len, flags);
+  } while (ret != 0 and errno == EINTR);
+
+  if (ret != 0) {
+    auto err = std::string("sync_file_range failed on file=") + file +
+               ": errno=" + std::to_string(errno) + ": " + strerror(errno);
+    throw std::runtime_error(err);
+  }
+}
+# endif
+
+} /* end anon namespace */
+
+FilePacker::FilePacker(
+  SerialSizeType size, std::string const& file,
+  buffer::FileWriteOptions const& options
+) : BaseSerializer(ModeType::Packing),
+    file_(file),
+    durability_(options.durability),
+    block_size_(std::max<SerialSizeType>(options.block_size, 1)),
+    write_behind_(options.write_behind)
+{
+  debug_checkpoint("FilePacker: opening file for write: %s\n", file_.c_str());
+
+  if (options.checksum.enabled) {
+    checksum_ = std::make_unique<buffer::ChunkChecksummer>(
+      options.checksum.chunk_size
+    );
+  }
+
+  // Never stage more than will be written. Allocated before the file is
+  // opened so a failed allocation cannot leak the descriptor
+  block_size_ = std::min(block_size_, std::max<SerialSizeType>(size, 1));
+  staging_ = buffer::allocateBytes(block_size_);
+
+  fd_ = open(file_.c_str(), O_CREAT | O_WRONLY | O_TRUNC, (mode_t)0600);
+  if (fd_ == -1) {
+    auto err = std::string("Failed to open file=") + file_ + ": errno=" +
+               std::to_string(errno) + ": " + strerror(errno);
+    throw std::runtime_error(err);
+  }
+
+# if defined(checkpoint_has_fallocate)
+  if (size > 0) {
+    int ret = fallocate(fd_, 0, 0, size);
+
+    if (ret != 0 and errno == ENOSPC) {
+      auto err = std::string("fallocate failed on file: errno=") +
+                 std::to_string(errno) + ": " + strerror(errno);
+      close(fd_);
+      fd_ = -1;
+      throw std::runtime_error(err);
+    }
+  }
+# endif
+}
+
+FilePacker::FilePacker(FilePacker&& other)
+  : BaseSerializer(other),
+    file_(std::move(other.file_)),
+    fd_(other.fd_),
+    durability_(other.durability_),
+    block_size_(other.block_size_),
+    staging_(std::move(other.staging_)),
+    staged_(other.staged_),
+    file_offset_(other.file_offset_),
+    n_bytes_(other.n_bytes_),
+    write_behind_(other.write_behind_),
+    behind_offset_(other.behind_offset_),
+    checksum_(std::move(other.checksum_))
+{
+  other.fd_ = -1;
+}
+
+FilePacker::~FilePacker() {
+  // Only reached with an open file if packing failed part way; do not throw
+  if (fd_ != -1) {
+    close(fd_);
+  }
+}
+
+void FilePacker::contiguousBytes(
+  void* ptr, SerialSizeType size, SerialSizeType num_elms
+) {
+  auto const len = size * num_elms;
+  auto const bytes = static_cast<SerialByteType const*>(ptr);
+
+  if (len == 0) {
+    return;
+  }
+
+  if (checksum_ != nullptr) {
+    checksum_->update(bytes, len);
+  }
+
+  if (len >= block_size_) {
+    flush(bytes, len);
+  } else {
+    if (staged_ + len > block_size_) {
+      flush(nullptr, 0);
+    }
+    std::memcpy(staging_.get() + staged_, bytes, len);
+    staged_ += len;
+  }
+
+  n_bytes_ += len;
+}
+
+void FilePacker::flush(SerialByteType const* extra, SerialSizeType extra_len) {
+  // With write-behind, large pieces go out one window at a time
+  auto const piece = write_behind_ > 0 ? write_behind_ : extra_len;
+  do {
+    auto const n = std::min(piece, extra_len);
+    writeOut(extra, n);
+    writeBehind();
+    extra += n;
+    extra_len -= n;
+  } while (extra_len > 0);
+}
+
+void FilePacker::writeOut(
+  SerialByteType const* extra, SerialSizeType extra_len
+) {
+  struct iovec iov[2];
+  int iovcnt = 0;
+
+  if (staged_ > 0) {
+    iov[iovcnt].iov_base = staging_.get();
+    iov[iovcnt].iov_len = staged_;
+    iovcnt++;
+  }
+  if (extra_len > 0) {
+    iov[iovcnt].iov_base = const_cast<SerialByteType*>(extra);
+    iov[iovcnt].iov_len = extra_len;
+    iovcnt++;
+  }
+
+  int cur = 0;
+  while (cur < iovcnt) {
+#   if defined(checkpoint_has_pwritev)
+    auto ret = pwritev(fd_, iov + cur, iovcnt - cur, file_offset_);
+#   else
+    auto ret = pwrite(fd_, iov[cur].iov_base, iov[cur].iov_len, file_offset_);
+#   endif
+
+    if (ret < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      auto err = std::string("pwrite failed on file=") + file_ + ": errno=" +
+                 std::to_string(errno) + ": " + strerror(errno);
+      throw std::runtime_error(err);
+    }
+
+    // Advance past whatever was written; writes may be partial
+    auto written = static_cast<SerialSizeType>(ret);
+    file_offset_ += written;
+    while (cur < iovcnt and written >= iov[cur].iov_len) {
+      written -= iov[cur].iov_len;
+      cur++;
+    }
+    if (cur < iovcnt) {
+      iov[cur].iov_base = static_cast<SerialByteType*>(iov[cur].iov_base) + written;
+      iov[cur].iov_len -= written;
+    }
+  }
+
+  staged_ = 0;
+}
+
+void FilePacker::writeBehind() {
+  while (write_behind_ > 0 and file_offset_ - behind_offset_ >= write_behind_) {
+#   if defined(checkpoint_has_sync_file_range)
+    // Start writeback of the completed window without waiting for it
+    syncRange(fd_, file_, behind_offset_, write_behind_, SYNC_FILE_RANGE_WRITE);
+
+    // The window before it has had a whole window of packing to finish
+    if (behind_offset_ >= write_behind_) {
+      auto const prev = behind_offset_ - write_behind_;
+      syncRange(
+        fd_, file_, prev, write_behind_,
+        SYNC_FILE_RANGE_WAIT_BEFORE | SYNC_FILE_RANGE_WRITE |
+        SYNC_FILE_RANGE_WAIT_AFTER
+      );
+#     if defined(checkpoint_has_posix_fadvise)
+      posix_fadvise(fd_, prev, write_behind_, POSIX_FADV_DONTNEED);
+#     endif
+    }
+#   endif
+    behind_offset_ += write_behind_;
+  }
+}
+
+void FilePacker::closeFile() {
+  if (fd_ == -1) {
+    return;
+  }
+
+  if (checksum_ != nullptr) {
+    std::vector<SerialByteType> trailer(checksum_->getTrailerSize());
+    checksum_->writeTrailer(trailer.data());
+    flush(trailer.data(), trailer.size());
+  } else {
+    flush(nullptr, 0);
+  }
+
+  /*
+   * fallocate may have reserved more than was written if the packed size was
+   * overestimated; make sure the file ends at the last packed byte
+   */
+  int ret = ftruncate(fd_, file_offset_);
+
+  if (ret != 0) {
+    auto err = std::string("ftruncate failed on file: errno=") +
+               std::to_string(errno) + ": " + strerror(errno);
+    throw std::runtime_error(err);
+  }
+
+  buffer::syncFile(fd_, file_, durability_);
+
+  debug_checkpoint("FilePacker: closing file: len=%lu\n", file_offset_);
+
+  ret = close(fd_);
+  fd_ = -1;
+
+  if (ret != 0) {
+    auto err = std::string("close on file descriptor failed: errno=") +
+               std::to_string(errno) + ": " + strerror(errno);
+    throw std::runtime_error(err);
+  }
+}
+
+} /* end namespace checkpoint */
@@ -0,0 +1,142 @@
+/*
+//@HEADER
+// *****************************************************************************
+//
+//                                file_packer.h
+//                 DARMA/magistrate => Serialization Library
+//
+// Copyright 2019 National Technology & Engineering Solutions of Sandia, LLC
+// (NTESS). Under the terms of Contract DE-NA0003525 with NTESS, the U.S.
+// Government retains certain rights in this software.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+//
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// * Neither the name of the copyright holder nor the names of its
+//   contributors may be used to endorse or promote products derived from this
+//   software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// Questions? Contact darma@sandia.gov
+//
+// *****************************************************************************
+//@HEADER
+*/
+
+#if !defined INCLUDED_SRC_CHECKPOINT_SERIALIZERS_FILE_PACKER_H
+#define INCLUDED_SRC_CHECKPOINT_SERIALIZERS_FILE_PACKER_H
+
+#include "checkpoint/common.h"
+#include "checkpoint/serializers/base_serializer.h"
+#include "checkpoint/buffer/allocation.h"
+#include "checkpoint/buffer/io_options.h"
+#include "checkpoint/buffer/checksum.h"
+
+#include <memory>
+
+#include <string>
+
+namespace checkpoint {
+
+/**
+ * \struct FilePacker
+ *
+ * \brief Packer that writes directly to a file with \c pwrite instead of
+ * through a shared mapping.
+ *
+ * Small pieces are accumulated in a staging block that is written out when it
+ * fills; pieces at least as large as the block are written straight from the
+ * source memory together with whatever is staged (using \c pwritev when
+ * available). \c closeFile must be called once packing completes to flush the
+ * remaining bytes and apply the durability policy.
+ *
+ * If \c options.checksum is enabled, chunk CRCs are computed as bytes are
+ * packed and a checksum trailer is written by \c closeFile.
+ *
+ * If \c options.write_behind is non-zero, bytes are written at most that many
+ * at a time; each completed window is handed to writeback and the one before
+ * it is waited on and dropped from the page cache, so neither memory nor dirty
+ * pages grow with the size of the file.
+ */
+struct FilePacker : BaseSerializer {
+  /**
+   * \brief Open \c file for writing
+   *
+   * \param[in] size the number of bytes that will be packed
+   * \param[in] file the name of the file to create or truncate
+   * \param[in] options the write options (block size and durability)
+   */
+  FilePacker(
+    SerialSizeType size, std::string const& file,
+    buffer::FileWriteOptions const& options = buffer::FileWriteOptions{}
+  );
+
+  FilePacker(FilePacker const&) = delete;
+  FilePacker(FilePacker&& other);
+  FilePacker& operator=(FilePacker const&) = delete;
+  FilePacker& operator=(FilePacker&&) = delete;
+
+  ~FilePacker();
+
+  /**
+   * \brief Pack contiguous bytes into the file
+   *
+   * \param[in] ptr the bytes to write
+   * \param[in] size the number of bytes for each element
+   * \param[in] num_elms the number of elements
+   */
+  void contiguousBytes(void* ptr, SerialSizeType size, SerialSizeType num_elms);
+
+  /**
+   * \brief Get the number of bytes packed so far
+   *
+   * \return the packed size
+   */
+  SerialSizeType usedBufferSize() const { return n_bytes_; }
+
+  /**
+   * \brief Write any staged bytes, synchronize according to the durability
+   * policy and close the file
+   */
+  void closeFile();
+
+private:
+  void flush(SerialByteType const* extra, SerialSizeType extra_len);
+  void writeOut(SerialByteType const* extra, SerialSizeType extra_len);
+  void writeBehind();
+
+private:
+  std::string file_;
+  int fd_ = -1;
+  buffer::FileDurability durability_ = buffer::FileDurability::DataSync;
+  SerialSizeType block_size_ = 0;
+  buffer::OwnedBytesType staging_ = nullptr;
+  SerialSizeType staged_ = 0;      /**< Bytes waiting in the staging block */
+  SerialSizeType file_offset_ = 0; /**< Bytes already written to the file */
+  SerialSizeType n_bytes_ = 0;     /**< Bytes packed */
+  SerialSizeType write_behind_ = 0;
+  SerialSizeType behind_offset_ = 0; /**< Bytes already handed to writeback */
+  std::unique_ptr<buffer::ChunkChecksummer> checksum_ = nullptr;
+};
+
+} /* end namespace checkpoint */
+
+#endif /*INCLUDED_SRC_CHECKPOINT_SERIALIZERS_FILE_PACKER_H*/
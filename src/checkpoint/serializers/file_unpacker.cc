@@ -0,0 +1,269 @@
+/*
+//@HEADER
+// *****************************************************************************
+//
+//                               file_unpacker.cc
+//                 DARMA/magistrate => Serialization Library
+//
+// Copyright 2019 National Technology & Engineering Solutions of Sandia, LLC
+// (NTESS). Under the terms of Contract DE-NA0003525 with NTESS, the U.S.
+// Government retains certain rights in this software.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+//
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// * Neither the name of the copyright holder nor the names of its
+//   contributors may be used to endorse or promote products derived from this
+//   software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// Questions? Contact darma@sandia.gov
+//
+// *****************************************************************************
+//@HEADER
+*/
+
+#include "checkpoint/common.h"
+#include "checkpoint/serializers/file_unpacker.h"
+
+#include <algorithm>
+#include <cstring>
+#include <string>
+#include <stdexcept>
+#include <vector>
+
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <errno.h>
+#include <string.h>
+
+namespace checkpoint {
+
+FileUnpacker::FileUnpacker(
+  std::string const& file, buffer::FileReadOptions const& options
+) : BaseSerializer(ModeType::Unpacking),
+    file_(file),
+    window_(std::max<SerialSizeType>(options.window, 1))
+{
+  debug_checkpoint("FileUnpacker: opening file for read: %s\n", file_.c_str());
+
+  fd_ = open(file_.c_str(), O_RDONLY, (mode_t)0600);
+  if (fd_ == -1) {
+    auto err = std::string("Failed to open file=") + file_ + ": errno=" +
+               std::to_string(errno) + ": " + strerror(errno);
+    throw std::runtime_error(err);
+  }
+
+  struct stat sb;
+  if (fstat(fd_, &sb) != 0) {
+    auto err = std::string("fstat failed for reading file size: errno=") +
+               std::to_string(errno) + ": " + strerror(errno);
+    close(fd_);
+    fd_ = -1;
+    throw std::runtime_error(err);
+  }
+
+  payload_ = sb.st_size;
+
+# if defined(checkpoint_has_posix_fadvise)
+  // Advice is best effort, so failures are not fatal
+  posix_fadvise(fd_, 0, payload_, POSIX_FADV_SEQUENTIAL);
+# endif
+
+  if (options.checksum != buffer::ChecksumVerify::Skip) {
+    try {
+      setupChecksum(payload_, options.checksum);
+    } catch (...) {
+      close(fd_);
+      fd_ = -1;
+      throw;
+    }
+  }
+
+  /*
+   * When verifying, the buffer has room for a whole chunk beyond the window so
+   * that a refill can always stop on a chunk boundary; never buffer more than
+   * the file holds
+   */
+  capacity_ = window_ + chunk_size_;
+  capacity_ = std::min(capacity_, std::max<SerialSizeType>(payload_, 1));
+  buf_ = buffer::allocateBytes(capacity_);
+}
+
+FileUnpacker::FileUnpacker(FileUnpacker&& other)
+  : BaseSerializer(other),
+    file_(std::move(other.file_)),
+    fd_(other.fd_),
+    window_(other.window_),
+    capacity_(other.capacity_),
+    buf_(std::move(other.buf_)),
+    begin_(other.begin_),
+    end_(other.end_),
+    file_pos_(other.file_pos_),
+    payload_(other.payload_),
+    chunk_size_(other.chunk_size_),
+    n_bytes_(other.n_bytes_),
+    verifier_(std::move(other.verifier_))
+{
+  other.fd_ = -1;
+}
+
+FileUnpacker::~FileUnpacker() {
+  if (fd_ != -1) {
+    close(fd_);
+  }
+}
+
+void FileUnpacker::setupChecksum(
+  SerialSizeType file_size, buffer::ChecksumVerify mode
+) {
+  buffer::ChecksumFooter footer;
+  bool found = file_size >= sizeof(footer);
+
+  if (found) {
+    file_pos_ = file_size - sizeof(footer);
+    readFile(reinterpret_cast<SerialByteType*>(&footer), sizeof(footer));
+    found = buffer::isValidChecksumFooter(footer, file_size);
+  }
+
+  if (not found) {
+    file_pos_ = 0;
+    if (mode == buffer::ChecksumVerify::Require) {
+      throw buffer::checksum_error("No checksum trailer found: file=" + file_);
+    }
+    return;
+  }
+
+  std::vector<uint32_t> expected(footer.num_chunks);
+  file_pos_ = footer.payload_size;
+  readFile(
+    reinterpret_cast<SerialByteType*>(expected.data()),
+    expected.size() * sizeof(uint32_t)
+  );
+  file_pos_ = 0;
+
+  payload_ = footer.payload_size;
+  chunk_size_ = footer.chunk_size;
+  verifier_ = std::make_unique<buffer::ChunkVerifier>(
+    footer, std::move(expected)
+  );
+}
+
+void FileUnpacker::contiguousBytes(
+  void* ptr, SerialSizeType size, SerialSizeType num_elms
+) {
+  auto const len = size * num_elms;
+  auto out = static_cast<SerialByteType*>(ptr);
+
+  if (len > payload_ - n_bytes_) {
+    throw std::runtime_error(
+      "FileUnpacker: unable to read required number of bytes: file=" + file_
+    );
+  }
+
+  if (len >= window_) {
+    auto const held = std::min(end_ - begin_, len);
+    std::memcpy(out, buf_.get() + begin_, held);
+    begin_ += held;
+
+    if (held < len) {
+      begin_ = end_ = 0;
+      readFile(out + held, len - held);
+
+      // Verify the rest of the last chunk before returning its bytes
+      if (chunk_size_ > 0 and file_pos_ % chunk_size_ != 0) {
+        auto const next = file_pos_ / chunk_size_ * chunk_size_ + chunk_size_;
+        end_ = std::min(next, payload_) - file_pos_;
+        readFile(buf_.get(), end_);
+      }
+    }
+  } else {
+    if (end_ - begin_ < len) {
+      refill(len);
+    }
+    std::memcpy(out, buf_.get() + begin_, len);
+    begin_ += len;
+  }
+
+  n_bytes_ += len;
+}
+
+void FileUnpacker::refill(SerialSizeType len) {
+  auto const held = end_ - begin_;
+  std::memmove(buf_.get(), buf_.get() + begin_, held);
+  begin_ = 0;
+  end_ = held;
+
+  // Stop on a chunk boundary so that every byte handed out is verified, unless
+  // the read reaches the end of the payload or there is no whole chunk left
+  auto target = file_pos_ + capacity_ - held;
+  if (chunk_size_ > 0 and target < payload_) {
+    auto const rounded = target / chunk_size_ * chunk_size_;
+    if (rounded > file_pos_) {
+      target = rounded;
+    }
+  }
+  target = std::min(target, payload_);
+
+  auto const n = target - file_pos_;
+  readFile(buf_.get() + end_, n);
+  end_ += n;
+
+  checkpointAssert(end_ >= len, "Refill must cover the requested bytes");
+}
+
+void FileUnpacker::readFile(SerialByteType* out, SerialSizeType len) {
+  while (len > 0) {
+    auto ret = pread(fd_, out, len, file_pos_);
+
+    if (ret < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      auto err = std::string("pread failed on file=") + file_ + ": errno=" +
+                 std::to_string(errno) + ": " + strerror(errno);
+      throw std::runtime_error(err);
+    }
+    if (ret == 0) {
+      throw std::runtime_error(
+        "FileUnpacker: file truncated while reading: file=" + file_
+      );
+    }
+
+    auto const n = static_cast<SerialSizeType>(ret);
+    if (verifier_ != nullptr) {
+      try {
+        verifier_->update(out, n);
+      } catch (buffer::checksum_error const& err) {
+        throw buffer::checksum_error(
+          std::string(err.what()) + ": file=" + file_
+        );
+      }
+    }
+    out += n;
+    len -= n;
+    file_pos_ += n;
+  }
+}
+
+} /* end namespace checkpoint */
@@ -0,0 +1,129 @@
+/*
+//@HEADER
+// *****************************************************************************
+//
+//                               file_unpacker.h
+//                 DARMA/magistrate => Serialization Library
+//
+// Copyright 2019 National Technology & Engineering Solutions of Sandia, LLC
+// (NTESS). Under the terms of Contract DE-NA0003525 with NTESS, the U.S.
+// Government retains certain rights in this software.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+//
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// * Neither the name of the copyright holder nor the names of its
+//   contributors may be used to endorse or promote products derived from this
+//   software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// Questions? Contact darma@sandia.gov
+//
+// *****************************************************************************
+//@HEADER
+*/
+
+#if !defined INCLUDED_SRC_CHECKPOINT_SERIALIZERS_FILE_UNPACKER_H
+#define INCLUDED_SRC_CHECKPOINT_SERIALIZERS_FILE_UNPACKER_H
+
+#include "checkpoint/common.h"
+#include "checkpoint/serializers/base_serializer.h"
+#include "checkpoint/buffer/allocation.h"
+#include "checkpoint/buffer/io_options.h"
+#include "checkpoint/buffer/checksum.h"
+
+#include <memory>
+#include <string>
+
+namespace checkpoint {
+
+/**
+ * \struct FileUnpacker
+ *
+ * \brief Unpacker that reads a file with \c pread through a fixed-size window
+ * instead of mapping it, so memory use does not grow with the file size.
+ *
+ * Small pieces are served from the window, which is refilled as it is
+ * consumed; pieces at least as large as the window are read straight into
+ * their destination.
+ *
+ * If the file ends with a checksum trailer (see \c options.checksum), each
+ * chunk is verified as it is read. The window then ends on chunk boundaries so
+ * that no byte is unpacked before its chunk has been verified.
+ */
+struct FileUnpacker : BaseSerializer {
+  /**
+   * \brief Open \c file for reading
+   *
+   * \param[in] file the name of the file
+   * \param[in] options the read options (window size and checksum)
+   */
+  explicit FileUnpacker(
+    std::string const& file,
+    buffer::FileReadOptions const& options = buffer::FileReadOptions{}
+  );
+
+  FileUnpacker(FileUnpacker const&) = delete;
+  FileUnpacker(FileUnpacker&& other);
+  FileUnpacker& operator=(FileUnpacker const&) = delete;
+  FileUnpacker& operator=(FileUnpacker&&) = delete;
+
+  ~FileUnpacker();
+
+  /**
+   * \brief Unpack contiguous bytes from the file
+   *
+   * \param[out] ptr where to put the bytes
+   * \param[in] size the number of bytes for each element
+   * \param[in] num_elms the number of elements
+   */
+  void contiguousBytes(void* ptr, SerialSizeType size, SerialSizeType num_elms);
+
+  /**
+   * \brief Get the number of bytes unpacked so far
+   *
+   * \return the unpacked size
+   */
+  SerialSizeType usedBufferSize() const { return n_bytes_; }
+
+private:
+  void setupChecksum(SerialSizeType file_size, buffer::ChecksumVerify mode);
+  void refill(SerialSizeType len);
+  void readFile(SerialByteType* out, SerialSizeType len);
+
+private:
+  std::string file_;
+  int fd_ = -1;
+  SerialSizeType window_ = 0;   /**< Pieces this large bypass the buffer */
+  SerialSizeType capacity_ = 0; /**< Size of the buffer */
+  buffer::OwnedBytesType buf_ = nullptr;
+  SerialSizeType begin_ = 0;    /**< First buffered byte not yet unpacked */
+  SerialSizeType end_ = 0;      /**< One past the last buffered byte */
+  SerialSizeType file_pos_ = 0; /**< Next offset read from the file */
+  SerialSizeType payload_ = 0;  /**< Bytes before any checksum trailer */
+  SerialSizeType chunk_size_ = 0;
+  SerialSizeType n_bytes_ = 0;  /**< Bytes unpacked */
+  std::unique_ptr<buffer::ChunkVerifier> verifier_ = nullptr;
+};
+
+} /* end namespace checkpoint */
+
+#endif /*INCLUDED_SRC_CHECKPOINT_SERIALIZERS_FILE_UNPACKER_H*/
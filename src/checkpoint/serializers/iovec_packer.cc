@@ -0,0 +1,114 @@
+/*
+//@HEADER
+// *****************************************************************************
+//
+//                               iovec_packer.cc
+//                 DARMA/magistrate => Serialization Library
+//
+// Copyright 2019 National Technology & Engineering Solutions of Sandia, LLC
+// (NTESS). Under the terms of Contract DE-NA0003525 with NTESS, the U.S.
+// Government retains certain rights in this software.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+//
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// * Neither the name of the copyright holder nor the names of its
+//   contributors may be used to endorse or promote products derived from this
+//   software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// Questions? Contact darma@sandia.gov
+//
+// *****************************************************************************
+//@HEADER
+*/
+
+#include "checkpoint/common.h"
+#include "checkpoint/serializers/iovec_packer.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace checkpoint {
+
+PackerIOVec::PackerIOVec(SerialSizeType size, SerialSizeType threshold)
+  : BaseSerializer(ModeType::Packing),
+    threshold_(std::max<SerialSizeType>(threshold, 1)),
+    side_(
+      std::make_unique<buffer::GrowableBuffer>(
+        std::min<SerialSizeType>(size, threshold_)
+      )
+    )
+{ }
+
+void PackerIOVec::contiguousBytes(
+  void* ptr, SerialSizeType size, SerialSizeType num_elms
+) {
+  auto const len = size * num_elms;
+  auto const bytes = static_cast<SerialByteType const*>(ptr);
+
+  if (len == 0) {
+    return;
+  }
+
+  n_bytes_ += len;
+
+  if (len >= threshold_ and transient_ == 0) {
+    segments_.push_back(Segment{bytes, 0, len});
+    return;
+  }
+
+  side_->reserve(side_size_ + len);
+  std::memcpy(side_->getBuffer() + side_size_, bytes, len);
+
+  // Consecutive copied pieces form a single segment
+  if (
+    not segments_.empty() and segments_.back().ptr == nullptr and
+    segments_.back().offset + segments_.back().len == side_size_
+  ) {
+    segments_.back().len += len;
+  } else {
+    segments_.push_back(Segment{nullptr, side_size_, len});
+  }
+
+  side_size_ += len;
+}
+
+std::unique_ptr<buffer::IOVecList> PackerIOVec::extractIOVecList() {
+  // The side buffer may have moved while growing, so resolve offsets last
+  side_->setSize(side_size_);
+  auto const base = side_->getBuffer();
+
+  std::vector<struct iovec> iov(segments_.size());
+  for (std::size_t i = 0; i < segments_.size(); i++) {
+    auto const& seg = segments_[i];
+    auto const src = seg.ptr != nullptr ? seg.ptr : base + seg.offset;
+    iov[i].iov_base = const_cast<SerialByteType*>(src);
+    iov[i].iov_len = seg.len;
+  }
+  segments_.clear();
+
+  return std::make_unique<buffer::IOVecList>(
+    std::move(side_), std::move(iov), n_bytes_
+  );
+}
+
+} /* end namespace checkpoint */
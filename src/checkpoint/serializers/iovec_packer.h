@@ -0,0 +1,129 @@
+/*
+//@HEADER
+// *****************************************************************************
+//
+//                                iovec_packer.h
+//                 DARMA/magistrate => Serialization Library
+//
+// Copyright 2019 National Technology & Engineering Solutions of Sandia, LLC
+// (NTESS). Under the terms of Contract DE-NA0003525 with NTESS, the U.S.
+// Government retains certain rights in this software.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+//
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// * Neither the name of the copyright holder nor the names of its
+//   contributors may be used to endorse or promote products derived from this
+//   software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// Questions? Contact darma@sandia.gov
+//
+// *****************************************************************************
+//@HEADER
+*/
+
+#if !defined INCLUDED_SRC_CHECKPOINT_SERIALIZERS_IOVEC_PACKER_H
+#define INCLUDED_SRC_CHECKPOINT_SERIALIZERS_IOVEC_PACKER_H
+
+#include "checkpoint/common.h"
+#include "checkpoint/serializers/base_serializer.h"
+#include "checkpoint/buffer/growable_buffer.h"
+#include "checkpoint/buffer/iovec_list.h"
+
+#include <memory>
+#include <vector>
+
+namespace checkpoint {
+
+/**
+ * \struct PackerIOVec
+ *
+ * \brief Scatter-gather packer that references large contiguous fields in
+ * place instead of copying them
+ *
+ * Pieces of at least the threshold size are recorded as segments pointing at
+ * the source memory; smaller pieces are copied into a side buffer. The result,
+ * obtained with \c extractIOVecList, refers to the serialized object, which
+ * must stay alive and unmodified until the segments have been consumed.
+ * Memory that only lives for the duration of a \c serialize call (e.g., a
+ * temporary host mirror) is copied when bracketed by \c beginTransient and
+ * \c endTransient.
+ */
+struct PackerIOVec : BaseSerializer {
+  /**
+   * \brief Construct the packer
+   *
+   * \param[in] size the number of bytes that will be packed
+   * \param[in] threshold the piece size at which memory is referenced
+   */
+  explicit PackerIOVec(
+    SerialSizeType size,
+    SerialSizeType threshold = buffer::iovec_reference_threshold
+  );
+
+  /**
+   * \brief Record contiguous bytes, by reference or by copy depending on size
+   *
+   * \param[in] ptr the bytes to pack
+   * \param[in] size the number of bytes for each element
+   * \param[in] num_elms the number of elements
+   */
+  void contiguousBytes(void* ptr, SerialSizeType size, SerialSizeType num_elms);
+
+  /**
+   * \brief Get the number of bytes packed so far
+   *
+   * \return the packed size
+   */
+  SerialSizeType usedBufferSize() const { return n_bytes_; }
+
+  /// Start of memory that must be copied because it will not outlive packing
+  void beginTransient() { transient_++; }
+
+  /// End of memory started with \c beginTransient
+  void endTransient() { transient_--; }
+
+  /**
+   * \brief Take the packed segments
+   *
+   * \return the segment list
+   */
+  std::unique_ptr<buffer::IOVecList> extractIOVecList();
+
+private:
+  struct Segment {
+    SerialByteType const* ptr = nullptr; /**< Source, or null if in side */
+    SerialSizeType offset = 0;           /**< Offset in the side buffer */
+    SerialSizeType len = 0;
+  };
+
+  SerialSizeType threshold_ = 0;
+  int transient_ = 0;
+  SerialSizeType n_bytes_ = 0;
+  std::unique_ptr<buffer::GrowableBuffer> side_ = nullptr;
+  SerialSizeType side_size_ = 0;
+  std::vector<Segment> segments_;
+};
+
+} /* end namespace checkpoint */
+
+#endif /*INCLUDED_SRC_CHECKPOINT_SERIALIZERS_IOVEC_PACKER_H*/
@@ -0,0 +1,95 @@
+/*
+//@HEADER
+// *****************************************************************************
+//
+//                             member_index_sizer.h
+//                 DARMA/magistrate => Serialization Library
+//
+// Copyright 2019 National Technology & Engineering Solutions of Sandia, LLC
+// (NTESS). Under the terms of Contract DE-NA0003525 with NTESS, the U.S.
+// Government retains certain rights in this software.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+//
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// * Neither the name of the copyright holder nor the names of its
+//   contributors may be used to endorse or promote products derived from this
+//   software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// Questions? Contact darma@sandia.gov
+//
+// *****************************************************************************
+//@HEADER
+*/
+
+#if !defined INCLUDED_SRC_CHECKPOINT_SERIALIZERS_MEMBER_INDEX_SIZER_H
+#define INCLUDED_SRC_CHECKPOINT_SERIALIZERS_MEMBER_INDEX_SIZER_H
+
+#include "checkpoint/common.h"
+#include "checkpoint/serializers/sizer.h"
+#include "checkpoint/buffer/member_table.h"
+
+#include <type_traits>
+
+namespace checkpoint {
+
+/**
+ * \struct MemberIndexSizer
+ *
+ * \brief A \c Sizer that also records where the members marked with
+ * \c indexMember and \c indexElements start in the packed bytes
+ *
+ * The sizer's count at any point of the traversal is the offset a packer will
+ * be at, so the offsets are known before packing starts.
+ */
+struct MemberIndexSizer : Sizer {
+  /**
+   * \brief Record a member that started at \c begin and ends at the current
+   * size
+   *
+   * \param[in] name the name of the member
+   * \param[in] index the element index, zero for a single member
+   * \param[in] begin the size before the member was traversed
+   */
+  void recordMember(
+    char const* name, SerialSizeType index, SerialSizeType begin
+  ) {
+    table_.add(name, index, begin, getSize() - begin);
+  }
+
+  /**
+   * \brief Get the recorded offsets
+   *
+   * \return the table
+   */
+  buffer::MemberTable const& getTable() const { return table_; }
+
+private:
+  buffer::MemberTable table_;
+};
+
+template <typename SerializerT>
+struct IsMemberIndexSizer : std::is_same<SerializerT, MemberIndexSizer> { };
+
+} /* end namespace checkpoint */
+
+#endif /*INCLUDED_SRC_CHECKPOINT_SERIALIZERS_MEMBER_INDEX_SIZER_H*/
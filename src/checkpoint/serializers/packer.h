@@ -50,6 +50,11 @@
 #include "checkpoint/buffer/managed_buffer.h"
 #include "checkpoint/buffer/user_buffer.h"
 #include "checkpoint/buffer/io_buffer.h"
+#include "checkpoint/buffer/growable_buffer.h"
+#include "checkpoint/buffer/buffer_pool.h"
+#include "checkpoint/buffer/checksum.h"
+
+#include <memory>
 
 namespace checkpoint {
 
@@ -65,11 +70,43 @@ struct PackerBuffer : MemorySerializer {
   explicit PackerBuffer(SerialSizeType const& in_size, Args&&... args);
 
   void contiguousBytes(void* ptr, SerialSizeType size, SerialSizeType num_elms);
+
+  /**
+   * \brief Advance past the next \c len bytes of the buffer so they can be
+   * written directly by the caller
+   *
+   * \param[in] len the number of bytes
+   *
+   * \return the start of the bytes
+   */
+  SerialByteType* claimBytes(SerialSizeType len);
+
   BufferTPtrType extractPackedBuffer();
   SerialSizeType usedBufferSize() const;
 
+  /**
+   * \brief Compute the CRC32C of every \c chunk_size chunk while the bytes are
+   * packed, so the checksum trailer does not take another pass over memory
+   *
+   * \param[in] chunk_size the bytes covered by each CRC
+   */
+  void enableChecksum(SerialSizeType chunk_size);
+
+  /**
+   * \brief Write the checksum trailer for the bytes packed so far right after
+   * them; the buffer must have room for \c getChecksumTrailerSize more bytes
+   */
+  void writeChecksumTrailer();
+
 private:
-  // Size of the buffer we are packing (Sizer should have run already)
+  // Make room for \c len more bytes when the buffer is growable
+  void reserveSpot(SerialSizeType const len);
+
+  // Add the bytes packed since the last call to the running checksum
+  void updateChecksum();
+
+  // Size of the buffer we are packing (Sizer should have run already), or the
+  // initial capacity when packing into a growable buffer
   SerialSizeType const size_;
 
   // Size of the actually used memory (for error checking)
@@ -77,11 +114,20 @@ private:
 
   // The abstract buffer that may manage the memory in various ways
   BufferTPtrType buffer_ = nullptr;
+
+  // Running chunk checksums, when enabled
+  std::unique_ptr<buffer::ChunkChecksummer> checksum_ = nullptr;
+
+  // Bytes already added to the checksum; claimed bytes are written by the
+  // caller after \c claimBytes returns, so they are added on a later call
+  SerialSizeType checksummed_ = 0;
 };
 
 using Packer = PackerBuffer<buffer::ManagedBuffer>;
 using PackerUserBuf = PackerBuffer<buffer::UserBuffer>;
 using PackerIO = PackerBuffer<buffer::IOBuffer>;
+using PackerGrowable = PackerBuffer<buffer::GrowableBuffer>;
+using PackerPooled = PackerBuffer<buffer::PooledBuffer>;
 
 } /* end namespace checkpoint */
 
@@ -104,6 +104,9 @@ PackerBuffer<BufferT>::PackerBuffer(
 template <typename BufferT>
 typename PackerBuffer<BufferT>::BufferTPtrType
 PackerBuffer<BufferT>::extractPackedBuffer() {
+  if constexpr (buffer::IsGrowableBuffer<BufferT>::value) {
+    buffer_->setSize(usedSize_);
+  }
   auto ret = std::move(buffer_);
   buffer_ = nullptr;
   return ret;
@@ -119,7 +122,7 @@ void PackerBuffer<BufferT>::contiguousBytes(
   );
 
   SerialSizeType const len = size * num_elms;
-  SerialByteType* spot = this->getSpotIncrement(len);
+  SerialByteType* spot = claimBytes(len);
   #pragma GCC diagnostic push
 #if !defined(__has_warning)
   #pragma GCC diagnostic ignored "-Wmaybe-uninitialized"
@@ -129,7 +132,28 @@ void PackerBuffer<BufferT>::contiguousBytes(
   std::memcpy(spot, ptr, len);
   #pragma GCC diagnostic pop
 
+  if (checksum_ != nullptr) {
+    updateChecksum();
+  }
+}
+
+template <typename BufferT>
+SerialByteType* PackerBuffer<BufferT>::claimBytes(SerialSizeType len) {
+  if constexpr (buffer::IsGrowableBuffer<BufferT>::value) {
+    reserveSpot(len);
+  }
   usedSize_ += len;
+  return this->getSpotIncrement(len);
+}
+
+template <typename BufferT>
+void PackerBuffer<BufferT>::reserveSpot(SerialSizeType const len) {
+  SerialSizeType const offset = cur_ - start_;
+  if (offset + len > buffer_->getCapacity()) {
+    buffer_->reserve(offset + len);
+    MemorySerializer::initializeBuffer(buffer_->getBuffer());
+    cur_ += offset;
+  }
 }
 
 template <typename BufferT>
@@ -137,6 +161,24 @@ SerialSizeType PackerBuffer<BufferT>::usedBufferSize() const {
   return usedSize_;
 }
 
+template <typename BufferT>
+void PackerBuffer<BufferT>::enableChecksum(SerialSizeType chunk_size) {
+  checksum_ = std::make_unique<buffer::ChunkChecksummer>(chunk_size);
+  checksummed_ = usedSize_;
+}
+
+template <typename BufferT>
+void PackerBuffer<BufferT>::updateChecksum() {
+  checksum_->update(start_ + checksummed_, usedSize_ - checksummed_);
+  checksummed_ = usedSize_;
+}
+
+template <typename BufferT>
+void PackerBuffer<BufferT>::writeChecksumTrailer() {
+  updateChecksum();
+  checksum_->writeTrailer(start_ + usedSize_);
+}
+
 } /* end namespace checkpoint */
 
 #endif /*INCLUDED_SRC_CHECKPOINT_SERIALIZERS_PACKER_IMPL_H*/
@@ -0,0 +1,190 @@
+/*
+//@HEADER
+// *****************************************************************************
+//
+//                            parallel_serializer.h
+//                 DARMA/magistrate => Serialization Library
+//
+// Copyright 2019 National Technology & Engineering Solutions of Sandia, LLC
+// (NTESS). Under the terms of Contract DE-NA0003525 with NTESS, the U.S.
+// Government retains certain rights in this software.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+//
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// * Neither the name of the copyright holder nor the names of its
+//   contributors may be used to endorse or promote products derived from this
+//   software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// Questions? Contact darma@sandia.gov
+//
+// *****************************************************************************
+//@HEADER
+*/
+
+#if !defined INCLUDED_SRC_CHECKPOINT_SERIALIZERS_PARALLEL_SERIALIZER_H
+#define INCLUDED_SRC_CHECKPOINT_SERIALIZERS_PARALLEL_SERIALIZER_H
+
+#include "checkpoint/common.h"
+#include "checkpoint/serializers/sizer.h"
+#include "checkpoint/serializers/packer.h"
+#include "checkpoint/serializers/unpacker.h"
+
+#include <cstdint>
+#include <memory>
+#include <type_traits>
+#include <vector>
+
+namespace checkpoint {
+
+/**
+ * \struct ParallelPackOptions
+ *
+ * \brief Options for sizing and packing large arrays on several threads
+ *
+ * Arrays of non-byte-copyable elements with at least \c min_elements elements
+ * are cut into chunks. Each chunk is sized on its own, a prefix sum of the
+ * chunk sizes gives each chunk its offset, and the chunks are then packed
+ * concurrently into disjoint parts of the buffer. The output is identical to
+ * packing serially. Element \c serialize methods must therefore be safe to run
+ * concurrently on different elements.
+ *
+ * With \c indexed set, the chunk sizes are also written ahead of each chunked
+ * array (see \c dispatch::serializeChunks) so that the chunks can be unpacked
+ * concurrently by a \c ParallelUnpackerBuffer; the output can then only be
+ * read by a \c ParallelUnpackerBuffer. The index is written even with one
+ * thread, so a checkpoint can be restarted on more threads than it was
+ * written with.
+ */
+struct ParallelPackOptions {
+  unsigned num_threads = 1;           /**< Threads sizing and packing chunks */
+  SerialSizeType min_elements = 4096; /**< Smallest array split into chunks */
+  SerialSizeType chunk_elements = 0;  /**< Elements per chunk; 0: automatic */
+  bool indexed = false;               /**< Write an element index */
+};
+
+/**
+ * \struct ParallelChunkPlan
+ *
+ * \brief The chunk sizes found by a \c ParallelSizer, so a
+ * \c ParallelPackerBuffer packing the same object does not size every chunk
+ * again
+ *
+ * Arrays are recorded in traversal order; an empty entry marks an array that
+ * is packed serially.
+ */
+struct ParallelChunkPlan {
+  std::vector<std::vector<std::uint64_t>> sizes;
+  std::size_t next = 0; /**< Next entry the packer uses */
+};
+
+/**
+ * \struct ParallelSizer
+ *
+ * \brief A \c Sizer that sizes large arrays in chunks on several threads
+ */
+struct ParallelSizer : Sizer {
+  explicit ParallelSizer(
+    ParallelPackOptions const& in_options,
+    std::shared_ptr<ParallelChunkPlan> in_plan = nullptr
+  ) : options_(in_options),
+      plan_(std::move(in_plan))
+  { }
+
+  ParallelPackOptions const& getParallelOptions() const { return options_; }
+
+  ParallelChunkPlan* getChunkPlan() const { return plan_.get(); }
+
+private:
+  ParallelPackOptions options_;
+  std::shared_ptr<ParallelChunkPlan> plan_ = nullptr;
+};
+
+/**
+ * \struct ParallelPackerBuffer
+ *
+ * \brief A \c PackerBuffer that packs large arrays in chunks on several
+ * threads
+ */
+template <typename BufferT>
+struct ParallelPackerBuffer : PackerBuffer<BufferT> {
+  template <typename... Args>
+  ParallelPackerBuffer(
+    SerialSizeType const& in_size, ParallelPackOptions const& in_options,
+    std::shared_ptr<ParallelChunkPlan> in_plan, Args&&... args
+  ) : PackerBuffer<BufferT>(in_size, std::forward<Args>(args)...),
+      options_(in_options),
+      plan_(std::move(in_plan))
+  { }
+
+  ParallelPackOptions const& getParallelOptions() const { return options_; }
+
+  ParallelChunkPlan* getChunkPlan() const { return plan_.get(); }
+
+private:
+  ParallelPackOptions options_;
+  std::shared_ptr<ParallelChunkPlan> plan_ = nullptr;
+};
+
+/**
+ * \struct ParallelUnpackerBuffer
+ *
+ * \brief An \c UnpackerBuffer for bytes packed with
+ * \c ParallelPackOptions::indexed, which unpacks the chunks of indexed arrays
+ * on several threads
+ */
+template <typename BufferT>
+struct ParallelUnpackerBuffer : UnpackerBuffer<BufferT> {
+  template <typename... Args>
+  explicit ParallelUnpackerBuffer(unsigned in_num_threads, Args&&... args)
+    : UnpackerBuffer<BufferT>(std::forward<Args>(args)...),
+      num_threads_(in_num_threads)
+  { }
+
+  unsigned getNumThreads() const { return num_threads_; }
+
+private:
+  unsigned num_threads_ = 1;
+};
+
+using ParallelPacker = ParallelPackerBuffer<buffer::ManagedBuffer>;
+using ParallelPackerIO = ParallelPackerBuffer<buffer::IOBuffer>;
+using ParallelUnpacker = ParallelUnpackerBuffer<buffer::UserBuffer>;
+using ParallelUnpackerIO = ParallelUnpackerBuffer<buffer::IOBuffer>;
+
+template <typename SerializerT>
+struct IsParallelSerializer : std::false_type { };
+
+template <>
+struct IsParallelSerializer<ParallelSizer> : std::true_type { };
+
+template <typename BufferT>
+struct IsParallelSerializer<ParallelPackerBuffer<BufferT>> : std::true_type { };
+
+template <typename SerializerT>
+struct IsParallelUnpacker : std::false_type { };
+
+template <typename BufferT>
+struct IsParallelUnpacker<ParallelUnpackerBuffer<BufferT>> : std::true_type { };
+
+} /* end namespace checkpoint */
+#endif /*INCLUDED_SRC_CHECKPOINT_SERIALIZERS_PARALLEL_SERIALIZER_H*/
@@ -0,0 +1,115 @@
+/*
+//@HEADER
+// *****************************************************************************
+//
+//                            portable_serializer.h
+//                 DARMA/magistrate => Serialization Library
+//
+// Copyright 2019 National Technology & Engineering Solutions of Sandia, LLC
+// (NTESS). Under the terms of Contract DE-NA0003525 with NTESS, the U.S.
+// Government retains certain rights in this software.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+//
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// * Neither the name of the copyright holder nor the names of its
+//   contributors may be used to endorse or promote products derived from this
+//   software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// Questions? Contact darma@sandia.gov
+//
+// *****************************************************************************
+//@HEADER
+*/
+
+#if !defined INCLUDED_SRC_CHECKPOINT_SERIALIZERS_PORTABLE_SERIALIZER_H
+#define INCLUDED_SRC_CHECKPOINT_SERIALIZERS_PORTABLE_SERIALIZER_H
+
+#include "checkpoint/common.h"
+#include "checkpoint/serializers/packer.h"
+#include "checkpoint/serializers/unpacker.h"
+#include "checkpoint/buffer/byte_order.h"
+
+namespace checkpoint {
+
+/**
+ * \struct PortablePackerBuffer
+ *
+ * \brief Packer that writes arithmetic values in the little-endian order of
+ * portable buffers.
+ *
+ * Arrays of 2, 4 and 8 byte values are byte-swapped with vector shuffles
+ * straight into the buffer when \c swap is set. The default only sets it on
+ * big-endian hosts; elsewhere the packer is identical to \c PackerBuffer, the
+ * choice being made at compile time. Other byte-copyable types (e.g., structs
+ * declared byte-copyable) are packed as raw bytes and are not portable.
+ *
+ * \tparam BufferT the buffer packed into
+ * \tparam swap whether values are byte-swapped
+ */
+template <typename BufferT, bool swap = buffer::host_is_big_endian>
+struct PortablePackerBuffer : PackerBuffer<BufferT> {
+  using PackerBuffer<BufferT>::PackerBuffer;
+
+  template <typename SerializerT, typename T>
+  void contiguousTyped(SerializerT& serdes, T* ptr, SerialSizeType num_elms) {
+    if constexpr (swap and buffer::IsByteSwappable<T>::value) {
+      buffer::byteSwap(
+        this->claimBytes(sizeof(T) * num_elms),
+        reinterpret_cast<SerialByteType const*>(ptr), num_elms, sizeof(T)
+      );
+    } else {
+      serdes.contiguousBytes(static_cast<void*>(ptr), sizeof(T), num_elms);
+    }
+  }
+};
+
+/**
+ * \struct PortableUnpackerBuffer
+ *
+ * \brief Unpacker for the payload of portable buffers; arithmetic values are
+ * byte-swapped back into host order after they are copied out when \c swap is
+ * set (by default, only on big-endian hosts)
+ *
+ * \tparam BufferT the buffer unpacked from
+ * \tparam swap whether values are byte-swapped
+ */
+template <typename BufferT, bool swap = buffer::host_is_big_endian>
+struct PortableUnpackerBuffer : UnpackerBuffer<BufferT> {
+  using UnpackerBuffer<BufferT>::UnpackerBuffer;
+
+  template <typename SerializerT, typename T>
+  void contiguousTyped(SerializerT& serdes, T* ptr, SerialSizeType num_elms) {
+    serdes.contiguousBytes(static_cast<void*>(ptr), sizeof(T), num_elms);
+    if constexpr (swap and buffer::IsByteSwappable<T>::value) {
+      auto const bytes = reinterpret_cast<SerialByteType*>(ptr);
+      buffer::byteSwap(bytes, bytes, num_elms, sizeof(T));
+    }
+  }
+};
+
+using PortablePacker = PortablePackerBuffer<buffer::ManagedBuffer>;
+using PortableUnpacker = PortableUnpackerBuffer<buffer::UserBuffer>;
+
+} /* end namespace checkpoint */
+
+#endif /*INCLUDED_SRC_CHECKPOINT_SERIALIZERS_PORTABLE_SERIALIZER_H*/
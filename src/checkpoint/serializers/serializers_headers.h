@@ -51,15 +51,41 @@
 #include "checkpoint/serializers/packer.h"
 #include "checkpoint/serializers/unpacker.h"
 #include "checkpoint/serializers/stream_serializer.h"
+#include "checkpoint/serializers/file_packer.h"
+#include "checkpoint/serializers/file_unpacker.h"
+#include "checkpoint/serializers/iovec_packer.h"
+#include "checkpoint/serializers/compressed_serializer.h"
+#include "checkpoint/serializers/parallel_serializer.h"
+#include "checkpoint/serializers/member_index_sizer.h"
+#include "checkpoint/serializers/portable_serializer.h"
+#include "checkpoint/serializers/compact_serializer.h"
 
 #define checkpoint_serializer_variadic_args()   \
   checkpoint::Footprinter,                      \
   checkpoint::Packer,                           \
   checkpoint::PackerUserBuf,                    \
   checkpoint::PackerIO,                         \
+  checkpoint::PackerGrowable,                   \
+  checkpoint::PackerPooled,                     \
+  checkpoint::FilePacker,                       \
+  checkpoint::FileUnpacker,                     \
+  checkpoint::PackerIOVec,                      \
+  checkpoint::CompressedPacker,                 \
+  checkpoint::CompressedUnpacker,               \
+  checkpoint::ParallelPacker,                   \
+  checkpoint::ParallelPackerIO,                 \
   checkpoint::Unpacker,                         \
   checkpoint::UnpackerIO,                       \
+  checkpoint::PortablePacker,                   \
+  checkpoint::PortableUnpacker,                 \
+  checkpoint::CompactPacker,                    \
+  checkpoint::CompactUnpacker,                  \
+  checkpoint::ParallelUnpacker,                 \
+  checkpoint::ParallelUnpackerIO,               \
   checkpoint::Sizer,                            \
+  checkpoint::ParallelSizer,                    \
+  checkpoint::MemberIndexSizer,                 \
+  checkpoint::CompactSizer,                     \
   checkpoint::StreamPacker<>,                   \
   checkpoint::StreamUnpacker<>                  \
 
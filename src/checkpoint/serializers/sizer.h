@@ -69,6 +69,26 @@ struct Sizer : BaseSerializer {
    */
   SerialSizeType getSize() const;
 
+  /**
+   * \brief Get the number of bytes counted so far, which is the offset a
+   * packer will be at in the same position of the traversal
+   *
+   * \return The current size
+   */
+  SerialSizeType usedBufferSize() const {
+    offset_used_ = true;
+    return num_bytes_;
+  }
+
+  /**
+   * \brief Whether \c usedBufferSize was called, i.e., whether the size
+   * depends on the offset the sizing started at (for instance because of
+   * alignment padding)
+   *
+   * \return whether the offset was used
+   */
+  bool isOffsetUsed() const { return offset_used_; }
+
   /**
    * \brief Add contiguous bytes to the sizer
    *
@@ -79,7 +99,8 @@ struct Sizer : BaseSerializer {
   void contiguousBytes(void* ptr, SerialSizeType size, SerialSizeType num_elms);
 
 private:
-  SerialSizeType num_bytes_ = 0; /**< Count of bytes */
+  SerialSizeType num_bytes_ = 0;     /**< Count of bytes */
+  mutable bool offset_used_ = false; /**< Whether the offset was queried */
 };
 
 } /* end namespace checkpoint */
@@ -46,51 +46,237 @@
 
 #include "checkpoint/common.h"
 #include "checkpoint/serializers/base_serializer.h"
+#include "checkpoint/buffer/allocation.h"
+
+#include <algorithm>
+#include <cstring>
 #include <ostream>
 #include <istream>
+#include <stdexcept>
+#include <utility>
 
 namespace checkpoint {
 
+/// Default size of the coalescing buffer in the stream serializers
+constexpr SerialSizeType const default_stream_buffer_size = 64ull << 10;
+
+/**
+ * \struct StreamPacker
+ *
+ * \brief Packer that writes to a stream through a coalescing buffer
+ *
+ * Small pieces are accumulated in a buffer of \c min(size, buffer_size) bytes
+ * and handed to \c stream.write when it fills; pieces at least as large as the
+ * buffer are written straight from the source memory after the buffered bytes.
+ * Remaining bytes are written by \c flush, which the destructor also calls.
+ */
 template<typename StreamT = std::ostream>
 struct StreamPacker : BaseSerializer {
-  StreamPacker(SerialSizeType, StreamT& m_stream)
-    : BaseSerializer(ModeType::Packing), stream(m_stream) {
-    //Nothing to do with the size.
-    //Pre-allocating a buffer for the stream has more problems than solutions.
+  /**
+   * \brief Construct a packer writing to \c m_stream
+   *
+   * \param[in] size the number of bytes that will be packed
+   * \param[in] m_stream the stream to write to
+   * \param[in] buffer_size the largest coalescing buffer to allocate; zero
+   * writes every piece directly
+   */
+  StreamPacker(
+    SerialSizeType size, StreamT& m_stream,
+    SerialSizeType buffer_size = default_stream_buffer_size
+  ) : BaseSerializer(ModeType::Packing),
+      stream(m_stream),
+      capacity(std::min(size, buffer_size))
+  {
+    if (capacity > 0) {
+      buf = buffer::allocateBytes(capacity);
+    }
+  }
+
+  StreamPacker(StreamPacker const&) = delete;
+  StreamPacker(StreamPacker&& other)
+    : BaseSerializer(std::move(other)),
+      stream(other.stream),
+      buf(std::move(other.buf)),
+      capacity(other.capacity),
+      buffered(other.buffered),
+      n_bytes(other.n_bytes)
+  {
+    other.buffered = 0;
+  }
+  StreamPacker& operator=(StreamPacker const&) = delete;
+  StreamPacker& operator=(StreamPacker&&) = delete;
+
+  ~StreamPacker() {
+    // Errors are reported by the stream's own state; never throw from here
+    try {
+      flush();
+    } catch (...) { }
   }
 
   void contiguousBytes(void* ptr, SerialSizeType size, SerialSizeType num_elms) {
-    stream.write(static_cast<char*>(ptr), size*num_elms);
-    n_bytes += size*num_elms;
+    auto const len = size * num_elms;
+    auto const bytes = static_cast<char const*>(ptr);
+
+    if (len >= capacity) {
+      flush();
+      stream.write(bytes, len);
+    } else {
+      if (buffered + len > capacity) {
+        flush();
+      }
+      std::memcpy(buf.get() + buffered, bytes, len);
+      buffered += len;
+    }
+    n_bytes += len;
   }
 
   SerialSizeType usedBufferSize() {
     return n_bytes;
   }
 
+  /**
+   * \brief Write the buffered bytes to the stream
+   */
+  void flush() {
+    if (buffered > 0) {
+      stream.write(buf.get(), buffered);
+      buffered = 0;
+    }
+  }
+
 private:
   StreamT& stream;
+  buffer::OwnedBytesType buf = nullptr;
+  SerialSizeType capacity = 0;
+  SerialSizeType buffered = 0; /**< Bytes waiting in the buffer */
   SerialSizeType n_bytes = 0;
 };
 
+/**
+ * \struct StreamUnpacker
+ *
+ * \brief Unpacker that reads from a stream through a read-ahead buffer
+ *
+ * Small pieces are served from a buffer refilled with up to \c buffer_size
+ * bytes per \c stream.read; pieces at least as large as the buffer are read
+ * straight into the destination. Bytes read ahead but never unpacked are
+ * returned to the stream with \c seekg when the unpacker is destroyed, so the
+ * stream is left just past the serialized object. Streams that do not report
+ * a position with \c tellg are read without buffering.
+ */
 template<typename StreamT = std::istream>
 struct StreamUnpacker : BaseSerializer {
-  StreamUnpacker(StreamT& m_stream)
-    : BaseSerializer(ModeType::Unpacking), stream(m_stream) { }
+  /**
+   * \brief Construct an unpacker reading from \c m_stream
+   *
+   * \param[in] m_stream the stream to read from
+   * \param[in] buffer_size the size of the read-ahead buffer; zero reads every
+   * piece directly
+   */
+  explicit StreamUnpacker(
+    StreamT& m_stream,
+    SerialSizeType buffer_size = default_stream_buffer_size
+  ) : BaseSerializer(ModeType::Unpacking),
+      stream(m_stream)
+  {
+    if (buffer_size > 0 and stream.tellg() != typename StreamT::pos_type(-1)) {
+      capacity = buffer_size;
+      buf = buffer::allocateBytes(capacity);
+    }
+  }
+
+  StreamUnpacker(StreamUnpacker const&) = delete;
+  StreamUnpacker(StreamUnpacker&& other)
+    : BaseSerializer(std::move(other)),
+      stream(other.stream),
+      buf(std::move(other.buf)),
+      capacity(other.capacity),
+      begin(other.begin),
+      end(other.end),
+      n_bytes(other.n_bytes)
+  {
+    other.begin = other.end = 0;
+  }
+  StreamUnpacker& operator=(StreamUnpacker const&) = delete;
+  StreamUnpacker& operator=(StreamUnpacker&&) = delete;
+
+  ~StreamUnpacker() {
+    try {
+      unread();
+    } catch (...) { }
+  }
 
   void contiguousBytes(void* ptr, SerialSizeType size, SerialSizeType num_elms) {
-    stream.read(static_cast<char*>(ptr), size*num_elms);
-    if(!stream)
-      throw std::runtime_error("Stream unable to read required number of bytes!");
-    n_bytes += size*num_elms;
+    auto const len = size * num_elms;
+    auto out = static_cast<char*>(ptr);
+
+    if (len >= capacity) {
+      auto const held = end - begin;
+      if (held > 0) {
+        std::memcpy(out, buf.get() + begin, held);
+        begin = end = 0;
+      }
+      read(out + held, len - held);
+    } else {
+      if (end - begin < len) {
+        refill(len);
+      }
+      std::memcpy(out, buf.get() + begin, len);
+      begin += len;
+    }
+    n_bytes += len;
   }
 
   SerialSizeType usedBufferSize() {
     return n_bytes;
   }
 
+private:
+  void read(char* out, SerialSizeType len) {
+    if (len == 0) {
+      return;
+    }
+    stream.read(out, len);
+    if (!stream) {
+      throw std::runtime_error(
+        "Stream unable to read required number of bytes!"
+      );
+    }
+  }
+
+  void refill(SerialSizeType len) {
+    auto const held = end - begin;
+    std::memmove(buf.get(), buf.get() + begin, held);
+    begin = 0;
+    end = held;
+
+    // The end of the stream may be reached before the buffer is full
+    stream.read(buf.get() + end, capacity - end);
+    end += static_cast<SerialSizeType>(stream.gcount());
+    if (end < len) {
+      throw std::runtime_error(
+        "Stream unable to read required number of bytes!"
+      );
+    }
+    if (stream.eof()) {
+      stream.clear(stream.rdstate() & ~(std::ios::eofbit | std::ios::failbit));
+    }
+  }
+
+  void unread() {
+    if (end > begin) {
+      auto const off = static_cast<typename StreamT::off_type>(end - begin);
+      stream.seekg(-off, std::ios::cur);
+      begin = end = 0;
+    }
+  }
+
 private:
   StreamT& stream;
+  buffer::OwnedBytesType buf = nullptr;
+  SerialSizeType capacity = 0;
+  SerialSizeType begin = 0; /**< First buffered byte not yet unpacked */
+  SerialSizeType end = 0;   /**< One past the last buffered byte */
   SerialSizeType n_bytes = 0;
 };
 
@@ -47,6 +47,7 @@
 #include "checkpoint/common.h"
 #include "checkpoint/serializers/memory_serializer.h"
 #include "checkpoint/buffer/user_buffer.h"
+#include "checkpoint/buffer/io_buffer.h"
 
 namespace checkpoint {
 
@@ -61,6 +62,15 @@ struct UnpackerBuffer : MemorySerializer {
 
   void contiguousBytes(void* ptr, SerialSizeType size, SerialSizeType num_elms);
   SerialSizeType usedBufferSize() const;
+  SerialByteType* borrowBytes(SerialSizeType const len);
+
+  /**
+   * \brief Take ownership of the underlying buffer, e.g., so views borrowed
+   * from it can outlive the unpacker
+   *
+   * \return the buffer
+   */
+  BufferPtrType extractBuffer();
 
 private:
   // Size of the actually used memory (for error checking)
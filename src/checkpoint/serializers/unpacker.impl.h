@@ -92,6 +92,11 @@ void UnpackerBuffer<BufferT>::contiguousBytes(
   );
 
   SerialSizeType const len = size * num_elms;
+
+  if constexpr (buffer::IsReadCursorBuffer<BufferT>::value) {
+    buffer_->advanceCursor(usedSize_ + len);
+  }
+
   SerialByteType* spot = this->getSpotIncrement(len);
   std::memcpy(ptr, spot, len);
 
@@ -103,6 +108,23 @@ SerialSizeType UnpackerBuffer<BufferT>::usedBufferSize() const {
   return usedSize_;
 }
 
+template <typename BufferT>
+SerialByteType* UnpackerBuffer<BufferT>::borrowBytes(SerialSizeType const len) {
+  usedSize_ += len;
+
+  if constexpr (buffer::IsReadCursorBuffer<BufferT>::value) {
+    buffer_->advanceCursor(usedSize_);
+  }
+
+  return this->getSpotIncrement(len);
+}
+
+template <typename BufferT>
+typename UnpackerBuffer<BufferT>::BufferPtrType
+UnpackerBuffer<BufferT>::extractBuffer() {
+  return std::move(buffer_);
+}
+
 } /* end namespace checkpoint */
 
 #endif /*INCLUDED_SRC_CHECKPOINT_SERIALIZERS_UNPACKER_IMPL_H*/
@@ -0,0 +1,112 @@
+/*
+//@HEADER
+// *****************************************************************************
+//
+//                             sharded_checkpoint.h
+//                 DARMA/magistrate => Serialization Library
+//
+// Copyright 2019 National Technology & Engineering Solutions of Sandia, LLC
+// (NTESS). Under the terms of Contract DE-NA0003525 with NTESS, the U.S.
+// Government retains certain rights in this software.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+//
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// * Neither the name of the copyright holder nor the names of its
+//   contributors may be used to endorse or promote products derived from this
+//   software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// Questions? Contact darma@sandia.gov
+//
+// *****************************************************************************
+//@HEADER
+*/
+
+#if !defined INCLUDED_SRC_CHECKPOINT_SHARDED_CHECKPOINT_H
+#define INCLUDED_SRC_CHECKPOINT_SHARDED_CHECKPOINT_H
+
+#include "checkpoint/common.h"
+#include "checkpoint/checkpoint_api.h"
+#include "checkpoint/buffer/shard_image.h"
+
+#include <memory>
+#include <string>
+
+namespace checkpoint {
+
+/**
+ * \brief Serialize \c T to the directory \c dir as \c num_shards shard files
+ * written concurrently, plus a manifest
+ *
+ * \c target is packed into memory once; the packed bytes are then cut into
+ * consecutive shards that are each written by their own thread with the
+ * \c FileBackend::PWrite path (\c options.backend is ignored). Durability and
+ * checksums in \c options apply to every shard. Read the directory back with
+ * \c deserializeFromDirectory.
+ *
+ * \param[in] target the \c T to serialize
+ * \param[in] dir the directory to write, created if it does not exist
+ * \param[in] num_shards the number of shard files, at least one
+ * \param[in] options durability and checksum options
+ */
+template <typename T>
+void serializeToDirectory(
+  T& target, std::string const& dir, unsigned num_shards,
+  FileWriteOptions const& options = FileWriteOptions{}
+) {
+  auto image = ::checkpoint::serialize<T>(target);
+  buffer::writeShardedImage(
+    reinterpret_cast<SerialByteType const*>(image->getBuffer()),
+    image->getSize(), dir, num_shards, options
+  );
+}
+
+/**
+ * \brief De-serialize and reify \c T from a directory written by
+ * \c serializeToDirectory
+ *
+ * The shards are mapped and copied into one buffer concurrently, then
+ * unpacked. The number of threads is independent of the number of shards the
+ * directory was written with.
+ *
+ * \param[in] dir the directory
+ * \param[in] num_threads the number of shards read at once, or zero for one
+ * thread per shard
+ * \param[in] options how each shard is read
+ *
+ * \return a \c std::unique_ptr to the new \c T
+ */
+template <typename T>
+std::unique_ptr<T> deserializeFromDirectory(
+  std::string const& dir, unsigned num_threads = 0,
+  FileReadOptions const& options = FileReadOptions{}
+) {
+  return deserialize<T>(
+    SerializedReturnType(
+      buffer::readShardedImage(dir, num_threads, options).release()
+    )
+  );
+}
+
+} /* end namespace checkpoint */
+
+#endif /*INCLUDED_SRC_CHECKPOINT_SHARDED_CHECKPOINT_H*/
@@ -303,4 +303,52 @@ INSTANTIATE_TYPED_TEST_CASE_P(TestMultiDouble_int64_t, TestMultiContainerUnorder
 INSTANTIATE_TYPED_TEST_CASE_P(TestMultiDouble_int16_t, TestMultiContainerUnordered, ContainerMultiTypesUnorderedDouble<int16_t>, );
 INSTANTIATE_TYPED_TEST_CASE_P(TestMultiDouble_float, TestMultiContainerUnordered, ContainerMultiTypesUnorderedDouble<float>, );
 
+struct TestContainerAdaptor : TestHarness { };
+
+TEST_F(TestContainerAdaptor, test_priority_queue) {
+  std::priority_queue<int, std::vector<int>, std::greater<int>> c1;
+  for (int i : {5, 1, 4, 2, 3, 2}) {
+    c1.push(i);
+  }
+
+  auto ret = checkpoint::serialize(c1);
+  auto t1 = checkpoint::deserialize<decltype(c1)>(ret->getBuffer());
+
+  ASSERT_EQ(c1.size(), t1->size());
+  while (not c1.empty()) {
+    EXPECT_EQ(c1.top(), t1->top());
+    c1.pop();
+    t1->pop();
+  }
+}
+
+TEST_F(TestContainerAdaptor, test_stack) {
+  std::stack<int, std::vector<int>> c1;
+  for (int i = 0; i < 10; i++) {
+    c1.push(i * 3);
+  }
+
+  auto ret = checkpoint::serialize(c1);
+  auto t1 = checkpoint::deserialize<decltype(c1)>(ret->getBuffer());
+
+  // The elements come back in the same order, top first
+  ASSERT_EQ(c1.size(), t1->size());
+  while (not c1.empty()) {
+    EXPECT_EQ(c1.top(), t1->top());
+    c1.pop();
+    t1->pop();
+  }
+}
+
+TEST_F(TestContainerAdaptor, test_queue_custom_container) {
+  std::queue<int, std::list<int>> c1;
+  for (int i = 0; i < 10; i++) {
+    c1.push(i + 7);
+  }
+
+  auto ret = checkpoint::serialize(c1);
+  auto t1 = checkpoint::deserialize<decltype(c1)>(ret->getBuffer());
+  EXPECT_EQ(c1, *t1);
+}
+
 }}} // end namespace checkpoint::tests::unit
@@ -0,0 +1,343 @@
+/*
+//@HEADER
+// *****************************************************************************
+//
+//                           test_delta_checkpoint.cc
+//                 DARMA/magistrate => Serialization Library
+//
+// Copyright 2019 National Technology & Engineering Solutions of Sandia, LLC
+// (NTESS). Under the terms of Contract DE-NA0003525 with NTESS, the U.S.
+// Government retains certain rights in this software.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+//
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// * Neither the name of the copyright holder nor the names of its
+//   contributors may be used to endorse or promote products derived from this
+//   software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// Questions? Contact darma@sandia.gov
+//
+// *****************************************************************************
+//@HEADER
+*/
+
+#include <gtest/gtest.h>
+
+#include "test_harness.h"
+
+#include <checkpoint/checkpoint.h>
+#include <checkpoint/buffer/delta_image.h>
+
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <random>
+#include <string>
+#include <vector>
+
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace checkpoint { namespace tests { namespace unit {
+
+using TestDeltaCheckpoint = TestHarness;
+
+struct UserObjectDelta {
+  UserObjectDelta() = default;
+  explicit UserObjectDelta(int n) {
+    for (int i = 0; i < n; i++) {
+      values.push_back(i * 7 + 3);
+    }
+  }
+
+  template <typename SerializerT>
+  void serialize(SerializerT& s) {
+    s | name | values;
+  }
+
+  void check(UserObjectDelta const& o) const {
+    EXPECT_EQ(name, o.name);
+    EXPECT_EQ(values, o.values);
+  }
+
+  std::string name = "delta";
+  std::vector<int64_t> values;
+};
+
+static std::size_t fileSize(std::string const& file) {
+  std::ifstream f(file, std::ios::binary | std::ios::ate);
+  return static_cast<std::size_t>(f.tellg());
+}
+
+TEST_F(TestDeltaCheckpoint, test_block_hash) {
+  // Reference values of XXH64 with seed zero
+  EXPECT_EQ(buffer::hashBlock(nullptr, 0), 0xef46db3751d8e999ull);
+  EXPECT_EQ(buffer::hashBlock("abc", 3), 0x44bc2cf5ad770999ull);
+
+  std::mt19937 gen(11);
+  std::vector<char> data(1000);
+  for (auto& c : data) {
+    c = static_cast<char>(gen());
+  }
+
+  // Every length exercises a different mix of the lane and tail paths
+  for (std::size_t len = 1; len < 80; len++) {
+    auto const h = buffer::hashBlock(data.data(), len);
+    EXPECT_EQ(buffer::hashBlock(data.data(), len), h);
+    EXPECT_NE(buffer::hashBlock(data.data(), len - 1), h);
+    data[len - 1] ^= 1;
+    EXPECT_NE(buffer::hashBlock(data.data(), len), h);
+    data[len - 1] ^= 1;
+  }
+
+  auto const serial = buffer::hashBlocks(
+    reinterpret_cast<SerialByteType const*>(data.data()), data.size(), 64
+  );
+  auto const threaded = buffer::hashBlocks(
+    reinterpret_cast<SerialByteType const*>(data.data()), data.size(), 64, 3
+  );
+  ASSERT_EQ(serial.size(), 16u);
+  EXPECT_EQ(serial, threaded);
+  EXPECT_EQ(serial[15], buffer::hashBlock(data.data() + 960, 40));
+}
+
+TEST_F(TestDeltaCheckpoint, test_delta_writes_changed_blocks) {
+  std::string const base = "test_delta_base.out";
+  std::string const delta = "test_delta_1.out";
+
+  DeltaOptions options;
+  options.block_size = 4096;
+
+  UserObjectDelta obj(100000);
+  DeltaCheckpointer cp(options);
+
+  auto const s0 = cp.checkpoint(obj, base);
+  EXPECT_TRUE(s0.full);
+  EXPECT_EQ(s0.image_size, checkpoint::getSize(obj));
+  EXPECT_EQ(fileSize(base), s0.image_size + sizeof(buffer::DeltaHeader));
+  EXPECT_EQ(fileSize(base), s0.bytes_written);
+
+  auto out0 = checkpoint::deserializeFromDeltaFile<UserObjectDelta>(base);
+  obj.check(*out0);
+
+  obj.values[50000] = -1;
+  auto const s1 = cp.checkpoint(obj, delta);
+  EXPECT_FALSE(s1.full);
+  EXPECT_EQ(s1.changed_blocks, 1u);
+  EXPECT_EQ(s1.bytes_written, fileSize(delta));
+  EXPECT_LT(s1.bytes_written, 2 * options.block_size);
+  EXPECT_EQ(cp.getLastFile(), delta);
+
+  auto out1 = checkpoint::deserializeFromDeltaFile<UserObjectDelta>(delta);
+  obj.check(*out1);
+
+  // An unchanged object stores no blocks at all
+  auto const s2 = cp.checkpoint(obj, "test_delta_2.out");
+  EXPECT_EQ(s2.changed_blocks, 0u);
+  auto out2 = checkpoint::deserializeFromDeltaFile<UserObjectDelta>(
+    "test_delta_2.out"
+  );
+  obj.check(*out2);
+
+  std::remove(base.c_str());
+  std::remove(delta.c_str());
+  std::remove("test_delta_2.out");
+}
+
+TEST_F(TestDeltaCheckpoint, test_delta_chain_and_resize) {
+  DeltaOptions options;
+  options.block_size = 1000;
+  options.max_chain = 3;
+  options.num_threads = 2;
+
+  UserObjectDelta obj(20000);
+  DeltaCheckpointer cp(options);
+  std::vector<std::string> files;
+
+  for (int i = 0; i < 6; i++) {
+    auto const file = "test_delta_chain_" + std::to_string(i) + ".out";
+    files.push_back(file);
+
+    // Grow, shrink and rename so image sizes and block alignment change
+    obj.values[i * 1000] += i;
+    if (i == 2) {
+      obj.values.resize(25000, 9);
+    } else if (i == 3) {
+      obj.values.resize(15000);
+    } else if (i == 4) {
+      obj.name = "a much longer name that shifts every block";
+    }
+
+    auto const stats = cp.checkpoint(obj, file);
+    EXPECT_EQ(stats.full, i % 4 == 0) << i;
+
+    auto out = checkpoint::deserializeFromDeltaFile<UserObjectDelta>(file);
+    obj.check(*out);
+  }
+
+  for (auto const& f : files) {
+    std::remove(f.c_str());
+  }
+}
+
+TEST_F(TestDeltaCheckpoint, test_delta_rotating_names) {
+  std::string const a = "test_delta_rotate_a.out";
+  std::string const b = "test_delta_rotate_b.out";
+
+  UserObjectDelta obj(10000);
+  DeltaCheckpointer cp;
+
+  for (int i = 0; i < 6; i++) {
+    obj.values[i * 100] = -i;
+    auto const& file = i % 2 == 0 ? a : b;
+    auto const stats = cp.checkpoint(obj, file);
+
+    // Writing A again would make it a base of itself through B
+    EXPECT_EQ(stats.full, i % 2 == 0) << i;
+
+    auto out = checkpoint::deserializeFromDeltaFile<UserObjectDelta>(file);
+    obj.check(*out);
+  }
+
+  std::remove(a.c_str());
+  std::remove(b.c_str());
+}
+
+TEST_F(TestDeltaCheckpoint, test_delta_base_relative_to_directory) {
+  std::string const dir = "test_delta_dir";
+  mkdir(dir.c_str(), 0700);
+
+  UserObjectDelta obj(3000);
+  DeltaCheckpointer cp;
+  cp.checkpoint(obj, dir + "/full.out");
+  obj.values[1] = 42;
+  cp.checkpoint(obj, dir + "/delta.out");
+
+  // The base is found next to the delta, not relative to the working directory
+  char cwd[4096];
+  ASSERT_NE(getcwd(cwd, sizeof(cwd)), nullptr);
+  ASSERT_EQ(chdir(dir.c_str()), 0);
+  auto out = checkpoint::deserializeFromDeltaFile<UserObjectDelta>(
+    "delta.out"
+  );
+  ASSERT_EQ(chdir(cwd), 0);
+  obj.check(*out);
+
+  auto out2 = checkpoint::deserializeFromDeltaFile<UserObjectDelta>(
+    dir + "/delta.out"
+  );
+  obj.check(*out2);
+
+  std::remove((dir + "/full.out").c_str());
+  std::remove((dir + "/delta.out").c_str());
+  rmdir(dir.c_str());
+}
+
+TEST_F(TestDeltaCheckpoint, test_delta_with_checksum) {
+  DeltaOptions options;
+  options.block_size = 512;
+  options.file.checksum.enabled = true;
+  options.file.checksum.chunk_size = 1024;
+
+  UserObjectDelta obj(5000);
+  DeltaCheckpointer cp(options);
+  cp.checkpoint(obj, "test_delta_crc_0.out");
+  obj.values[10] = 0;
+  cp.checkpoint(obj, "test_delta_crc_1.out");
+
+  FileReadOptions read_options;
+  read_options.checksum = ChecksumVerify::Require;
+  auto out = checkpoint::deserializeFromDeltaFile<UserObjectDelta>(
+    "test_delta_crc_1.out", read_options
+  );
+  obj.check(*out);
+
+  std::remove("test_delta_crc_0.out");
+  std::remove("test_delta_crc_1.out");
+}
+
+TEST_F(TestDeltaCheckpoint, test_delta_missing_base_throws) {
+  UserObjectDelta obj(1000);
+  DeltaCheckpointer cp;
+  cp.checkpoint(obj, "test_delta_gone_0.out");
+  obj.values[0] = 5;
+  cp.checkpoint(obj, "test_delta_gone_1.out");
+
+  std::remove("test_delta_gone_0.out");
+  EXPECT_THROW(
+    checkpoint::deserializeFromDeltaFile<UserObjectDelta>(
+      "test_delta_gone_1.out"
+    ),
+    std::runtime_error
+  );
+
+  // After a reset the chain starts over with a full image
+  cp.reset();
+  EXPECT_TRUE(cp.checkpoint(obj, "test_delta_gone_2.out").full);
+  auto out = checkpoint::deserializeFromDeltaFile<UserObjectDelta>(
+    "test_delta_gone_2.out"
+  );
+  obj.check(*out);
+
+  std::remove("test_delta_gone_1.out");
+  std::remove("test_delta_gone_2.out");
+}
+
+TEST_F(TestDeltaCheckpoint, test_full_image_starting_with_delta_magic) {
+  std::string const full = "test_delta_magic_0.out";
+  std::string const delta = "test_delta_magic_1.out";
+
+  // The image starts with a delta header, but the file is tagged as full
+  std::vector<SerialByteType> image(10000, 7);
+  buffer::DeltaHeader h;
+  std::memcpy(image.data(), &h, sizeof(h));
+
+  DeltaOptions options;
+  options.block_size = 1024;
+  buffer::DeltaImageWriter writer(options);
+  EXPECT_TRUE(writer.write(image.data(), image.size(), full).full);
+
+  auto out0 = buffer::readDeltaImage(full);
+  ASSERT_EQ(out0->getSize(), image.size());
+  EXPECT_EQ(std::memcmp(out0->getBuffer(), image.data(), image.size()), 0);
+
+  image[5000] = 1;
+  EXPECT_FALSE(writer.write(image.data(), image.size(), delta).full);
+
+  auto out1 = buffer::readDeltaImage(delta);
+  ASSERT_EQ(out1->getSize(), image.size());
+  EXPECT_EQ(std::memcmp(out1->getBuffer(), image.data(), image.size()), 0);
+
+  // A file not written by a DeltaImageWriter has no header and is rejected
+  UserObjectDelta plain(1000);
+  checkpoint::serializeToFile(plain, full);
+  EXPECT_THROW(
+    checkpoint::deserializeFromDeltaFile<UserObjectDelta>(full),
+    std::runtime_error
+  );
+
+  std::remove(full.c_str());
+  std::remove(delta.c_str());
+}
+
+}}} // end namespace checkpoint::tests::unit
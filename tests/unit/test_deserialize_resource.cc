@@ -0,0 +1,191 @@
+/*
+//@HEADER
+// *****************************************************************************
+//
+//                         test_deserialize_resource.cc
+//                 DARMA/magistrate => Serialization Library
+//
+// Copyright 2019 National Technology & Engineering Solutions of Sandia, LLC
+// (NTESS). Under the terms of Contract DE-NA0003525 with NTESS, the U.S.
+// Government retains certain rights in this software.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+//
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// * Neither the name of the copyright holder nor the names of its
+//   contributors may be used to endorse or promote products derived from this
+//   software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// Questions? Contact darma@sandia.gov
+//
+// *****************************************************************************
+//@HEADER
+*/
+
+#include "test_harness.h"
+
+#include <checkpoint/checkpoint.h>
+
+#include <gtest/gtest.h>
+
+#include <memory>
+#include <memory_resource>
+#include <vector>
+
+namespace checkpoint { namespace tests { namespace unit {
+
+struct TestDeserializeResource : TestHarness { };
+
+struct ResShape : SerializableBase<ResShape> {
+  template <typename SerializerT>
+  void serialize(SerializerT& s) {
+    s | id;
+  }
+
+  int id = 0;
+};
+
+struct ResCircle : SerializableDerived<ResCircle, ResShape> {
+  template <typename SerializerT>
+  void serialize(SerializerT& s) {
+    s | r;
+  }
+
+  double r = 0;
+};
+
+struct ResLeaf {
+  template <typename SerializerT>
+  void serialize(SerializerT& s) {
+    s | x | values;
+  }
+
+  int x = 0;
+  std::pmr::vector<double> values;
+};
+
+struct ResRoot {
+  template <typename SerializerT>
+  void serialize(SerializerT& s) {
+    s | leaf | nested | shapes;
+    checkpoint::serializeTypeGrouped(s, grouped);
+  }
+
+  std::unique_ptr<ResLeaf> leaf;
+  std::pmr::vector<std::pmr::vector<int>> nested;
+  std::pmr::vector<std::unique_ptr<ResShape>> shapes;
+  std::pmr::vector<std::unique_ptr<ResShape>> grouped;
+};
+
+static ResRoot makeRoot() {
+  ResRoot root;
+  root.leaf = std::make_unique<ResLeaf>();
+  root.leaf->x = 7;
+  root.leaf->values = {1.5, 2.5, 3.5};
+  root.nested = {{1, 2}, {3, 4, 5}};
+  for (int i = 0; i < 4; i++) {
+    std::unique_ptr<ResShape> shape;
+    if (i % 2 == 0) {
+      shape = std::make_unique<ResShape>();
+    } else {
+      auto circle = std::make_unique<ResCircle>();
+      circle->r = i * 0.5;
+      shape = std::move(circle);
+    }
+    shape->id = i;
+    root.shapes.push_back(std::move(shape));
+    root.grouped.push_back(std::make_unique<ResCircle>());
+    root.grouped.back()->id = 10 + i;
+  }
+  return root;
+}
+
+static void checkRoot(ResRoot const& out, ResRoot const& in) {
+  ASSERT_NE(out.leaf, nullptr);
+  EXPECT_EQ(out.leaf->x, in.leaf->x);
+  EXPECT_EQ(out.leaf->values, in.leaf->values);
+  EXPECT_EQ(out.nested, in.nested);
+  ASSERT_EQ(out.shapes.size(), in.shapes.size());
+  for (std::size_t i = 0; i < in.shapes.size(); i++) {
+    EXPECT_EQ(typeid(*out.shapes[i]), typeid(*in.shapes[i]));
+    EXPECT_EQ(out.shapes[i]->id, in.shapes[i]->id);
+    if (auto c = dynamic_cast<ResCircle const*>(in.shapes[i].get())) {
+      EXPECT_EQ(static_cast<ResCircle const*>(out.shapes[i].get())->r, c->r);
+    }
+  }
+  ASSERT_EQ(out.grouped.size(), in.grouped.size());
+  for (std::size_t i = 0; i < in.grouped.size(); i++) {
+    EXPECT_EQ(out.grouped[i]->id, in.grouped[i]->id);
+  }
+}
+
+TEST_F(TestDeserializeResource, test_deserialize_to_resource) {
+  auto in = makeRoot();
+  auto ret = checkpoint::serialize(in);
+
+  // Running out of the buffer throws instead of falling back to the heap
+  std::vector<char> arena(1 << 16);
+  std::pmr::monotonic_buffer_resource resource(
+    arena.data(), arena.size(), std::pmr::null_memory_resource()
+  );
+  auto inArena = [&](void const* p) {
+    auto const c = static_cast<char const*>(p);
+    return c >= arena.data() and c < arena.data() + arena.size();
+  };
+
+  auto out = checkpoint::deserializeToResource<ResRoot>(
+    ret->getBuffer(), &resource
+  );
+  checkRoot(*out, in);
+
+  EXPECT_TRUE(inArena(out));
+  EXPECT_TRUE(inArena(out->leaf.get()));
+  EXPECT_TRUE(inArena(out->leaf->values.data()));
+  EXPECT_TRUE(inArena(out->nested.data()));
+  for (auto const& v : out->nested) {
+    EXPECT_TRUE(inArena(v.data()));
+  }
+  EXPECT_TRUE(inArena(out->shapes.data()));
+  for (auto const& shape : out->shapes) {
+    EXPECT_TRUE(inArena(shape.get()));
+  }
+  for (auto const& shape : out->grouped) {
+    EXPECT_TRUE(inArena(shape.get()));
+  }
+
+  // Tear down by releasing the arena, without destroying the objects
+  resource.release();
+}
+
+TEST_F(TestDeserializeResource, test_deserialize_without_resource) {
+  // Without a resource the pmr vectors keep the default resource
+  auto in = makeRoot();
+  auto ret = checkpoint::serialize(in);
+  auto out = checkpoint::deserialize<ResRoot>(ret->getBuffer());
+  checkRoot(*out, in);
+  EXPECT_EQ(
+    out->leaf->values.get_allocator().resource(),
+    std::pmr::get_default_resource()
+  );
+}
+
+}}} // end namespace checkpoint::tests::unit
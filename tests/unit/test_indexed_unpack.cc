@@ -0,0 +1,249 @@
+/*
+//@HEADER
+// *****************************************************************************
+//
+//                            test_indexed_unpack.cc
+//                 DARMA/magistrate => Serialization Library
+//
+// Copyright 2019 National Technology & Engineering Solutions of Sandia, LLC
+// (NTESS). Under the terms of Contract DE-NA0003525 with NTESS, the U.S.
+// Government retains certain rights in this software.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+//
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// * Neither the name of the copyright holder nor the names of its
+//   contributors may be used to endorse or promote products derived from this
+//   software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// Questions? Contact darma@sandia.gov
+//
+// *****************************************************************************
+//@HEADER
+*/
+
+#include <gtest/gtest.h>
+
+#include "test_harness.h"
+
+#include <checkpoint/checkpoint.h>
+
+#include <cstdio>
+#include <cstring>
+#include <deque>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace checkpoint { namespace tests { namespace unit {
+
+using TestIndexedUnpack = TestHarness;
+
+struct Cell {
+  Cell() = default;
+  explicit Cell(int i)
+    : id(i), label("cell-" + std::to_string(i % 97)), neighbors(i % 6, i)
+  { }
+
+  template <typename SerializerT>
+  void serialize(SerializerT& s) {
+    s | id | label | neighbors;
+  }
+
+  bool operator==(Cell const& o) const {
+    return id == o.id and label == o.label and neighbors == o.neighbors;
+  }
+
+  int id = 0;
+  std::string label;
+  std::vector<int> neighbors;
+};
+
+struct Mesh {
+  template <typename SerializerT>
+  void serialize(SerializerT& s) {
+    s | name | cells | ghosts | patches | tags;
+  }
+
+  void check(Mesh const& o) const {
+    EXPECT_EQ(name, o.name);
+    EXPECT_EQ(cells, o.cells);
+    EXPECT_EQ(ghosts, o.ghosts);
+    EXPECT_EQ(patches, o.patches);
+    EXPECT_EQ(tags, o.tags);
+  }
+
+  std::string name = "mesh";
+  std::vector<Cell> cells;
+  std::deque<Cell> ghosts;
+  std::vector<std::vector<Cell>> patches;
+  std::vector<std::string> tags;
+};
+
+static Mesh makeMesh(int n) {
+  Mesh m;
+  for (int i = 0; i < n; i++) {
+    m.cells.emplace_back(i);
+    m.tags.push_back(std::to_string(i));
+    if (i % 3 == 0) {
+      m.ghosts.emplace_back(i + n);
+    }
+  }
+  for (int i = 0; i < 40; i++) {
+    m.patches.emplace_back(std::vector<Cell>(i * 5, Cell(i)));
+  }
+  return m;
+}
+
+TEST_F(TestIndexedUnpack, test_indexed_round_trip) {
+  auto in = makeMesh(30000);
+
+  for (unsigned pack_threads : {1u, 4u}) {
+    ParallelPackOptions options;
+    options.num_threads = pack_threads;
+    options.min_elements = 100;
+    options.indexed = true;
+
+    auto ret = checkpoint::serialize(in, options);
+    EXPECT_GT(ret->getSize(), checkpoint::getSize(in));
+
+    for (unsigned unpack_threads : {1u, 3u, 8u}) {
+      auto out = checkpoint::deserializeIndexed<Mesh>(
+        ret->getBuffer(), unpack_threads
+      );
+      in.check(*out);
+    }
+  }
+}
+
+TEST_F(TestIndexedUnpack, test_unindexed_deque_identical_bytes) {
+  auto in = makeMesh(5000);
+
+  ParallelPackOptions options;
+  options.num_threads = 4;
+  options.min_elements = 64;
+
+  auto serial = checkpoint::serialize(in);
+  auto parallel = checkpoint::serialize(in, options);
+  ASSERT_EQ(serial->getSize(), parallel->getSize());
+  EXPECT_EQ(
+    std::memcmp(serial->getBuffer(), parallel->getBuffer(), serial->getSize()),
+    0
+  );
+}
+
+TEST_F(TestIndexedUnpack, test_indexed_chunk_sizes) {
+  std::vector<Cell> in;
+  for (int i = 0; i < 1000; i++) {
+    in.emplace_back(i);
+  }
+
+  ParallelPackOptions options;
+  options.min_elements = 10;
+  options.chunk_elements = 64;
+  options.indexed = true;
+
+  // One marker byte, the chunk count and length, and a size per chunk
+  auto const chunks = (in.size() + 63) / 64;
+  auto ret = checkpoint::serialize(in, options);
+  EXPECT_EQ(
+    ret->getSize(), checkpoint::getSize(in) + 1 + 8 * (2 + chunks)
+  );
+
+  auto out = checkpoint::deserializeIndexed<std::vector<Cell>>(
+    std::move(ret), 4
+  );
+  EXPECT_EQ(*out, in);
+}
+
+TEST_F(TestIndexedUnpack, test_indexed_corrupt_index) {
+  std::vector<Cell> in(500, Cell(3));
+
+  ParallelPackOptions options;
+  options.min_elements = 10;
+  options.chunk_elements = 50;
+  options.indexed = true;
+  auto ret = checkpoint::serialize(in, options);
+
+  // Find the index: a marker followed by 10 chunks of 50 elements
+  std::vector<char> bytes(ret->getBuffer(), ret->getBuffer() + ret->getSize());
+  std::size_t marker = 0;
+  for (std::size_t i = 0; i < bytes.size(); i++) {
+    if (bytes[i] == 1) {
+      uint64_t header[2];
+      std::memcpy(header, bytes.data() + i + 1, sizeof(header));
+      if (header[0] == 10 and header[1] == 50) {
+        marker = i;
+        break;
+      }
+    }
+  }
+  ASSERT_NE(marker, 0u);
+
+  // Shrink the first chunk so it no longer lines up with its elements
+  auto corrupt = bytes;
+  uint64_t first = 0;
+  std::memcpy(&first, corrupt.data() + marker + 17, sizeof(first));
+  first -= 1;
+  std::memcpy(corrupt.data() + marker + 17, &first, sizeof(first));
+  EXPECT_THROW(
+    checkpoint::deserializeIndexed<std::vector<Cell>>(corrupt.data(), 2),
+    std::runtime_error
+  );
+
+  // A chunk count that does not match the number of elements
+  corrupt = bytes;
+  corrupt[marker + 1] = 11;
+  EXPECT_THROW(
+    checkpoint::deserializeIndexed<std::vector<Cell>>(corrupt.data(), 2),
+    std::runtime_error
+  );
+}
+
+TEST_F(TestIndexedUnpack, test_indexed_file) {
+  auto in = makeMesh(20000);
+  std::string const file = "test_indexed_file.out";
+
+  ParallelPackOptions parallel;
+  parallel.num_threads = 2;
+  parallel.min_elements = 100;
+  parallel.indexed = true;
+
+  for (auto backend : {FileBackend::MMap, FileBackend::PWrite}) {
+    FileWriteOptions options;
+    options.backend = backend;
+    options.durability = FileDurability::None;
+    options.checksum.enabled = true;
+    checkpoint::serializeToFile(in, file, parallel, options);
+
+    FileReadOptions read_options;
+    read_options.checksum = ChecksumVerify::Require;
+    auto out = checkpoint::deserializeIndexedFromFile<Mesh>(
+      file, 4, read_options
+    );
+    in.check(*out);
+  }
+  std::remove(file.c_str());
+}
+
+}}} // end namespace checkpoint::tests::unit
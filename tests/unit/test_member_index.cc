@@ -0,0 +1,256 @@
+/*
+//@HEADER
+// *****************************************************************************
+//
+//                             test_member_index.cc
+//                 DARMA/magistrate => Serialization Library
+//
+// Copyright 2019 National Technology & Engineering Solutions of Sandia, LLC
+// (NTESS). Under the terms of Contract DE-NA0003525 with NTESS, the U.S.
+// Government retains certain rights in this software.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+//
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// * Neither the name of the copyright holder nor the names of its
+//   contributors may be used to endorse or promote products derived from this
+//   software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// Questions? Contact darma@sandia.gov
+//
+// *****************************************************************************
+//@HEADER
+*/
+
+#include <gtest/gtest.h>
+
+#include "test_harness.h"
+
+#include <checkpoint/checkpoint.h>
+
+#include <cstdio>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace checkpoint { namespace tests { namespace unit {
+
+using TestMemberIndex = TestHarness;
+
+struct GridIndexed {
+  template <typename SerializerT>
+  void serialize(SerializerT& s) {
+    s | label | values;
+  }
+
+  std::string label;
+  std::vector<double> values;
+};
+
+struct CellIndexed {
+  template <typename SerializerT>
+  void serialize(SerializerT& s) {
+    s | id | neighbors;
+  }
+
+  int id = 0;
+  std::vector<int> neighbors;
+};
+
+struct SimulationIndexed {
+  SimulationIndexed() = default;
+  explicit SimulationIndexed(int n) : step(n) {
+    grid.label = "grid-" + std::to_string(n);
+    for (int i = 0; i < n * 10; i++) {
+      grid.values.push_back(i * 0.25);
+    }
+    for (int i = 0; i < n; i++) {
+      CellIndexed c;
+      c.id = i;
+      c.neighbors.assign(i % 7, i);
+      cells.push_back(c);
+    }
+  }
+
+  template <typename SerializerT>
+  void serialize(SerializerT& s) {
+    s | step;
+    checkpoint::indexMember(s, "grid", grid);
+    checkpoint::indexElements(s, "cells", cells);
+    checkpoint::indexMember(s, "tail", tail);
+  }
+
+  void check(SimulationIndexed const& o) const {
+    EXPECT_EQ(step, o.step);
+    EXPECT_EQ(grid.label, o.grid.label);
+    EXPECT_EQ(grid.values, o.grid.values);
+    ASSERT_EQ(cells.size(), o.cells.size());
+    for (std::size_t i = 0; i < cells.size(); i++) {
+      EXPECT_EQ(cells[i].id, o.cells[i].id);
+      EXPECT_EQ(cells[i].neighbors, o.cells[i].neighbors);
+    }
+    EXPECT_EQ(tail, o.tail);
+  }
+
+  int step = 0;
+  GridIndexed grid;
+  std::vector<CellIndexed> cells;
+  std::string tail = "end";
+};
+
+TEST_F(TestMemberIndex, test_member_index_whole_object) {
+  std::string const file = "test_member_index_whole.out";
+  SimulationIndexed in(100);
+
+  // Indexing does not change the bytes of the object
+  checkpoint::serializeToFile(in, file);
+  auto out = checkpoint::deserializeFromFile<SimulationIndexed>(file);
+  in.check(*out);
+
+  checkpoint::serializeToIndexedFile(in, file);
+  out = checkpoint::deserializeFromFile<SimulationIndexed>(file);
+  in.check(*out);
+
+  std::remove(file.c_str());
+}
+
+TEST_F(TestMemberIndex, test_member_index_read_members) {
+  std::string const file = "test_member_index_members.out";
+  SimulationIndexed in(200);
+
+  for (auto backend : {FileBackend::MMap, FileBackend::PWrite}) {
+    FileWriteOptions options;
+    options.backend = backend;
+    options.durability = FileDurability::None;
+    checkpoint::serializeToIndexedFile(in, file, options);
+
+    auto grid = checkpoint::deserializeMemberFromFile<GridIndexed>(
+      file, "grid"
+    );
+    EXPECT_EQ(grid->label, in.grid.label);
+    EXPECT_EQ(grid->values, in.grid.values);
+
+    for (int i : {0, 17, 199}) {
+      auto cell = checkpoint::deserializeElementFromFile<CellIndexed>(
+        file, "cells", i
+      );
+      EXPECT_EQ(cell->id, in.cells[i].id);
+      EXPECT_EQ(cell->neighbors, in.cells[i].neighbors);
+    }
+
+    auto tail = checkpoint::deserializeMemberFromFile<std::string>(
+      file, "tail"
+    );
+    EXPECT_EQ(*tail, in.tail);
+  }
+
+  std::remove(file.c_str());
+}
+
+TEST_F(TestMemberIndex, test_member_index_reader) {
+  std::string const file = "test_member_index_reader.out";
+  SimulationIndexed in(50);
+  checkpoint::serializeToIndexedFile(in, file);
+
+  MemberTableReader reader(file);
+  auto const& table = reader.getTable();
+  EXPECT_EQ(
+    table.getNames(), (std::vector<std::string>{"grid", "cells", "tail"})
+  );
+  EXPECT_EQ(table.getEntries().size(), 52u);
+  EXPECT_EQ(reader.getImageSize(), checkpoint::getSize(in));
+
+  for (int i = 49; i >= 0; i--) {
+    auto cell = checkpoint::deserializeMember<CellIndexed>(reader, "cells", i);
+    EXPECT_EQ(cell->id, i);
+  }
+
+  EXPECT_THROW(reader.lookup("cells", 50), std::runtime_error);
+  EXPECT_THROW(reader.lookup("missing", 0), std::runtime_error);
+
+  // Unpacking a member as the wrong type is detected
+  EXPECT_THROW(
+    checkpoint::deserializeMember<int>(reader, "grid"), std::runtime_error
+  );
+
+  std::remove(file.c_str());
+}
+
+TEST_F(TestMemberIndex, test_member_index_not_indexed) {
+  std::string const file = "test_member_index_plain.out";
+  SimulationIndexed in(10);
+  checkpoint::serializeToFile(in, file);
+
+  EXPECT_THROW(
+    checkpoint::deserializeMemberFromFile<GridIndexed>(file, "grid"),
+    std::runtime_error
+  );
+
+  std::remove(file.c_str());
+}
+
+TEST_F(TestMemberIndex, test_member_index_checksum) {
+  std::string const file = "test_member_index_checksum.out";
+  SimulationIndexed in(2000);
+
+  FileWriteOptions options;
+  options.durability = FileDurability::None;
+  options.checksum.enabled = true;
+  options.checksum.chunk_size = 1024;
+  checkpoint::serializeToIndexedFile(in, file, options);
+
+  FileReadOptions read_options;
+  read_options.checksum = ChecksumVerify::Require;
+
+  std::size_t offset = 0;
+  {
+    MemberTableReader reader(file, read_options);
+    offset = reader.lookup("cells", 1500).offset;
+  }
+
+  {
+    std::fstream f(file, std::ios::in | std::ios::out | std::ios::binary);
+    f.seekg(offset);
+    char c = 0;
+    f.read(&c, 1);
+    f.seekp(offset);
+    f.put(static_cast<char>(c ^ 0x5a));
+  }
+
+  // Only the chunks that are read are verified
+  auto grid = checkpoint::deserializeMemberFromFile<GridIndexed>(
+    file, "grid", read_options
+  );
+  EXPECT_EQ(grid->values, in.grid.values);
+
+  EXPECT_THROW(
+    checkpoint::deserializeElementFromFile<CellIndexed>(
+      file, "cells", 1500, read_options
+    ),
+    buffer::checksum_error
+  );
+
+  std::remove(file.c_str());
+}
+
+}}} // end namespace checkpoint::tests::unit
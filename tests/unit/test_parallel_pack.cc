@@ -0,0 +1,340 @@
+/*
+//@HEADER
+// *****************************************************************************
+//
+//                            test_parallel_pack.cc
+//                 DARMA/magistrate => Serialization Library
+//
+// Copyright 2019 National Technology & Engineering Solutions of Sandia, LLC
+// (NTESS). Under the terms of Contract DE-NA0003525 with NTESS, the U.S.
+// Government retains certain rights in this software.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+//
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// * Neither the name of the copyright holder nor the names of its
+//   contributors may be used to endorse or promote products derived from this
+//   software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// Questions? Contact darma@sandia.gov
+//
+// *****************************************************************************
+//@HEADER
+*/
+
+#include <gtest/gtest.h>
+
+#include "test_harness.h"
+
+#include <checkpoint/checkpoint.h>
+#include <checkpoint/buffer/parallel_for.h>
+
+#include <atomic>
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace checkpoint { namespace tests { namespace unit {
+
+using TestParallelPack = TestHarness;
+
+struct Record {
+  Record() = default;
+  explicit Record(int i)
+    : id(i), name("record-" + std::to_string(i)), samples(i % 13, i * 0.5)
+  { }
+
+  template <typename SerializerT>
+  void serialize(SerializerT& s) {
+    s | id | name | samples;
+  }
+
+  bool operator==(Record const& o) const {
+    return id == o.id and name == o.name and samples == o.samples;
+  }
+
+  int id = 0;
+  std::string name;
+  std::vector<double> samples;
+};
+
+struct Records {
+  template <typename SerializerT>
+  void serialize(SerializerT& s) {
+    s | header | records | names | nested;
+  }
+
+  std::string header = "records";
+  std::vector<Record> records;
+  std::vector<std::string> names;
+  std::vector<std::vector<Record>> nested;
+};
+
+static Records makeRecords(int n) {
+  Records r;
+  for (int i = 0; i < n; i++) {
+    r.records.emplace_back(i);
+    r.names.push_back(std::string(i % 29, 'x'));
+  }
+  for (int i = 0; i < 50; i++) {
+    r.nested.emplace_back(std::vector<Record>(i * 3, Record(i)));
+  }
+  return r;
+}
+
+static void expectSameBytes(
+  SerializedReturnType const& a, SerializedReturnType const& b
+) {
+  ASSERT_EQ(a->getSize(), b->getSize());
+  EXPECT_EQ(std::memcmp(a->getBuffer(), b->getBuffer(), a->getSize()), 0);
+}
+
+TEST_F(TestParallelPack, test_parallel_pack_identical_bytes) {
+  auto in = makeRecords(20000);
+  auto serial = checkpoint::serialize(in);
+
+  for (SerialSizeType chunk : {SerialSizeType{0}, SerialSizeType{7}}) {
+    ParallelPackOptions options;
+    options.num_threads = 4;
+    options.min_elements = 64;
+    options.chunk_elements = chunk;
+
+    auto parallel = checkpoint::serialize(in, options);
+    expectSameBytes(serial, parallel);
+
+    auto out = checkpoint::deserialize<Records>(std::move(parallel));
+    EXPECT_EQ(out->records, in.records);
+    EXPECT_EQ(out->names, in.names);
+    EXPECT_EQ(out->nested, in.nested);
+  }
+}
+
+TEST_F(TestParallelPack, test_parallel_pack_small_and_single_thread) {
+  auto in = makeRecords(100);
+  auto serial = checkpoint::serialize(in);
+
+  ParallelPackOptions options;
+  options.num_threads = 1;
+  options.min_elements = 2;
+  expectSameBytes(serial, checkpoint::serialize(in, options));
+
+  // Arrays below the threshold are packed serially
+  options.num_threads = 4;
+  options.min_elements = 1000;
+  expectSameBytes(serial, checkpoint::serialize(in, options));
+}
+
+struct AlignedRecord {
+  AlignedRecord() = default;
+  explicit AlignedRecord(int i) : tag(static_cast<char>(i)), values(i % 5 + 1) {
+    for (auto& v : values) {
+      v = i;
+    }
+    view = span<double>(values.data(), values.size());
+  }
+
+  template <typename SerializerT>
+  void serialize(SerializerT& s) {
+    s | tag | view;
+  }
+
+  char tag = 0;
+  std::vector<double> values;
+  span<double> view;
+};
+
+TEST_F(TestParallelPack, test_parallel_pack_alignment_falls_back) {
+  // Borrowed spans are padded relative to the buffer start, so their size
+  // depends on where each chunk lands and they are packed serially
+  std::vector<AlignedRecord> in;
+  for (int i = 0; i < 5000; i++) {
+    in.emplace_back(i);
+  }
+
+  ParallelPackOptions options;
+  options.num_threads = 4;
+  options.min_elements = 16;
+  expectSameBytes(checkpoint::serialize(in), checkpoint::serialize(in, options));
+}
+
+struct ThrowingRecord {
+  template <typename SerializerT>
+  void serialize(SerializerT& s) {
+    if (s.isPacking() and fail) {
+      throw std::runtime_error("record failed to pack");
+    }
+    s | value;
+  }
+
+  bool fail = false;
+  int value = 0;
+};
+
+TEST_F(TestParallelPack, test_parallel_pack_exception) {
+  std::vector<ThrowingRecord> in(10000);
+  in[7777].fail = true;
+
+  ParallelPackOptions options;
+  options.num_threads = 4;
+  options.min_elements = 16;
+  EXPECT_THROW(checkpoint::serialize(in, options), std::runtime_error);
+}
+
+struct CountingRecord {
+  template <typename SerializerT>
+  void serialize(SerializerT& s) {
+    if (s.isSizing()) {
+      sized++;
+    }
+    s | value;
+  }
+
+  static std::atomic<int> sized;
+  std::string value = "counted";
+};
+
+std::atomic<int> CountingRecord::sized = {0};
+
+TEST_F(TestParallelPack, test_parallel_pack_sizes_chunks_once) {
+  std::vector<CountingRecord> in(10000);
+
+  ParallelPackOptions options;
+  options.num_threads = 4;
+  options.min_elements = 16;
+
+  // The packer reuses the chunk sizes recorded by the sizer
+  CountingRecord::sized = 0;
+  auto ret = checkpoint::serialize(in, options);
+  EXPECT_EQ(CountingRecord::sized, 10000);
+
+  auto out = checkpoint::deserialize<std::vector<CountingRecord>>(
+    ret->getBuffer()
+  );
+  ASSERT_EQ(out->size(), in.size());
+  EXPECT_EQ(out->back().value, "counted");
+}
+
+TEST_F(TestParallelPack, test_parallel_for_reuses_threads) {
+  auto& pool = buffer::ThreadPool::global();
+  std::atomic<int> sum = {0};
+  buffer::parallelFor(100, 4, [&](SerialSizeType i) { sum += int(i); });
+  auto const workers = pool.getNumWorkers();
+  EXPECT_GE(workers, 3u);
+
+  for (int r = 0; r < 10; r++) {
+    buffer::parallelFor(100, 4, [&](SerialSizeType i) {
+      // Nested calls run on the calling thread without waiting for workers
+      buffer::parallelFor(3, 4, [&](SerialSizeType j) { sum += int(j); });
+      sum += int(i);
+    });
+  }
+  EXPECT_EQ(sum, 4950 * 11 + 3 * 100 * 10);
+  EXPECT_EQ(pool.getNumWorkers(), workers);
+}
+
+struct Shape : SerializableBase<Shape> {
+  Shape() = default;
+  explicit Shape(SERIALIZE_CONSTRUCT_TAG) { }
+
+  template <typename SerializerT>
+  void serialize(SerializerT& s) {
+    s | id;
+  }
+
+  int id = 0;
+};
+
+struct Circle : SerializableDerived<Circle, Shape> {
+  Circle() = default;
+  explicit Circle(SERIALIZE_CONSTRUCT_TAG tag)
+    : SerializableDerived<Circle, Shape>(tag)
+  { }
+
+  template <typename SerializerT>
+  void serialize(SerializerT& s) {
+    s | radius;
+  }
+
+  double radius = 0.0;
+};
+
+TEST_F(TestParallelPack, test_parallel_pack_polymorphic) {
+  std::vector<std::unique_ptr<Shape>> in;
+  for (int i = 0; i < 3000; i++) {
+    if (i % 2) {
+      auto c = std::make_unique<Circle>();
+      c->radius = i * 0.25;
+      in.push_back(std::move(c));
+    } else {
+      in.push_back(std::make_unique<Shape>());
+    }
+    in.back()->id = i;
+  }
+
+  ParallelPackOptions options;
+  options.num_threads = 3;
+  options.min_elements = 16;
+  auto parallel = checkpoint::serialize(in, options);
+  expectSameBytes(checkpoint::serialize(in), parallel);
+
+  auto out = checkpoint::deserialize<std::vector<std::unique_ptr<Shape>>>(
+    std::move(parallel)
+  );
+  ASSERT_EQ(out->size(), in.size());
+  for (int i = 0; i < 3000; i++) {
+    EXPECT_EQ((*out)[i]->id, i);
+    auto circle = dynamic_cast<Circle*>((*out)[i].get());
+    EXPECT_EQ(circle != nullptr, i % 2 == 1);
+    if (circle) {
+      EXPECT_EQ(circle->radius, i * 0.25);
+    }
+  }
+}
+
+TEST_F(TestParallelPack, test_parallel_pack_file) {
+  auto in = makeRecords(10000);
+  std::string const file = "test_parallel_pack_file.out";
+
+  ParallelPackOptions parallel;
+  parallel.num_threads = 4;
+  parallel.min_elements = 64;
+
+  for (auto backend : {FileBackend::MMap, FileBackend::PWrite}) {
+    FileWriteOptions options;
+    options.backend = backend;
+    options.durability = FileDurability::None;
+    options.checksum.enabled = true;
+    checkpoint::serializeToFile(in, file, parallel, options);
+
+    FileReadOptions read_options;
+    read_options.checksum = ChecksumVerify::Require;
+    auto out = checkpoint::deserializeFromFile<Records>(file, read_options);
+    EXPECT_EQ(out->records, in.records);
+    EXPECT_EQ(out->nested, in.nested);
+  }
+  std::remove(file.c_str());
+}
+
+}}} // end namespace checkpoint::tests::unit
@@ -0,0 +1,189 @@
+/*
+//@HEADER
+// *****************************************************************************
+//
+//                     test_serialization_hash_checking.cc
+//                 DARMA/magistrate => Serialization Library
+//
+// Copyright 2019 National Technology & Engineering Solutions of Sandia, LLC
+// (NTESS). Under the terms of Contract DE-NA0003525 with NTESS, the U.S.
+// Government retains certain rights in this software.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+//
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// * Neither the name of the copyright holder nor the names of its
+//   contributors may be used to endorse or promote products derived from this
+//   software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// Questions? Contact darma@sandia.gov
+//
+// *****************************************************************************
+//@HEADER
+*/
+
+#include <gtest/gtest.h>
+
+#include "checkpoint/checkpoint.h"
+#include "test_harness.h"
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace checkpoint { namespace tests { namespace unit {
+
+#if defined(SERIALIZATION_HASH_CHECKING)
+
+struct TestHashChecking : TestHarness { };
+
+struct Inner {
+  double value{1.0};
+
+  template <typename Serializer>
+  void serialize(Serializer& s) {
+    s | value;
+  }
+};
+
+struct Outer {
+  int count{2};
+  Inner inner;
+
+  template <typename Serializer>
+  void serialize(Serializer& s) {
+    s | count | inner;
+  }
+};
+
+/// Unpacks a field of the same size but a different type than it packed
+struct ChangedInner {
+  double value{1.0};
+  std::int64_t other{0};
+
+  template <typename Serializer>
+  void serialize(Serializer& s) {
+    if (s.isUnpacking()) {
+      s | other;
+    } else {
+      s | value;
+    }
+  }
+};
+
+struct ChangedOuter {
+  int count{2};
+  std::vector<ChangedInner> inners{3};
+
+  template <typename Serializer>
+  void serialize(Serializer& s) {
+    s | count | inners;
+  }
+};
+
+TEST_F(TestHashChecking, test_hash_checking_round_trip) {
+  Outer in;
+  in.count = 5;
+  in.inner.value = 2.5;
+  auto ret = checkpoint::serialize(in);
+  auto out = checkpoint::deserialize<Outer>(ret->getBuffer());
+  EXPECT_EQ(out->count, 5);
+  EXPECT_EQ(out->inner.value, 2.5);
+}
+
+TEST_F(TestHashChecking, test_hash_checking_size) {
+  Outer in;
+
+  // One hash for Outer and one for Inner, instead of a type index and size
+  // for every field
+  auto const expected = sizeof(int) + sizeof(double) +
+    sizeof(dispatch::typeregistry::DecodedIndex) + sizeof(SerialSizeType) +
+    2 * sizeof(std::uint32_t);
+  EXPECT_EQ(checkpoint::getSize(in), expected);
+}
+
+TEST_F(TestHashChecking, test_hash_checking_compact_round_trip) {
+  // The hashes stay 4 fixed bytes when integral fields are varints; vectors
+  // of every length up to 256 give as many different hashes
+  for (bool integers : {false, true}) {
+    CompactOptions options;
+    options.integers = integers;
+    for (int len = 0; len < 256; len++) {
+      std::vector<int> in(len, 300);
+      auto ret = checkpoint::serialize(in, options);
+      auto out = checkpoint::deserializeCompact<std::vector<int>>(
+        std::move(ret), options
+      );
+      EXPECT_EQ(*out, in);
+    }
+  }
+}
+
+TEST_F(TestHashChecking, test_hash_checking_portable_round_trip) {
+  Outer in;
+  in.count = 7;
+  auto ret = checkpoint::serializePortable(in);
+  auto out = checkpoint::deserializePortable<Outer>(std::move(ret));
+  EXPECT_EQ(out->count, 7);
+  EXPECT_EQ(out->inner.value, 1.0);
+}
+
+TEST_F(TestHashChecking, test_hash_checking_mismatch_trace) {
+  ChangedOuter in;
+  auto ret = checkpoint::serialize(in);
+
+  try {
+    checkpoint::deserialize<ChangedOuter>(ret->getBuffer());
+    FAIL() << "Expected a serialization_error";
+  } catch (dispatch::serialization_error const& err) {
+    std::string const what = err.what();
+    auto const inner =
+      what.find("#0 " + dispatch::typeregistry::getTypeName<ChangedInner>());
+    auto const vec = what.find(
+      "#1 " +
+      dispatch::typeregistry::getTypeName<std::vector<ChangedInner>>()
+    );
+    auto const outer =
+      what.find("#2 " + dispatch::typeregistry::getTypeName<ChangedOuter>());
+    EXPECT_NE(inner, std::string::npos) << what;
+    EXPECT_NE(vec, std::string::npos) << what;
+    EXPECT_NE(outer, std::string::npos) << what;
+  }
+
+  // The trace of a failed unpack does not leak into the next one
+  Outer ok;
+  auto ok_ret = checkpoint::serialize(ok);
+  EXPECT_NO_THROW(checkpoint::deserialize<Outer>(ok_ret->getBuffer()));
+}
+
+TEST_F(TestHashChecking, test_hash_checking_wrong_root) {
+  Outer in;
+  auto ret = checkpoint::serialize(in);
+  EXPECT_THROW(
+    checkpoint::deserialize<Inner>(ret->getBuffer()),
+    dispatch::serialization_error
+  );
+}
+
+#endif /*SERIALIZATION_HASH_CHECKING*/
+
+}}} // end namespace checkpoint::tests::unit
@@ -0,0 +1,197 @@
+/*
+//@HEADER
+// *****************************************************************************
+//
+//                        test_serialization_session.cc
+//                 DARMA/magistrate => Serialization Library
+//
+// Copyright 2019 National Technology & Engineering Solutions of Sandia, LLC
+// (NTESS). Under the terms of Contract DE-NA0003525 with NTESS, the U.S.
+// Government retains certain rights in this software.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+//
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// * Neither the name of the copyright holder nor the names of its
+//   contributors may be used to endorse or promote products derived from this
+//   software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// Questions? Contact darma@sandia.gov
+//
+// *****************************************************************************
+//@HEADER
+*/
+
+#include <gtest/gtest.h>
+
+#include "test_harness.h"
+
+#include <checkpoint/checkpoint.h>
+
+#include <cstring>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace checkpoint { namespace tests { namespace unit {
+
+using TestSerializationSession = TestHarness;
+
+struct UserObjectSession {
+  UserObjectSession() = default;
+  explicit UserObjectSession(int n)
+    : values(n, n * 0.5), name("session-" + std::to_string(n))
+  { }
+
+  template <typename SerializerT>
+  void serialize(SerializerT& s) {
+    s | values | name;
+  }
+
+  std::vector<double> values;
+  std::string name;
+};
+
+TEST_F(TestSerializationSession, test_session_round_trip) {
+  SerializationSession session;
+  UserObjectSession in(100);
+
+  auto ret = session.serialize(in);
+  auto flat = checkpoint::serialize(in);
+  ASSERT_EQ(ret->getSize(), flat->getSize());
+  EXPECT_EQ(std::memcmp(ret->getBuffer(), flat->getBuffer(), ret->getSize()), 0);
+
+  auto out = checkpoint::deserialize<UserObjectSession>(std::move(ret));
+  EXPECT_EQ(out->values, in.values);
+  EXPECT_EQ(out->name, in.name);
+}
+
+struct ShapeSession : SerializableBase<ShapeSession> {
+  ShapeSession() = default;
+  explicit ShapeSession(SERIALIZE_CONSTRUCT_TAG) { }
+
+  template <typename SerializerT>
+  void serialize(SerializerT& s) {
+    s | id;
+  }
+
+  int id = 0;
+};
+
+struct SquareSession : SerializableDerived<SquareSession, ShapeSession> {
+  SquareSession() = default;
+  explicit SquareSession(SERIALIZE_CONSTRUCT_TAG tag)
+    : SerializableDerived<SquareSession, ShapeSession>(tag)
+  { }
+
+  template <typename SerializerT>
+  void serialize(SerializerT& s) {
+    s | side;
+  }
+
+  double side = 0.0;
+};
+
+struct ShapeHolder {
+  template <typename SerializerT>
+  void serialize(SerializerT& s) {
+    s | shape;
+  }
+
+  std::unique_ptr<ShapeSession> shape;
+};
+
+TEST_F(TestSerializationSession, test_session_polymorphic) {
+  SerializationSession session;
+
+  ShapeHolder in;
+  auto square = std::make_unique<SquareSession>();
+  square->id = 3;
+  square->side = 2.5;
+  in.shape = std::move(square);
+
+  auto ret = session.serialize(in);
+  auto out = checkpoint::deserialize<ShapeHolder>(std::move(ret));
+  auto out_square = dynamic_cast<SquareSession*>(out->shape.get());
+  ASSERT_NE(out_square, nullptr);
+  EXPECT_EQ(out_square->id, 3);
+  EXPECT_EQ(out_square->side, 2.5);
+}
+
+TEST_F(TestSerializationSession, test_session_reuses_buffers) {
+  SerializationSession session;
+
+  for (int i = 0; i < 100; i++) {
+    // Sizes vary within one size class
+    UserObjectSession in(100 + i % 3);
+    auto ret = session.serialize(in);
+    auto out = checkpoint::deserialize<UserObjectSession>(ret->getBuffer());
+    EXPECT_EQ(out->values.size(), static_cast<std::size_t>(100 + i % 3));
+  }
+
+  auto const stats = session.getStats();
+  EXPECT_EQ(stats.system_allocations, 1u);
+  EXPECT_EQ(stats.thread_cache_hits + stats.shared_hits, 99u);
+  EXPECT_EQ(stats.releases, 100u);
+}
+
+TEST_F(TestSerializationSession, test_session_outlives_pool_handle) {
+  SerializedReturnType ret;
+  {
+    SerializationSession session;
+    UserObjectSession in(10);
+    ret = session.serialize(in);
+  }
+
+  // The buffer keeps the pool alive after the session is gone
+  auto out = checkpoint::deserialize<UserObjectSession>(std::move(ret));
+  EXPECT_EQ(out->name, "session-10");
+}
+
+TEST_F(TestSerializationSession, test_session_threads) {
+  auto pool = std::make_shared<BufferPool>();
+  int const num_threads = 4;
+  int const iters = 200;
+
+  std::vector<std::thread> threads;
+  for (int t = 0; t < num_threads; t++) {
+    threads.emplace_back([pool, t]{
+      SerializationSession session(pool);
+      for (int i = 0; i < iters; i++) {
+        UserObjectSession in(t * 10 + i % 5);
+        auto ret = session.serialize(in);
+        auto out = checkpoint::deserialize<UserObjectSession>(ret->getBuffer());
+        EXPECT_EQ(out->name, in.name);
+      }
+    });
+  }
+  for (auto& th : threads) {
+    th.join();
+  }
+
+  auto const stats = pool->getStats();
+  EXPECT_EQ(stats.releases, static_cast<std::size_t>(num_threads * iters));
+  EXPECT_LT(stats.system_allocations, static_cast<std::size_t>(num_threads * iters));
+}
+
+}}} // end namespace checkpoint::tests::unit
@@ -0,0 +1,200 @@
+/*
+//@HEADER
+// *****************************************************************************
+//
+//                          test_serialize_borrowed.cc
+//                 DARMA/magistrate => Serialization Library
+//
+// Copyright 2019 National Technology & Engineering Solutions of Sandia, LLC
+// (NTESS). Under the terms of Contract DE-NA0003525 with NTESS, the U.S.
+// Government retains certain rights in this software.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+//
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// * Neither the name of the copyright holder nor the names of its
+//   contributors may be used to endorse or promote products derived from this
+//   software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// Questions? Contact darma@sandia.gov
+//
+// *****************************************************************************
+//@HEADER
+*/
+
+#include <gtest/gtest.h>
+
+#include "test_harness.h"
+
+#include <checkpoint/checkpoint.h>
+
+#include <cstdint>
+#include <cstdio>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace checkpoint { namespace tests { namespace unit {
+
+using TestSerializeBorrowed = TestHarness;
+
+struct UserObjectBorrowed {
+  template <typename SerializerT>
+  void serialize(SerializerT& s) {
+    s | tag | name | values | empty | ids;
+  }
+
+  char tag = 'x';
+  std::string_view name;
+  checkpoint::span<double const> values;
+  checkpoint::span<int const> empty;
+  checkpoint::span<std::int64_t const> ids;
+};
+
+static std::string const test_name = "a borrowed name";
+static std::vector<double> const test_values = {1.5, 2.5, 3.5, 4.5};
+static std::vector<std::int64_t> const test_ids = {7, 8, 9};
+
+static UserObjectBorrowed makeBorrowedObject() {
+  UserObjectBorrowed obj;
+  obj.name = test_name;
+  obj.values = checkpoint::span<double const>(test_values);
+  obj.ids = checkpoint::span<std::int64_t const>(test_ids);
+  return obj;
+}
+
+static void checkBorrowedObject(
+  UserObjectBorrowed const& obj, char const* begin, char const* end
+) {
+  EXPECT_EQ(obj.tag, 'x');
+  EXPECT_EQ(obj.name, test_name);
+  EXPECT_EQ(
+    std::vector<double>(obj.values.begin(), obj.values.end()), test_values
+  );
+  EXPECT_TRUE(obj.empty.empty());
+  EXPECT_EQ(
+    std::vector<std::int64_t>(obj.ids.begin(), obj.ids.end()), test_ids
+  );
+
+  // Views must point into the serialized bytes, suitably aligned
+  auto inside = [&](void const* p) {
+    auto c = static_cast<char const*>(p);
+    return c >= begin and c < end;
+  };
+  EXPECT_TRUE(inside(obj.name.data()));
+  EXPECT_TRUE(inside(obj.values.data()));
+  EXPECT_TRUE(inside(obj.ids.data()));
+  EXPECT_EQ(reinterpret_cast<std::uintptr_t>(obj.values.data()) % alignof(double), 0u);
+  EXPECT_EQ(reinterpret_cast<std::uintptr_t>(obj.ids.data()) % alignof(std::int64_t), 0u);
+}
+
+TEST_F(TestSerializeBorrowed, test_deserialize_borrowed_buffer) {
+  auto in = makeBorrowedObject();
+
+  auto ret = checkpoint::serialize(in);
+  auto const begin = ret->getBuffer();
+  auto const end = begin + ret->getSize();
+
+  auto out = checkpoint::deserializeBorrowed<UserObjectBorrowed>(std::move(ret));
+  checkBorrowedObject(*out, begin, end);
+}
+
+TEST_F(TestSerializeBorrowed, test_deserialize_borrowed_file) {
+  auto in = makeBorrowedObject();
+  checkpoint::serializeToFile(in, "hello_borrowed.txt");
+
+  std::shared_ptr<UserObjectBorrowed> copy;
+  {
+    auto out =
+      checkpoint::deserializeBorrowedFromFile<UserObjectBorrowed>(
+        "hello_borrowed.txt"
+      );
+    copy = out;
+  }
+
+  // The mapping stays alive through the remaining shared owner
+  auto const begin = copy->name.data() - 64;
+  auto const end = begin + 64 + checkpoint::getSize(in);
+  checkBorrowedObject(*copy, begin, end);
+
+  std::remove("hello_borrowed.txt");
+}
+
+TEST_F(TestSerializeBorrowed, test_string_view_round_trip) {
+  std::string const str = "a string_view at the root";
+  std::string_view in = str;
+
+  auto ret = checkpoint::serialize(in);
+  auto out = checkpoint::deserializeBorrowed<std::string_view>(std::move(ret));
+  EXPECT_EQ(*out, str);
+  EXPECT_NE(out->data(), str.data());
+}
+
+TEST_F(TestSerializeBorrowed, test_borrow_unsupported_throws) {
+  auto in = makeBorrowedObject();
+
+  std::stringstream stream;
+  checkpoint::serializeToStream(in, stream);
+
+  EXPECT_THROW(
+    checkpoint::deserializeFromStream<UserObjectBorrowed>(stream),
+    checkpoint::dispatch::serialization_error
+  );
+}
+
+TEST_F(TestSerializeBorrowed, test_deserialize_rejects_borrowed) {
+  auto in = makeBorrowedObject();
+
+  // The bytes are released when deserialize returns, so views would dangle
+  EXPECT_THROW(
+    checkpoint::deserialize<UserObjectBorrowed>(checkpoint::serialize(in)),
+    checkpoint::dispatch::serialization_error
+  );
+
+  auto ret = checkpoint::serialize(in);
+  EXPECT_THROW(
+    checkpoint::deserialize<UserObjectBorrowed>(ret->getBuffer()),
+    checkpoint::dispatch::serialization_error
+  );
+}
+
+TEST_F(TestSerializeBorrowed, test_deserialize_from_file_rejects_borrowed) {
+  auto in = makeBorrowedObject();
+  checkpoint::serializeToFile(in, "hello_borrowed_reject.txt");
+
+  // The file is unmapped when deserializeFromFile returns
+  for (auto strategy : {FileReadStrategy::Default, FileReadStrategy::Window}) {
+    FileReadOptions options;
+    options.strategy = strategy;
+    EXPECT_THROW(
+      checkpoint::deserializeFromFile<UserObjectBorrowed>(
+        "hello_borrowed_reject.txt", options
+      ),
+      checkpoint::dispatch::serialization_error
+    );
+  }
+
+  std::remove("hello_borrowed_reject.txt");
+}
+
+}}} // end namespace checkpoint::tests::unit
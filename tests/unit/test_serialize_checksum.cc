@@ -0,0 +1,321 @@
+/*
+//@HEADER
+// *****************************************************************************
+//
+//                          test_serialize_checksum.cc
+//                 DARMA/magistrate => Serialization Library
+//
+// Copyright 2019 National Technology & Engineering Solutions of Sandia, LLC
+// (NTESS). Under the terms of Contract DE-NA0003525 with NTESS, the U.S.
+// Government retains certain rights in this software.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+//
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// * Neither the name of the copyright holder nor the names of its
+//   contributors may be used to endorse or promote products derived from this
+//   software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// Questions? Contact darma@sandia.gov
+//
+// *****************************************************************************
+//@HEADER
+*/
+
+#include <gtest/gtest.h>
+
+#include "test_harness.h"
+
+#include <checkpoint/checkpoint.h>
+#include <checkpoint/buffer/checksum.h>
+
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace checkpoint { namespace tests { namespace unit {
+
+using TestSerializeChecksum = TestHarness;
+
+struct UserObjectChecksum {
+  UserObjectChecksum() = default;
+  explicit UserObjectChecksum(int n) {
+    for (int i = 0; i < n; i++) {
+      values.push_back(i * 3 + 1);
+      names.push_back("n" + std::to_string(i));
+    }
+  }
+
+  template <typename SerializerT>
+  void serialize(SerializerT& s) {
+    s | values | names;
+  }
+
+  void check(UserObjectChecksum const& o) const {
+    EXPECT_EQ(values, o.values);
+    EXPECT_EQ(names, o.names);
+  }
+
+  std::vector<int64_t> values;
+  std::vector<std::string> names;
+};
+
+static void flipByte(std::string const& file, std::streamoff offset) {
+  std::fstream f(file, std::ios::in | std::ios::out | std::ios::binary);
+  f.seekg(offset);
+  char c = 0;
+  f.read(&c, 1);
+  c = static_cast<char>(c ^ 0x5a);
+  f.seekp(offset);
+  f.write(&c, 1);
+}
+
+TEST_F(TestSerializeChecksum, test_crc32c_known_values) {
+  std::string const digits = "123456789";
+  EXPECT_EQ(buffer::crc32c(digits.data(), digits.size()), 0xe3069283u);
+  EXPECT_EQ(buffer::crc32c(nullptr, 0), 0u);
+
+  std::vector<unsigned char> zeros(32, 0);
+  EXPECT_EQ(buffer::crc32c(zeros.data(), zeros.size()), 0x8a9136aau);
+}
+
+TEST_F(TestSerializeChecksum, test_crc32c_incremental_and_combine) {
+  std::mt19937 gen(7);
+  std::vector<char> data(100000);
+  for (auto& c : data) {
+    c = static_cast<char>(gen());
+  }
+
+  // Lengths cross the interleaved-block boundaries of the hardware path
+  for (std::size_t len : {1ul, 7ul, 4096ul, 12288ul, 12295ul, 100000ul}) {
+    auto const whole = buffer::crc32c(data.data(), len);
+    for (std::size_t split : {std::size_t{0}, len / 3, len}) {
+      auto const a = buffer::crc32c(data.data(), split);
+      auto const b = buffer::crc32c(data.data() + split, len - split);
+      EXPECT_EQ(buffer::crc32c(data.data() + split, len - split, a), whole);
+      EXPECT_EQ(buffer::crc32cCombine(a, b, len - split), whole);
+    }
+  }
+}
+
+TEST_F(TestSerializeChecksum, test_checksum_in_memory) {
+  UserObjectChecksum in(5000);
+
+  ChecksumOptions options;
+  options.enabled = true;
+  options.chunk_size = 1000;
+  options.num_threads = 3;
+
+  auto ret = checkpoint::serialize(in, options);
+  auto const payload = checkpoint::getSize(in);
+  EXPECT_EQ(
+    ret->getSize(),
+    payload + buffer::getChecksumTrailerSize(payload, options.chunk_size)
+  );
+  EXPECT_EQ(checkpoint::verifyChecksum(ret->getBuffer(), ret->getSize(), 2), payload);
+
+  // The payload is readable without knowing about the trailer
+  auto out = checkpoint::deserialize<UserObjectChecksum>(ret->getBuffer());
+  in.check(*out);
+
+  ret->getBuffer()[payload / 2] ^= 1;
+  EXPECT_THROW(
+    checkpoint::verifyChecksum(ret->getBuffer(), ret->getSize()),
+    buffer::checksum_error
+  );
+
+  auto plain = checkpoint::serialize(in);
+  EXPECT_THROW(
+    checkpoint::verifyChecksum(plain->getBuffer(), plain->getSize()),
+    buffer::checksum_error
+  );
+}
+
+TEST_F(TestSerializeChecksum, test_checksum_file_backends) {
+  UserObjectChecksum in(20000);
+  std::string const file = "test_checksum_file.out";
+
+  for (auto backend : {FileBackend::MMap, FileBackend::PWrite}) {
+    FileWriteOptions options;
+    options.backend = backend;
+    options.durability = FileDurability::None;
+    options.block_size = 4096;
+    options.checksum.enabled = true;
+    options.checksum.chunk_size = 10000;
+    checkpoint::serializeToFile(in, file, options);
+
+    FileReadOptions read_options;
+    read_options.checksum = ChecksumVerify::Require;
+    read_options.checksum_threads = 2;
+    auto out = checkpoint::deserializeFromFile<UserObjectChecksum>(
+      file, read_options
+    );
+    in.check(*out);
+
+    flipByte(file, 12345);
+    EXPECT_THROW(
+      checkpoint::deserializeFromFile<UserObjectChecksum>(file),
+      buffer::checksum_error
+    );
+
+    // Skipping verification still reads the (corrupt) payload
+    read_options.checksum = ChecksumVerify::Skip;
+    flipByte(file, 12345);
+    out = checkpoint::deserializeFromFile<UserObjectChecksum>(
+      file, read_options
+    );
+    in.check(*out);
+    std::remove(file.c_str());
+  }
+}
+
+TEST_F(TestSerializeChecksum, test_checksum_read_ahead) {
+  UserObjectChecksum in(20000);
+  std::string const file = "test_checksum_read_ahead.out";
+
+  FileWriteOptions options;
+  options.durability = FileDurability::None;
+  options.checksum.enabled = true;
+  options.checksum.chunk_size = 10000;
+  checkpoint::serializeToFile(in, file, options);
+  auto const payload = checkpoint::getSize(in);
+
+  // The read-ahead thread verifies the chunks while the unpacker follows
+  FileReadOptions read_options;
+  read_options.strategy = FileReadStrategy::ReadAhead;
+  read_options.read_ahead = 4096;
+  read_options.checksum = ChecksumVerify::Require;
+  auto out = checkpoint::deserializeFromFile<UserObjectChecksum>(
+    file, read_options
+  );
+  in.check(*out);
+
+  auto borrowed = checkpoint::deserializeBorrowedFromFile<UserObjectChecksum>(
+    file, read_options
+  );
+  in.check(*borrowed);
+
+  // Corruption is found wherever the unpacker gets to it
+  for (auto offset : {SerialSizeType{100}, payload / 2, payload - 10}) {
+    flipByte(file, offset);
+    EXPECT_THROW(
+      checkpoint::deserializeFromFile<UserObjectChecksum>(file, read_options),
+      buffer::checksum_error
+    );
+    flipByte(file, offset);
+  }
+
+  out = checkpoint::deserializeFromFile<UserObjectChecksum>(file, read_options);
+  in.check(*out);
+  std::remove(file.c_str());
+}
+
+TEST_F(TestSerializeChecksum, test_checksum_computed_while_packing) {
+  UserObjectChecksum in(20000);
+
+  ChecksumOptions options;
+  options.enabled = true;
+  options.chunk_size = 777;
+
+  // The trailer computed while packing matches one computed afterwards
+  auto plain = checkpoint::serialize(in);
+  auto const len = plain->getSize();
+  std::vector<char> expected(
+    len + buffer::getChecksumTrailerSize(len, options.chunk_size)
+  );
+  std::memcpy(expected.data(), plain->getBuffer(), len);
+  buffer::appendChecksumTrailer(expected.data(), len, options);
+
+  auto ret = checkpoint::serialize(in, options);
+  ASSERT_EQ(ret->getSize(), expected.size());
+  EXPECT_EQ(std::memcmp(ret->getBuffer(), expected.data(), expected.size()), 0);
+
+  // Chunks packed in parallel into claimed bytes are checksummed too
+  std::string const file = "test_checksum_parallel.out";
+  ParallelPackOptions parallel;
+  parallel.num_threads = 3;
+  parallel.min_elements = 16;
+
+  FileWriteOptions file_options;
+  file_options.durability = FileDurability::None;
+  file_options.checksum = options;
+  checkpoint::serializeToFile(in, file, parallel, file_options);
+
+  FileReadOptions read_options;
+  read_options.checksum = ChecksumVerify::Require;
+  auto out = checkpoint::deserializeFromFile<UserObjectChecksum>(
+    file, read_options
+  );
+  in.check(*out);
+  std::remove(file.c_str());
+}
+
+TEST_F(TestSerializeChecksum, test_checksum_file_missing_trailer) {
+  UserObjectChecksum in(100);
+  std::string const file = "test_checksum_missing.out";
+
+  FileWriteOptions options;
+  options.durability = FileDurability::None;
+  checkpoint::serializeToFile(in, file, options);
+
+  auto out = checkpoint::deserializeFromFile<UserObjectChecksum>(file);
+  in.check(*out);
+
+  FileReadOptions read_options;
+  read_options.checksum = ChecksumVerify::Require;
+  EXPECT_THROW(
+    checkpoint::deserializeFromFile<UserObjectChecksum>(file, read_options),
+    buffer::checksum_error
+  );
+  std::remove(file.c_str());
+}
+
+TEST_F(TestSerializeChecksum, test_checksum_async_and_compressed) {
+  UserObjectChecksum in(3000);
+  std::string const file = "test_checksum_async.out";
+
+  FileWriteOptions options;
+  options.durability = FileDurability::None;
+  options.checksum.enabled = true;
+  options.checksum.chunk_size = 4096;
+  checkpoint::serializeToFileAsync(in, file, options).wait();
+
+  FileReadOptions read_options;
+  read_options.checksum = ChecksumVerify::Require;
+  auto out = checkpoint::deserializeFromFile<UserObjectChecksum>(
+    file, read_options
+  );
+  in.check(*out);
+
+  checkpoint::serializeToFile(in, file, CompressionOptions{}, options);
+  auto cout = checkpoint::deserializeCompressedFromFile<UserObjectChecksum>(
+    file, 1, read_options
+  );
+  in.check(*cout);
+  std::remove(file.c_str());
+}
+
+}}} // end namespace checkpoint::tests::unit
@@ -0,0 +1,197 @@
+/*
+//@HEADER
+// *****************************************************************************
+//
+//                          test_serialize_compact.cc
+//                 DARMA/magistrate => Serialization Library
+//
+// Copyright 2019 National Technology & Engineering Solutions of Sandia, LLC
+// (NTESS). Under the terms of Contract DE-NA0003525 with NTESS, the U.S.
+// Government retains certain rights in this software.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+//
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// * Neither the name of the copyright holder nor the names of its
+//   contributors may be used to endorse or promote products derived from this
+//   software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// Questions? Contact darma@sandia.gov
+//
+// *****************************************************************************
+//@HEADER
+*/
+
+#include <gtest/gtest.h>
+
+#include "test_harness.h"
+
+#include <checkpoint/checkpoint.h>
+#include <checkpoint/buffer/varint.h>
+
+#include <cstdint>
+#include <limits>
+#include <map>
+#include <string>
+#include <variant>
+#include <vector>
+
+namespace checkpoint { namespace tests { namespace unit {
+
+using TestSerializeCompact = TestHarness;
+
+struct UserObjectCompact {
+  UserObjectCompact() = default;
+  explicit UserObjectCompact(int n) {
+    for (int i = 0; i < n; i++) {
+      small.push_back(i % 200 - 100);
+      counts.push_back(static_cast<uint64_t>(i) * i);
+      names.push_back("n" + std::to_string(i));
+      table[i] = std::to_string(i * 3);
+    }
+  }
+
+  template <typename SerializerT>
+  void serialize(SerializerT& s) {
+    s | id | low | high | ratio | flag | small | counts | names | table | v;
+  }
+
+  void check(UserObjectCompact const& o) const {
+    EXPECT_EQ(id, o.id);
+    EXPECT_EQ(low, o.low);
+    EXPECT_EQ(high, o.high);
+    EXPECT_EQ(ratio, o.ratio);
+    EXPECT_EQ(flag, o.flag);
+    EXPECT_EQ(small, o.small);
+    EXPECT_EQ(counts, o.counts);
+    EXPECT_EQ(names, o.names);
+    EXPECT_EQ(table, o.table);
+    EXPECT_EQ(v, o.v);
+  }
+
+  int64_t id = -42;
+  int32_t low = std::numeric_limits<int32_t>::min();
+  uint64_t high = std::numeric_limits<uint64_t>::max();
+  double ratio = 0.375;
+  bool flag = true;
+  std::vector<int32_t> small;
+  std::vector<uint64_t> counts;
+  std::vector<std::string> names;
+  std::map<int, std::string> table;
+  std::variant<int, std::string> v = std::string("variant");
+};
+
+TEST_F(TestSerializeCompact, test_varint_codec) {
+  std::vector<uint64_t> values = {0, 1, 127, 128, 16383, 16384};
+  for (int bits = 20; bits <= 64; bits++) {
+    auto const v = bits == 64 ? ~0ull : (1ull << bits) - 1;
+    values.push_back(v);
+    values.push_back(v + 1);
+  }
+
+  for (auto const v : values) {
+    // Padding selects the word-at-a-time decoder, none the byte loop
+    for (SerialSizeType pad : {0ul, 8ul}) {
+      std::vector<char> bytes(buffer::max_varint_size + pad, '\x55');
+      auto const n = buffer::encodeVarint(v, bytes.data());
+      EXPECT_EQ(n, buffer::varintSize(v));
+
+      uint64_t out = 0;
+      EXPECT_EQ(buffer::decodeVarint(bytes.data(), n + pad, out), n);
+      EXPECT_EQ(out, v) << "n=" << n << " pad=" << pad;
+    }
+  }
+
+  for (int64_t v : {int64_t{0}, int64_t{-1}, int64_t{1}, int64_t{-64},
+                    std::numeric_limits<int64_t>::min(),
+                    std::numeric_limits<int64_t>::max()}) {
+    EXPECT_EQ(buffer::fromVarint<int64_t>(buffer::toVarint(v)), v);
+  }
+  EXPECT_EQ(buffer::toVarint(int16_t{-1}), 1u);
+  EXPECT_EQ(buffer::toVarint(int16_t{1}), 2u);
+  EXPECT_EQ(
+    buffer::fromVarint<int16_t>(buffer::toVarint(int16_t{-32768})), -32768
+  );
+}
+
+TEST_F(TestSerializeCompact, test_compact_round_trip) {
+  UserObjectCompact in(1000);
+  for (bool integers : {false, true}) {
+    CompactOptions options;
+    options.integers = integers;
+
+    auto bytes = checkpoint::serialize(in, options);
+    EXPECT_LT(bytes->getSize(), checkpoint::getSize(in));
+
+    auto out = checkpoint::deserializeCompact<UserObjectCompact>(
+      std::move(bytes), options
+    );
+    in.check(*out);
+  }
+}
+
+TEST_F(TestSerializeCompact, test_compact_integers_shrink_arrays) {
+  std::vector<int32_t> in(10000);
+  for (std::size_t i = 0; i < in.size(); i++) {
+    in[i] = static_cast<int32_t>(i % 100) - 50;
+  }
+
+  auto sizes_only = checkpoint::serialize(in, CompactOptions{});
+  auto integers = checkpoint::serialize(in, CompactOptions{true});
+
+  // Sizes alone only shrink the vector's size and capacity; every value
+  // between -64 and 63 takes one byte once integers are varints
+  EXPECT_GT(sizes_only->getSize(), in.size() * sizeof(int32_t));
+  EXPECT_LT(integers->getSize(), in.size() + 32);
+
+  auto out = checkpoint::deserializeCompact<std::vector<int32_t>>(
+    std::move(integers), CompactOptions{true}
+  );
+  EXPECT_EQ(*out, in);
+}
+
+TEST_F(TestSerializeCompact, test_compact_varint_errors) {
+  uint64_t value = std::numeric_limits<uint64_t>::max();
+  auto bytes = checkpoint::serialize(value, CompactOptions{true});
+
+  // The last varint is cut short
+  EXPECT_THROW(
+    checkpoint::deserializeCompact<uint64_t>(
+      bytes->getBuffer(), bytes->getSize() - 1, CompactOptions{true}
+    ),
+    std::runtime_error
+  );
+
+  // Eleven continuation bytes do not fit in 64 bits
+  std::vector<char> overlong(16, '\xff');
+  CompactUnpacker u(overlong.data(), overlong.size(), CompactOptions{});
+  uint64_t out = 0;
+  EXPECT_THROW(u.varint(out), std::runtime_error);
+
+  // A value that does not fit in the destination type
+  char const wide[] = {'\x80', '\x80', '\x04'};
+  CompactUnpacker narrow(const_cast<char*>(wide), sizeof(wide), {});
+  uint16_t small = 0;
+  EXPECT_THROW(narrow.varint(small), std::runtime_error);
+}
+
+}}} // end namespace checkpoint::tests::unit
@@ -0,0 +1,332 @@
+/*
+//@HEADER
+// *****************************************************************************
+//
+//                         test_serialize_compressed.cc
+//                 DARMA/magistrate => Serialization Library
+//
+// Copyright 2019 National Technology & Engineering Solutions of Sandia, LLC
+// (NTESS). Under the terms of Contract DE-NA0003525 with NTESS, the U.S.
+// Government retains certain rights in this software.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+//
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// * Neither the name of the copyright holder nor the names of its
+//   contributors may be used to endorse or promote products derived from this
+//   software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// Questions? Contact darma@sandia.gov
+//
+// *****************************************************************************
+//@HEADER
+*/
+
+#include <gtest/gtest.h>
+
+#include "test_harness.h"
+
+#include <checkpoint/checkpoint.h>
+
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <random>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace checkpoint { namespace tests { namespace unit {
+
+using TestSerializeCompressed = TestHarness;
+
+struct UserObjectCompressed {
+  UserObjectCompressed() = default;
+  explicit UserObjectCompressed(int n) {
+    for (int i = 0; i < n; i++) {
+      field.push_back(std::sin(i * 0.001));
+      labels.push_back("cell-" + std::to_string(i % 17));
+    }
+  }
+
+  template <typename SerializerT>
+  void serialize(SerializerT& s) {
+    s | field | labels;
+  }
+
+  void check(UserObjectCompressed const& o) const {
+    EXPECT_EQ(field, o.field);
+    EXPECT_EQ(labels, o.labels);
+  }
+
+  std::vector<double> field;
+  std::vector<std::string> labels;
+};
+
+TEST_F(TestSerializeCompressed, test_compressed_round_trip) {
+  UserObjectCompressed in(20000);
+
+  auto ret = checkpoint::serialize(in, CompressionOptions{});
+  EXPECT_LT(ret->getSize(), checkpoint::getSize(in));
+
+  auto out = checkpoint::deserializeCompressed<UserObjectCompressed>(
+    std::move(ret)
+  );
+  in.check(*out);
+}
+
+struct ShapeCompressed : SerializableBase<ShapeCompressed> {
+  ShapeCompressed() = default;
+  explicit ShapeCompressed(SERIALIZE_CONSTRUCT_TAG) { }
+
+  template <typename SerializerT>
+  void serialize(SerializerT& s) {
+    s | id;
+  }
+
+  int id = 0;
+};
+
+struct CircleCompressed
+  : SerializableDerived<CircleCompressed, ShapeCompressed>
+{
+  CircleCompressed() = default;
+  explicit CircleCompressed(SERIALIZE_CONSTRUCT_TAG tag)
+    : SerializableDerived<CircleCompressed, ShapeCompressed>(tag)
+  { }
+
+  template <typename SerializerT>
+  void serialize(SerializerT& s) {
+    s | radius;
+  }
+
+  double radius = 0.0;
+};
+
+TEST_F(TestSerializeCompressed, test_compressed_polymorphic) {
+  std::vector<std::unique_ptr<ShapeCompressed>> in;
+  for (int i = 0; i < 1000; i++) {
+    if (i % 3 == 0) {
+      auto c = std::make_unique<CircleCompressed>();
+      c->radius = i * 0.5;
+      in.push_back(std::move(c));
+    } else {
+      in.push_back(std::make_unique<ShapeCompressed>());
+    }
+    in.back()->id = i;
+  }
+
+  auto ret = checkpoint::serialize(in, CompressionOptions{});
+  auto out = checkpoint::deserializeCompressed<
+    std::vector<std::unique_ptr<ShapeCompressed>>
+  >(std::move(ret));
+
+  ASSERT_EQ(out->size(), in.size());
+  for (int i = 0; i < 1000; i++) {
+    EXPECT_EQ((*out)[i]->id, i);
+    auto circle = dynamic_cast<CircleCompressed*>((*out)[i].get());
+    ASSERT_EQ(circle != nullptr, i % 3 == 0);
+    if (circle) {
+      EXPECT_EQ(circle->radius, i * 0.5);
+    }
+  }
+}
+
+TEST_F(TestSerializeCompressed, test_compressed_frames_threads_shuffle) {
+  UserObjectCompressed in(50000);
+
+  CompressionOptions options;
+  options.frame_size = 4096;
+  options.shuffle_width = 8;
+  options.num_threads = 4;
+
+  auto ret = checkpoint::serialize(in, options);
+  for (unsigned threads : {1u, 3u}) {
+    auto out = checkpoint::deserializeCompressed<UserObjectCompressed>(
+      ret->getBuffer(), ret->getSize(), threads
+    );
+    in.check(*out);
+  }
+}
+
+TEST_F(TestSerializeCompressed, test_compressed_frame_view) {
+  UserObjectCompressed in(30000);
+
+  CompressionOptions options;
+  options.frame_size = 10000;
+  auto ret = checkpoint::serialize(in, options);
+  auto flat = checkpoint::serialize(in);
+
+  buffer::FrameStreamView view(ret->getBuffer(), ret->getSize());
+  ASSERT_EQ(view.getRawSize(), flat->getSize());
+  EXPECT_EQ(view.getNumFrames(), (flat->getSize() + 9999) / 10000);
+
+  auto all = view.decompressAll(4);
+  EXPECT_EQ(std::memcmp(all->getBuffer(), flat->getBuffer(), flat->getSize()), 0);
+
+  // Any single frame can be decompressed on its own
+  std::vector<char> frame(view.getFrameSize());
+  auto const len = view.decompressFrame(2, frame.data());
+  EXPECT_EQ(len, 10000u);
+  EXPECT_EQ(std::memcmp(frame.data(), flat->getBuffer() + 20000, len), 0);
+}
+
+TEST_F(TestSerializeCompressed, test_compressed_incompressible) {
+  std::mt19937_64 gen(42);
+  std::vector<uint64_t> in(100000);
+  for (auto& v : in) {
+    v = gen();
+  }
+
+  auto ret = checkpoint::serialize(in, CompressionOptions{});
+  auto out = checkpoint::deserializeCompressed<std::vector<uint64_t>>(
+    std::move(ret)
+  );
+  EXPECT_EQ(*out, in);
+}
+
+TEST_F(TestSerializeCompressed, test_compressed_file) {
+  UserObjectCompressed in(40000);
+  std::string const file = "test_compressed_file.out";
+
+  CompressionOptions compression;
+  compression.frame_size = 1 << 16;
+  FileWriteOptions options;
+  options.durability = FileDurability::None;
+  checkpoint::serializeToFile(in, file, compression, options);
+
+  auto out = checkpoint::deserializeCompressedFromFile<UserObjectCompressed>(
+    file, 2
+  );
+  in.check(*out);
+  std::remove(file.c_str());
+}
+
+TEST_F(TestSerializeCompressed, test_compressed_stream) {
+  UserObjectCompressed a(10000), b(123);
+
+  CompressionOptions options;
+  options.frame_size = 8192;
+
+  std::stringstream stream;
+  checkpoint::serializeToStream(a, stream, options);
+  checkpoint::serializeToStream(b, stream, options);
+
+  // Each read consumes exactly one compressed stream
+  auto out_a =
+    checkpoint::deserializeCompressedFromStream<UserObjectCompressed>(stream);
+  auto out_b =
+    checkpoint::deserializeCompressedFromStream<UserObjectCompressed>(stream, 2);
+  a.check(*out_a);
+  b.check(*out_b);
+}
+
+TEST_F(TestSerializeCompressed, test_compressed_corrupt) {
+  UserObjectCompressed in(5000);
+  auto ret = checkpoint::serialize(in, CompressionOptions{});
+
+  std::vector<char> bad(ret->getBuffer(), ret->getBuffer() + ret->getSize());
+  bad[0] ^= 0x1;
+  EXPECT_THROW(
+    checkpoint::deserializeCompressed<UserObjectCompressed>(bad.data(), bad.size()),
+    std::runtime_error
+  );
+
+  // Truncated stream
+  EXPECT_THROW(
+    checkpoint::deserializeCompressed<UserObjectCompressed>(
+      ret->getBuffer(), ret->getSize() / 2
+    ),
+    std::runtime_error
+  );
+}
+
+struct XorCodec final : Codec {
+  uint8_t getID() const override { return 200; }
+  std::string getName() const override { return "xor"; }
+  SerialSizeType getMaxCompressedSize(SerialSizeType len) const override {
+    return len;
+  }
+  SerialSizeType compress(
+    SerialByteType const* src, SerialSizeType len,
+    SerialByteType* dst, SerialSizeType
+  ) const override {
+    // Pretend to shrink by one byte so frames are not stored raw
+    for (SerialSizeType i = 0; i + 1 < len; i++) {
+      dst[i] = src[i] ^ 0x5a;
+    }
+    return len - 1;
+  }
+  void decompress(
+    SerialByteType const* src, SerialSizeType len,
+    SerialByteType* dst, SerialSizeType raw_len
+  ) const override {
+    for (SerialSizeType i = 0; i < len; i++) {
+      dst[i] = src[i] ^ 0x5a;
+    }
+    dst[raw_len - 1] = 0;
+  }
+};
+
+TEST_F(TestSerializeCompressed, test_compressed_custom_codec) {
+  // Every packed frame of a vector of zeros ends in a zero byte
+  std::vector<int> in(1000, 0);
+
+  CompressionOptions options;
+  options.codec = std::make_shared<XorCodec>();
+  options.frame_size = 512;
+
+  auto ret = checkpoint::serialize(in, options);
+  auto out = checkpoint::deserializeCompressed<std::vector<int>>(std::move(ret));
+  EXPECT_EQ(*out, in);
+  EXPECT_EQ(buffer::getCodec(200)->getName(), "xor");
+}
+
+TEST_F(TestSerializeCompressed, test_lz_codec_patterns) {
+  buffer::LZCodec codec;
+  std::mt19937 gen(7);
+
+  for (int trial = 0; trial < 50; trial++) {
+    std::size_t const len = gen() % 200000;
+    std::vector<char> raw(len);
+    for (std::size_t i = 0; i < len; i++) {
+      // Mix runs, short repeats and noise
+      switch ((i / 1000) % 3) {
+      case 0: raw[i] = 'a'; break;
+      case 1: raw[i] = static_cast<char>(i % 13); break;
+      default: raw[i] = static_cast<char>(gen()); break;
+      }
+    }
+
+    std::vector<char> packed(codec.getMaxCompressedSize(len));
+    auto const n = codec.compress(raw.data(), len, packed.data(), packed.size());
+    ASSERT_GT(n, 0u);
+
+    std::vector<char> out(len);
+    codec.decompress(packed.data(), n, out.data(), len);
+    EXPECT_EQ(out, raw);
+  }
+}
+
+}}} // end namespace checkpoint::tests::unit
@@ -49,6 +49,8 @@
 
 #include <vector>
 #include <cstdio>
+#include <fstream>
+#include <iterator>
 
 namespace checkpoint { namespace tests { namespace unit {
 
@@ -155,13 +157,110 @@ TYPED_TEST_P(TestSerializeFileInPlace, test_serialize_file_multi_in_place) {
   out.check();
 }
 
+TYPED_TEST_P(TestSerializeFile, test_serialize_file_options) {
+  using TestType = TypeParam;
+
+  TestType in(u_val);
+  in.check();
+
+  for (auto backend : {FileBackend::MMap, FileBackend::PWrite}) {
+    for (auto durability : {
+      FileDurability::None, FileDurability::DataSync, FileDurability::Full
+    }) {
+      FileWriteOptions options;
+      options.backend = backend;
+      options.durability = durability;
+
+      checkpoint::serializeToFile(in, "hello.txt", options);
+      auto out = checkpoint::deserializeFromFile<TestType>("hello.txt");
+      out->check();
+    }
+  }
+}
+
+TYPED_TEST_P(TestSerializeFile, test_serialize_file_read_strategies) {
+  using TestType = TypeParam;
+
+  TestType in(u_val);
+  in.check();
+
+  checkpoint::serializeToFile(in, "hello.txt");
+
+  for (auto strategy : {
+    FileReadStrategy::Default, FileReadStrategy::Populate,
+    FileReadStrategy::Sequential, FileReadStrategy::FAdvise,
+    FileReadStrategy::ReadAhead
+  }) {
+    FileReadOptions options;
+    options.strategy = strategy;
+    options.read_ahead = 4096;
+
+    auto out = checkpoint::deserializeFromFile<TestType>("hello.txt", options);
+    out->check();
+
+    TestType out_in_place{};
+    checkpoint::deserializeInPlaceFromFile<TestType>(
+      "hello.txt", &out_in_place, options
+    );
+    out_in_place.check();
+  }
+}
+
+static std::vector<char> readFileBytes(std::string const& file) {
+  std::ifstream is(file, std::ios::binary);
+  return std::vector<char>(
+    std::istreambuf_iterator<char>(is), std::istreambuf_iterator<char>()
+  );
+}
+
+struct UserObjectMixed {
+  template <typename SerializerT>
+  void serialize(SerializerT& s) {
+    s | small | big | tail;
+  }
+
+  std::vector<int> small = std::vector<int>(3, 7);
+  std::vector<double> big = std::vector<double>(1000, 2.5);
+  std::string tail = "tail";
+};
+
+using TestSerializeFileBackend = TestHarness;
+
+TEST_F(TestSerializeFileBackend, test_serialize_file_pwrite_matches_mmap) {
+  UserObjectMixed in;
+
+  checkpoint::serializeToFile(in, "hello_mmap.txt");
+
+  // A tiny staging block exercises both staged and direct writes
+  FileWriteOptions options;
+  options.backend = FileBackend::PWrite;
+  options.block_size = 64;
+  checkpoint::serializeToFile(in, "hello_pwrite.txt", options);
+
+  auto mmap_bytes = readFileBytes("hello_mmap.txt");
+  auto pwrite_bytes = readFileBytes("hello_pwrite.txt");
+  EXPECT_EQ(mmap_bytes.size(), checkpoint::getSize(in));
+  EXPECT_EQ(mmap_bytes, pwrite_bytes);
+
+  auto out = checkpoint::deserializeFromFile<UserObjectMixed>("hello_pwrite.txt");
+  EXPECT_EQ(out->small, in.small);
+  EXPECT_EQ(out->big, in.big);
+  EXPECT_EQ(out->tail, in.tail);
+
+  std::remove("hello_mmap.txt");
+  std::remove("hello_pwrite.txt");
+}
+
 using ConstructTypes = ::testing::Types<
   UserObjectA,
   UserObjectB,
   UserObjectC
 >;
 
-REGISTER_TYPED_TEST_CASE_P(TestSerializeFile, test_serialize_file_multi);
+REGISTER_TYPED_TEST_CASE_P(
+  TestSerializeFile, test_serialize_file_multi, test_serialize_file_options,
+  test_serialize_file_read_strategies
+);
 REGISTER_TYPED_TEST_CASE_P(TestSerializeFileInPlace, test_serialize_file_multi_in_place);
 
 INSTANTIATE_TYPED_TEST_CASE_P(test_file, TestSerializeFile, ConstructTypes, );
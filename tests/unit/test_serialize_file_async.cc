@@ -0,0 +1,201 @@
+/*
+//@HEADER
+// *****************************************************************************
+//
+//                         test_serialize_file_async.cc
+//                 DARMA/magistrate => Serialization Library
+//
+// Copyright 2019 National Technology & Engineering Solutions of Sandia, LLC
+// (NTESS). Under the terms of Contract DE-NA0003525 with NTESS, the U.S.
+// Government retains certain rights in this software.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+//
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// * Neither the name of the copyright holder nor the names of its
+//   contributors may be used to endorse or promote products derived from this
+//   software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// Questions? Contact darma@sandia.gov
+//
+// *****************************************************************************
+//@HEADER
+*/
+
+#include <gtest/gtest.h>
+
+#include "test_harness.h"
+
+#include <checkpoint/checkpoint.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace checkpoint { namespace tests { namespace unit {
+
+using TestSerializeFileAsync = TestHarness;
+
+struct UserObjectAsync {
+  UserObjectAsync() = default;
+  explicit UserObjectAsync(int n) : values(n), label(std::to_string(n)) {
+    for (int i = 0; i < n; i++) {
+      values[i] = i * 0.5;
+    }
+  }
+
+  template <typename SerializerT>
+  void serialize(SerializerT& s) {
+    s | values | label;
+  }
+
+  std::vector<double> values;
+  std::string label;
+};
+
+TEST_F(TestSerializeFileAsync, test_serialize_file_async_round_trip) {
+  UserObjectAsync in(1000);
+
+  auto handle = checkpoint::serializeToFileAsync(in, "hello_async.txt");
+  EXPECT_TRUE(handle.valid());
+
+  // The snapshot was taken before returning; later changes are not written
+  in.values.clear();
+  in.label = "changed";
+
+  handle.wait();
+  EXPECT_TRUE(handle.poll());
+
+  auto out = checkpoint::deserializeFromFile<UserObjectAsync>("hello_async.txt");
+  EXPECT_EQ(out->values.size(), 1000u);
+  EXPECT_EQ(out->values[999], 999 * 0.5);
+  EXPECT_EQ(out->label, "1000");
+
+  std::remove("hello_async.txt");
+}
+
+TEST_F(TestSerializeFileAsync, test_serialize_file_async_bounded) {
+  checkpoint::setMaxAsyncFileWrites(1);
+
+  std::vector<FileWriteHandle> handles;
+  for (int i = 0; i < 4; i++) {
+    UserObjectAsync in(100 + i);
+    handles.push_back(
+      checkpoint::serializeToFileAsync(in, "hello_async_" + std::to_string(i))
+    );
+  }
+
+  for (int i = 0; i < 4; i++) {
+    handles[i].wait();
+    auto const file = "hello_async_" + std::to_string(i);
+    auto out = checkpoint::deserializeFromFile<UserObjectAsync>(file);
+    EXPECT_EQ(out->values.size(), static_cast<std::size_t>(100 + i));
+    std::remove(file.c_str());
+  }
+
+  checkpoint::setMaxAsyncFileWrites(2);
+}
+
+TEST_F(TestSerializeFileAsync, test_serialize_file_async_backends) {
+  UserObjectAsync in(5000);
+
+  for (auto backend : {FileBackend::MMap, FileBackend::PWrite}) {
+    FileWriteOptions options;
+    options.backend = backend;
+    options.durability = FileDurability::None;
+    options.checksum.enabled = true;
+    options.checksum.chunk_size = 1000;
+    checkpoint::serializeToFileAsync(in, "hello_async_backend", options).wait();
+
+    FileReadOptions read_options;
+    read_options.checksum = ChecksumVerify::Require;
+    auto out = checkpoint::deserializeFromFile<UserObjectAsync>(
+      "hello_async_backend", read_options
+    );
+    EXPECT_EQ(out->values, in.values);
+    EXPECT_EQ(out->label, in.label);
+  }
+
+  std::remove("hello_async_backend");
+}
+
+struct UserObjectAsyncPacking {
+  template <typename SerializerT>
+  void serialize(SerializerT& s) {
+    if (s.isPacking()) {
+      auto const now = ++packing;
+      max_packing = std::max(max_packing.load(), now);
+      std::this_thread::sleep_for(std::chrono::milliseconds(2));
+      --packing;
+    }
+    s | values;
+  }
+
+  static std::atomic<int> packing;
+  static std::atomic<int> max_packing;
+
+  std::vector<double> values = std::vector<double>(100, 1.0);
+};
+
+std::atomic<int> UserObjectAsyncPacking::packing = {0};
+std::atomic<int> UserObjectAsyncPacking::max_packing = {0};
+
+TEST_F(TestSerializeFileAsync, test_serialize_file_async_bounded_concurrent) {
+  checkpoint::setMaxAsyncFileWrites(1);
+
+  // A slot is reserved before packing, so with one slot no two snapshots
+  // are ever live at once, even when callers race
+  std::vector<std::thread> threads;
+  for (int t = 0; t < 4; t++) {
+    threads.emplace_back([t]{
+      for (int i = 0; i < 3; i++) {
+        UserObjectAsyncPacking in;
+        auto const file = "hello_async_concurrent_" + std::to_string(t);
+        checkpoint::serializeToFileAsync(in, file).wait();
+        std::remove(file.c_str());
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+
+  EXPECT_EQ(UserObjectAsyncPacking::max_packing.load(), 1);
+
+  checkpoint::setMaxAsyncFileWrites(2);
+}
+
+TEST_F(TestSerializeFileAsync, test_serialize_file_async_error) {
+  UserObjectAsync in(10);
+
+  auto handle = checkpoint::serializeToFileAsync(
+    in, "no_such_directory/hello_async.txt"
+  );
+  EXPECT_THROW(handle.wait(), std::runtime_error);
+}
+
+}}} // end namespace checkpoint::tests::unit
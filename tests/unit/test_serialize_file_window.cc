@@ -0,0 +1,233 @@
+/*
+//@HEADER
+// *****************************************************************************
+//
+//                        test_serialize_file_window.cc
+//                 DARMA/magistrate => Serialization Library
+//
+// Copyright 2019 National Technology & Engineering Solutions of Sandia, LLC
+// (NTESS). Under the terms of Contract DE-NA0003525 with NTESS, the U.S.
+// Government retains certain rights in this software.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+//
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// * Neither the name of the copyright holder nor the names of its
+//   contributors may be used to endorse or promote products derived from this
+//   software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// Questions? Contact darma@sandia.gov
+//
+// *****************************************************************************
+//@HEADER
+*/
+
+#include <gtest/gtest.h>
+
+#include "test_harness.h"
+
+#include <checkpoint/checkpoint.h>
+#include <checkpoint/buffer/checksum.h>
+
+#include <cstdio>
+#include <fstream>
+#include <string>
+#include <vector>
+
+namespace checkpoint { namespace tests { namespace unit {
+
+using TestSerializeFileWindow = TestHarness;
+
+struct UserObjectWindow {
+  UserObjectWindow() = default;
+  explicit UserObjectWindow(int n) : large(n) {
+    for (int i = 0; i < n; i++) {
+      large[i] = i * 0.25;
+      if (i % 100 == 0) {
+        small.push_back("s" + std::to_string(i));
+      }
+    }
+  }
+
+  template <typename SerializerT>
+  void serialize(SerializerT& s) {
+    s | small | large | tail;
+  }
+
+  void check(UserObjectWindow const& o) const {
+    EXPECT_EQ(small, o.small);
+    EXPECT_EQ(large, o.large);
+    EXPECT_EQ(tail, o.tail);
+  }
+
+  std::vector<std::string> small;
+  std::vector<double> large;
+  int tail = 17;
+};
+
+static void flipByte(std::string const& file, std::streamoff offset) {
+  std::fstream f(file, std::ios::in | std::ios::out | std::ios::binary);
+  f.seekg(offset);
+  char c = 0;
+  f.read(&c, 1);
+  c = static_cast<char>(c ^ 0x5a);
+  f.seekp(offset);
+  f.write(&c, 1);
+}
+
+static FileReadOptions windowOptions(SerialSizeType window) {
+  FileReadOptions options;
+  options.strategy = FileReadStrategy::Window;
+  options.window = window;
+  return options;
+}
+
+TEST_F(TestSerializeFileWindow, test_write_behind_round_trip) {
+  std::string const file = "test_file_window_behind.out";
+  UserObjectWindow in(100000);
+
+  FileWriteOptions options;
+  options.backend = FileBackend::PWrite;
+  options.block_size = 4096;
+  options.write_behind = 64 << 10;
+  checkpoint::serializeToFile(in, file, options);
+
+  auto out = checkpoint::deserializeFromFile<UserObjectWindow>(file);
+  in.check(*out);
+
+  std::remove(file.c_str());
+}
+
+TEST_F(TestSerializeFileWindow, test_window_round_trip) {
+  std::string const file = "test_file_window.out";
+  UserObjectWindow in(100000);
+  checkpoint::serializeToFile(in, file);
+
+  // Windows smaller and larger than the large member and the whole file
+  for (SerialSizeType window : {1ull, 7ull, 4096ull, 1ull << 20, 64ull << 20}) {
+    auto out = checkpoint::deserializeFromFile<UserObjectWindow>(
+      file, windowOptions(window)
+    );
+    in.check(*out);
+
+    UserObjectWindow in_place;
+    checkpoint::deserializeInPlaceFromFile(
+      file, &in_place, windowOptions(window)
+    );
+    in.check(in_place);
+  }
+
+  std::remove(file.c_str());
+}
+
+TEST_F(TestSerializeFileWindow, test_window_verifies_checksum) {
+  std::string const file = "test_file_window_checksum.out";
+  UserObjectWindow in(100000);
+
+  // Chunks that do not divide the payload or line up with the window
+  FileWriteOptions options;
+  options.checksum.enabled = true;
+  options.checksum.chunk_size = 10007;
+  checkpoint::serializeToFile(in, file, options);
+
+  for (SerialSizeType window : {1ull, 4096ull, 1ull << 20}) {
+    auto opts = windowOptions(window);
+    opts.checksum = ChecksumVerify::Require;
+    auto out = checkpoint::deserializeFromFile<UserObjectWindow>(file, opts);
+    in.check(*out);
+  }
+
+  flipByte(file, 200000);
+  for (SerialSizeType window : {1ull, 4096ull, 1ull << 20}) {
+    EXPECT_THROW(
+      checkpoint::deserializeFromFile<UserObjectWindow>(
+        file, windowOptions(window)
+      ),
+      buffer::checksum_error
+    );
+  }
+
+  std::remove(file.c_str());
+}
+
+TEST_F(TestSerializeFileWindow, test_window_payload_smaller_than_chunk) {
+  std::string const file = "test_file_window_small_checksum.out";
+  UserObjectWindow in(5);
+
+  // The default chunk is far larger than the whole payload
+  FileWriteOptions options;
+  options.checksum.enabled = true;
+  checkpoint::serializeToFile(in, file, options);
+
+  for (SerialSizeType window : {1ull, 7ull, 4096ull, 1ull << 20}) {
+    auto opts = windowOptions(window);
+    opts.checksum = ChecksumVerify::Require;
+    auto out = checkpoint::deserializeFromFile<UserObjectWindow>(file, opts);
+    in.check(*out);
+  }
+
+  flipByte(file, 20);
+  EXPECT_THROW(
+    checkpoint::deserializeFromFile<UserObjectWindow>(
+      file, windowOptions(4096)
+    ),
+    buffer::checksum_error
+  );
+
+  std::remove(file.c_str());
+}
+
+TEST_F(TestSerializeFileWindow, test_window_require_missing_trailer) {
+  std::string const file = "test_file_window_no_trailer.out";
+  UserObjectWindow in(1000);
+  checkpoint::serializeToFile(in, file);
+
+  auto opts = windowOptions(4096);
+  opts.checksum = ChecksumVerify::Require;
+  EXPECT_THROW(
+    checkpoint::deserializeFromFile<UserObjectWindow>(file, opts),
+    buffer::checksum_error
+  );
+
+  std::remove(file.c_str());
+}
+
+TEST_F(TestSerializeFileWindow, test_window_truncated_file) {
+  std::string const file = "test_file_window_truncated.out";
+  UserObjectWindow in(1000);
+  auto bytes = checkpoint::serialize(in);
+  {
+    std::ofstream out(file, std::ios::binary | std::ios::trunc);
+    out.write(bytes->getBuffer(), bytes->getSize() - 1);
+  }
+
+  EXPECT_THROW(
+    checkpoint::deserializeFromFile<UserObjectWindow>(
+      file, windowOptions(4096)
+    ),
+    std::runtime_error
+  );
+
+  std::remove(file.c_str());
+}
+
+}}} // end namespace checkpoint::tests::unit
@@ -0,0 +1,204 @@
+/*
+//@HEADER
+// *****************************************************************************
+//
+//                           test_serialize_iovec.cc
+//                 DARMA/magistrate => Serialization Library
+//
+// Copyright 2019 National Technology & Engineering Solutions of Sandia, LLC
+// (NTESS). Under the terms of Contract DE-NA0003525 with NTESS, the U.S.
+// Government retains certain rights in this software.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+//
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// * Neither the name of the copyright holder nor the names of its
+//   contributors may be used to endorse or promote products derived from this
+//   software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// Questions? Contact darma@sandia.gov
+//
+// *****************************************************************************
+//@HEADER
+*/
+
+#include <gtest/gtest.h>
+
+#include "test_harness.h"
+
+#include <checkpoint/checkpoint.h>
+
+#include <cstdio>
+#include <queue>
+#include <sstream>
+#include <stack>
+#include <string>
+#include <vector>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+namespace checkpoint { namespace tests { namespace unit {
+
+using TestSerializeIOVec = TestHarness;
+
+struct UserObjectIOVec {
+  UserObjectIOVec() = default;
+  explicit UserObjectIOVec(int n)
+    : id(n), big(n, 1.25), small(3, 4), name("iovec"), other(n * 2, 7)
+  { }
+
+  template <typename SerializerT>
+  void serialize(SerializerT& s) {
+    s | id | big | small | name | other;
+  }
+
+  void check(UserObjectIOVec const& o) const {
+    EXPECT_EQ(id, o.id);
+    EXPECT_EQ(big, o.big);
+    EXPECT_EQ(small, o.small);
+    EXPECT_EQ(name, o.name);
+    EXPECT_EQ(other, o.other);
+  }
+
+  int id = 0;
+  std::vector<double> big;
+  std::vector<int> small;
+  std::string name;
+  std::vector<int> other;
+};
+
+static std::vector<char> flatten(IOVecList const& list) {
+  std::vector<char> out(list.getSize());
+  list.copyTo(out.data());
+  return out;
+}
+
+TEST_F(TestSerializeIOVec, test_iovec_matches_packer) {
+  UserObjectIOVec in(10000);
+
+  auto list = checkpoint::serializeIOVec(in, 1024);
+  auto flat = checkpoint::serialize(in);
+
+  ASSERT_EQ(list->getSize(), flat->getSize());
+  auto bytes = flatten(*list);
+  EXPECT_EQ(
+    std::vector<char>(flat->getBuffer(), flat->getBuffer() + flat->getSize()),
+    bytes
+  );
+
+  // The large vectors are referenced, not copied
+  bool found_big = false, found_other = false;
+  for (auto const& seg : list->getSegments()) {
+    found_big |= seg.iov_base == static_cast<void*>(in.big.data());
+    found_other |= seg.iov_base == static_cast<void*>(in.other.data());
+  }
+  EXPECT_TRUE(found_big);
+  EXPECT_TRUE(found_other);
+
+  auto out = checkpoint::deserialize<UserObjectIOVec>(bytes.data());
+  in.check(*out);
+}
+
+TEST_F(TestSerializeIOVec, test_iovec_below_threshold_is_one_segment) {
+  UserObjectIOVec in(10);
+
+  auto list = checkpoint::serializeIOVec(in);
+  EXPECT_EQ(list->getSegments().size(), 1u);
+
+  auto bytes = flatten(*list);
+  auto out = checkpoint::deserialize<UserObjectIOVec>(bytes.data());
+  in.check(*out);
+}
+
+TEST_F(TestSerializeIOVec, test_iovec_write_fd) {
+  UserObjectIOVec in(5000);
+
+  auto list = checkpoint::serializeIOVec(in, 256);
+
+  int fd = open("hello_iovec.txt", O_CREAT | O_WRONLY | O_TRUNC, 0600);
+  ASSERT_NE(fd, -1);
+  list->writeTo(fd);
+  close(fd);
+
+  auto out = checkpoint::deserializeFromFile<UserObjectIOVec>("hello_iovec.txt");
+  in.check(*out);
+
+  std::remove("hello_iovec.txt");
+}
+
+TEST_F(TestSerializeIOVec, test_iovec_write_stream) {
+  UserObjectIOVec in(5000);
+
+  auto list = checkpoint::serializeIOVec(in, 256);
+
+  std::stringstream stream;
+  list->writeTo(stream);
+
+  auto out = checkpoint::deserializeFromStream<UserObjectIOVec>(stream);
+  in.check(*out);
+}
+
+struct QueueHolderIOVec {
+  template <typename SerializerT>
+  void serialize(SerializerT& s) {
+    s | q | pq | st;
+  }
+
+  std::queue<std::vector<double>> q;
+  std::priority_queue<std::vector<double>> pq;
+  std::stack<std::vector<double>> st;
+};
+
+TEST_F(TestSerializeIOVec, test_iovec_queue_adaptors) {
+  QueueHolderIOVec in;
+  for (int i = 0; i < 3; i++) {
+    in.q.push(std::vector<double>(10000, 1.0 + i));
+    in.pq.push(std::vector<double>(10000, 4.0 + i));
+    in.st.push(std::vector<double>(10000, 7.0 + i));
+  }
+
+  // The adaptors are packed from temporary copies, which must not be
+  // referenced once packing is done
+  auto list = checkpoint::serializeIOVec(in, 1024);
+  auto bytes = flatten(*list);
+
+  auto flat = checkpoint::serialize(in);
+  EXPECT_EQ(
+    std::vector<char>(flat->getBuffer(), flat->getBuffer() + flat->getSize()),
+    bytes
+  );
+
+  auto out = checkpoint::deserialize<QueueHolderIOVec>(bytes.data());
+  ASSERT_EQ(out->q.size(), in.q.size());
+  ASSERT_EQ(out->pq.size(), in.pq.size());
+  ASSERT_EQ(out->st.size(), in.st.size());
+  while (!in.q.empty()) {
+    EXPECT_EQ(out->q.front(), in.q.front());
+    EXPECT_EQ(out->pq.top(), in.pq.top());
+    EXPECT_EQ(out->st.top(), in.st.top());
+    in.q.pop(); in.pq.pop(); in.st.pop();
+    out->q.pop(); out->pq.pop(); out->st.pop();
+  }
+}
+
+}}} // end namespace checkpoint::tests::unit
@@ -0,0 +1,224 @@
+/*
+//@HEADER
+// *****************************************************************************
+//
+//                          test_serialize_portable.cc
+//                 DARMA/magistrate => Serialization Library
+//
+// Copyright 2019 National Technology & Engineering Solutions of Sandia, LLC
+// (NTESS). Under the terms of Contract DE-NA0003525 with NTESS, the U.S.
+// Government retains certain rights in this software.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+//
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// * Neither the name of the copyright holder nor the names of its
+//   contributors may be used to endorse or promote products derived from this
+//   software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// Questions? Contact darma@sandia.gov
+//
+// *****************************************************************************
+//@HEADER
+*/
+
+#include <gtest/gtest.h>
+
+#include "test_harness.h"
+
+#include <checkpoint/checkpoint.h>
+#include <checkpoint/buffer/byte_order.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace checkpoint { namespace tests { namespace unit {
+
+using TestSerializePortable = TestHarness;
+
+enum struct Color : int16_t { Red = 1, Green = 0x0203 };
+
+struct UserObjectPortable {
+  UserObjectPortable() = default;
+  explicit UserObjectPortable(int n) {
+    for (int i = 0; i < n; i++) {
+      doubles.push_back(i * 1.5 - 7.25);
+      shorts.push_back(static_cast<uint16_t>(i * 257));
+      names.push_back("n" + std::to_string(i));
+    }
+  }
+
+  template <typename SerializerT>
+  void serialize(SerializerT& s) {
+    s | id | ratio | flag | color | doubles | shorts | names;
+  }
+
+  void check(UserObjectPortable const& o) const {
+    EXPECT_EQ(id, o.id);
+    EXPECT_EQ(ratio, o.ratio);
+    EXPECT_EQ(flag, o.flag);
+    EXPECT_EQ(color, o.color);
+    EXPECT_EQ(doubles, o.doubles);
+    EXPECT_EQ(shorts, o.shorts);
+    EXPECT_EQ(names, o.names);
+  }
+
+  int64_t id = 0x0102030405060708ll;
+  float ratio = 0.375f;
+  bool flag = true;
+  Color color = Color::Green;
+  std::vector<double> doubles;
+  std::vector<uint16_t> shorts;
+  std::vector<std::string> names;
+};
+
+template <typename U>
+static void checkSwap(std::size_t n) {
+  std::mt19937_64 gen(n);
+  std::vector<U> in(n), out(n, 0), ref(n);
+  for (std::size_t i = 0; i < n; i++) {
+    in[i] = static_cast<U>(gen());
+    U r = 0;
+    for (std::size_t b = 0; b < sizeof(U); b++) {
+      r = static_cast<U>(r << 8) | static_cast<U>((in[i] >> (8 * b)) & 0xff);
+    }
+    ref[i] = r;
+  }
+
+  auto const src = reinterpret_cast<char const*>(in.data());
+  buffer::byteSwap(reinterpret_cast<char*>(out.data()), src, n, sizeof(U));
+  EXPECT_EQ(out, ref) << "size=" << sizeof(U) << " n=" << n;
+
+  // In place
+  auto bytes = reinterpret_cast<char*>(in.data());
+  buffer::byteSwap(bytes, bytes, n, sizeof(U));
+  EXPECT_EQ(in, ref) << "size=" << sizeof(U) << " n=" << n;
+}
+
+TEST_F(TestSerializePortable, test_byte_swap_kernels) {
+  // Lengths cover empty input, partial vectors and vector tails
+  for (std::size_t n : {0ul, 1ul, 3ul, 7ul, 8ul, 15ul, 16ul, 17ul, 1001ul}) {
+    checkSwap<uint16_t>(n);
+    checkSwap<uint32_t>(n);
+    checkSwap<uint64_t>(n);
+  }
+}
+
+TEST_F(TestSerializePortable, test_portable_round_trip) {
+  UserObjectPortable in(1000);
+  auto bytes = checkpoint::serializePortable(in);
+  EXPECT_EQ(
+    bytes->getSize(), checkpoint::getSize(in) + buffer::portable_header_size
+  );
+
+  auto out = checkpoint::deserializePortable<UserObjectPortable>(
+    std::move(bytes)
+  );
+  in.check(*out);
+}
+
+TEST_F(TestSerializePortable, test_portable_payload_is_little_endian) {
+  uint32_t value = 0x01020304;
+  auto bytes = checkpoint::serializePortable(value);
+  auto const begin = bytes->getBuffer() + buffer::portable_header_size;
+  auto const end = bytes->getBuffer() + bytes->getSize();
+
+  char const little[] = {0x04, 0x03, 0x02, 0x01};
+  char const big[] = {0x01, 0x02, 0x03, 0x04};
+  EXPECT_NE(std::search(begin, end, little, little + 4), end);
+  EXPECT_EQ(std::search(begin, end, big, big + 4), end);
+}
+
+TEST_F(TestSerializePortable, test_swapping_serializers_round_trip) {
+  // Force the swapping path so it is exercised on any host
+  using SwapPacker = PortablePackerBuffer<buffer::ManagedBuffer, true>;
+  using SwapUnpacker = PortableUnpackerBuffer<buffer::UserBuffer, true>;
+
+  UserObjectPortable in(100);
+  auto const len = checkpoint::getSize(in);
+  auto p = dispatch::Standard::pack<UserObjectPortable, SwapPacker>(in, len);
+  dispatch::validatePackerBufferSize<UserObjectPortable>(p, len);
+  auto buf = p.extractPackedBuffer();
+
+  // The id is packed in the opposite order of the host
+  auto const swapped = __builtin_bswap64(static_cast<uint64_t>(in.id));
+  char id[sizeof(swapped)];
+  std::memcpy(id, &swapped, sizeof(swapped));
+  auto const end = buf->getBuffer() + len;
+  EXPECT_NE(std::search(buf->getBuffer(), end, id, id + sizeof(id)), end);
+
+  auto out = std::unique_ptr<UserObjectPortable>(
+    dispatch::Standard::unpack<UserObjectPortable, SwapUnpacker>(
+      dispatch::Standard::construct<UserObjectPortable>(
+        dispatch::Standard::allocate<UserObjectPortable>()
+      ),
+      buf->getBuffer()
+    )
+  );
+  in.check(*out);
+}
+
+TEST_F(TestSerializePortable, test_portable_header_errors) {
+  UserObjectPortable in(10);
+  auto bytes = checkpoint::serializePortable(in);
+  std::vector<char> good(
+    bytes->getBuffer(), bytes->getBuffer() + bytes->getSize()
+  );
+
+  // Plain bytes have no header
+  auto plain = checkpoint::serialize(in);
+  EXPECT_THROW(
+    checkpoint::deserializePortable<UserObjectPortable>(
+      plain->getBuffer(), plain->getSize()
+    ),
+    std::runtime_error
+  );
+
+  auto truncated = good;
+  truncated.pop_back();
+  EXPECT_THROW(
+    checkpoint::deserializePortable<UserObjectPortable>(
+      truncated.data(), truncated.size()
+    ),
+    std::runtime_error
+  );
+
+  auto wrong_order = good;
+  wrong_order[5] = 1;
+  EXPECT_THROW(
+    checkpoint::deserializePortable<UserObjectPortable>(
+      wrong_order.data(), wrong_order.size()
+    ),
+    std::runtime_error
+  );
+
+  auto out = checkpoint::deserializePortable<UserObjectPortable>(
+    good.data(), good.size()
+  );
+  in.check(*out);
+}
+
+}}} // end namespace checkpoint::tests::unit
@@ -0,0 +1,154 @@
+/*
+//@HEADER
+// *****************************************************************************
+//
+//                        test_serialize_single_pass.cc
+//                 DARMA/magistrate => Serialization Library
+//
+// Copyright 2019 National Technology & Engineering Solutions of Sandia, LLC
+// (NTESS). Under the terms of Contract DE-NA0003525 with NTESS, the U.S.
+// Government retains certain rights in this software.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+//
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// * Neither the name of the copyright holder nor the names of its
+//   contributors may be used to endorse or promote products derived from this
+//   software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// Questions? Contact darma@sandia.gov
+//
+// *****************************************************************************
+//@HEADER
+*/
+
+#include <gtest/gtest.h>
+
+#include "test_harness.h"
+
+#include <checkpoint/checkpoint.h>
+
+#include <cstdint>
+#include <cstring>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace checkpoint { namespace tests { namespace unit {
+
+using TestSerializeSinglePass = TestHarness;
+
+struct UserObjectNested {
+  UserObjectNested() = default;
+  explicit UserObjectNested(int in_x) : x(in_x), name(std::to_string(in_x)) { }
+
+  template <typename SerializerT>
+  void serialize(SerializerT& s) {
+    s | x | name;
+  }
+
+  int x = 0;
+  std::string name;
+};
+
+struct UserObjectSinglePass {
+  UserObjectSinglePass() = default;
+
+  explicit UserObjectSinglePass(int n) {
+    for (int i = 0; i < n; i++) {
+      values.push_back(i * 1.5);
+      table[i] = std::vector<std::string>(i % 7, std::to_string(i));
+    }
+    nested = std::make_unique<UserObjectNested>(n);
+  }
+
+  template <typename SerializerT>
+  void serialize(SerializerT& s) {
+    s | values | table | nested;
+  }
+
+  void check(UserObjectSinglePass const& other) const {
+    EXPECT_EQ(values, other.values);
+    EXPECT_EQ(table, other.table);
+    ASSERT_NE(nested, nullptr);
+    ASSERT_NE(other.nested, nullptr);
+    EXPECT_EQ(nested->x, other.nested->x);
+    EXPECT_EQ(nested->name, other.nested->name);
+  }
+
+  std::vector<double> values;
+  std::map<int, std::vector<std::string>> table;
+  std::unique_ptr<UserObjectNested> nested;
+};
+
+TEST_F(TestSerializeSinglePass, test_single_pass_round_trip) {
+  UserObjectSinglePass in(100);
+
+  auto ret = checkpoint::serializeSinglePass(in);
+  EXPECT_EQ(ret->getSize(), checkpoint::getSize(in));
+
+  auto out = checkpoint::deserialize<UserObjectSinglePass>(ret->getBuffer());
+  in.check(*out);
+}
+
+TEST_F(TestSerializeSinglePass, test_single_pass_matches_two_pass) {
+  UserObjectSinglePass in(250);
+
+  // Start with a tiny buffer so the packer has to grow many times
+  auto single = checkpoint::serializeSinglePass(in, 1);
+  auto two_pass = checkpoint::serialize(in);
+
+  ASSERT_EQ(single->getSize(), two_pass->getSize());
+  EXPECT_EQ(
+    std::memcmp(single->getBuffer(), two_pass->getBuffer(), single->getSize()),
+    0
+  );
+}
+
+TEST_F(TestSerializeSinglePass, test_single_pass_grows_into_huge_pages) {
+  std::vector<double> in(1 << 20);
+  for (std::size_t i = 0; i < in.size(); i++) {
+    in[i] = i * 0.25;
+  }
+
+  // Growing past the huge-page threshold moves to huge-page storage
+  auto ret = checkpoint::serializeSinglePass(in, 1);
+  EXPECT_EQ(ret->getSize(), checkpoint::getSize(in));
+# if defined(checkpoint_has_posix_memalign)
+  auto const addr = reinterpret_cast<std::uintptr_t>(ret->getBuffer());
+  EXPECT_EQ(addr % buffer::huge_page_size, 0u);
+# endif
+
+  auto out = checkpoint::deserialize<std::vector<double>>(ret->getBuffer());
+  EXPECT_EQ(*out, in);
+}
+
+TEST_F(TestSerializeSinglePass, test_single_pass_empty_vector) {
+  std::vector<int> in;
+
+  auto ret = checkpoint::serializeSinglePass(in, 0);
+  auto out = checkpoint::deserialize<std::vector<int>>(ret->getBuffer());
+  EXPECT_TRUE(out->empty());
+}
+
+}}} // end namespace checkpoint::tests::unit
@@ -45,6 +45,7 @@
 
 #include <checkpoint/checkpoint.h>
 #include <fstream>
+#include <sstream>
 
 #include <gtest/gtest.h>
 
@@ -170,6 +171,76 @@ TYPED_TEST_P(TestSerializeStreamInPlace, test_serialize_stream_multi_in_place) {
   }
 }
 
+struct TestSerializeStreamBuffered : TestHarness { };
+
+struct Mixed {
+  Mixed() = default;
+  explicit Mixed(int n) : large_(n) {
+    for (int i = 0; i < n; i++) {
+      small_.push_back(std::to_string(i));
+      large_[i] = i * 0.5;
+    }
+  }
+
+  template <typename SerializerT>
+  void serialize(SerializerT& s) {
+    s | small_ | large_;
+  }
+
+  std::vector<std::string> small_;
+  std::vector<double> large_;
+};
+
+TEST_F(TestSerializeStreamBuffered, test_back_to_back_objects) {
+  // Buffers smaller, larger and absent relative to the large member
+  for (SerialSizeType buffer_size : {0ull, 7ull, 4096ull, 1ull << 20}) {
+    Mixed a(100), b(1000);
+    int tail = 42;
+
+    std::stringstream stream;
+    checkpoint::serializeToStream(a, stream, buffer_size);
+    checkpoint::serializeToStream(b, stream, buffer_size);
+    checkpoint::serializeToStream(tail, stream, buffer_size);
+    EXPECT_EQ(
+      static_cast<SerialSizeType>(stream.tellp()),
+      checkpoint::getSize(a) + checkpoint::getSize(b) +
+        checkpoint::getSize(tail)
+    );
+
+    auto out_a = checkpoint::deserializeFromStream<Mixed>(stream, buffer_size);
+    EXPECT_EQ(out_a->small_, a.small_);
+    EXPECT_EQ(out_a->large_, a.large_);
+
+    // Read-ahead past the first object must have been given back
+    EXPECT_EQ(
+      static_cast<SerialSizeType>(stream.tellg()), checkpoint::getSize(a)
+    );
+
+    Mixed out_b;
+    checkpoint::deserializeInPlaceFromStream(stream, &out_b, buffer_size);
+    EXPECT_EQ(out_b.small_, b.small_);
+    EXPECT_EQ(out_b.large_, b.large_);
+
+    auto out_tail = checkpoint::deserializeFromStream<int>(stream, buffer_size);
+    EXPECT_EQ(*out_tail, tail);
+    EXPECT_TRUE(stream.good());
+  }
+}
+
+TEST_F(TestSerializeStreamBuffered, test_truncated_stream_throws) {
+  Mixed a(100);
+
+  std::stringstream stream;
+  checkpoint::serializeToStream(a, stream);
+  auto bytes = stream.str();
+  bytes.resize(bytes.size() - 1);
+
+  std::stringstream truncated(bytes);
+  EXPECT_THROW(
+    checkpoint::deserializeFromStream<Mixed>(truncated), std::runtime_error
+  );
+}
+
 using ConstructTypes = ::testing::Types<
   UserObjectA,
   UserObjectB,
@@ -0,0 +1,237 @@
+/*
+//@HEADER
+// *****************************************************************************
+//
+//                          test_sharded_checkpoint.cc
+//                 DARMA/magistrate => Serialization Library
+//
+// Copyright 2019 National Technology & Engineering Solutions of Sandia, LLC
+// (NTESS). Under the terms of Contract DE-NA0003525 with NTESS, the U.S.
+// Government retains certain rights in this software.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+//
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// * Neither the name of the copyright holder nor the names of its
+//   contributors may be used to endorse or promote products derived from this
+//   software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// Questions? Contact darma@sandia.gov
+//
+// *****************************************************************************
+//@HEADER
+*/
+
+#include <gtest/gtest.h>
+
+#include "test_harness.h"
+
+#include <checkpoint/checkpoint.h>
+#include <checkpoint/buffer/shard_image.h>
+
+#include <cstdio>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <unistd.h>
+
+namespace checkpoint { namespace tests { namespace unit {
+
+using TestShardedCheckpoint = TestHarness;
+
+struct UserObjectSharded {
+  UserObjectSharded() = default;
+  explicit UserObjectSharded(int n) {
+    for (int i = 0; i < n; i++) {
+      values.push_back(i * 5 + 1);
+    }
+  }
+
+  template <typename SerializerT>
+  void serialize(SerializerT& s) {
+    s | name | values;
+  }
+
+  void check(UserObjectSharded const& o) const {
+    EXPECT_EQ(name, o.name);
+    EXPECT_EQ(values, o.values);
+  }
+
+  std::string name = "sharded";
+  std::vector<int64_t> values;
+};
+
+static std::size_t fileSize(std::string const& file) {
+  std::ifstream f(file, std::ios::binary | std::ios::ate);
+  return static_cast<std::size_t>(f.tellg());
+}
+
+static bool fileExists(std::string const& file) {
+  return access(file.c_str(), F_OK) == 0;
+}
+
+static void removeShardedImage(std::string const& dir) {
+  std::remove(buffer::getShardManifestFile(dir).c_str());
+  for (int i = 0; fileExists(buffer::getShardFile(dir, i)); i++) {
+    std::remove(buffer::getShardFile(dir, i).c_str());
+  }
+  rmdir(dir.c_str());
+}
+
+TEST_F(TestShardedCheckpoint, test_sharded_round_trip) {
+  std::string const dir = "test_sharded_round_trip";
+  FileWriteOptions options;
+  options.durability = FileDurability::None;
+
+  UserObjectSharded in(100000);
+  auto const size = checkpoint::getSize(in);
+
+  for (unsigned shards : {1u, 3u, 8u}) {
+    checkpoint::serializeToDirectory(in, dir, shards, options);
+
+    // The shards hold the packed bytes, cut into consecutive pieces
+    std::size_t total = 0;
+    for (unsigned i = 0; i < shards; i++) {
+      total += fileSize(buffer::getShardFile(dir, i));
+    }
+    EXPECT_EQ(total, size);
+
+    // Any number of readers restores any number of shards
+    for (unsigned threads : {0u, 1u, 2u, 5u}) {
+      auto out = checkpoint::deserializeFromDirectory<UserObjectSharded>(
+        dir, threads
+      );
+      in.check(*out);
+    }
+  }
+
+  removeShardedImage(dir);
+}
+
+TEST_F(TestShardedCheckpoint, test_sharded_rewrite_fewer_shards) {
+  std::string const dir = "test_sharded_rewrite";
+  FileWriteOptions options;
+  options.durability = FileDurability::None;
+
+  UserObjectSharded a(50000);
+  checkpoint::serializeToDirectory(a, dir, 6, options);
+  EXPECT_TRUE(fileExists(buffer::getShardFile(dir, 5)));
+
+  UserObjectSharded b(20000);
+  b.name = "rewritten";
+  checkpoint::serializeToDirectory(b, dir, 2, options);
+  EXPECT_TRUE(fileExists(buffer::getShardFile(dir, 1)));
+  EXPECT_FALSE(fileExists(buffer::getShardFile(dir, 2)));
+  EXPECT_FALSE(fileExists(buffer::getShardFile(dir, 5)));
+
+  auto out = checkpoint::deserializeFromDirectory<UserObjectSharded>(dir, 4);
+  b.check(*out);
+
+  removeShardedImage(dir);
+}
+
+TEST_F(TestShardedCheckpoint, test_sharded_small_image) {
+  std::string const dir = "test_sharded_small";
+  FileWriteOptions options;
+  options.durability = FileDurability::None;
+
+  // Shards are page aligned, so all but the first are empty
+  UserObjectSharded in(10);
+  checkpoint::serializeToDirectory(in, dir, 4, options);
+  EXPECT_EQ(fileSize(buffer::getShardFile(dir, 0)), checkpoint::getSize(in));
+  EXPECT_EQ(fileSize(buffer::getShardFile(dir, 3)), 0u);
+
+  auto out = checkpoint::deserializeFromDirectory<UserObjectSharded>(dir);
+  in.check(*out);
+
+  removeShardedImage(dir);
+}
+
+TEST_F(TestShardedCheckpoint, test_sharded_checksum) {
+  std::string const dir = "test_sharded_checksum";
+  FileWriteOptions options;
+  options.durability = FileDurability::None;
+  options.checksum.enabled = true;
+  options.checksum.chunk_size = 4096;
+
+  UserObjectSharded in(100000);
+  checkpoint::serializeToDirectory(in, dir, 4, options);
+
+  FileReadOptions read_options;
+  read_options.checksum = ChecksumVerify::Require;
+  auto out = checkpoint::deserializeFromDirectory<UserObjectSharded>(
+    dir, 0, read_options
+  );
+  in.check(*out);
+
+  // Corrupt one byte of the third shard
+  auto const shard = buffer::getShardFile(dir, 2);
+  {
+    std::fstream f(shard, std::ios::in | std::ios::out | std::ios::binary);
+    f.seekp(100);
+    f.put('\x5a');
+  }
+  EXPECT_THROW(
+    checkpoint::deserializeFromDirectory<UserObjectSharded>(
+      dir, 0, read_options
+    ),
+    buffer::checksum_error
+  );
+
+  removeShardedImage(dir);
+}
+
+TEST_F(TestShardedCheckpoint, test_sharded_errors) {
+  std::string const dir = "test_sharded_errors";
+  FileWriteOptions options;
+  options.durability = FileDurability::None;
+
+  UserObjectSharded in(1000);
+  EXPECT_THROW(
+    checkpoint::serializeToDirectory(in, dir, 0, options), std::runtime_error
+  );
+
+  checkpoint::serializeToDirectory(in, dir, 2, options);
+
+  // A shard that does not match the manifest is rejected
+  {
+    std::ofstream f(buffer::getShardFile(dir, 0), std::ios::app);
+    f << "extra";
+  }
+  EXPECT_THROW(
+    checkpoint::deserializeFromDirectory<UserObjectSharded>(dir),
+    std::runtime_error
+  );
+
+  // Without a manifest the directory holds no image
+  std::remove(buffer::getShardManifestFile(dir).c_str());
+  EXPECT_THROW(
+    checkpoint::deserializeFromDirectory<UserObjectSharded>(dir),
+    std::runtime_error
+  );
+
+  removeShardedImage(dir);
+}
+
+}}} // end namespace checkpoint::tests::unit
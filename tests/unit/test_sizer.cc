@@ -48,10 +48,19 @@
 #include <checkpoint/checkpoint.h>
 #include <checkpoint/dispatch/type_registry.h>
 
+#include <cstdint>
+
 namespace checkpoint { namespace tests { namespace unit {
 
 struct TestSizer : TestHarness { };
 
+#if defined(SERIALIZATION_HASH_CHECKING)
+// Every object serialized by a serialize method is followed by its hash
+constexpr std::size_t structure_hash_size = sizeof(std::uint32_t);
+#else
+constexpr std::size_t structure_hash_size = 0;
+#endif
+
 struct Test1 {
   int a;
 
@@ -76,8 +85,10 @@ TEST_F(TestSizer, test_sizer_1) {
   // Expected is
   // sizeof(int) +
   // sizeof(DecodedIndex) + sizeof(SerialSizeType) for Test1
+  // structure_hash_size for Test1
   auto const expectedSize = sizeof(int) +
-    sizeof(dispatch::typeregistry::DecodedIndex) + sizeof(SerialSizeType);
+    sizeof(dispatch::typeregistry::DecodedIndex) + sizeof(SerialSizeType) +
+    structure_hash_size;
 #endif
 
   EXPECT_EQ(size, expectedSize);
@@ -108,8 +119,10 @@ TEST_F(TestSizer, test_sizer_2) {
   // Expected is
   // 2 * sizeof(int) +
   // sizeof(DecodedIndex) + sizeof(SerialSizeType) for Test2
+  // structure_hash_size for Test2
   auto const expectedSize = 2 * sizeof(int) +
-    sizeof(dispatch::typeregistry::DecodedIndex) + sizeof(SerialSizeType);
+    sizeof(dispatch::typeregistry::DecodedIndex) + sizeof(SerialSizeType) +
+    structure_hash_size;
 #endif
 
   EXPECT_EQ(size, expectedSize);
@@ -141,8 +154,10 @@ TEST_F(TestSizer, test_sizer_3) {
   // Expected is
   // 3 * sizeof(int) +
   // sizeof(DecodedIndex) + sizeof(SerialSizeType) for Test3
+  // structure_hash_size for Test3
   auto const expectedSize = 3 * sizeof(int) +
-    sizeof(dispatch::typeregistry::DecodedIndex) + sizeof(SerialSizeType);
+    sizeof(dispatch::typeregistry::DecodedIndex) + sizeof(SerialSizeType) +
+    structure_hash_size;
 #endif
 
   EXPECT_EQ(size, expectedSize);
@@ -175,8 +190,10 @@ TEST_F(TestSizer, test_sizer_4) {
   // Expected is
   // 4 * sizeof(int) +
   // sizeof(DecodedIndex) + sizeof(SerialSizeType) for Test4
+  // structure_hash_size for Test4
   auto const expectedSize = 4 * sizeof(int) +
-    sizeof(dispatch::typeregistry::DecodedIndex) + sizeof(SerialSizeType);
+    sizeof(dispatch::typeregistry::DecodedIndex) + sizeof(SerialSizeType) +
+    structure_hash_size;
 #endif
 
   EXPECT_EQ(size, expectedSize);
@@ -209,8 +226,10 @@ TEST_F(TestSizer, test_sizer_5) {
   // Expected is
   // sizeof(int) + 3 * sizeof(Test5::b::char) +
   // sizeof(DecodedIndex) + sizeof(SerialSizeType) for Test5
+  // 2 * structure_hash_size for Test5 and Test5::b
   auto const expectedSize = sizeof(int) + 3 * sizeof(char) +
-    sizeof(dispatch::typeregistry::DecodedIndex) + sizeof(SerialSizeType);
+    sizeof(dispatch::typeregistry::DecodedIndex) + sizeof(SerialSizeType) +
+    2 * structure_hash_size;
 #endif
 
   EXPECT_EQ(size, expectedSize);
@@ -254,9 +273,11 @@ TEST_F(TestSizer, test_sizer_6) {
   // sizeof(Test6::b::capacity()) + sizeof(Test6::b::size()) +
   // 7 * sizeof(Test5::b::char) +
   // sizeof(DecodedIndex) + sizeof(SerialSizeType) for Test6
+  // 2 * structure_hash_size for Test6 and Test6::b
   auto const expectedSize = sizeof(double) + sizeof(CapacityT) + sizeof(SizeT) +
     7 * sizeof(float) + sizeof(dispatch::typeregistry::DecodedIndex) +
-    sizeof(SerialSizeType);
+    sizeof(SerialSizeType) +
+    2 * structure_hash_size;
 #endif
 
   EXPECT_EQ(size, expectedSize);
@@ -0,0 +1,236 @@
+/*
+//@HEADER
+// *****************************************************************************
+//
+//                        test_type_grouped_serialize.cc
+//                 DARMA/magistrate => Serialization Library
+//
+// Copyright 2019 National Technology & Engineering Solutions of Sandia, LLC
+// (NTESS). Under the terms of Contract DE-NA0003525 with NTESS, the U.S.
+// Government retains certain rights in this software.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+//
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// * Neither the name of the copyright holder nor the names of its
+//   contributors may be used to endorse or promote products derived from this
+//   software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// Questions? Contact darma@sandia.gov
+//
+// *****************************************************************************
+//@HEADER
+*/
+
+#include "test_harness.h"
+
+#include <checkpoint/checkpoint.h>
+
+#include <gtest/gtest.h>
+
+#include <memory>
+#include <vector>
+
+namespace checkpoint { namespace tests { namespace unit {
+
+struct TestTypeGroupedSerialize : TestHarness { };
+
+struct GroupBase : SerializableBase<GroupBase> {
+  GroupBase() = default;
+  explicit GroupBase(int in_a) : a(in_a) { }
+
+  template <typename SerializerT>
+  void serialize(SerializerT& s) {
+    s | a;
+  }
+
+  int a = 0;
+};
+
+struct GroupLeft : SerializableDerived<GroupLeft, GroupBase> {
+  GroupLeft() = default;
+  explicit GroupLeft(int in_a) : SerializableDerived(in_a), b(in_a * 0.5) { }
+
+  template <typename SerializerT>
+  void serialize(SerializerT& s) {
+    s | b;
+  }
+
+  double b = 0;
+};
+
+struct GroupRight : SerializableDerived<GroupRight, GroupBase> {
+  GroupRight() = default;
+  explicit GroupRight(int in_a)
+    : SerializableDerived(in_a), c(in_a, in_a + 1)
+  { }
+
+  template <typename SerializerT>
+  void serialize(SerializerT& s) {
+    s | c;
+  }
+
+  std::vector<int> c;
+};
+
+struct GroupRightMost : SerializableDerived<GroupRightMost, GroupRight> {
+  GroupRightMost() = default;
+  explicit GroupRightMost(int in_a) : SerializableDerived(in_a), d(-in_a) { }
+
+  template <typename SerializerT>
+  void serialize(SerializerT& s) {
+    s | d;
+  }
+
+  long d = 0;
+};
+
+struct GroupZero : SerializableDerived<GroupZero, GroupBase> {
+  GroupZero() = default;
+  explicit GroupZero(int in_a) : SerializableDerived(in_a) { }
+};
+
+}}} // end namespace checkpoint::tests::unit
+
+template <>
+struct checkpoint::VirtualTypeId<checkpoint::tests::unit::GroupZero> {
+  static constexpr checkpoint::dispatch::vrt::TypeIdx value = 0;
+};
+
+namespace checkpoint { namespace tests { namespace unit {
+
+struct GroupHolder {
+  template <typename SerializerT>
+  void serialize(SerializerT& s) {
+    checkpoint::serializeTypeGrouped(s, elms);
+  }
+
+  std::vector<std::unique_ptr<GroupBase>> elms;
+};
+
+static void checkElement(GroupBase const* out, GroupBase const* in) {
+  if (in == nullptr) {
+    EXPECT_EQ(out, nullptr);
+    return;
+  }
+  ASSERT_NE(out, nullptr);
+  EXPECT_EQ(typeid(*out), typeid(*in));
+  EXPECT_EQ(out->a, in->a);
+  if (auto l = dynamic_cast<GroupLeft const*>(in)) {
+    EXPECT_EQ(static_cast<GroupLeft const*>(out)->b, l->b);
+  }
+  if (auto r = dynamic_cast<GroupRight const*>(in)) {
+    EXPECT_EQ(static_cast<GroupRight const*>(out)->c, r->c);
+  }
+  if (auto m = dynamic_cast<GroupRightMost const*>(in)) {
+    EXPECT_EQ(static_cast<GroupRightMost const*>(out)->d, m->d);
+  }
+}
+
+TEST_F(TestTypeGroupedSerialize, test_type_grouped_roundtrip) {
+  GroupHolder in;
+  for (int i = 0; i < 100; i++) {
+    switch (i % 5) {
+    case 0: in.elms.push_back(std::make_unique<GroupBase>(i)); break;
+    case 1: in.elms.push_back(std::make_unique<GroupLeft>(i)); break;
+    case 2: in.elms.push_back(std::make_unique<GroupRight>(i)); break;
+    case 3: in.elms.push_back(std::make_unique<GroupRightMost>(i)); break;
+    default: in.elms.push_back(nullptr); break;
+    }
+  }
+
+  auto ret = checkpoint::serialize(in);
+  EXPECT_EQ(ret->getSize(), checkpoint::getSize(in));
+
+  auto out = checkpoint::deserialize<GroupHolder>(ret->getBuffer());
+  ASSERT_EQ(out->elms.size(), in.elms.size());
+  for (std::size_t i = 0; i < in.elms.size(); i++) {
+    checkElement(out->elms[i].get(), in.elms[i].get());
+  }
+}
+
+TEST_F(TestTypeGroupedSerialize, test_type_grouped_runs_are_compact) {
+  // Adjacent objects of one type share a single entry of the type column
+  GroupHolder grouped;
+  std::vector<std::unique_ptr<GroupBase>> plain;
+  for (int i = 0; i < 1000; i++) {
+    grouped.elms.push_back(std::make_unique<GroupLeft>(i));
+    plain.push_back(std::make_unique<GroupLeft>(i));
+  }
+
+  auto const plain_size = checkpoint::getSize(plain);
+  auto const grouped_size = checkpoint::getSize(grouped);
+  EXPECT_LE(grouped_size + 999 * sizeof(dispatch::vrt::TypeIdx), plain_size);
+
+  auto ret = checkpoint::serialize(grouped);
+  auto out = checkpoint::deserialize<GroupHolder>(ret->getBuffer());
+  ASSERT_EQ(out->elms.size(), grouped.elms.size());
+  for (std::size_t i = 0; i < grouped.elms.size(); i++) {
+    checkElement(out->elms[i].get(), grouped.elms[i].get());
+  }
+}
+
+TEST_F(TestTypeGroupedSerialize, test_type_grouped_in_place) {
+  GroupHolder in;
+  in.elms.push_back(std::make_unique<GroupLeft>(1));
+  in.elms.push_back(std::make_unique<GroupRight>(2));
+  auto ret = checkpoint::serialize(in);
+
+  // The first element keeps its object, the second is replaced
+  GroupHolder out;
+  out.elms.push_back(std::make_unique<GroupLeft>(7));
+  out.elms.push_back(std::make_unique<GroupLeft>(8));
+  out.elms.push_back(std::make_unique<GroupLeft>(9));
+  auto const kept = out.elms[0].get();
+  checkpoint::deserializeInPlace<GroupHolder>(ret->getBuffer(), &out);
+
+  ASSERT_EQ(out.elms.size(), 2u);
+  EXPECT_EQ(out.elms[0].get(), kept);
+  checkElement(out.elms[0].get(), in.elms[0].get());
+  checkElement(out.elms[1].get(), in.elms[1].get());
+}
+
+TEST_F(TestTypeGroupedSerialize, test_type_grouped_zero_type_id_and_null) {
+  // Null elements must not be taken for objects of the type with id zero
+  GroupHolder in;
+  in.elms.push_back(std::make_unique<GroupZero>(1));
+  in.elms.push_back(nullptr);
+  in.elms.push_back(std::make_unique<GroupZero>(2));
+  in.elms.push_back(nullptr);
+  in.elms.push_back(nullptr);
+
+  auto ret = checkpoint::serialize(in);
+  auto out = checkpoint::deserialize<GroupHolder>(ret->getBuffer());
+  ASSERT_EQ(out->elms.size(), in.elms.size());
+  for (std::size_t i = 0; i < in.elms.size(); i++) {
+    checkElement(out->elms[i].get(), in.elms[i].get());
+  }
+}
+
+TEST_F(TestTypeGroupedSerialize, test_type_grouped_empty) {
+  GroupHolder in;
+  auto ret = checkpoint::serialize(in);
+  auto out = checkpoint::deserialize<GroupHolder>(ret->getBuffer());
+  EXPECT_TRUE(out->elms.empty());
+}
+
+}}} // end namespace checkpoint::tests::unit
@@ -0,0 +1,111 @@
+/*
+//@HEADER
+// *****************************************************************************
+//
+//                            test_type_registry.cc
+//                 DARMA/magistrate => Serialization Library
+//
+// Copyright 2019 National Technology & Engineering Solutions of Sandia, LLC
+// (NTESS). Under the terms of Contract DE-NA0003525 with NTESS, the U.S.
+// Government retains certain rights in this software.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+//
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// * Neither the name of the copyright holder nor the names of its
+//   contributors may be used to endorse or promote products derived from this
+//   software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// Questions? Contact darma@sandia.gov
+//
+// *****************************************************************************
+//@HEADER
+*/
+
+#include <gtest/gtest.h>
+
+#include "test_harness.h"
+
+#include <checkpoint/checkpoint.h>
+
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace checkpoint { namespace tests { namespace unit {
+
+using TestTypeRegistry = TestHarness;
+
+namespace typeregistry = dispatch::typeregistry;
+
+struct RegistryProbe { };
+
+template <int N>
+struct RegistryTag { };
+
+TEST_F(TestTypeRegistry, test_type_registry_names) {
+  auto const idx = typeregistry::getTypeIdx<RegistryProbe>();
+  EXPECT_TRUE(typeregistry::validateIndex(idx));
+  EXPECT_NE(idx, typeregistry::getTypeIdx<RegistryTag<1>>());
+
+  auto const& name = typeregistry::getTypeName<RegistryProbe>();
+  EXPECT_NE(name.find("RegistryProbe"), std::string::npos) << name;
+
+  // The demangled name is kept, so later lookups return the same string
+  EXPECT_EQ(&name, &typeregistry::getTypeNameForIdx(idx));
+  EXPECT_NE(
+    typeregistry::getTypeName<RegistryTag<1>>().find("RegistryTag<1>"),
+    std::string::npos
+  );
+}
+
+TEST_F(TestTypeRegistry, test_type_registry_unknown_index) {
+  EXPECT_TRUE(typeregistry::getTypeNameForIdx(0).empty());
+
+  auto const past_end = static_cast<typeregistry::DecodedIndex>(
+    (0xFFFF << 8) | typeregistry::dead_mark
+  );
+  EXPECT_GT(0xFFFFu, typeregistry::getNumRegistered());
+  EXPECT_TRUE(typeregistry::getTypeNameForIdx(past_end).empty());
+}
+
+TEST_F(TestTypeRegistry, test_type_registry_concurrent_lookup) {
+  auto const idx = typeregistry::getTypeIdx<RegistryTag<2>>();
+
+  std::vector<std::string const*> names(8, nullptr);
+  std::vector<std::thread> threads;
+  for (std::size_t i = 0; i < names.size(); i++) {
+    threads.emplace_back([&names, i, idx]{
+      names[i] = &typeregistry::getTypeNameForIdx(idx);
+    });
+  }
+  for (auto& t : threads) {
+    t.join();
+  }
+
+  for (auto const name : names) {
+    EXPECT_EQ(name, names[0]);
+  }
+  EXPECT_NE(names[0]->find("RegistryTag<2>"), std::string::npos);
+}
+
+}}} // end namespace checkpoint::tests::unit
@@ -0,0 +1,153 @@
+/*
+//@HEADER
+// *****************************************************************************
+//
+//                     test_virtual_serializer_registry.cc
+//                 DARMA/magistrate => Serialization Library
+//
+// Copyright 2019 National Technology & Engineering Solutions of Sandia, LLC
+// (NTESS). Under the terms of Contract DE-NA0003525 with NTESS, the U.S.
+// Government retains certain rights in this software.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+//
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// * Neither the name of the copyright holder nor the names of its
+//   contributors may be used to endorse or promote products derived from this
+//   software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// Questions? Contact darma@sandia.gov
+//
+// *****************************************************************************
+//@HEADER
+*/
+
+#include "test_harness.h"
+
+#include <checkpoint/checkpoint.h>
+
+#include <gtest/gtest.h>
+
+#include <memory>
+#include <vector>
+
+namespace checkpoint { namespace tests { namespace unit {
+
+struct TestVirtualSerializerRegistry : TestHarness { };
+
+struct RegBase : SerializableBase<RegBase> {
+  RegBase() = default;
+  explicit RegBase(int in_a) : a(in_a) { }
+
+  template <typename SerializerT>
+  void serialize(SerializerT& s) {
+    s | a;
+  }
+
+  virtual int value() const { return a; }
+
+  int a = 0;
+};
+
+struct RegMiddle : SerializableDerived<RegMiddle, RegBase> {
+  RegMiddle() = default;
+  RegMiddle(int in_a, double in_b) : SerializableDerived(in_a), b(in_b) { }
+
+  template <typename SerializerT>
+  void serialize(SerializerT& s) {
+    s | b;
+  }
+
+  int value() const override { return a + static_cast<int>(b); }
+
+  double b = 0;
+};
+
+struct RegLeaf : SerializableDerived<RegLeaf, RegMiddle> {
+  RegLeaf() = default;
+  RegLeaf(int in_a, double in_b, std::vector<int> in_c)
+    : SerializableDerived(in_a, in_b), c(std::move(in_c))
+  { }
+
+  template <typename SerializerT>
+  void serialize(SerializerT& s) {
+    s | c;
+  }
+
+  int value() const override {
+    return RegMiddle::value() + static_cast<int>(c.size());
+  }
+
+  std::vector<int> c;
+};
+
+TEST_F(TestVirtualSerializerRegistry, test_base_table_lookup) {
+  using namespace dispatch::vrt::serializer_registry;
+
+  std::vector<std::unique_ptr<RegBase>> in;
+  in.push_back(std::make_unique<RegLeaf>(1, 2.0, std::vector<int>{1, 2}));
+  checkpoint::getSize(in);
+
+  // Every level resolves the base entry of a serializer to its own entry for
+  // the same serializer
+  auto const base_idx = makeObjIdx<RegBase, Sizer>();
+  EXPECT_EQ(
+    getBaseIdx<RegMiddle>(base_idx),
+    getObjIdx<RegMiddle>(makeObjIdx<RegMiddle, Sizer>())
+  );
+  EXPECT_EQ(
+    getBaseIdx<RegLeaf>(base_idx),
+    getObjIdx<RegLeaf>(makeObjIdx<RegLeaf, Sizer>())
+  );
+  EXPECT_EQ(
+    getBaseIdx<RegLeaf>(base_idx), (&dispatchSerializer<RegLeaf, Sizer>)
+  );
+}
+
+TEST_F(TestVirtualSerializerRegistry, test_mixed_hierarchy_round_trip) {
+  std::vector<std::unique_ptr<RegBase>> in;
+  for (int i = 0; i < 300; i++) {
+    switch (i % 3) {
+    case 0: in.push_back(std::make_unique<RegBase>(i)); break;
+    case 1: in.push_back(std::make_unique<RegMiddle>(i, 0.5 * i)); break;
+    default:
+      in.push_back(
+        std::make_unique<RegLeaf>(i, 1.5, std::vector<int>(i % 7, i))
+      );
+      break;
+    }
+  }
+
+  auto ret = checkpoint::serialize(in);
+  auto out = checkpoint::deserialize<std::vector<std::unique_ptr<RegBase>>>(
+    ret->getBuffer()
+  );
+  ASSERT_EQ(out->size(), in.size());
+  for (std::size_t i = 0; i < in.size(); i++) {
+    auto const& expected = *in[i];
+    auto const& actual = *(*out)[i];
+    EXPECT_EQ(typeid(actual), typeid(expected));
+    EXPECT_EQ(actual.value(), expected.value());
+  }
+}
+
+}}} // end namespace checkpoint::tests::unit
@@ -0,0 +1,151 @@
+/*
+//@HEADER
+// *****************************************************************************
+//
+//                           test_virtual_type_id.cc
+//                 DARMA/magistrate => Serialization Library
+//
+// Copyright 2019 National Technology & Engineering Solutions of Sandia, LLC
+// (NTESS). Under the terms of Contract DE-NA0003525 with NTESS, the U.S.
+// Government retains certain rights in this software.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+//
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// * Neither the name of the copyright holder nor the names of its
+//   contributors may be used to endorse or promote products derived from this
+//   software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// Questions? Contact darma@sandia.gov
+//
+// *****************************************************************************
+//@HEADER
+*/
+
+#include "test_harness.h"
+
+#include <checkpoint/checkpoint.h>
+
+#include <gtest/gtest.h>
+
+#include <cstring>
+#include <memory>
+#include <stdexcept>
+#include <vector>
+
+namespace checkpoint { namespace tests { namespace unit {
+
+struct TestVirtualTypeId : TestHarness { };
+
+struct IdBase : SerializableBase<IdBase> {
+  template <typename SerializerT>
+  void serialize(SerializerT& s) {
+    s | a;
+  }
+
+  int a = 1;
+};
+
+struct IdHashed : SerializableDerived<IdHashed, IdBase> {
+  template <typename SerializerT>
+  void serialize(SerializerT& s) {
+    s | b;
+  }
+
+  double b = 2.0;
+};
+
+struct IdDeclared : SerializableDerived<IdDeclared, IdBase> {
+  template <typename SerializerT>
+  void serialize(SerializerT& s) {
+    s | c;
+  }
+
+  float c = 3.0f;
+};
+
+}}} // end namespace checkpoint::tests::unit
+
+template <>
+struct checkpoint::VirtualTypeId<checkpoint::tests::unit::IdDeclared> {
+  static constexpr checkpoint::dispatch::vrt::TypeIdx value = 424242;
+};
+
+namespace checkpoint { namespace tests { namespace unit {
+
+using dispatch::vrt::TypeIdx;
+
+TEST_F(TestVirtualTypeId, test_type_id_hash_is_stable) {
+  // Ids written by earlier builds must keep resolving, so the name hash must
+  // not change
+  auto const h = dispatch::typeregistry::hashTypeName("N3foo3BarE");
+  EXPECT_EQ(h, 0xdade113d5435555full);
+
+  auto const id = dispatch::vrt::objregistry::makeObjIdx<IdHashed>();
+  EXPECT_EQ(id, dispatch::vrt::objregistry::makeTypeId<IdHashed>());
+  EXPECT_GE(id, 0);
+}
+
+TEST_F(TestVirtualTypeId, test_declared_type_id) {
+  EXPECT_EQ(dispatch::vrt::objregistry::makeObjIdx<IdDeclared>(), 424242);
+
+  std::vector<std::unique_ptr<IdBase>> in;
+  in.push_back(std::make_unique<IdHashed>());
+  in.push_back(std::make_unique<IdDeclared>());
+  in.push_back(std::make_unique<IdBase>());
+
+  auto ret = checkpoint::serialize(in);
+  auto out = checkpoint::deserialize<std::vector<std::unique_ptr<IdBase>>>(
+    ret->getBuffer()
+  );
+  ASSERT_EQ(out->size(), 3u);
+  EXPECT_NE(dynamic_cast<IdHashed*>((*out)[0].get()), nullptr);
+  EXPECT_NE(dynamic_cast<IdDeclared*>((*out)[1].get()), nullptr);
+  EXPECT_EQ(dynamic_cast<IdHashed*>((*out)[2].get()), nullptr);
+  EXPECT_EQ(dynamic_cast<IdDeclared*>((*out)[2].get()), nullptr);
+}
+
+TEST_F(TestVirtualTypeId, test_unknown_type_id) {
+  std::unique_ptr<IdBase> in = std::make_unique<IdDeclared>();
+  auto ret = checkpoint::serialize(in);
+
+  // Replace the declared id with one no type was registered with
+  TypeIdx const id = 424242;
+  TypeIdx const unknown = 424243;
+  auto const buf = ret->getBuffer();
+  auto const size = ret->getSize();
+  bool replaced = false;
+  for (std::size_t i = 0; i + sizeof(id) <= size; i++) {
+    if (std::memcmp(buf + i, &id, sizeof(id)) == 0) {
+      std::memcpy(buf + i, &unknown, sizeof(unknown));
+      replaced = true;
+      break;
+    }
+  }
+  ASSERT_TRUE(replaced);
+
+  EXPECT_THROW(
+    checkpoint::deserialize<std::unique_ptr<IdBase>>(buf), std::runtime_error
+  );
+}
+
+}}} // end namespace checkpoint::tests::unit